@@ -10,22 +10,22 @@ _generate_dynamic_array(AVRPtr);
 
 // https://en.wikipedia.org/wiki/Atmel_AVR_instruction_set#Instruction_encoding
 // http://ww1.microchip.com/downloads/cn/DeviceDoc/AVR-Instruction-Set-Manual-DS40002198A.pdf
-inline u16 NOP() {
+static inline u16 NOP() {
     return 0x0;
 }
 
-inline u16 MOVW(u8 rd, u8 rr) {
-    // values should be in registers 16-31
-    if (rd >= (1 << 5)) {
-        warning(0, "MOVW Rd value greater than 0xF");
+static inline u16 MOVW(u8 rd, u8 rr) {
+    // even registers 0-30, they get moved together with the one after them
+    if (rd >= (1 << 5) || (rd & 1)) {
+        warning(0, "MOVW Rd value isn't an even register");
     }
-    if (rr >= (1 << 5)) {
-        warning(0, "MOVW Rr value greater than 0xF");
+    if (rr >= (1 << 5) || (rr & 1)) {
+        warning(0, "MOVW Rr value isn't an even register");
     }
-    return 0x0100 | ((rd & 0xF) << 4) | (rr & 0xF);
+    return 0x0100 | ((rd & 0x1E) << 3) | ((rr & 0x1E) >> 1);
 }
 
-inline u16 MULS(u8 rd, u8 rr) {
+static inline u16 MULS(u8 rd, u8 rr) {
     // values should be in registers 16-31
     if (rd >= (1 << 5)) {
         warning(0, "MULS Rd value greater than 0xF");
@@ -36,7 +36,7 @@ inline u16 MULS(u8 rd, u8 rr) {
     return 0x0200 | ((rd & 0xF) << 4) | (rr & 0xF);
 }
 
-inline u16 MULSU(u8 rd, u8 rr) {
+static inline u16 MULSU(u8 rd, u8 rr) {
     // values should be in registers 16-23
     if (rd >= (1 << 4)) {
         warning(0, "MULSU Rd value greater than 0x7");
@@ -47,7 +47,7 @@ inline u16 MULSU(u8 rd, u8 rr) {
     return 0x0300 | ((rd & 0x7) << 4) | (rr & 0x7);
 }
 
-inline u16 FMUL(u8 rd, u8 rr) {
+static inline u16 FMUL(u8 rd, u8 rr) {
     // values should be in registers 16-23
     if (rd >= (1 << 4)) {
         warning(0, "FMUL Rd value greater than 0x7");
@@ -58,7 +58,7 @@ inline u16 FMUL(u8 rd, u8 rr) {
     return 0x0308 | ((rd & 0x7) << 4) | (rr & 0x7);
 }
 
-inline u16 FMULS(u8 rd, u8 rr) {
+static inline u16 FMULS(u8 rd, u8 rr) {
     // values should be in registers 16-23
     if (rd >= (1 << 4)) {
         warning(0, "FMULS Rd value greater than 0x7");
@@ -69,7 +69,7 @@ inline u16 FMULS(u8 rd, u8 rr) {
     return 0x0380 | ((rd & 0x7) << 4) | (rr & 0x7);
 }
 
-inline u16 FMULSU(u8 rd, u8 rr) {
+static inline u16 FMULSU(u8 rd, u8 rr) {
     // values should be in registers 16-23
     if (rd >= (1 << 4)) {
         warning(0, "FMULSU Rd value greater than 0x7");
@@ -80,7 +80,7 @@ inline u16 FMULSU(u8 rd, u8 rr) {
     return 0x0388 | ((rd & 0x7) << 4) | (rr & 0x7);
 }
 
-inline u16 CPC(u8 rd, u8 rr) {
+static inline u16 CPC(u8 rd, u8 rr) {
     // values should be in registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "CPC Rd value greater than 0x1F");
@@ -93,7 +93,7 @@ inline u16 CPC(u8 rd, u8 rr) {
     return 0x0400 | (rd << 4) | (rr & 0xF) | ((rr & 0x10) << 5);
 }
 
-inline u16 CP(u8 rd, u8 rr) {
+static inline u16 CP(u8 rd, u8 rr) {
     // values should be in registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "CP Rd value greater than 0x1F");
@@ -106,7 +106,7 @@ inline u16 CP(u8 rd, u8 rr) {
     return 0x1400 | (rd << 4) | (rr & 0xF) | ((rr & 0x10) << 5);
 }
 
-inline u16 SBC(u8 rd, u8 rr) {
+static inline u16 SBC(u8 rd, u8 rr) {
     // values should be in registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "SBC Rd value greater than 0x1F");
@@ -119,7 +119,7 @@ inline u16 SBC(u8 rd, u8 rr) {
     return 0x0800 | (rd << 4) | (rr & 0xF) | ((rr & 0x10) << 5);
 }
 
-inline u16 SUB(u8 rd, u8 rr) {
+static inline u16 SUB(u8 rd, u8 rr) {
     // values should be in registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "SUB Rd value greater than 0x1F");
@@ -132,7 +132,7 @@ inline u16 SUB(u8 rd, u8 rr) {
     return 0x1800 | (rd << 4) | (rr & 0xF) | ((rr & 0x10) << 5);
 }
 
-inline u16 ADD(u8 rd, u8 rr) {
+static inline u16 ADD(u8 rd, u8 rr) {
     // values should be in registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "ADD Rd value greater than 0x1F");
@@ -145,7 +145,7 @@ inline u16 ADD(u8 rd, u8 rr) {
     return 0x0C00 | (rd << 4) | (rr & 0xF) | ((rr & 0x10) << 5);
 }
 
-inline u16 ADC(u8 rd, u8 rr) {
+static inline u16 ADC(u8 rd, u8 rr) {
     // values should be in registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "ADC Rd value greater than 0x1F");
@@ -158,7 +158,7 @@ inline u16 ADC(u8 rd, u8 rr) {
     return 0x1C00 | (rd << 4) | (rr & 0xF) | ((rr & 0x10) << 5);
 }
 
-inline u16 LSL(u8 rd) {
+static inline u16 LSL(u8 rd) {
     // values should be in registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "LSL Rd value greater than 0x1F");
@@ -168,7 +168,7 @@ inline u16 LSL(u8 rd) {
     return 0x0C00 | (rd << 4) | (rr & 0xF) | ((rr & 0x10) << 5);
 }
 
-inline u16 ROL(u8 rd) {
+static inline u16 ROL(u8 rd) {
     // values should be in registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "ROL Rd value greater than 0x1F");
@@ -178,7 +178,7 @@ inline u16 ROL(u8 rd) {
     return 0x1C00 | (rd << 4) | (rr & 0xF) | ((rr & 0x10) << 5);
 }
 
-inline u16 CPSE(u8 rd, u8 rr) {
+static inline u16 CPSE(u8 rd, u8 rr) {
     // values should be in registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "ADC Rd value greater than 0x1F");
@@ -191,7 +191,7 @@ inline u16 CPSE(u8 rd, u8 rr) {
     return 0x1000 | (rd << 4) | (rr & 0xF) | ((rr & 0x10) << 5);
 }
 
-inline u16 AND(u8 rd, u8 rr) {
+static inline u16 AND(u8 rd, u8 rr) {
     // values should be in registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "AND Rd value greater than 0x1F");
@@ -204,7 +204,7 @@ inline u16 AND(u8 rd, u8 rr) {
     return 0x2000 | (rd << 4) | (rr & 0xF) | ((rr & 0x10) << 5);
 }
 
-inline u16 EOR(u8 rd, u8 rr) {
+static inline u16 EOR(u8 rd, u8 rr) {
     // values should be in registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "EOR Rd value greater than 0x1F");
@@ -217,7 +217,7 @@ inline u16 EOR(u8 rd, u8 rr) {
     return 0x2400 | (rd << 4) | (rr & 0xF) | ((rr & 0x10) << 5);
 }
 
-inline u16 OR(u8 rd, u8 rr) {
+static inline u16 OR(u8 rd, u8 rr) {
     // values should be in registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "OR Rd value greater than 0x1F");
@@ -230,7 +230,7 @@ inline u16 OR(u8 rd, u8 rr) {
     return 0x2800 | (rd << 4) | (rr & 0xF) | ((rr & 0x10) << 5);
 }
 
-inline u16 MOV(u8 rd, u8 rr) {
+static inline u16 MOV(u8 rd, u8 rr) {
     // values should be in registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "MOV Rd value greater than 0x1F");
@@ -243,7 +243,7 @@ inline u16 MOV(u8 rd, u8 rr) {
     return 0x2C00 | (rd << 4) | (rr & 0xF) | ((rr & 0x10) << 5);
 }
 
-inline u16 CPI(u8 rd, u8 K) {
+static inline u16 CPI(u8 rd, u8 K) {
     // registers 16-31, K 0-255
     if (rd >= (1 << 5)) {
         warning(0, "CPI Rd value greater than 0xF");
@@ -251,7 +251,7 @@ inline u16 CPI(u8 rd, u8 K) {
     return 0x3000 | ((rd & 0xF) << 4) | (K & 0xF) | ((K & 0xF0) << 4);
 }
 
-inline u16 SBCI(u8 rd, u8 K) {
+static inline u16 SBCI(u8 rd, u8 K) {
     // registers 16-31, K 0-255
     if (rd >= (1 << 5)) {
         warning(0, "SBCI Rd value greater than 0xF");
@@ -259,7 +259,7 @@ inline u16 SBCI(u8 rd, u8 K) {
     return 0x4000 | ((rd & 0xF) << 4) | (K & 0xF) | ((K & 0xF0) << 4);
 }
 
-inline u16 SUBI(u8 rd, u8 K) {
+static inline u16 SUBI(u8 rd, u8 K) {
     // registers 16-31, K 0-255
     if (rd >= (1 << 5)) {
         warning(0, "SUBI Rd value greater than 0xF");
@@ -267,7 +267,7 @@ inline u16 SUBI(u8 rd, u8 K) {
     return 0x5000 | ((rd & 0xF) << 4) | (K & 0xF) | ((K & 0xF0) << 4);
 }
 
-inline u16 ORI(u8 rd, u8 K) {
+static inline u16 ORI(u8 rd, u8 K) {
     // registers 16-31, K 0-255
     if (rd >= (1 << 5)) {
         warning(0, "ORI Rd value greater than 0xF");
@@ -275,7 +275,7 @@ inline u16 ORI(u8 rd, u8 K) {
     return 0x6000 | ((rd & 0xF) << 4) | (K & 0xF) | ((K & 0xF0) << 4);
 }
 
-inline u16 SBR(u8 rd, u8 K) {
+static inline u16 SBR(u8 rd, u8 K) {
     // registers 16-31, K 0-255
     if (rd >= (1 << 5)) {
         warning(0, "SBR Rd value greater than 0xF");
@@ -283,7 +283,7 @@ inline u16 SBR(u8 rd, u8 K) {
     return 0x6000 | ((rd & 0xF) << 4) | (K & 0xF) | ((K & 0xF0) << 4);
 }
 
-inline u16 ANDI(u8 rd, u8 K) {
+static inline u16 ANDI(u8 rd, u8 K) {
     // registers 16-31, K 0-255
     if (rd >= (1 << 5)) {
         warning(0, "ANDI Rd value greater than 0xF");
@@ -291,7 +291,7 @@ inline u16 ANDI(u8 rd, u8 K) {
     return 0x7000 | ((rd & 0xF) << 4) | (K & 0xF) | ((K & 0xF0) << 4);
 }
 
-inline u16 CBR(u8 rd, u8 K) {
+static inline u16 CBR(u8 rd, u8 K) {
     // registers 16-31, K 0-255
     if (rd >= (1 << 5)) {
         warning(0, "CBR Rd value greater than 0xF");
@@ -299,7 +299,7 @@ inline u16 CBR(u8 rd, u8 K) {
     return 0x7000 | ((rd & 0xF) << 4) | (K & 0xF) | ((K & 0xF0) << 4);
 }
 
-inline u16 LDDz(u8 rd, u8 K) {
+static inline u16 LDDz(u8 rd, u8 K) {
     // registers 0-31, K 0-64
     if (rd >= (1 << 6)) {
         warning(0, "LDDz Rd value greater than 0x1F");
@@ -307,10 +307,10 @@ inline u16 LDDz(u8 rd, u8 K) {
     if (K >= (1 << 7)) {
         warning(0, "LDDz K value greater than 0x3F");
     }
-    return 0x8000 | (K & 0x7) | ((K & 0x18) << 7) | ((K & 0x20) << 11) | ((rd & 0x1F) << 4);
+    return 0x8000 | (K & 0x7) | ((K & 0x18) << 7) | ((K & 0x20) << 8) | ((rd & 0x1F) << 4);
 }
 
-inline u16 LDDy(u8 rd, u8 K) {
+static inline u16 LDDy(u8 rd, u8 K) {
     // registers 0-31, K 0-64
     if (rd >= (1 << 6)) {
         warning(0, "LDDy Rd value greater than 0x1F");
@@ -318,10 +318,10 @@ inline u16 LDDy(u8 rd, u8 K) {
     if (K >= (1 << 7)) {
         warning(0, "LDDy K value greater than 0x3F");
     }
-    return 0x8008 | (K & 0x7) | ((K & 0x18) << 7) | ((K & 0x20) << 11) | ((rd & 0x1F) << 4);
+    return 0x8008 | (K & 0x7) | ((K & 0x18) << 7) | ((K & 0x20) << 8) | ((rd & 0x1F) << 4);
 }
 
-inline u16 STDz(u8 rd, u8 K) {
+static inline u16 STDz(u8 rd, u8 K) {
     // registers 0-31, K 0-64
     if (rd >= (1 << 6)) {
         warning(0, "STDz Rd value greater than 0x1F");
@@ -329,10 +329,10 @@ inline u16 STDz(u8 rd, u8 K) {
     if (K >= (1 << 7)) {
         warning(0, "STDz K value greater than 0x3F");
     }
-    return 0x8200 | (K & 0x7) | ((K & 0x18) << 7) | ((K & 0x20) << 11) | ((rd & 0x1F) << 4);
+    return 0x8200 | (K & 0x7) | ((K & 0x18) << 7) | ((K & 0x20) << 8) | ((rd & 0x1F) << 4);
 }
 
-inline u16 STDy(u8 rd, u8 K) {
+static inline u16 STDy(u8 rd, u8 K) {
     // registers 0-31, K 0-64
     if (rd >= (1 << 6)) {
         warning(0, "STDy Rd value greater than 0x1F");
@@ -340,10 +340,10 @@ inline u16 STDy(u8 rd, u8 K) {
     if (K >= (1 << 7)) {
         warning(0, "STDy K value greater than 0x3F");
     }
-    return 0x8208 | (K & 0x7) | ((K & 0x18) << 7) | ((K & 0x20) << 11) | ((rd & 0x1F) << 4);
+    return 0x8208 | (K & 0x7) | ((K & 0x18) << 7) | ((K & 0x20) << 8) | ((rd & 0x1F) << 4);
 }
 
-inline u32 LDS(u8 rd, u16 address) {
+static inline u32 LDS(u8 rd, u16 address) {
     // registers 0-31, address 0-65535
     if (rd >= (1 << 6)) {
         warning(0, "LDS Rd value greater than 0x1F");
@@ -351,7 +351,7 @@ inline u32 LDS(u8 rd, u16 address) {
     return (u32)0x90000000 | address | ((rd & 0x1F) << 20);
 }
 
-inline u32 STS(u8 rd, u16 address) {
+static inline u32 STS(u8 rd, u16 address) {
     // registers 0-31, address 0-65535
     if (rd >= (1 << 6)) {
         warning(0, "STS Rd value greater than 0x1F");
@@ -359,7 +359,7 @@ inline u32 STS(u8 rd, u16 address) {
     return (u32)0x92000000 | address | ((rd & 0x1F) << 20);
 }
 
-inline u16 LDp(u8 rd, u8 y) {
+static inline u16 LDp(u8 rd, u8 y) {
     // registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "LD+ Rd value greater than 0x1F");
@@ -368,7 +368,7 @@ inline u16 LDp(u8 rd, u8 y) {
     return 0x9001 | ((rd & 0x1F) << 4) | (y << 3);
 }
 
-inline u16 STp(u8 rd, u8 y) {
+static inline u16 STp(u8 rd, u8 y) {
     // registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "ST+ Rd value greater than 0x1F");
@@ -377,7 +377,7 @@ inline u16 STp(u8 rd, u8 y) {
     return 0x9201 | ((rd & 0x1F) << 4) | (y << 3);
 }
 
-inline u16 LDm(u8 rd, u8 y) {
+static inline u16 LDm(u8 rd, u8 y) {
     // registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "LD- Rd value greater than 0x1F");
@@ -386,7 +386,7 @@ inline u16 LDm(u8 rd, u8 y) {
     return 0x9001 | ((rd & 0x1F) << 4) | (y << 3);
 }
 
-inline u16 STm(u8 rd, u8 y) {
+static inline u16 STm(u8 rd, u8 y) {
     // registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "ST- Rd value greater than 0x1F");
@@ -395,7 +395,7 @@ inline u16 STm(u8 rd, u8 y) {
     return 0x9202 | ((rd & 0x1F) << 4) | (y << 3);
 }
 
-inline u16 LPM(u8 rd) {
+static inline u16 LPM(u8 rd) {
     // registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "LPM Rd value greater than 0x1F");
@@ -403,7 +403,7 @@ inline u16 LPM(u8 rd) {
     return 0x9004 | ((rd & 0x1F) << 4);
 }
 
-inline u16 ELPM(u8 rd) {
+static inline u16 ELPM(u8 rd) {
     // registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "ELPM Rd value greater than 0x1F");
@@ -411,7 +411,7 @@ inline u16 ELPM(u8 rd) {
     return 0x9006 | ((rd & 0x1F) << 4);
 }
 
-inline u16 LPMp(u8 rd) {
+static inline u16 LPMp(u8 rd) {
     // registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "LPM+ Rd value greater than 0x1F");
@@ -419,7 +419,7 @@ inline u16 LPMp(u8 rd) {
     return 0x9005 | ((rd & 0x1F) << 4);
 }
 
-inline u16 ELPMp(u8 rd) {
+static inline u16 ELPMp(u8 rd) {
     // registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "ELPM+ Rd value greater than 0x1F");
@@ -427,7 +427,7 @@ inline u16 ELPMp(u8 rd) {
     return 0x9007 | ((rd & 0x1F) << 4);
 }
 
-inline u16 XCH(u8 rd) {
+static inline u16 XCH(u8 rd) {
     // registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "XCH Rd value greater than 0x1F");
@@ -435,7 +435,7 @@ inline u16 XCH(u8 rd) {
     return 0x9204 | ((rd & 0x1F) << 4);
 }
 
-inline u16 LAS(u8 rd) {
+static inline u16 LAS(u8 rd) {
     // registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "LAS Rd value greater than 0x1F");
@@ -443,7 +443,7 @@ inline u16 LAS(u8 rd) {
     return 0x9205 | ((rd & 0x1F) << 4);
 }
 
-inline u16 LAC(u8 rd) {
+static inline u16 LAC(u8 rd) {
     // registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "LAC Rd value greater than 0x1F");
@@ -451,7 +451,7 @@ inline u16 LAC(u8 rd) {
     return 0x9206 | ((rd & 0x1F) << 4);
 }
 
-inline u16 LAT(u8 rd) {
+static inline u16 LAT(u8 rd) {
     // registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "LAT Rd value greater than 0x1F");
@@ -459,7 +459,7 @@ inline u16 LAT(u8 rd) {
     return 0x9207 | ((rd & 0x1F) << 4);
 }
 
-inline u16 LDx(u8 rd) {
+static inline u16 LDx(u8 rd) {
     // registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "LDx Rd value greater than 0x1F");
@@ -467,7 +467,7 @@ inline u16 LDx(u8 rd) {
     return 0x900C | ((rd & 0x1F) << 4);
 }
 
-inline u16 STx(u8 rd) {
+static inline u16 STx(u8 rd) {
     // registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "STx Rd value greater than 0x1F");
@@ -475,7 +475,7 @@ inline u16 STx(u8 rd) {
     return 0x920C | ((rd & 0x1F) << 4);
 }
 
-inline u16 LDxp(u8 rd) {
+static inline u16 LDxp(u8 rd) {
     // registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "LDxp Rd value greater than 0x1F");
@@ -483,7 +483,7 @@ inline u16 LDxp(u8 rd) {
     return 0x900D | ((rd & 0x1F) << 4);
 }
 
-inline u16 STxp(u8 rd) {
+static inline u16 STxp(u8 rd) {
     // registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "STxp Rd value greater than 0x1F");
@@ -491,7 +491,7 @@ inline u16 STxp(u8 rd) {
     return 0x920D | ((rd & 0x1F) << 4);
 }
 
-inline u16 LDxm(u8 rd) {
+static inline u16 LDxm(u8 rd) {
     // registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "LDxm Rd value greater than 0x1F");
@@ -499,7 +499,7 @@ inline u16 LDxm(u8 rd) {
     return 0x900E | ((rd & 0x1F) << 4);
 }
 
-inline u16 STxm(u8 rd) {
+static inline u16 STxm(u8 rd) {
     // registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "STxm Rd value greater than 0x1F");
@@ -507,7 +507,7 @@ inline u16 STxm(u8 rd) {
     return 0x920E | ((rd & 0x1F) << 4);
 }
 
-inline u16 POP(u8 rd) {
+static inline u16 POP(u8 rd) {
     // registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "POP Rd value greater than 0x1F");
@@ -515,7 +515,7 @@ inline u16 POP(u8 rd) {
     return 0x900F | ((rd & 0x1F) << 4);
 }
 
-inline u16 PUSH(u8 rd) {
+static inline u16 PUSH(u8 rd) {
     // registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "PUSH Rd value greater than 0x1F");
@@ -523,7 +523,7 @@ inline u16 PUSH(u8 rd) {
     return 0x920F | ((rd & 0x1F) << 4);
 }
 
-inline u16 COM(u8 rd) {
+static inline u16 COM(u8 rd) {
     // registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "COM Rd value greater than 0x1F");
@@ -531,7 +531,7 @@ inline u16 COM(u8 rd) {
     return 0x9400 | ((rd & 0x1F) << 4);
 }
 
-inline u16 NEG(u8 rd) {
+static inline u16 NEG(u8 rd) {
     // registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "NEG Rd value greater than 0x1F");
@@ -539,7 +539,7 @@ inline u16 NEG(u8 rd) {
     return 0x9401 | ((rd & 0x1F) << 4);
 }
 
-inline u16 SWAP(u8 rd) {
+static inline u16 SWAP(u8 rd) {
     // registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "SWAP Rd value greater than 0x1F");
@@ -547,7 +547,7 @@ inline u16 SWAP(u8 rd) {
     return 0x9402 | ((rd & 0x1F) << 4);
 }
 
-inline u16 INC(u8 rd) {
+static inline u16 INC(u8 rd) {
     // registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "INC Rd value greater than 0x1F");
@@ -555,7 +555,7 @@ inline u16 INC(u8 rd) {
     return 0x9403 | ((rd & 0x1F) << 4);
 }
 
-inline u16 ASR(u8 rd) {
+static inline u16 ASR(u8 rd) {
     // registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "COM Rd value greater than 0x1F");
@@ -563,7 +563,7 @@ inline u16 ASR(u8 rd) {
     return 0x9405 | ((rd & 0x1F) << 4);
 }
 
-inline u16 LSR(u8 rd) {
+static inline u16 LSR(u8 rd) {
     // registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "LSR Rd value greater than 0x1F");
@@ -571,7 +571,7 @@ inline u16 LSR(u8 rd) {
     return 0x9406 | ((rd & 0x1F) << 4);
 }
 
-inline u16 ROR(u8 rd) {
+static inline u16 ROR(u8 rd) {
     // registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "ROR Rd value greater than 0x1F");
@@ -579,7 +579,7 @@ inline u16 ROR(u8 rd) {
     return 0x9407 | ((rd & 0x1F) << 4);
 }
 
-inline u16 SER(u8 rd) {
+static inline u16 SER(u8 rd) {
     // registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "SE Rd value greater than 0x1F");
@@ -587,123 +587,124 @@ inline u16 SER(u8 rd) {
     return 0xCF0F | ((rd & 0xF) << 4);
 }
 
-inline u16 CLR(u8 rd) {
+static inline u16 CLR(u8 rd) {
     // registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "CLR Rd value greater than 0x1F");
     }
-    return 0x2400 | (rd & 0xF) | ((rd & 0xF) << 4);
+    rd &= 0x1F;
+    return 0x2400 | (rd << 4) | (rd & 0xF) | ((rd & 0x10) << 5);
 }
 
-inline u16 SEC() {
+static inline u16 SEC() {
     return 0x9408;
 }
 
-inline u16 SEH() {
+static inline u16 SEH() {
     return 0x9458;
 }
 
-inline u16 SEI() {
+static inline u16 SEI() {
     return 0x9478;
 }
 
-inline u16 SEN() {
+static inline u16 SEN() {
     return 0x9428;
 }
 
-inline u16 SES() {
+static inline u16 SES() {
     return 0x9448;
 }
 
-inline u16 SET() {
+static inline u16 SET() {
     return 0x9468;
 }
 
-inline u16 SEV() {
+static inline u16 SEV() {
     return 0x9438;
 }
 
-inline u16 SEZ() {
+static inline u16 SEZ() {
     return 0x948;
 }
 
-inline u16 CLC() {
+static inline u16 CLC() {
     return 0x9488;
 }
 
-inline u16 CLH() {
+static inline u16 CLH() {
     return 0x94D8;
 }
 
-inline u16 CLI() {
+static inline u16 CLI() {
     return 0x94F8;
 }
 
-inline u16 CLN() {
+static inline u16 CLN() {
     return 0x94A8;
 }
 
-inline u16 CLS() {
+static inline u16 CLS() {
     return 0x94C8;
 }
 
-inline u16 CLT() {
+static inline u16 CLT() {
     return 0x94E8;
 }
 
-inline u16 CLV() {
+static inline u16 CLV() {
     return 0x94B8;
 }
 
-inline u16 CLZ() {
+static inline u16 CLZ() {
     return 0x9498;
 }
 
-inline u16 RET() {
+static inline u16 RET() {
     return 0x9508;
 }
 
-inline u16 RETI() {
+static inline u16 RETI() {
     return 0x9518;
 }
 
-inline u16 SLEEP() {
+static inline u16 SLEEP() {
     return 0x9588;
 }
 
-inline u16 BREAK() {
+static inline u16 BREAK() {
     return 0x9598;
 }
 
-inline u16 WDR() {
+static inline u16 WDR() {
     return 0x95A8;
 }
 
-inline u16 SPM() {
+static inline u16 SPM() {
     return 0x95E8;
 }
 
-inline u16 SPMzp() {
+static inline u16 SPMzp() {
     return 0x95F8;
 }
 
-inline u16 IJMP() {
+static inline u16 IJMP() {
     return 0x9409;
 }
 
-inline u16 EIJMP() {
+static inline u16 EIJMP() {
     return 0x9419;
 }
 
-inline u16 ICALL() {
+static inline u16 ICALL() {
     return 0x9509;
 }
 
-inline u16 EICALL() {
+static inline u16 EICALL() {
     return 0x9519;
 }
 
-inline u16 DEC(u8 rd) {
+static inline u16 DEC(u8 rd) {
     // registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "DEC Rd value greater than 0x1F");
@@ -711,7 +712,7 @@ inline u16 DEC(u8 rd) {
     return 0x940A | ((rd & 0x1F) << 4);
 }
 
-inline u16 DES(u8 K) {
+static inline u16 DES(u8 K) {
     // registers 0-31
     if (K >= (1 << 5)) {
         warning(0, "DES K value greater than 0xF");
@@ -719,7 +720,7 @@ inline u16 DES(u8 K) {
     return 0x940B | ((K & 0xF) << 4);
 }
 
-inline u32 JMP(u32 address) {
+static inline u32 JMP(u32 address) {
     // address 0-4194303
     if (address >= (1 << 23)) {
         warning(0, "JMP address value greater than 0x3FFFFF");
@@ -727,7 +728,7 @@ inline u32 JMP(u32 address) {
     return (u32)0x940C0000 | (address & 0x1FFFF) | ((address & 0x3E0000) << 3);
 }
 
-inline u32 CALL(u32 address) {
+static inline u32 CALL(u32 address) {
     // address 0-4194303
     if (address >= (1 << 23)) {
         warning(0, "CALL address value greater than 0x3FFFFF");
@@ -735,31 +736,31 @@ inline u32 CALL(u32 address) {
     return (u32)0x940E0000 | (address & 0x1FFFF) | ((address & 0x3E0000) << 3);
 }
 
-inline u16 ADIW(u8 rp, u8 K) {
-    // pp = Register pair, W, X, Y or Z
+static inline u16 ADIW(u8 rp, u8 K) {
+    // rp = the low register of the pair, 24 (W), 26 (X), 28 (Y) or 30 (Z)
     // K 0-63
-    if (rp >= (1 << 3)) {
-        warning(0, "ADIW Rp value greater than 0x3");
+    if (rp < 24 || rp > 30 || (rp & 1)) {
+        warning(0, "ADIW Rp isn't one of r24, r26, r28 or r30");
     }
-    if (K >= (1 << 7)) {
+    if (K >= (1 << 6)) {
         warning(0, "ADIW K value greater than 0x3F");
     }
-    return 0x960B | (K & 0xF) | ((rp & 0x3) << 4) | ((K & 0x30) << 2);
+    return 0x9600 | (K & 0xF) | ((((rp - 24) >> 1) & 0x3) << 4) | ((K & 0x30) << 2);
 }
 
-inline u16 SBIW(u8 rp, u8 K) {
-    // pp = Register pair, W, X, Y or Z
+static inline u16 SBIW(u8 rp, u8 K) {
+    // rp = the low register of the pair, 24 (W), 26 (X), 28 (Y) or 30 (Z)
     // K 0-63
-    if (rp >= (1 << 3)) {
-        warning(0, "SBIW Rp value greater than 0x3");
+    if (rp < 24 || rp > 30 || (rp & 1)) {
+        warning(0, "SBIW Rp isn't one of r24, r26, r28 or r30");
     }
-    if (K >= (1 << 7)) {
+    if (K >= (1 << 6)) {
         warning(0, "SBIW K value greater than 0x3F");
     }
-    return 0x970B | (K & 0xF) | ((rp & 0x3) << 4) | ((K & 0x30) << 2);
+    return 0x9700 | (K & 0xF) | ((((rp - 24) >> 1) & 0x3) << 4) | ((K & 0x30) << 2);
 }
 
-inline u16 CBI(u8 A, u8 B) {
+static inline u16 CBI(u8 A, u8 B) {
     // A 0-63, B 0-8
     if (A >= (1 << 6)) {
         warning(0, "CBI A value greater than 0x1F");
@@ -770,7 +771,7 @@ inline u16 CBI(u8 A, u8 B) {
     return 0x9800 | (B & 0x7) | ((A & 0x1F) << 3);
 }
 
-inline u16 SBI(u8 A, u8 B) {
+static inline u16 SBI(u8 A, u8 B) {
     // A 0-63, B 0-8
     if (A >= (1 << 6)) {
         warning(0, "SBI A value greater than 0x1F");
@@ -781,7 +782,7 @@ inline u16 SBI(u8 A, u8 B) {
     return 0x9A00 | (B & 0x7) | ((A & 0x1F) << 3);
 }
 
-inline u16 SBIC(u8 A, u8 B) {
+static inline u16 SBIC(u8 A, u8 B) {
     // A 0-63, B 0-8
     if (A >= (1 << 6)) {
         warning(0, "SBIC A value greater than 0x1F");
@@ -792,7 +793,7 @@ inline u16 SBIC(u8 A, u8 B) {
     return 0x9900 | (B & 0x7) | ((A & 0x1F) << 3);
 }
 
-inline u16 SBIS(u8 A, u8 B) {
+static inline u16 SBIS(u8 A, u8 B) {
     // A 0-63, B 0-8
     if (A >= (1 << 6)) {
         warning(0, "SBIS A value greater than 0x1F");
@@ -803,7 +804,7 @@ inline u16 SBIS(u8 A, u8 B) {
     return 0x9C00 | (B & 0x7) | ((A & 0x1F) << 3);
 }
 
-inline u16 MUL(u8 rd, u8 rr) {
+static inline u16 MUL(u8 rd, u8 rr) {
     // values should be in registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "MUL Rd value greater than 0x1F");
@@ -816,7 +817,7 @@ inline u16 MUL(u8 rd, u8 rr) {
     return 0x9C00 | (rd << 4) | (rr & 0xF) | ((rr & 0x10) << 5);
 }
 
-inline u16 IN(u8 rd, u8 a) {
+static inline u16 IN(u8 rd, u8 a) {
     // values should be in registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "IN Rd value greater than 0x1F");
@@ -829,7 +830,7 @@ inline u16 IN(u8 rd, u8 a) {
     return 0xB000 | (rd << 4) | (a & 0xF) | ((a & 0x30) << 5);
 }
 
-inline u16 OUT(u8 rd, u8 a) {
+static inline u16 OUT(u8 rd, u8 a) {
     // values should be in registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "OUT Rd value greater than 0x1F");
@@ -842,7 +843,7 @@ inline u16 OUT(u8 rd, u8 a) {
     return 0xB800 | (rd << 4) | (a & 0xF) | ((a & 0x30) << 5);
 }
 
-inline u16 RJMP(u16 offset) {
+static inline u16 RJMP(u16 offset) {
     // offset is a signed 12 bit integer, we'll treat it as an uint for ease
     // please prepare it beforehand uwu
     if (offset >= (1 << 13)) {
@@ -851,7 +852,7 @@ inline u16 RJMP(u16 offset) {
     return 0xC000 | (offset & 0x0FFF);
 }
 
-inline u16 RCALL(u16 offset) {
+static inline u16 RCALL(u16 offset) {
     // offset is a signed 12 bit integer, we'll treat it as an uint for ease
     // please prepare it beforehand uwu
     if (offset >= (1 << 13)) {
@@ -860,7 +861,7 @@ inline u16 RCALL(u16 offset) {
     return 0xD000 | (offset & 0x0FFF);
 }
 
-inline u16 LDI(u8 rd, u8 K) {
+static inline u16 LDI(u8 rd, u8 K) {
     // registers 16-31, K 0-255
     if (rd >= (1 << 5)) {
         warning(0, "LDI Rd value greater than 0xF");
@@ -868,7 +869,7 @@ inline u16 LDI(u8 rd, u8 K) {
     return 0xE000 | ((rd & 0xF) << 4) | (K & 0xF) | ((K & 0xF0) << 4);
 }
 
-inline u16 BRBC(u8 K, u8 B) {
+static inline u16 BRBC(u8 K, u8 B) {
     // K 0-127 (7 bit signed int, treated as uint), B 0-8
     if (K >= (1 << 7)) {
         warning(0, "BRBC K value greater than 0x7F");
@@ -879,7 +880,7 @@ inline u16 BRBC(u8 K, u8 B) {
     return 0xF400 | ((K & 0x7F) << 3) | (B & 0x7);
 }
 
-inline u16 BRBS(u8 K, u8 B) {
+static inline u16 BRBS(u8 K, u8 B) {
     // K 0-127 (7 bit signed int, treated as uint), B 0-8
     if (K >= (1 << 7)) {
         warning(0, "BRBS K value greater than 0x7F");
@@ -890,7 +891,7 @@ inline u16 BRBS(u8 K, u8 B) {
     return 0xF000 | ((K & 0x7F) << 3) | (B & 0x7);
 }
 
-inline u16 BRCC(u8 K) {
+static inline u16 BRCC(u8 K) {
     // K 0-127 (7 bit signed int, treated as uint)
     if (K >= (1 << 7)) {
         warning(0, "BRCC K value greater than 0x7F");
@@ -898,7 +899,7 @@ inline u16 BRCC(u8 K) {
     return 0xF400 | ((K & 0x7F) << 3);
 }
 
-inline u16 BRCS(u8 K) {
+static inline u16 BRCS(u8 K) {
     // K 0-127 (7 bit signed int, treated as uint)
     if (K >= (1 << 7)) {
         warning(0, "BRCS K value greater than 0x7F");
@@ -906,7 +907,7 @@ inline u16 BRCS(u8 K) {
     return 0xF000 | ((K & 0x7F) << 3);
 }
 
-inline u16 BREQ(u8 K) {
+static inline u16 BREQ(u8 K) {
     // K 0-127 (7 bit signed int, treated as uint)
     if (K >= (1 << 7)) {
         warning(0, "BREQ K value greater than 0x7F");
@@ -914,7 +915,7 @@ inline u16 BREQ(u8 K) {
     return 0xF001 | ((K & 0x7F) << 3);
 }
 
-inline u16 BRGE(u8 K) {
+static inline u16 BRGE(u8 K) {
     // K 0-127 (7 bit signed int, treated as uint)
     if (K >= (1 << 7)) {
         warning(0, "BRGE K value greater than 0x7F");
@@ -922,7 +923,7 @@ inline u16 BRGE(u8 K) {
     return 0xF404 | ((K & 0x7F) << 3);
 }
 
-inline u16 BRHC(u8 K) {
+static inline u16 BRHC(u8 K) {
     // K 0-127 (7 bit signed int, treated as uint)
     if (K >= (1 << 7)) {
         warning(0, "BRHC K value greater than 0x7F");
@@ -930,7 +931,7 @@ inline u16 BRHC(u8 K) {
     return 0xF405 | ((K & 0x7F) << 3);
 }
 
-inline u16 BRHS(u8 K) {
+static inline u16 BRHS(u8 K) {
     // K 0-127 (7 bit signed int, treated as uint)
     if (K >= (1 << 7)) {
         warning(0, "BRHS K value greater than 0x7F");
@@ -938,7 +939,7 @@ inline u16 BRHS(u8 K) {
     return 0xF005 | ((K & 0x7F) << 3);
 }
 
-inline u16 BRID(u8 K) {
+static inline u16 BRID(u8 K) {
     // K 0-127 (7 bit signed int, treated as uint)
     if (K >= (1 << 7)) {
         warning(0, "BRID K value greater than 0x7F");
@@ -946,7 +947,7 @@ inline u16 BRID(u8 K) {
     return 0xF407 | ((K & 0x7F) << 3);
 }
 
-inline u16 BRIE(u8 K) {
+static inline u16 BRIE(u8 K) {
     // K 0-127 (7 bit signed int, treated as uint)
     if (K >= (1 << 7)) {
         warning(0, "BRIE K value greater than 0x7F");
@@ -954,7 +955,7 @@ inline u16 BRIE(u8 K) {
     return 0xF007 | ((K & 0x7F) << 3);
 }
 
-inline u16 BRLO(u8 K) {
+static inline u16 BRLO(u8 K) {
     // K 0-127 (7 bit signed int, treated as uint)
     if (K >= (1 << 7)) {
         warning(0, "BRLO K value greater than 0x7F");
@@ -962,7 +963,7 @@ inline u16 BRLO(u8 K) {
     return 0xF000 | ((K & 0x7F) << 3);
 }
 
-inline u16 BRLT(u8 K) {
+static inline u16 BRLT(u8 K) {
     // K 0-127 (7 bit signed int, treated as uint)
     if (K >= (1 << 7)) {
         warning(0, "BRLT K value greater than 0x7F");
@@ -970,7 +971,7 @@ inline u16 BRLT(u8 K) {
     return 0xF004 | ((K & 0x7F) << 3);
 }
 
-inline u16 BRMI(u8 K) {
+static inline u16 BRMI(u8 K) {
     // K 0-127 (7 bit signed int, treated as uint)
     if (K >= (1 << 7)) {
         warning(0, "BRMI K value greater than 0x7F");
@@ -978,7 +979,7 @@ inline u16 BRMI(u8 K) {
     return 0xF002 | ((K & 0x7F) << 3);
 }
 
-inline u16 BRNE(u8 K) {
+static inline u16 BRNE(u8 K) {
     // K 0-127 (7 bit signed int, treated as uint)
     if (K >= (1 << 7)) {
         warning(0, "BRNE K value greater than 0x7F");
@@ -986,7 +987,7 @@ inline u16 BRNE(u8 K) {
     return 0xF401 | ((K & 0x7F) << 3);
 }
 
-inline u16 BRPL(u8 K) {
+static inline u16 BRPL(u8 K) {
     // K 0-127 (7 bit signed int, treated as uint)
     if (K >= (1 << 7)) {
         warning(0, "BRPL K value greater than 0x7F");
@@ -994,7 +995,7 @@ inline u16 BRPL(u8 K) {
     return 0xF402 | ((K & 0x7F) << 3);
 }
 
-inline u16 BRSH(u8 K) {
+static inline u16 BRSH(u8 K) {
     // K 0-127 (7 bit signed int, treated as uint)
     if (K >= (1 << 7)) {
         warning(0, "BRSH K value greater than 0x7F");
@@ -1002,7 +1003,7 @@ inline u16 BRSH(u8 K) {
     return 0xF400 | ((K & 0x7F) << 3);
 }
 
-inline u16 BRTC(u8 K) {
+static inline u16 BRTC(u8 K) {
     // K 0-127 (7 bit signed int, treated as uint)
     if (K >= (1 << 7)) {
         warning(0, "BRTC K value greater than 0x7F");
@@ -1010,7 +1011,7 @@ inline u16 BRTC(u8 K) {
     return 0xF406 | ((K & 0x7F) << 3);
 }
 
-inline u16 BRTS(u8 K) {
+static inline u16 BRTS(u8 K) {
     // K 0-127 (7 bit signed int, treated as uint)
     if (K >= (1 << 7)) {
         warning(0, "BRTS K value greater than 0x7F");
@@ -1018,7 +1019,7 @@ inline u16 BRTS(u8 K) {
     return 0xF006 | ((K & 0x7F) << 3);
 }
 
-inline u16 BRVC(u8 K) {
+static inline u16 BRVC(u8 K) {
     // K 0-127 (7 bit signed int, treated as uint)
     if (K >= (1 << 7)) {
         warning(0, "BRVC K value greater than 0x7F");
@@ -1026,7 +1027,7 @@ inline u16 BRVC(u8 K) {
     return 0xF403 | ((K & 0x7F) << 3);
 }
 
-inline u16 BRVS(u8 K) {
+static inline u16 BRVS(u8 K) {
     // K 0-127 (7 bit signed int, treated as uint)
     if (K >= (1 << 7)) {
         warning(0, "BRVS K value greater than 0x7F");
@@ -1034,7 +1035,7 @@ inline u16 BRVS(u8 K) {
     return 0xF003 | ((K & 0x7F) << 3);
 }
 
-inline u16 BSET(u8 S) {
+static inline u16 BSET(u8 S) {
     // S 0-7 
     if (S >= (1 << 7)) {
         warning(0, "BSET S value greater than 0x7");
@@ -1042,7 +1043,7 @@ inline u16 BSET(u8 S) {
     return 0x9408 | ((S & 0x7) << 4);
 }
 
-inline u16 BCLR(u8 S) {
+static inline u16 BCLR(u8 S) {
     // S 0-7 
     if (S >= (1 << 7)) {
         warning(0, "BCLR S value greater than 0x7");
@@ -1050,7 +1051,7 @@ inline u16 BCLR(u8 S) {
     return 0x9488 | ((S & 0x7) << 4);
 }
 
-inline u16 BLD(u8 rd, u8 B) {
+static inline u16 BLD(u8 rd, u8 B) {
     // registers 16-31, B 0-8
     if (rd >= (1 << 6)) {
         warning(0, "BLD Rd value greater than 0x1F");
@@ -1061,7 +1062,7 @@ inline u16 BLD(u8 rd, u8 B) {
     return 0xF800 | ((rd & 0x1F) << 4) | (B & 0x7);
 }
 
-inline u16 BST(u8 rd, u8 B) {
+static inline u16 BST(u8 rd, u8 B) {
     // registers 16-31, B 0-8
     if (rd >= (1 << 6)) {
         warning(0, "BST Rd value greater than 0x1F");
@@ -1072,7 +1073,7 @@ inline u16 BST(u8 rd, u8 B) {
     return 0xFA00 | ((rd & 0x1F) << 4) | (B & 0x7);
 }
 
-inline u16 SBRC(u8 rd, u8 B) {
+static inline u16 SBRC(u8 rd, u8 B) {
     // registers 16-31, B 0-8
     if (rd >= (1 << 6)) {
         warning(0, "SBRC Rd value greater than 0x1F");
@@ -1080,10 +1081,10 @@ inline u16 SBRC(u8 rd, u8 B) {
     if (B >= (1 << 4)) {
         warning(0, "SBRC B value greater than 0x7");
     }
-    return 0xFE00 | ((rd & 0x1F) << 4) | (B & 0x7);
+    return 0xFC00 | ((rd & 0x1F) << 4) | (B & 0x7);
 }
 
-inline u16 SBRS(u8 rd, u8 B) {
+static inline u16 SBRS(u8 rd, u8 B) {
     // registers 16-31, B 0-8
     if (rd >= (1 << 6)) {
         warning(0, "SBRS Rd value greater than 0x1F");
@@ -1091,15 +1092,16 @@ inline u16 SBRS(u8 rd, u8 B) {
     if (B >= (1 << 4)) {
         warning(0, "SBRS B value greater than 0x7");
     }
-    return 0xFF00 | ((rd & 0x1F) << 4) | (B & 0x7);
+    return 0xFE00 | ((rd & 0x1F) << 4) | (B & 0x7);
 }
 
-inline u16 TST(u8 rd) {
+static inline u16 TST(u8 rd) {
     // registers 0-31
     if (rd >= (1 << 6)) {
         warning(0, "SBRS Rd value greater than 0x1F");
     }
-    return 0x2000 | ((rd & 0x1F) << 5) | (rd & 0x1F);
+    rd &= 0x1F;
+    return 0x2000 | (rd << 4) | (rd & 0xF) | ((rd & 0x10) << 5);
 }
 
 void printAVR(const AVRArray *instructions) {
@@ -1143,7 +1145,7 @@ void printAVR(const AVRArray *instructions) {
             // MOVW
             const u16 r1 = instruction & 0xF;
             const u16 r2 = (instruction & 0xF0) >> 4;
-            printf("[0x%04x]\tmovw r%d, r%d\n", instruction, r2+16, r1+16);
+            printf("[0x%04x]\tmovw r%d, r%d\n", instruction, r2*2, r1*2);
         } else if ((instruction >> 8) == 2) {
             // MULS
             const u16 r1 = instruction & 0xF;
@@ -1219,7 +1221,7 @@ void printAVR(const AVRArray *instructions) {
         } else if ((instruction & 0xD000) == 0x8000) {
             // LDD/STD
             const u16 reg = (instruction & 0x01F0) >> 4;
-            const u16 value = (instruction & 0x7) | ((instruction >> 7) & 0x0018) | ((instruction >> 7) & 0x0020);
+            const u16 value = (instruction & 0x7) | ((instruction >> 7) & 0x0018) | ((instruction >> 8) & 0x0020);
             const u8 y = (instruction & 0x8) >> 3;
             const u8 s = (instruction & 0x0200) >> 9;
             const char * opnames[2];
@@ -1284,7 +1286,7 @@ void printAVR(const AVRArray *instructions) {
             const char * opnames[2];
             opnames[0] = "adiw";
             opnames[1] = "sbiw";
-            printf("[0x%04x]\t%s r%d, 0x%x\t", instruction, opnames[op], (reg+12)*2, value);
+            printf("[0x%04x]\t%s r%d, 0x%x\n", instruction, opnames[op], (reg+12)*2, value);
         } else if ((instruction & 0xFC00) == 0x9800) {
             // CBI/SBI/SBIC/SBIS
             const u8 value = (instruction & 0x00F8) >> 3;
@@ -1352,7 +1354,7 @@ void printAVR(const AVRArray *instructions) {
         } else if ((instruction & 0xFC08) == 0xFC00) {
             // SBRC/SBRS
             const u8 bit = (instruction & 0x7);
-            const u16 reg = (instruction >> 4) & 0xF;
+            const u16 reg = (instruction >> 4) & 0x1F;
             if (instruction & 0x0200) {
                 printf("[0x%04x]\tsbrs r%d, %u\n", instruction, reg, bit);
             } else {
@@ -1410,7 +1412,7 @@ void saveAVR(const AVRArray *instructions, char *outfile) {
             // MOVW
             const u16 r1 = instruction & 0xF;
             const u16 r2 = (instruction & 0xF0) >> 4;
-            fprintf(fp, "[0x%04x]\tmovw r%d, r%d\n", instruction, r2+16, r1+16);
+            fprintf(fp, "[0x%04x]\tmovw r%d, r%d\n", instruction, r2*2, r1*2);
         } else if ((instruction >> 8) == 2) {
             // MULS
             const u16 r1 = instruction & 0xF;
@@ -1486,7 +1488,7 @@ void saveAVR(const AVRArray *instructions, char *outfile) {
         } else if ((instruction & 0xD000) == 0x8000) {
             // LDD/STD
             const u16 reg = (instruction & 0x01F0) >> 4;
-            const u16 value = (instruction & 0x7) | ((instruction >> 7) & 0x0018) | ((instruction >> 7) & 0x0020);
+            const u16 value = (instruction & 0x7) | ((instruction >> 7) & 0x0018) | ((instruction >> 8) & 0x0020);
             const u8 y = (instruction & 0x8) >> 3;
             const u8 s = (instruction & 0x0200) >> 9;
             const char * opnames[2];
@@ -1551,7 +1553,7 @@ void saveAVR(const AVRArray *instructions, char *outfile) {
             const char * opnames[2];
             opnames[0] = "adiw";
             opnames[1] = "sbiw";
-            fprintf(fp, "[0x%04x]\t%s r%d, 0x%x\t", instruction, opnames[op], (reg+12)*2, value);
+            fprintf(fp, "[0x%04x]\t%s r%d, 0x%x\n", instruction, opnames[op], (reg+12)*2, value);
         } else if ((instruction & 0xFC00) == 0x9800) {
             // CBI/SBI/SBIC/SBIS
             const u8 value = (instruction & 0x00F8) >> 3;
@@ -1619,7 +1621,7 @@ void saveAVR(const AVRArray *instructions, char *outfile) {
         } else if ((instruction & 0xFC08) == 0xFC00) {
             // SBRC/SBRS
             const u8 bit = (instruction & 0x7);
-            const u16 reg = (instruction >> 4) & 0xF;
+            const u16 reg = (instruction >> 4) & 0x1F;
             if (instruction & 0x0200) {
                 fprintf(fp, "[0x%04x]\tsbrs r%d, %u\n", instruction, reg, bit);
             } else {
@@ -1632,11 +1634,11 @@ void saveAVR(const AVRArray *instructions, char *outfile) {
     fclose(fp);
 }
 
-inline u16 swapEndiannes16(u16 x) {
+static inline u16 swapEndiannes16(u16 x) {
     return ((x & 0xFF00) >> 8) | ((x & 0x00FF) << 8);
 }
 
-inline u32 swapEndiannes32(u32 x) {
+static inline u32 swapEndiannes32(u32 x) {
     return (swapEndiannes16((x & 0xFFFF0000) >> 16) << 16) | swapEndiannes16(x & 0x0000FFFF);
 }
 
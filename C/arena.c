@@ -1,11 +1,33 @@
+#ifndef _MSC_VER
+#define _DEFAULT_SOURCE // MAP_ANONYMOUS isn't POSIX
+#include <sys/mman.h>
+#endif
+
 #include "arena.h"
 
 _Arena *_Arena_init(u64 capacity, _Arena *prev) {
-    _Arena *arena = malloc(sizeof(_Arena));
-    arena->prev = prev;
-    arena->used = 0;
+    _Arena *arena = NULL;
+    bool mapped = false;
+#ifndef _MSC_VER
+    if (capacity >= ARENA_MMAP_THRESHOLD) {
+        void *mapping = mmap(NULL, sizeof(_Arena) + capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapping != MAP_FAILED) {
+            arena = mapping;
+            mapped = true;
+        }
+    }
+#endif
+    if (arena == NULL) {
+        arena = malloc(sizeof(_Arena) + capacity);
+        if (arena == NULL) {
+            error(0, "Error: out of memory, couldn't get another %llu bytes for an arena", capacity);
+        }
+    }
+    arena->data = (u8 *)(arena + 1);
     arena->capacity = capacity;
-    arena->data = malloc(capacity);
+    arena->used = 0;
+    arena->prev = prev;
+    arena->mapped = mapped;
     return arena;
 }
 
@@ -13,34 +35,95 @@ Arena *Arena_init(u64 capacity) {
     Arena *arena = malloc(sizeof(Arena));
     arena->current = _Arena_init(capacity, NULL);
     arena->total_capacity = capacity;
+    arena->requested = 0;
+    arena->wasted = 0;
+    arena->chunk_count = 1;
+    arena->peak_capacity = capacity;
     
     return arena;
 }
 
-void *Arena_alloc(Arena *arena, u64 size) {
+static inline u64 Arena_padding(const _Arena *chunk, u64 alignment) {
+    return -(uintptr_t)(chunk->data + chunk->used) & (alignment - 1);
+}
+
+void *Arena_allocAligned(Arena *arena, u64 size, u64 alignment) {
+    assert(alignment && (alignment & (alignment - 1)) == 0);
     _Arena *cur = arena->current;
+    u64 padding = Arena_padding(cur, alignment);
     
-    if (size + cur->used > cur->capacity) {
-        u64 new_cap = max(arena->total_capacity, size); // NOTE(mdizdar): this is slightly dumb and I don't currently know how this affects alignment...
+    if (cur->used + padding + size > cur->capacity) {
+        // NOTE(mdizdar): the new chunk is as big as everything before it, so the chunks double in size
+        u64 new_cap = max(arena->total_capacity, size + alignment);
+        arena->wasted += cur->capacity - cur->used;
         arena->current = _Arena_init(new_cap, cur);
         arena->total_capacity += new_cap;
+        arena->peak_capacity = max(arena->peak_capacity, arena->total_capacity);
+        ++arena->chunk_count;
         cur = arena->current;
+        padding = Arena_padding(cur, alignment);
     }
-    void *ptr = &cur->data[cur->used];
-    cur->used += size;
+    void *ptr = &cur->data[cur->used + padding];
+    cur->used += padding + size;
+    arena->requested += size;
+    arena->wasted += padding;
     
     return ptr;
 }
 
+void *Arena_alloc(Arena *arena, u64 size) {
+    return Arena_allocAligned(arena, size, ARENA_ALIGNMENT);
+}
+
+ArenaMark Arena_mark(const Arena *arena) {
+    return (ArenaMark){
+        .chunk = arena->current,
+        .used = arena->current->used,
+        .requested = arena->requested,
+        .wasted = arena->wasted,
+    };
+}
+
+// NOTE(mdizdar): everything allocated after the mark is gone, including any chunks that had to be made for it
+void Arena_rewind(Arena *arena, ArenaMark mark) {
+    while (arena->current != mark.chunk) {
+        _Arena *prev = arena->current->prev;
+        assert(prev != NULL && "rewinding to a mark from a different arena");
+        arena->total_capacity -= arena->current->capacity;
+        --arena->chunk_count;
+        _Arena_freeall(arena->current);
+        arena->current = prev;
+    }
+    arena->current->used = mark.used;
+    arena->requested = mark.requested;
+    arena->wasted = mark.wasted;
+}
+
 void _Arena_freeall(_Arena *arena) {
+#ifndef _MSC_VER
+    if (arena->mapped) {
+        munmap(arena, sizeof(_Arena) + arena->capacity);
+        return;
+    }
+#endif
     free(arena);
 }
 
 void Arena_freeall(Arena *arena) {
-    for (_Arena *prev = arena->current->prev; 
-         arena->current != NULL; 
-         arena->current = prev) {
-        _Arena_freeall(arena->current);
+    _Arena *cur = arena->current;
+    while (cur != NULL) {
+        _Arena *prev = cur->prev;
+        _Arena_freeall(cur);
+        cur = prev;
     }
     free(arena);
 }
+
+void Arena_printStats(const Arena *arena, const char *name) {
+    u64 used = 0;
+    for (const _Arena *cur = arena->current; cur != NULL; cur = cur->prev) {
+        used += cur->used;
+    }
+    printf("%-14s %8lu requested %8lu wasted %8lu used %8lu reserved %8lu peak %4lu chunks\n",
+           name, arena->requested, arena->wasted, used, arena->total_capacity, arena->peak_capacity, arena->chunk_count);
+}
@@ -9,25 +9,49 @@
 
 #include "../utils/common.h"
 
-// TODO(mdizdar): we are currently not concerned with freeing individual pieces of memory given out
-// TODO(mdizdar): add alignment and stuff
+// NOTE(mdizdar): memory comes back all at once, either with Arena_freeall or with Arena_rewind to a mark taken
+// earlier, never a piece at a time. Every phase (lexer, parser/types, symbol table, ...) gets its own arena
+// and frees it when it's done, so Arena_printStats right before that tells us what the phase cost.
 
+// NOTE(mdizdar): each chunk is a single allocation with this header in front of the data
 typedef struct _Arena {
     u8 *data;
     u64 capacity;
     u64 used;
     struct _Arena *prev;
+    bool mapped;
 } _Arena;
 
 typedef struct {
     _Arena *current;
-    u64 total_capacity;
+    u64 total_capacity; // of the chunks we have right now
+    
+    u64 requested;      // bytes asked for through Arena_alloc
+    u64 wasted;         // alignment padding, plus whatever was left in a chunk when we moved on to the next one
+    u64 chunk_count;
+    u64 peak_capacity;
 } Arena;
 
+typedef struct {
+    _Arena *chunk;
+    u64 used;
+    u64 requested;
+    u64 wasted;
+} ArenaMark;
+
+// NOTE(mdizdar): enough for anything we put in here, same as what malloc promises
+#define ARENA_ALIGNMENT 16
+// chunks at least this big come straight from mmap instead of malloc
+#define ARENA_MMAP_THRESHOLD (1 << 20)
+
 _Arena *_Arena_init(u64 capacity, _Arena *prev);
 Arena *Arena_init(u64 capacity);
 void *Arena_alloc(Arena *arena, u64 size);
+void *Arena_allocAligned(Arena *arena, u64 size, u64 alignment);
+ArenaMark Arena_mark(const Arena *arena);
+void Arena_rewind(Arena *arena, ArenaMark mark);
 void _Arena_freeall(_Arena *arena);
 void Arena_freeall(Arena *arena);
+void Arena_printStats(const Arena *arena, const char *name);
 
 #endif //ARENA_H
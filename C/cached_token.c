@@ -1,3 +0,0 @@
-#include "cached_token.h"
-
-STRUCT_SOURCE(CachedToken);
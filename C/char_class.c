@@ -0,0 +1,128 @@
+#include "char_class.h"
+
+const u8 CHAR_CLASS[256] = {
+    ['\t'] = CHAR_SPACE, ['\n'] = CHAR_SPACE, ['\v'] = CHAR_SPACE,
+    ['\f'] = CHAR_SPACE, ['\r'] = CHAR_SPACE, [' ']  = CHAR_SPACE,
+
+    ['0'] = CHAR_DIGIT, ['1'] = CHAR_DIGIT, ['2'] = CHAR_DIGIT, ['3'] = CHAR_DIGIT, ['4'] = CHAR_DIGIT,
+    ['5'] = CHAR_DIGIT, ['6'] = CHAR_DIGIT, ['7'] = CHAR_DIGIT, ['8'] = CHAR_DIGIT, ['9'] = CHAR_DIGIT,
+
+    ['a'] = CHAR_ALPHA, ['b'] = CHAR_ALPHA, ['c'] = CHAR_ALPHA, ['d'] = CHAR_ALPHA, ['e'] = CHAR_ALPHA,
+    ['f'] = CHAR_ALPHA, ['g'] = CHAR_ALPHA, ['h'] = CHAR_ALPHA, ['i'] = CHAR_ALPHA, ['j'] = CHAR_ALPHA,
+    ['k'] = CHAR_ALPHA, ['l'] = CHAR_ALPHA, ['m'] = CHAR_ALPHA, ['n'] = CHAR_ALPHA, ['o'] = CHAR_ALPHA,
+    ['p'] = CHAR_ALPHA, ['q'] = CHAR_ALPHA, ['r'] = CHAR_ALPHA, ['s'] = CHAR_ALPHA, ['t'] = CHAR_ALPHA,
+    ['u'] = CHAR_ALPHA, ['v'] = CHAR_ALPHA, ['w'] = CHAR_ALPHA, ['x'] = CHAR_ALPHA, ['y'] = CHAR_ALPHA,
+    ['z'] = CHAR_ALPHA,
+
+    ['A'] = CHAR_ALPHA, ['B'] = CHAR_ALPHA, ['C'] = CHAR_ALPHA, ['D'] = CHAR_ALPHA, ['E'] = CHAR_ALPHA,
+    ['F'] = CHAR_ALPHA, ['G'] = CHAR_ALPHA, ['H'] = CHAR_ALPHA, ['I'] = CHAR_ALPHA, ['J'] = CHAR_ALPHA,
+    ['K'] = CHAR_ALPHA, ['L'] = CHAR_ALPHA, ['M'] = CHAR_ALPHA, ['N'] = CHAR_ALPHA, ['O'] = CHAR_ALPHA,
+    ['P'] = CHAR_ALPHA, ['Q'] = CHAR_ALPHA, ['R'] = CHAR_ALPHA, ['S'] = CHAR_ALPHA, ['T'] = CHAR_ALPHA,
+    ['U'] = CHAR_ALPHA, ['V'] = CHAR_ALPHA, ['W'] = CHAR_ALPHA, ['X'] = CHAR_ALPHA, ['Y'] = CHAR_ALPHA,
+    ['Z'] = CHAR_ALPHA,
+
+    ['_'] = CHAR_UNDERSCORE,
+};
+
+// NOTE(mdizdar): the vector versions only differ in width, so everything below is written against these.
+// A character is in [lo, hi] iff the saturated (c - lo) - (hi - lo) is 0, which saves us a signed compare
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define CHAR_CLASS_WIDTH 32
+#define CHAR_CLASS_FULL  0xFFFFFFFFu
+typedef __m256i CharBlock;
+#define CharBlock_load(p)   _mm256_loadu_si256((const __m256i *)(p))
+#define CharBlock_splat(c)  _mm256_set1_epi8((char)(c))
+#define CharBlock_eq(a, b)  _mm256_cmpeq_epi8((a), (b))
+#define CharBlock_or(a, b)  _mm256_or_si256((a), (b))
+#define CharBlock_sub(a, b) _mm256_sub_epi8((a), (b))
+#define CharBlock_subs(a, b) _mm256_subs_epu8((a), (b))
+#define CharBlock_mask(a)   ((u32)_mm256_movemask_epi8(a))
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define CHAR_CLASS_WIDTH 16
+#define CHAR_CLASS_FULL  0xFFFFu
+typedef __m128i CharBlock;
+#define CharBlock_load(p)   _mm_loadu_si128((const __m128i *)(p))
+#define CharBlock_splat(c)  _mm_set1_epi8((char)(c))
+#define CharBlock_eq(a, b)  _mm_cmpeq_epi8((a), (b))
+#define CharBlock_or(a, b)  _mm_or_si128((a), (b))
+#define CharBlock_sub(a, b) _mm_sub_epi8((a), (b))
+#define CharBlock_subs(a, b) _mm_subs_epu8((a), (b))
+#define CharBlock_mask(a)   ((u32)_mm_movemask_epi8(a))
+#endif
+
+#ifdef CHAR_CLASS_WIDTH
+static inline CharBlock CharBlock_inRange(CharBlock x, u8 lo, u8 hi) {
+    CharBlock over = CharBlock_subs(CharBlock_sub(x, CharBlock_splat(lo)), CharBlock_splat(hi - lo));
+    return CharBlock_eq(over, CharBlock_splat(0));
+}
+
+static inline u32 CharClass_digitMask(const char *p) {
+    return CharBlock_mask(CharBlock_inRange(CharBlock_load(p), '0', '9'));
+}
+
+static inline u32 CharClass_identMask(const char *p) {
+    CharBlock x = CharBlock_load(p);
+    CharBlock alpha = CharBlock_inRange(CharBlock_or(x, CharBlock_splat(0x20)), 'a', 'z');
+    CharBlock digit = CharBlock_inRange(x, '0', '9');
+    CharBlock underscore = CharBlock_eq(x, CharBlock_splat('_'));
+    return CharBlock_mask(CharBlock_or(CharBlock_or(alpha, digit), underscore));
+}
+#endif
+
+u64 CharClass_skipIdent(const char *data, u64 pos) {
+#ifdef CHAR_CLASS_WIDTH
+    for (;; pos += CHAR_CLASS_WIDTH) {
+        u32 rest = ~CharClass_identMask(data + pos) & CHAR_CLASS_FULL;
+        if (rest) return pos + __builtin_ctz(rest);
+    }
+#else
+    while (CHAR_IS(data[pos], CHAR_IDENT)) ++pos;
+    return pos;
+#endif
+}
+
+u64 CharClass_skipDigits(const char *data, u64 pos) {
+#ifdef CHAR_CLASS_WIDTH
+    for (;; pos += CHAR_CLASS_WIDTH) {
+        u32 rest = ~CharClass_digitMask(data + pos) & CHAR_CLASS_FULL;
+        if (rest) return pos + __builtin_ctz(rest);
+    }
+#else
+    while (CHAR_IS(data[pos], CHAR_DIGIT)) ++pos;
+    return pos;
+#endif
+}
+
+u64 CharClass_skipSpace(const char *data, u64 pos, u64 *line, u64 *col) {
+#ifdef CHAR_CLASS_WIDTH
+    for (;;) {
+        CharBlock x = CharBlock_load(data + pos);
+        CharBlock space = CharBlock_or(CharBlock_eq(x, CharBlock_splat(' ')), CharBlock_inRange(x, '\t', '\r'));
+        u32 rest = ~CharBlock_mask(space) & CHAR_CLASS_FULL;
+        // every bit below the first non-space character, or all of them if there isn't one
+        u32 run = rest ? (rest & -rest) - 1 : CHAR_CLASS_FULL;
+        u32 length = rest ? (u32)__builtin_ctz(rest) : CHAR_CLASS_WIDTH;
+        u32 newlines = CharBlock_mask(CharBlock_eq(x, CharBlock_splat('\n'))) & run;
+        if (newlines) {
+            *line += __builtin_popcount(newlines);
+            *col = length - 1 - (31 - __builtin_clz(newlines));
+        } else {
+            *col += length;
+        }
+        pos += length;
+        if (rest) return pos;
+    }
+#else
+    for (; CHAR_IS(data[pos], CHAR_SPACE); ++pos) {
+        if (data[pos] == '\n') {
+            ++*line;
+            *col = 0;
+        } else {
+            ++*col;
+        }
+    }
+    return pos;
+#endif
+}
@@ -0,0 +1,25 @@
+#ifndef CHAR_CLASS_H
+#define CHAR_CLASS_H
+
+#include "../utils/common.h"
+
+#define CHAR_SPACE       1  // ' ', \t, \n, \v, \f, \r
+#define CHAR_DIGIT       2  // 0-9
+#define CHAR_ALPHA       4  // a-z, A-Z
+#define CHAR_UNDERSCORE  8  // _
+#define CHAR_IDENT_START (CHAR_ALPHA | CHAR_UNDERSCORE)
+#define CHAR_IDENT       (CHAR_ALPHA | CHAR_UNDERSCORE | CHAR_DIGIT)
+
+// NOTE(mdizdar): same thing isspace/isdigit/... would tell us, minus the locale lookup
+extern const u8 CHAR_CLASS[256];
+#define CHAR_IS(c, class) (CHAR_CLASS[(u8)(c)] & (class))
+
+// these all return the index of the first character at or after pos that doesn't belong to the run.
+// There's no end, data has to be followed by LEXER_PADDING zero bytes (0 isn't in any class),
+// which also makes it safe for the SSE2/AVX2 versions to look at 16/32 characters at a time
+u64 CharClass_skipIdent(const char *data, u64 pos);
+u64 CharClass_skipDigits(const char *data, u64 pos);
+// line and col are the position of data[pos] going in and of the returned index coming out
+u64 CharClass_skipSpace(const char *data, u64 pos, u64 *line, u64 *col);
+
+#endif //CHAR_CLASS_H
@@ -6,14 +6,13 @@
 
 struct Type;
 typedef struct Type Type;
-struct Node;
-typedef struct Node Node;
+typedef u32 NodeIndex;
 
 STRUCT_HEADER(FunctionType, {
     u64 size_of;
     Type *return_type;
     DeclarationArray parameters;
-    Node *block;
+    NodeIndex block;
 });
 
 
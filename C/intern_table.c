@@ -0,0 +1,59 @@
+#include "intern_table.h"
+
+STRUCT_SOURCE(InternTable);
+
+InternTable *InternTable_init(u64 capacity) {
+    InternTable *table = malloc(sizeof(InternTable));
+    table->capacity = 16;
+    while (table->capacity < capacity) {
+        table->capacity *= 2;
+    }
+    table->count = 0;
+    table->slots = calloc(table->capacity, sizeof(String));
+    table->hashes = calloc(table->capacity, sizeof(u64));
+    return table;
+}
+
+static void InternTable_grow(InternTable *table) {
+    String *old_slots = table->slots;
+    u64 *old_hashes = table->hashes;
+    u64 old_capacity = table->capacity;
+    
+    table->capacity *= 2;
+    table->slots = calloc(table->capacity, sizeof(String));
+    table->hashes = calloc(table->capacity, sizeof(u64));
+    for (u64 i = 0; i < old_capacity; ++i) {
+        if (old_slots[i].data == NULL) continue;
+        u64 slot = old_hashes[i] & (table->capacity-1);
+        while (table->slots[slot].data != NULL) {
+            slot = (slot+1) & (table->capacity-1);
+        }
+        table->slots[slot] = old_slots[i];
+        table->hashes[slot] = old_hashes[i];
+    }
+    free(old_slots);
+    free(old_hashes);
+}
+
+String InternTable_intern(InternTable *table, const char *data, u64 count) {
+    const String key = {.data = (char *)data, .count = count};
+    const u64 hash = String_hash(&key);
+    
+    u64 slot = hash & (table->capacity-1);
+    while (table->slots[slot].data != NULL) {
+        if (table->hashes[slot] == hash && table->slots[slot].count == count &&
+            memcmp(table->slots[slot].data, data, count) == 0) {
+            return table->slots[slot];
+        }
+        slot = (slot+1) & (table->capacity-1);
+    }
+    
+    // NOTE(mdizdar): first time we're seeing this one, the code outlives the table so we just point at it
+    table->slots[slot] = key;
+    table->hashes[slot] = hash;
+    
+    if (++table->count * 4 > table->capacity * 3) {
+        InternTable_grow(table);
+    }
+    return key;
+}
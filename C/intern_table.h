@@ -0,0 +1,19 @@
+#ifndef INTERN_TABLE_H
+#define INTERN_TABLE_H
+
+#include "../utils/common.h"
+
+// NOTE(mdizdar): every identifier the lexer sees goes through here, so two Strings with the same
+// contents always share the same data pointer. The data points at the first occurrence in the code itself,
+// which is never freed, so it's not 0 terminated and String_copy gets away with not copying anything.
+STRUCT_HEADER(InternTable, {
+    String *slots; // open addressing, capacity is always a power of two
+    u64 *hashes;
+    u64 count;
+    u64 capacity;
+});
+
+InternTable *InternTable_init(u64 capacity);
+String InternTable_intern(InternTable *table, const char *data, u64 count);
+
+#endif //INTERN_TABLE_H
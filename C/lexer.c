@@ -1,49 +1,33 @@
 #include "lexer.h"
-#include <ctype.h>
+#include "char_class.h"
 
 STRUCT_SOURCE(Lexer);
 
-TokenType checkKeyword(const char *name) {
-    for (u32 i = 0; i < KEYWORDS_count; ++i) {
-        if (strcmp(name, KEYWORDS[i]) == 0) {
-            return (TokenType)(TOKEN_KEYWORD + i + 1); // NOTE(mdizdar): this is a disgusting error prone hack, but it works...
-        }
-    }
-    for (u32 i = 0; i < TYPES_count; ++i) {
-        if (strcmp(name, TYPES[i]) == 0) {
-            return (TokenType)(TOKEN_TYPE + i + 1); // NOTE(mdizdar): this is a disgusting error prone hack, but it works...
-        }
+TokenType checkKeyword(const char *name, u64 count) {
+    if (count < RESERVED_MIN_LENGTH || count > RESERVED_MAX_LENGTH) {
+        return TOKEN_IDENT;
     }
-    for (u32 i = 0; i < MODIFIERS_count; ++i) {
-        if (strcmp(name, MODIFIERS[i]) == 0) {
-            return (TokenType)(TOKEN_MODIFIER + i + 1); // NOTE(mdizdar): this is a disgusting error prone hack, but it works...
-        }
+    const ReservedWord *word = &RESERVED_WORDS[Reserved_hash(name, count)];
+    if (word->count == count && memcmp(word->name, name, count) == 0) {
+        return (TokenType)word->token_type;
     }
     return TOKEN_IDENT;
 }
 
 Token *Lexer_returnToken(Lexer *lexer, u64 lookahead, Token *t) {
-    if (t != NULL && t->type != TOKEN_ERROR) {
-        for (u64 i = lexer->peek; i < lookahead; ++i) {
-            lexer->token_at[i].token = t;
-            lexer->token_at[i].lookahead = lookahead;
-            lexer->token_at[i].cur_line = lexer->cur_line;
-            lexer->token_at[i].cur_col = lexer->cur_col - lookahead + lexer->peek;
-        }
-    }
-    t->line = lexer->cur_line;
-    t->col = lexer->cur_col - lookahead + lexer->peek;
-    lexer->peek = lookahead;
+    t->line = lexer->scan_line;
+    t->col = lexer->scan_col - lookahead + lexer->scan_pos;
+    lexer->scan_pos = lookahead;
     return t;
 }
 
 inline Token *Lexer_currentToken(Lexer *lexer) {
-    return lexer->token_at[lexer->pos - 1].token;
+    return &lexer->tokens.data[min(lexer->pos - 1, lexer->tokens.count - 1)];
 }
 
 inline Token *Lexer_currentPeekedToken(Lexer *lexer) {
-    assert(lexer->token_at[lexer->peek - 1].token != NULL);
-    return lexer->token_at[lexer->peek - 1].token;
+    assert(lexer->peek > 0);
+    return &lexer->tokens.data[min(lexer->peek - 1, lexer->tokens.count - 1)];
 }
 
 inline void Lexer_resetPeek(Lexer *lexer) {
@@ -58,15 +42,25 @@ inline void Lexer_confirmPeek(Lexer *lexer) {
     lexer->prev_col = lexer->cur_col;
 }
 
-// finds the next token and returns it
+// returns the next token and moves the peek past it
 Token *Lexer_peekNextToken(Lexer *lexer) {
-    if (lexer->token_at[lexer->peek].token != NULL) {
-        CachedToken *ct = &lexer->token_at[lexer->peek];
-        lexer->peek = ct->lookahead;
-        lexer->cur_line = ct->cur_line;
-        lexer->cur_col = ct->cur_col;
-        return ct->token;
-    }
+    // NOTE(mdizdar): the last token is always the TOKEN_ERROR at the end of the file,
+    // so peeking past the end just keeps returning that one
+    Token *t = &lexer->tokens.data[min(lexer->peek, lexer->tokens.count - 1)];
+    ++lexer->peek;
+    lexer->cur_line = t->line;
+    lexer->cur_col = t->col;
+    return t;
+}
+
+// moves lookahead to the last character of a run that ends at end, the for loop in Lexer_scanToken steps past it
+static inline void Lexer_skipRun(Lexer *lexer, u64 *lookahead, u64 end) {
+    lexer->scan_col += end - 1 - *lookahead;
+    *lookahead = end - 1;
+}
+
+// scans the token starting at scan_pos into t
+static Token *Lexer_scanToken(Lexer *lexer, Token *t) {
     enum State {
         UNKNOWN = 0,
         IDENT,      // [_a-zA-Z][_a-zA-Z0-9]*
@@ -88,25 +82,27 @@ Token *Lexer_peekNextToken(Lexer *lexer) {
     double double_value = 0;
     double dec_digit    = 1;
     
-    Token *t = Arena_alloc(lexer->token_arena, sizeof(Token)); // the token we return
     t->type = TOKEN_ERROR;
     
-    for (u64 lookahead = lexer->peek; lookahead < lexer->code.count; ++lookahead, ++lexer->cur_col) {
+    // NOTE(mdizdar): the code is followed by LEXER_PADDING zero bytes, so the 0 is what stops us at the end of the file
+    for (u64 lookahead = lexer->scan_pos;; ++lookahead, ++lexer->scan_col) {
         char c = lexer->code.data[lookahead];
         //printf("%llu %c\n", lookahead, c);
         switch (state) {
             case UNKNOWN: {
-                if (isspace(c)) {
-                    if (c == '\n') {
-                        ++lexer->cur_line;
-                        lexer->cur_col = -1;
-                    }
-                    ++lexer->peek;
+                if (CHAR_IS(c, CHAR_SPACE)) {
+                    u64 end = CharClass_skipSpace(lexer->code.data, lookahead, &lexer->scan_line, &lexer->scan_col);
+                    lexer->scan_pos = end;
+                    lookahead = end - 1;
+                    --lexer->scan_col;
                     continue;
                 }
-                if (c == '_' || isalpha(c)) {
+                if (c == 0) {
+                    return Lexer_returnToken(lexer, lookahead, t);
+                }
+                if (CHAR_IS(c, CHAR_IDENT_START)) {
                     state = IDENT;
-                } else if (isdigit(c)) {
+                } else if (CHAR_IS(c, CHAR_DIGIT)) {
                     state = DECINT;
                     integer_value = c - '0';
                     was_zero = c == '0';
@@ -120,14 +116,15 @@ Token *Lexer_peekNextToken(Lexer *lexer) {
                 break;
             }
             case IDENT: {
-                if (c == '_' || isalnum(c)) continue;
-                u64 count = lookahead - lexer->peek;
-                char *name = malloc(count+1);
-                name[count] = 0;
-                strncpy(name, lexer->code.data + lexer->peek, count);
-                t->type = checkKeyword(name);
+                if (CHAR_IS(c, CHAR_IDENT)) {
+                    Lexer_skipRun(lexer, &lookahead, CharClass_skipIdent(lexer->code.data, lookahead));
+                    continue;
+                }
+                u64 count = lookahead - lexer->scan_pos;
+                const char *name = lexer->code.data + lexer->scan_pos;
+                t->type = checkKeyword(name, count);
                 if (t->type == TOKEN_IDENT) {
-                    t->name = (String){.data = name, .count = count};
+                    t->name = InternTable_intern(lexer->idents, name, count);
                 }
                 return Lexer_returnToken(lexer, lookahead, t);
             }
@@ -135,22 +132,26 @@ Token *Lexer_peekNextToken(Lexer *lexer) {
                 if (was_zero) {
                     if (c == 'x' || c == 'X') {
                         state = HEXINT;
-                    } else if (isdigit(c)) {
+                    } else if (CHAR_IS(c, CHAR_DIGIT)) {
                         state = OCTINT;
                         --lookahead;
-                    } else if (isalpha(c)) {
-                        error(lexer->cur_line, "Parse error: Unexpected alpha character");
+                    } else if (CHAR_IS(c, CHAR_ALPHA)) {
+                        error(lexer->scan_line, "Parse error: Unexpected alpha character");
                     } else {
                         t->type = TOKEN_INT_LITERAL;
                         t->integer_value = 0;
                         return Lexer_returnToken(lexer, lookahead, t);
                     }
                 } else {
-                    if (isdigit(c)) {
-                        integer_value *= 10;
-                        integer_value += c - '0';
-                    } else if (isalpha(c)) {
-                        error(lexer->cur_line, "Parse error: Unexpected alpha character");
+                    if (CHAR_IS(c, CHAR_DIGIT)) {
+                        u64 end = CharClass_skipDigits(lexer->code.data, lookahead);
+                        for (u64 i = lookahead; i < end; ++i) {
+                            integer_value *= 10;
+                            integer_value += lexer->code.data[i] - '0';
+                        }
+                        Lexer_skipRun(lexer, &lookahead, end);
+                    } else if (CHAR_IS(c, CHAR_ALPHA)) {
+                        error(lexer->scan_line, "Parse error: Unexpected alpha character");
                     } else if (c == '.') {
                         double_value = (double)integer_value;
                         state = FLOAT;
@@ -166,10 +167,10 @@ Token *Lexer_peekNextToken(Lexer *lexer) {
                 integer_value *= 8;
                 if (c >= '0' && c <= '7') {
                     integer_value += c - '0';
-                } else if (isdigit(c)) {
-                    error(lexer->cur_line, "Parse error: Did you write a '9' in an octal literal?");
-                } else if (isalpha(c) || c == '.') {
-                    error(lexer->cur_line, "Look at this dude.");
+                } else if (CHAR_IS(c, CHAR_DIGIT)) {
+                    error(lexer->scan_line, "Parse error: Did you write a '9' in an octal literal?");
+                } else if (CHAR_IS(c, CHAR_ALPHA) || c == '.') {
+                    error(lexer->scan_line, "Look at this dude.");
                 } else {
                     t->type = TOKEN_INT_LITERAL;
                     t->integer_value = integer_value;
@@ -179,14 +180,14 @@ Token *Lexer_peekNextToken(Lexer *lexer) {
             }
             case HEXINT: {
                 integer_value *= 16;
-                if (isdigit(c)) {
+                if (CHAR_IS(c, CHAR_DIGIT)) {
                     integer_value += c - '0';
                 } else if (c >= 'a' && c <= 'f') {
                     integer_value += c - 'a';
                 } else if (c >= 'A' && c <= 'F') {
                     integer_value += c - 'A';
-                } else if (isalpha(c) || c == '.') {
-                    error(lexer->cur_line, "Look at this dude.");
+                } else if (CHAR_IS(c, CHAR_ALPHA) || c == '.') {
+                    error(lexer->scan_line, "Look at this dude.");
                 } else {
                     t->type = TOKEN_INT_LITERAL;
                     t->integer_value = integer_value;
@@ -195,11 +196,11 @@ Token *Lexer_peekNextToken(Lexer *lexer) {
                 break;
             }
             case FLOAT: { // TODO(mdizdar): differentiate floats and doubles
-                if (isdigit(c)) {
+                if (CHAR_IS(c, CHAR_DIGIT)) {
                     dec_digit /= 10;
                     double_value += (c - '0') * dec_digit;
-                } else if (isalpha(c) || c == '.') {
-                    error(lexer->cur_line, "Look at this dude.");
+                } else if (CHAR_IS(c, CHAR_ALPHA) || c == '.') {
+                    error(lexer->scan_line, "Look at this dude.");
                 } else {
                     t->type = TOKEN_DOUBLE_LITERAL;
                     t->double_value = double_value;
@@ -209,14 +210,14 @@ Token *Lexer_peekNextToken(Lexer *lexer) {
             }
             case OP: {
                 char prev = lexer->code.data[lookahead-1];
-                if (prev == '.' && isdigit(c)) {
+                if (prev == '.' && CHAR_IS(c, CHAR_DIGIT)) {
                     dec_digit /= 10;
                     double_value += (c - '0') * dec_digit;
                     state = FLOAT;
                 } else if (prev == '?' || prev == ':' || prev == '.' || prev == '(' || prev == ')' || prev == '[' || prev == ']' || prev == '{' || prev == '}') {
                     t->type = prev;
                     return Lexer_returnToken(lexer, lookahead, t);
-                } else if (lookahead - lexer->peek == 1) {
+                } else if (lookahead - lexer->scan_pos == 1) {
                     if ((c != '>' || prev != '>') && (c != '<' || prev != '<')) {
                         for (u32 i = 0; i < MULTI_OPS_count - 4; ++i) {
                             if (prev == MULTI_OPS[i][0] && c == MULTI_OPS[i][1]) {
@@ -273,7 +274,7 @@ Token *Lexer_peekNextToken(Lexer *lexer) {
                     } else if (c == 'v') {
                         lexer->code.data[lookahead] = 0x0b;
                     } else {
-                        error(lexer->cur_line, "Error: escape sequence not recognized");
+                        error(lexer->scan_line, "Error: escape sequence not recognized");
                     }
                     continue;
                 }
@@ -281,10 +282,13 @@ Token *Lexer_peekNextToken(Lexer *lexer) {
                     escaped = true;
                     continue;
                 }
+                if (c == 0) {
+                    error(lexer->scan_line, "Error: unterminated character literal");
+                }
                 if (c == '\'') {
-                    u64 count = lookahead - lexer->peek - 1 - escaped_count;
+                    u64 count = lookahead - lexer->scan_pos - 1 - escaped_count;
                     if (count > 1) {
-                        error(lexer->cur_line, "Error: character literals can't be longer than 1 character.");
+                        error(lexer->scan_line, "Error: character literals can't be longer than 1 character.");
                     }
                     t->type = TOKEN_CHAR_LITERAL;
                     t->integer_value = lexer->code.data[lookahead-1];;
@@ -319,7 +323,7 @@ Token *Lexer_peekNextToken(Lexer *lexer) {
                     } else if (c == 'v') {
                         lexer->code.data[lookahead] = 0x0b;
                     } else {
-                        error(lexer->cur_line, "Error: escape sequence not recognized");
+                        error(lexer->scan_line, "Error: escape sequence not recognized");
                     }
                     continue;
                 }
@@ -327,14 +331,19 @@ Token *Lexer_peekNextToken(Lexer *lexer) {
                     escaped = true;
                     continue;
                 }
+                if (c == 0) {
+                    error(lexer->scan_line, "Error: unterminated string literal");
+                }
                 if (c == '"') {
-                    u64 count = lookahead - lexer->peek - 1 - escaped_count;;
-                    char *str = Arena_alloc(lexer->token_arena, count+1);
-                    str[count] = 0;
-                    for (u64 i = lexer->peek+1, j = 0; i < lookahead; ++i) {
+                    u64 count = lookahead - lexer->scan_pos - 1 - escaped_count;;
+                    // NOTE(mdizdar): we never look at this part of the code again, so the literal gets unescaped in place
+                    // and the closing quote (or something before it) becomes the terminating 0
+                    char *str = lexer->code.data + lexer->scan_pos + 1;
+                    for (u64 i = lexer->scan_pos+1, j = 0; i < lookahead; ++i) {
                         if (lexer->code.data[i] == '\\' && lexer->code.data[i-1] != '\\') continue;
                         str[j++] = lexer->code.data[i];
                     }
+                    str[count] = 0;
                     t->type = TOKEN_STRING_LITERAL;
                     t->string_value = (String){.data = str, .count = count};
                     return Lexer_returnToken(lexer, lookahead+1, t);
@@ -346,7 +355,24 @@ Token *Lexer_peekNextToken(Lexer *lexer) {
             }
         }
     }
-    return Lexer_returnToken(lexer, lexer->code.count, t);
+}
+
+// lexes the whole file in one go, after this the lexer only moves around the token array
+void Lexer_tokenize(Lexer *lexer) {
+    Reserved_check();
+    lexer->scan_pos = 0;
+    lexer->scan_line = lexer->cur_line;
+    lexer->scan_col = lexer->cur_col;
+    
+    TokenArray_construct(&lexer->tokens);
+    // NOTE(mdizdar): just a guess so we don't realloc too much, tokens tend to be a couple of characters long
+    TokenArray_reserve(&lexer->tokens, lexer->code.count/4 + 16);
+    
+    Token t;
+    do {
+        Lexer_scanToken(lexer, &t);
+        TokenArray_push_ptr(&lexer->tokens, &t);
+    } while (t.type != TOKEN_ERROR);
 }
 
 // consumes peeked tokens
@@ -2,14 +2,19 @@
 #define LEXER_H
 
 #include "../utils/common.h"
-#include "cached_token.h"
+#include "token.h"
 #include "arena.h"
+#include "intern_table.h"
+
+// how many zero bytes the lexer expects after the end of the code, has to be at least 32 for CharClass_skip*
+#define LEXER_PADDING 64
 
 STRUCT_HEADER(Lexer, {
     String code;
     
-    CachedToken *token_at;
-    Arena *token_arena;
+    TokenArray tokens; // pos and peek are indices into this
+    Arena *token_arena; // for the tokens the parser makes up
+    InternTable *idents;
     
     u64 cur_col;
     u64 prev_col;
@@ -17,14 +22,21 @@ STRUCT_HEADER(Lexer, {
     u64 prev_line;
     u64 pos;
     u64 peek;
+    
+    // only used while tokenizing
+    u64 scan_pos;
+    u64 scan_line;
+    u64 scan_col;
 });
 
-TokenType checkKeyword(const char *name);
+TokenType checkKeyword(const char *name, u64 count);
 Token *Lexer_returnToken(Lexer *lexer, u64 lookahead, Token *t);
 Token *Lexer_currentToken(Lexer *lexer);
 Token *Lexer_currentPeekedToken(Lexer *lexer);
 void Lexer_resetPeek(Lexer *lexer);
 void Lexer_confirmPeek(Lexer *lexer);
+// lexes the whole file into tokens, has to be called before anything else
+void Lexer_tokenize(Lexer *lexer);
 // finds the next token and returns it
 Token *Lexer_peekNextToken(Lexer *lexer);
 // consumes peeked tokens
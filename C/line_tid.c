@@ -1,3 +0,0 @@
-#include "line_tid.h"
-
-STRUCT_SOURCE(LineTemporaryID);
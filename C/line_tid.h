@@ -6,9 +6,4 @@
 typedef u64 TemporaryID;
 typedef u64 Line;
 
-STRUCT_HEADER(LineTemporaryID, {
-    TemporaryID id;
-    Line line;
-});
-
 #endif //LINE_TID_H
@@ -1,3 +1,21 @@
 #include "node.h"
 
 STRUCT_SOURCE(Node);
+
+NodeArray AST_nodes;
+
+NodeIndex Node_new(Token token, NodeIndex left, NodeIndex right) {
+    if (AST_nodes.count == 0) {
+        // the null node, so that index 0 can mean "no node"
+        NodeArray_push_back(&AST_nodes, (Node){0});
+    }
+    NodeArray_push_back(&AST_nodes, (Node){
+        .token = token,
+        .left = left,
+        .right = right,
+        .cond = 0,
+        .scope = NULL,
+        .type = NULL
+    });
+    return (NodeIndex)(AST_nodes.count - 1);
+}
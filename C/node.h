@@ -5,15 +5,27 @@
 #include "token.h"
 #include "scope.h"
 
+// NOTE(mdizdar): nodes refer to each other by their index in AST_nodes, 0 is the null node
+typedef u32 NodeIndex;
+
 STRUCT_HEADER(Node, {
-    Token *token;
-    struct Node *left;
-    struct Node *right;
-    struct Node *cond; // this is only used for ternary
+    Token token;
+    NodeIndex left;
+    NodeIndex right;
+    NodeIndex cond; // this is only used for ternary
     
     const Scope *scope; // NOTE(mdizdar): usually NULL, except on nodes that change the scope
     Type *type; // filled in by type checker
 });
 
+// every node of the program, in the order the parser made them
+extern NodeArray AST_nodes;
+
+NodeIndex Node_new(Token token, NodeIndex left, NodeIndex right);
+
+// NOTE(mdizdar): the pointer is only good until the next Node_new, after parsing is done that doesn't matter anymore
+static inline Node *Node_at(NodeIndex index) {
+    return index ? AST_nodes.data + index : NULL;
+}
 
 #endif //NODE_H
@@ -10,7 +10,7 @@ _Noreturn void Parser_error(Parser *parser, Token *token, TokenType expected_typ
 }
 
 _Noreturn void Parser_duplicateError(Parser *parser, SymbolTableEntry *previous) {
-    error(parser->lexer.cur_line, "redefinition of %s; previous definition on line %llu", previous->name.data, previous->definition_line);
+    error(parser->lexer.cur_line, "redefinition of %.*s; previous definition on line %llu", (int)previous->name.count, previous->name.data, previous->definition_line);
 }
 
 _Noreturn void Parser_conflictingTypesError(Parser *parser, TokenType current, TokenType conflicting) {
@@ -31,73 +31,41 @@ inline void Parser_eat(Parser *parser, Token *token, TokenType token_type) {
 
 //#define Parser_eat(parser, token, type) { printf("%s: %u\n", __FILE__, __LINE__); Parser_eat((parser), (token), (type)); }
 
-Node *Parser_operand(Parser *parser) {
+NodeIndex Parser_operand(Parser *parser) {
     // factor ::= ident | literal | '(' expr ')'
     
     Token *token = Lexer_peekNextToken(&parser->lexer); // TODO(mdizdar): I should really be handling the pointer but it's annoying right now
-    Node *node = NULL;
+    NodeIndex node = 0;
     if (token->type == TOKEN_CHAR_LITERAL) {
         Parser_eat(parser, token, TOKEN_CHAR_LITERAL);
-        node = Arena_alloc(parser->arena, sizeof(Node));
-        node->token = token;
-        node->left = NULL;
-        node->right = NULL;
-        node->scope = NULL;
+        node = Node_new(*token, 0, 0);
     } else if (token->type == TOKEN_INT_LITERAL) {
         Parser_eat(parser, token, TOKEN_INT_LITERAL);
-        node = Arena_alloc(parser->arena, sizeof(Node));
-        node->token = token;
-        node->left = NULL;
-        node->right = NULL;
-        node->scope = NULL;
+        node = Node_new(*token, 0, 0);
     } else if (token->type == TOKEN_LONG_LITERAL) {
         Parser_eat(parser, token, TOKEN_LONG_LITERAL);
-        node = Arena_alloc(parser->arena, sizeof(Node));
-        node->token = token;
-        node->left = NULL;
-        node->right = NULL;
-        node->scope = NULL;
+        node = Node_new(*token, 0, 0);
     } else if (token->type == TOKEN_LLONG_LITERAL) {
         Parser_eat(parser, token, TOKEN_LLONG_LITERAL);
-        node = Arena_alloc(parser->arena, sizeof(Node));
-        node->token = token;
-        node->left = NULL;
-        node->right = NULL;
-        node->scope = NULL;
+        node = Node_new(*token, 0, 0);
     } else if (token->type == TOKEN_FLOAT_LITERAL) {
         Parser_eat(parser, token, TOKEN_FLOAT_LITERAL);
-        node = Arena_alloc(parser->arena, sizeof(Node));
-        node->token = token;
-        node->left = NULL;
-        node->right = NULL;
-        node->scope = NULL;
+        node = Node_new(*token, 0, 0);
     } else if (token->type == TOKEN_DOUBLE_LITERAL) {
         Parser_eat(parser, token, TOKEN_DOUBLE_LITERAL);
-        node = Arena_alloc(parser->arena, sizeof(Node));
-        node->token = token;
-        node->left = NULL;
-        node->right = NULL;
-        node->scope = NULL;
+        node = Node_new(*token, 0, 0);
     } else if (token->type == TOKEN_STRING_LITERAL) {
         Parser_eat(parser, token, TOKEN_STRING_LITERAL);
-        node = Arena_alloc(parser->arena, sizeof(Node));
-        node->token = token;
-        node->left = NULL;
-        node->right = NULL;
-        node->scope = NULL;
+        node = Node_new(*token, 0, 0);
     } else if (token->type == TOKEN_IDENT) {
         Parser_eat(parser, token, TOKEN_IDENT);
-        node = Arena_alloc(parser->arena, sizeof(Node));
         SymbolTableEntry *entry = SymbolTable_find_before(parser->symbol_table, &token->name, token->line, token->col);
         if (entry) {
             token->entry = entry;
         } else {
-            error(token->line, "Identifier `%s` isn't declared in the current scope", token->name.data);
+            error(token->line, "Identifier `%.*s` isn't declared in the current scope", (int)token->name.count, token->name.data);
         }
-        node->token = token;
-        node->left = NULL;
-        node->right = NULL;
-        node->scope = NULL;
+        node = Node_new(*token, 0, 0);
     } else if (token->type == '(') {
         Parser_eat(parser, token, '(');
         node = Parser_expr(parser);
@@ -110,13 +78,13 @@ Node *Parser_operand(Parser *parser) {
     return node;
 }
 
-Node *Parser_postfix(Parser *parser) {
-    Node *node = Parser_operand(parser);
+NodeIndex Parser_postfix(Parser *parser) {
+    NodeIndex node = Parser_operand(parser);
     
     Token *token = Lexer_peekNextToken(&parser->lexer);
     
     while (token->type == TOKEN_INC || token->type == TOKEN_DEC || token->type == TOKEN_ARROW || token->type == '.' || token->type == '[' || token->type == '(') {
-        Node *right = NULL;
+        NodeIndex right = 0;
         if (token->type == TOKEN_INC) {
             Parser_eat(parser, token, TOKEN_INC);
             token->type = TOKEN_POSTINC;
@@ -143,12 +111,7 @@ Node *Parser_postfix(Parser *parser) {
             token->type = TOKEN_FUNCTION_CALL;
         }
         
-        Node *tmp = Arena_alloc(parser->arena, sizeof(Node));
-        tmp->left = node;
-        tmp->token = token;
-        tmp->right = right;
-        tmp->scope = NULL;
-        node = tmp;
+        node = Node_new(*token, node, right);
         
         token = Lexer_peekNextToken(&parser->lexer);
     }
@@ -158,8 +121,8 @@ Node *Parser_postfix(Parser *parser) {
     return node;
 }
 
-Node *Parser_prefix(Parser *parser) {
-    Node *node;
+NodeIndex Parser_prefix(Parser *parser) {
+    NodeIndex node;
     
     Token *token = Lexer_peekNextToken(&parser->lexer);
     
@@ -196,11 +159,8 @@ Node *Parser_prefix(Parser *parser) {
             token->type = TOKEN_ADDRESS;
         }
         
-        node = Arena_alloc(parser->arena, sizeof(Node));
-        node->left = Parser_prefix(parser);
-        node->token = token;
-        node->right = NULL;
-        node->scope = NULL;
+        NodeIndex operand = Parser_prefix(parser);
+        node = Node_new(*token, operand, 0);
     } else {
         parser->lexer.peek = parser->lexer.pos;
         
@@ -212,357 +172,64 @@ Node *Parser_prefix(Parser *parser) {
     return node;
 }
 
-Node *Parser_muls(Parser *parser) {
-    // term ::= factor [('*'|'/'|'%') factor]*
-    Node *node = Parser_prefix(parser);
+// NOTE(mdizdar): how tightly each binary operator binds, anything that isn't in here (or is 0) ends the expression
+static const u8 BINARY_PRECEDENCE[TOKEN_BIT_R_ASSIGN+1] = {
+    [','] = PRECEDENCE_COMMA,
     
-    Token *token = Lexer_peekNextToken(&parser->lexer);
-    
-    while (token->type == '*' || token->type == '/' || token->type == '%') {
-        if (token->type == '*') {
-            Parser_eat(parser, token, '*');
-        } else if (token->type == '/') {
-            Parser_eat(parser, token, '/');
-        } else if (token->type == '%') {
-            Parser_eat(parser, token, '%');
-        }
-        
-        Node *tmp = Arena_alloc(parser->arena, sizeof(Node));
-        tmp->left = node;
-        tmp->token = token;
-        tmp->right = Parser_prefix(parser);
-        tmp->scope = NULL;
-        node = tmp;
-        
-        token = Lexer_peekNextToken(&parser->lexer);
-    }
-    
-    Lexer_resetPeek(&parser->lexer);
-    
-    return node;
-}
-
-Node *Parser_sums(Parser *parser) {
-    // expr ::= term [('+'|'-') term]*
-    
-    Node *node = Parser_muls(parser);
-    
-    Token *token = Lexer_peekNextToken(&parser->lexer);
-    while (token->type == '+' || token->type == '-') {
-        if (token->type == '+') {
-            Parser_eat(parser, token, '+');
-        } else if (token->type == '-') {
-            Parser_eat(parser, token, '-');
-        }
-        Node *tmp = Arena_alloc(parser->arena, sizeof(Node));
-        tmp->left = node;
-        tmp->token = token;
-        tmp->right = Parser_muls(parser);
-        tmp->scope = NULL;
-        node = tmp;
-        
-        token = Lexer_peekNextToken(&parser->lexer);
-    }
-    
-    Lexer_resetPeek(&parser->lexer);
-    
-    return node;
-}
-
-Node *Parser_bitshift(Parser *parser) {
-    Node *node = Parser_sums(parser);
-    
-    Token *token = Lexer_peekNextToken(&parser->lexer);
-    
-    while (token->type == TOKEN_BITSHIFT_LEFT || token->type == TOKEN_BITSHIFT_RIGHT) {
-        if (token->type == TOKEN_BITSHIFT_LEFT) {
-            Parser_eat(parser, token, TOKEN_BITSHIFT_LEFT);
-        } else if (token->type == TOKEN_BITSHIFT_RIGHT) {
-            Parser_eat(parser, token, TOKEN_BITSHIFT_RIGHT);
-        }
-        
-        Node *tmp = Arena_alloc(parser->arena, sizeof(Node));
-        tmp->left = node;
-        tmp->token = token;
-        tmp->right = Parser_sums(parser);
-        tmp->scope = NULL;
-        node = tmp;
-        
-        token = Lexer_peekNextToken(&parser->lexer);
-    }
-    
-    Lexer_resetPeek(&parser->lexer);
-    
-    return node;
-}
-
-Node *Parser_rel_op(Parser *parser) {
-    Node *node = Parser_bitshift(parser);
-    
-    Token *token = Lexer_peekNextToken(&parser->lexer);
-    
-    while (token->type == TOKEN_LESS_EQ || token->type == TOKEN_GREATER_EQ ||
-           token->type == '<' || token->type == '>') {
-        if (token->type == TOKEN_LESS_EQ) {
-            Parser_eat(parser, token, TOKEN_LESS_EQ);
-        } else if (token->type == TOKEN_GREATER_EQ) {
-            Parser_eat(parser, token, TOKEN_GREATER_EQ);
-        } else if (token->type == '<') {
-            Parser_eat(parser, token, '<');
-        } else if (token->type == '>') {
-            Parser_eat(parser, token, '>');
-        }
-        
-        Node *tmp = Arena_alloc(parser->arena, sizeof(Node));
-        tmp->left = node;
-        tmp->token = token;
-        tmp->right = Parser_bitshift(parser);
-        tmp->scope = NULL;
-        node = tmp;
-        
-        token = Lexer_peekNextToken(&parser->lexer);
-    }
-    
-    Lexer_resetPeek(&parser->lexer);
-    
-    return node;
-}
-
-Node *Parser_rel_eq(Parser *parser) {
-    Node *node = Parser_rel_op(parser);
-    
-    Token *token = Lexer_peekNextToken(&parser->lexer);
-    
-    while (token->type == TOKEN_EQUALS || token->type == TOKEN_NOT_EQ) {
-        if (token->type == TOKEN_EQUALS) {
-            Parser_eat(parser, token, TOKEN_EQUALS);
-        } else if (token->type == TOKEN_NOT_EQ) {
-            Parser_eat(parser, token, TOKEN_NOT_EQ);
-        }
-        
-        Node *tmp = Arena_alloc(parser->arena, sizeof(Node));
-        tmp->left = node;
-        tmp->token = token;
-        tmp->right = Parser_rel_op(parser);
-        tmp->scope = NULL;
-        node = tmp;
-        
-        token = Lexer_peekNextToken(&parser->lexer);
-    }
-    
-    Lexer_resetPeek(&parser->lexer);
-    
-    return node;
-}
-
-Node *Parser_bit_and(Parser *parser) {
-    Node *node = Parser_rel_eq(parser);
-    
-    Token *token = Lexer_peekNextToken(&parser->lexer);
-    
-    while (token->type == '&') {
-        Parser_eat(parser, token, '&');
-        
-        Node *tmp = Arena_alloc(parser->arena, sizeof(Node));
-        tmp->left = node;
-        tmp->token = token;
-        tmp->right = Parser_rel_eq(parser);
-        tmp->scope = NULL;
-        node = tmp;
-        
-        token = Lexer_peekNextToken(&parser->lexer);
-    }
-    
-    Lexer_resetPeek(&parser->lexer);
-    
-    return node;
-}
-
-Node *Parser_bit_xor(Parser *parser) {
-    Node *node = Parser_bit_and(parser);
+    ['='] = PRECEDENCE_ASSIGNMENT,
+    [TOKEN_ADD_ASSIGN] = PRECEDENCE_ASSIGNMENT, [TOKEN_SUB_ASSIGN] = PRECEDENCE_ASSIGNMENT,
+    [TOKEN_MUL_ASSIGN] = PRECEDENCE_ASSIGNMENT, [TOKEN_DIV_ASSIGN] = PRECEDENCE_ASSIGNMENT,
+    [TOKEN_MOD_ASSIGN] = PRECEDENCE_ASSIGNMENT, [TOKEN_OR_ASSIGN]  = PRECEDENCE_ASSIGNMENT,
+    [TOKEN_AND_ASSIGN] = PRECEDENCE_ASSIGNMENT, [TOKEN_XOR_ASSIGN] = PRECEDENCE_ASSIGNMENT,
+    [TOKEN_BIT_L_ASSIGN] = PRECEDENCE_ASSIGNMENT, [TOKEN_BIT_R_ASSIGN] = PRECEDENCE_ASSIGNMENT,
     
-    Token *token = Lexer_peekNextToken(&parser->lexer);
+    ['?'] = PRECEDENCE_TERNARY,
     
-    while (token->type == '^') {
-        Parser_eat(parser, token, '^');
-        
-        Node *tmp = Arena_alloc(parser->arena, sizeof(Node));
-        tmp->left = node;
-        tmp->token = token;
-        tmp->right = Parser_bit_and(parser);
-        tmp->scope = NULL;
-        node = tmp;
-        
-        token = Lexer_peekNextToken(&parser->lexer);
-    }
+    [TOKEN_LOGICAL_OR]  = PRECEDENCE_LOG_OR,
+    [TOKEN_LOGICAL_AND] = PRECEDENCE_LOG_AND,
+    ['|'] = PRECEDENCE_BIT_OR,
+    ['^'] = PRECEDENCE_BIT_XOR,
+    ['&'] = PRECEDENCE_BIT_AND,
     
-    Lexer_resetPeek(&parser->lexer);
+    [TOKEN_EQUALS]  = PRECEDENCE_REL_EQ, [TOKEN_NOT_EQ]     = PRECEDENCE_REL_EQ,
+    [TOKEN_LESS_EQ] = PRECEDENCE_REL_OP, [TOKEN_GREATER_EQ] = PRECEDENCE_REL_OP,
+    ['<'] = PRECEDENCE_REL_OP, ['>'] = PRECEDENCE_REL_OP,
     
-    return node;
-}
-
-Node *Parser_bit_or(Parser *parser) {
-    Node *node = Parser_bit_xor(parser);
+    [TOKEN_BITSHIFT_LEFT] = PRECEDENCE_BITSHIFT, [TOKEN_BITSHIFT_RIGHT] = PRECEDENCE_BITSHIFT,
     
-    Token *token = Lexer_peekNextToken(&parser->lexer);
-    
-    while (token->type == '|') {
-        Parser_eat(parser, token, '|');
-        
-        Node *tmp = Arena_alloc(parser->arena, sizeof(Node));
-        tmp->left = node;
-        tmp->token = token;
-        tmp->right = Parser_bit_xor(parser);
-        tmp->scope = NULL;
-        node = tmp;
-        
-        token = Lexer_peekNextToken(&parser->lexer);
-    }
-    
-    Lexer_resetPeek(&parser->lexer);
-    
-    return node;
-}
+    ['+'] = PRECEDENCE_ADD, ['-'] = PRECEDENCE_ADD,
+    ['*'] = PRECEDENCE_MUL, ['/'] = PRECEDENCE_MUL, ['%'] = PRECEDENCE_MUL,
+};
 
-Node *Parser_log_and(Parser *parser) {
-    Node *node = Parser_bit_or(parser);
-    
-    Token *token = Lexer_peekNextToken(&parser->lexer);
-    
-    while (token->type == TOKEN_LOGICAL_AND) {
-        Parser_eat(parser, token, TOKEN_LOGICAL_AND);
-        
-        Node *tmp = Arena_alloc(parser->arena, sizeof(Node));
-        tmp->left = node;
-        tmp->token = token;
-        tmp->right = Parser_bit_or(parser);
-        tmp->scope = NULL;
-        node = tmp;
-        
-        token = Lexer_peekNextToken(&parser->lexer);
-    }
-    
-    Lexer_resetPeek(&parser->lexer);
-    
-    return node;
+static inline Precedence Parser_binaryPrecedence(TokenType type) {
+    return (u32)type < sizeof(BINARY_PRECEDENCE) ? (Precedence)BINARY_PRECEDENCE[type] : PRECEDENCE_NONE;
 }
 
-Node *Parser_log_or(Parser *parser) {
-    Node *node = Parser_log_and(parser);
-    
-    Token *token = Lexer_peekNextToken(&parser->lexer);
-    
-    while (token->type == TOKEN_LOGICAL_OR) {
-        Parser_eat(parser, token, TOKEN_LOGICAL_OR);
-        
-        Node *tmp = Arena_alloc(parser->arena, sizeof(Node));
-        tmp->left = node;
-        tmp->token = token;
-        tmp->right = Parser_log_and(parser);
-        tmp->scope = NULL;
-        node = tmp;
-        
-        token = Lexer_peekNextToken(&parser->lexer);
-    }
-    
-    Lexer_resetPeek(&parser->lexer);
+// parses a prefix expression followed by every binary operator that binds at least as tightly as min_precedence.
+// Everything is left associative except assignments (right) and the ternary, whose middle is a full
+// expression and whose false branch is another ternary, same as C
+NodeIndex Parser_binary(Parser *parser, Precedence min_precedence) {
+    NodeIndex node = Parser_prefix(parser);
     
-    return node;
-}
-
-Node *Parser_ternary(Parser *parser) {
-    Node *node = Parser_log_or(parser);
-    
-    Token *token = Lexer_peekNextToken(&parser->lexer);
-    
-    if (token->type == '?') {
-        Parser_eat(parser, token, '?');
-        Node *ternary_true = Parser_expr(parser);
-        Token *colon = Lexer_peekNextToken(&parser->lexer);
-        Parser_eat(parser, colon, ':');
-        
-        Node *tmp = Arena_alloc(parser->arena, sizeof(Node));
-        tmp->cond = node;
-        tmp->left = ternary_true;
-        tmp->token = token;
-        tmp->right = Parser_ternary(parser);
-        tmp->scope = NULL;
-        node = tmp;
-    }
-    
-    Lexer_resetPeek(&parser->lexer);
-    
-    return node;
-}
-
-Node *Parser_assignment(Parser *parser) {
-    Node *node = Parser_ternary(parser);
-    
-    Token *token = Lexer_peekNextToken(&parser->lexer);
-    
-    // TODO(mdizdar): doing this exact same thing for each level is kinda stupid, refactor it eventually
-    
-    if (token->type == '=' || 
-        token->type == TOKEN_ADD_ASSIGN || token->type == TOKEN_SUB_ASSIGN ||
-        token->type == TOKEN_MUL_ASSIGN || token->type == TOKEN_DIV_ASSIGN || 
-        token->type == TOKEN_MOD_ASSIGN || token->type == TOKEN_OR_ASSIGN  || 
-        token->type == TOKEN_AND_ASSIGN || token->type == TOKEN_XOR_ASSIGN || 
-        token->type == TOKEN_BIT_L_ASSIGN || token->type == TOKEN_BIT_R_ASSIGN) {
-        if (token->type == '=') {
-            Parser_eat(parser, token, '=');
-        } else if (token->type == TOKEN_ADD_ASSIGN) {
-            Parser_eat(parser, token, TOKEN_ADD_ASSIGN);
-        } else if (token->type == TOKEN_SUB_ASSIGN) {
-            Parser_eat(parser, token, TOKEN_SUB_ASSIGN);
-        } else if (token->type == TOKEN_MUL_ASSIGN) {
-            Parser_eat(parser, token, TOKEN_MUL_ASSIGN);
-        } else if (token->type == TOKEN_DIV_ASSIGN) {
-            Parser_eat(parser, token, TOKEN_DIV_ASSIGN);
-        } else if (token->type == TOKEN_MOD_ASSIGN) {
-            Parser_eat(parser, token, TOKEN_MOD_ASSIGN);
-        } else if (token->type == TOKEN_OR_ASSIGN) {
-            Parser_eat(parser, token, TOKEN_OR_ASSIGN);
-        } else if (token->type == TOKEN_AND_ASSIGN) {
-            Parser_eat(parser, token, TOKEN_AND_ASSIGN);
-        } else if (token->type == TOKEN_XOR_ASSIGN) {
-            Parser_eat(parser, token, TOKEN_XOR_ASSIGN);
-        } else if (token->type == TOKEN_BIT_L_ASSIGN) {
-            Parser_eat(parser, token, TOKEN_BIT_L_ASSIGN);
-        } else if (token->type == TOKEN_BIT_R_ASSIGN) {
-            Parser_eat(parser, token, TOKEN_BIT_R_ASSIGN);
-        }
+    for (;;) {
+        Token *token = Lexer_peekNextToken(&parser->lexer);
+        Precedence precedence = Parser_binaryPrecedence(token->type);
+        if (precedence == PRECEDENCE_NONE || precedence < min_precedence) break;
+        Lexer_eat(&parser->lexer);
         
-        Node *tmp = Arena_alloc(parser->arena, sizeof(Node));
-        tmp->left = node;
-        tmp->token = token;
-        tmp->right = Parser_assignment(parser);
-        tmp->scope = NULL;
-        node = tmp;
-    }
-    
-    Lexer_resetPeek(&parser->lexer);
-    
-    return node;
-}
-
-Node *Parser_comma(Parser *parser) {
-    Node *node = Parser_assignment(parser);
-    
-    Token *token = Lexer_peekNextToken(&parser->lexer);
-    
-    while (token->type == ',') {
-        if (token->type == ',') {
-            Parser_eat(parser, token, ',');
+        if (precedence == PRECEDENCE_TERNARY) {
+            NodeIndex ternary_true = Parser_expr(parser);
+            Token *colon = Lexer_peekNextToken(&parser->lexer);
+            Parser_eat(parser, colon, ':');
+            
+            NodeIndex ternary_false = Parser_binary(parser, PRECEDENCE_TERNARY);
+            NodeIndex tmp = Node_new(*token, ternary_true, ternary_false);
+            Node_at(tmp)->cond = node;
+            node = tmp;
+        } else {
+            NodeIndex right = Parser_binary(parser, precedence == PRECEDENCE_ASSIGNMENT ? precedence : precedence+1);
+            node = Node_new(*token, node, right);
         }
-        
-        Node *tmp = Arena_alloc(parser->arena, sizeof(Node));
-        tmp->left = node;
-        tmp->token = token;
-        tmp->right = Parser_assignment(parser);
-        tmp->scope = NULL;
-        node = tmp;
-        
-        token = Lexer_peekNextToken(&parser->lexer);
     }
     
     Lexer_resetPeek(&parser->lexer);
@@ -570,27 +237,22 @@ Node *Parser_comma(Parser *parser) {
     return node;
 }
 
-Node *Parser_expr(Parser *parser) {
-    return Parser_comma(parser);
+NodeIndex Parser_expr(Parser *parser) {
+    return Parser_binary(parser, PRECEDENCE_COMMA);
 }
 
-Node *Parser_functionBlock(Parser *parser) {
+NodeIndex Parser_functionBlock(Parser *parser) {
     Token *token = Lexer_peekNextToken(&parser->lexer);
     Parser_eat(parser, token, '{');
     
-    Node *node = Parser_statement(parser);
+    NodeIndex node = Parser_statement(parser);
     token = Lexer_peekNextToken(&parser->lexer);
     
     while (token->type != '}') {
         Lexer_resetPeek(&parser->lexer);
         
-        Node *tmp = Arena_alloc(parser->arena, sizeof(Node));
-        tmp->left = node;
-        tmp->token = Arena_alloc(parser->lexer.token_arena, sizeof(Token));
-        tmp->token->type = TOKEN_NEXT;
-        tmp->right = Parser_statement(parser);
-        tmp->scope = NULL;
-        node = tmp;
+        NodeIndex statement = Parser_statement(parser);
+        node = Node_new((Token){.type = TOKEN_NEXT}, node, statement);
         
         token = Lexer_peekNextToken(&parser->lexer);
     }
@@ -599,16 +261,16 @@ Node *Parser_functionBlock(Parser *parser) {
     
     Lexer_resetPeek(&parser->lexer);
     
-    node->scope = parser->symbol_table->scope;
+    Node_at(node)->scope = parser->symbol_table->scope;
     // TODO(mdizdar): this is wrong, the scope should be changed at the function declaration, or when opening a new block. i.e. in lines 1027 and when creating a function declaration node, but it should only refer to the scope within it, so I'm not sure how to handle that rn Sadge
     
     return node;
 }
 
-Node *Parser_block(Parser *parser) {
+NodeIndex Parser_block(Parser *parser) {
     SymbolTable_pushScope(parser->symbol_table);
     
-    Node *node = Parser_functionBlock(parser);
+    NodeIndex node = Parser_functionBlock(parser);
     
     SymbolTable_popScope(parser->symbol_table);
     
@@ -737,17 +399,12 @@ Type *Parser_function(Parser *parser, Type *type) {
     }
     Parser_eat(parser, token, '('); // uhh
     
-    Type *ftype = Arena_alloc(parser->type_arena, sizeof(Type));
-    ftype->is_static = false;
-    ftype->is_struct = false;
-    ftype->is_union = false;
-    ftype->is_typedef = false;
-    ftype->is_array = false;
-    ftype->is_function = true;
-    ftype->pointer_count = 0;
-    ftype->function_type = Arena_alloc(parser->type_arena, sizeof(FunctionType));
-    DeclarationArray_construct(&ftype->function_type->parameters);
-    ftype->function_type->return_type = type;
+    Type ftype = (Type){
+        .is_function = true,
+        .function_type = Arena_alloc(parser->type_arena, sizeof(FunctionType))
+    };
+    DeclarationArray_construct(&ftype.function_type->parameters);
+    ftype.function_type->return_type = type;
     
     SymbolTable_pushScope(parser->symbol_table);
     
@@ -756,7 +413,7 @@ Type *Parser_function(Parser *parser, Type *type) {
     while (token->type != ')') {
         Lexer_resetPeek(&parser->lexer);
         Declaration *decl = Parser_declaration(parser, false);
-        DeclarationArray_push_ptr(&ftype->function_type->parameters, decl);
+        DeclarationArray_push_ptr(&ftype.function_type->parameters, decl);
         token = Lexer_peekNextToken(&parser->lexer);
         if (token->type == ',') {
             Parser_eat(parser, token, ',');
@@ -765,13 +422,13 @@ Type *Parser_function(Parser *parser, Type *type) {
     }
     Parser_eat(parser, token, ')');
     
-    ftype->function_type->block = Parser_functionBlock(parser);
+    ftype.function_type->block = Parser_functionBlock(parser);
     
     SymbolTable_popScope(parser->symbol_table);
     
     Lexer_resetPeek(&parser->lexer);
     
-    return ftype;
+    return Type_intern(&ftype);
 }
 
 inline Type *Parser_cvp(Parser *parser, Type *type) {
@@ -779,12 +436,14 @@ inline Type *Parser_cvp(Parser *parser, Type *type) {
     
     Token *token = Lexer_currentPeekedToken(&parser->lexer);
     
-    Type *new_type = Arena_alloc(parser->type_arena, sizeof(Type));;
-    memcpy(new_type, type, sizeof(Type));
+    Type new_type = *type;
     
     while (token->type == '*') {
         Parser_eat(parser, token, '*');
-        ++new_type->pointer_count;
+        if (new_type.pointer_count == TYPE_MAX_POINTERS) {
+            error(parser->lexer.cur_line, "Error: more than %d levels of pointers, what are you doing", TYPE_MAX_POINTERS);
+        }
+        ++new_type.pointer_count;
         
         token = Lexer_peekNextToken(&parser->lexer);
         
@@ -795,24 +454,24 @@ inline Type *Parser_cvp(Parser *parser, Type *type) {
             
             switch (token->type) {
                 case TOKEN_CONST: {
-                    Bitset_set(new_type->is_const, new_type->pointer_count);
+                    new_type.is_const |= TYPE_QUALIFIER(new_type.pointer_count);
                     break;
                 }
                 case TOKEN_VOLATILE: {
-                    Bitset_set(new_type->is_volatile, new_type->pointer_count);
+                    new_type.is_volatile |= TYPE_QUALIFIER(new_type.pointer_count);
                     break;
                 }
                 default: {
                     error(parser->lexer.cur_line, "Internal compiler error: token type isn't const, volatile nor restrict"); 
                 }
-                // TODO(mdizdar): case TOKEN_RESTRICT: Bitset_set(new_type->is_restrict, new_type->pointer_count); break;
+                // TODO(mdizdar): case TOKEN_RESTRICT: new_type.is_restrict |= TYPE_QUALIFIER(new_type.pointer_count); break;
             }
             
             token = Lexer_peekNextToken(&parser->lexer);
         }
     }
     
-    return new_type;
+    return Type_intern(&new_type);
 }
 
 Declaration *Parser_declaration(Parser *parser, bool can_be_static) {
@@ -866,11 +525,11 @@ Declaration *Parser_declaration(Parser *parser, bool can_be_static) {
                 break;
             }
             case TOKEN_CONST: {
-                Bitset_set(type->is_const, type->pointer_count);
+                type->is_const |= TYPE_QUALIFIER(type->pointer_count);
                 break;
             }
             case TOKEN_VOLATILE: {
-                Bitset_set(type->is_volatile, type->pointer_count);
+                type->is_volatile |= TYPE_QUALIFIER(type->pointer_count);
                 break;
             }
             case TOKEN_SIGNED: {
@@ -918,7 +577,7 @@ Declaration *Parser_declaration(Parser *parser, bool can_be_static) {
                 break;
             }
             default: {
-                error(parser->lexer.cur_line, "Expected a type name, got %s", token->name.data);
+                error(parser->lexer.cur_line, "Expected a type name, got %.*s", (int)token->name.count, token->name.data);
             }
         }
         token = Lexer_peekNextToken(&parser->lexer);
@@ -992,140 +651,132 @@ while (token->type == ',') {
     return declaration;
 }
 
-Node *Parser_statement(Parser *parser) {
+NodeIndex Parser_statement(Parser *parser) {
     Declaration *decl = Parser_declaration(parser, true);
     if (decl) {
-        Node *tmp = Arena_alloc(parser->arena, sizeof(Node));
-        tmp->token = Arena_alloc(parser->lexer.token_arena, sizeof(Token));
-        tmp->token->type = TOKEN_DECLARATION;
-        tmp->token->entry = SymbolTable_find(parser->symbol_table, &decl->name);
-        tmp->left = NULL;
-        tmp->right = NULL;
-        tmp->scope = NULL;
+        NodeIndex tmp = Node_new((Token){
+            .type = TOKEN_DECLARATION,
+            .entry = SymbolTable_find(parser->symbol_table, &decl->name)
+        }, 0, 0);
         
         Token *token = Lexer_peekNextToken(&parser->lexer);
         Parser_eat(parser, token, ';');
         return tmp;
     }
     
-    Node *node = Arena_alloc(parser->arena, sizeof(Node));
-    node->scope = NULL;
-    node->left = NULL;
-    node->right = NULL;
-    node->cond = NULL;
+    NodeIndex node;
     
     Token *token = Lexer_peekNextToken(&parser->lexer);
     
+    // NOTE(mdizdar): Node_new can move the nodes around, so the children are parsed before making their parent
     if (token->type == TOKEN_IF) {
         Parser_eat(parser, token, TOKEN_IF);
         
-        node->token = token;
+        Token *if_token = token;
         
         token = Lexer_peekNextToken(&parser->lexer);
         Parser_eat(parser, token, '(');
-        Node *cond = Parser_expr(parser);
+        NodeIndex cond = Parser_expr(parser);
         token = Lexer_peekNextToken(&parser->lexer);
         Parser_eat(parser, token, ')');
         
-        node->cond = cond;
-        node->right = NULL;
-        
-        node->left = Parser_statement(parser);
+        NodeIndex then = Parser_statement(parser);
+        NodeIndex otherwise = 0;
         
         token = Lexer_peekNextToken(&parser->lexer);
         if (token->type == TOKEN_ELSE) {
             Parser_eat(parser, token, TOKEN_ELSE);
-            node->right = Parser_statement(parser);
+            otherwise = Parser_statement(parser);
         }
+        
+        node = Node_new(*if_token, then, otherwise);
+        Node_at(node)->cond = cond;
     } else if (token->type == TOKEN_WHILE) {
         Parser_eat(parser, token, TOKEN_WHILE);
         
-        node->token = token;
+        Token *while_token = token;
         
         token = Lexer_peekNextToken(&parser->lexer);
         Parser_eat(parser, token, '(');
-        Node *cond = Parser_expr(parser);
+        NodeIndex cond = Parser_expr(parser);
         token = Lexer_peekNextToken(&parser->lexer);
         Parser_eat(parser, token, ')');
         
-        node->cond = cond;
-        node->right = NULL;
+        NodeIndex body = Parser_statement(parser);
         
-        node->left = Parser_statement(parser);
+        node = Node_new(*while_token, body, 0);
+        Node_at(node)->cond = cond;
     } else if (token->type == TOKEN_FOR) {
         Parser_eat(parser, token, TOKEN_FOR);
         
-        node->token = token;
+        Token *for_token = token;
         
         token = Lexer_peekNextToken(&parser->lexer);
         Parser_eat(parser, token, '(');
-        Node *init = Parser_expr(parser);
+        NodeIndex init = Parser_expr(parser);
         token = Lexer_peekNextToken(&parser->lexer);
         Parser_eat(parser, token, ';');
-        Node *cond = Parser_expr(parser);
+        NodeIndex cond = Parser_expr(parser);
         token = Lexer_peekNextToken(&parser->lexer);
         Parser_eat(parser, token, ';');
-        Node *iter = Parser_expr(parser);
+        NodeIndex iter = Parser_expr(parser);
         token = Lexer_peekNextToken(&parser->lexer);
         Parser_eat(parser, token, ')');
         
-        Node *tmp = Arena_alloc(parser->arena, sizeof(Node));
-        tmp->cond = cond;
-        tmp->left = init;
-        tmp->right = iter;
-        tmp->scope = NULL;
-        tmp->token = Arena_alloc(parser->lexer.token_arena, sizeof(Token));
-        tmp->token->type = TOKEN_FOR_COND;
+        NodeIndex for_cond = Node_new((Token){.type = TOKEN_FOR_COND}, init, iter);
+        Node_at(for_cond)->cond = cond;
         
-        node->cond = tmp;
-        node->right = NULL;
+        NodeIndex body = Parser_statement(parser);
         
-        node->left = Parser_statement(parser);
+        node = Node_new(*for_token, body, 0);
+        Node_at(node)->cond = for_cond;
     } else if (token->type == TOKEN_DO) {
         Parser_eat(parser, token, TOKEN_DO);
         
-        node->token = token;
+        Token *do_token = token;
         
         token = Lexer_peekNextToken(&parser->lexer);
         
-        node->left = Parser_statement(parser);
+        NodeIndex body = Parser_statement(parser);
         
         token = Lexer_peekNextToken(&parser->lexer);
         Parser_eat(parser, token, TOKEN_WHILE);
         
         token = Lexer_peekNextToken(&parser->lexer);
         Parser_eat(parser, token, '(');
-        Node *cond = Parser_expr(parser);
+        NodeIndex cond = Parser_expr(parser);
         token = Lexer_peekNextToken(&parser->lexer);
         Parser_eat(parser, token, ')');
         token = Lexer_peekNextToken(&parser->lexer);
         
-        node->cond = cond;
+        node = Node_new(*do_token, body, 0);
+        Node_at(node)->cond = cond;
     } else if (token->type == TOKEN_RETURN) {
         Parser_eat(parser, token, TOKEN_RETURN);
         
-        node->token = token;
+        Token *return_token = token;
         //token = Lexer_peekNextToken(&parser->lexer);
-        node->left = Parser_expr(parser);
+        NodeIndex value = Parser_expr(parser);
         token = Lexer_peekNextToken(&parser->lexer);
         Parser_eat(parser, token, ';');
+        
+        node = Node_new(*return_token, value, 0);
     } else if (token->type == TOKEN_CONTINUE) {
         Parser_eat(parser, token, TOKEN_CONTINUE);
         
-        node->token = token;
+        node = Node_new(*token, 0, 0);
         token = Lexer_peekNextToken(&parser->lexer);
         Parser_eat(parser, token, ';');
     } else if (token->type == TOKEN_BREAK) {
         Parser_eat(parser, token, TOKEN_BREAK);
         
-        node->token = token;
+        node = Node_new(*token, 0, 0);
         token = Lexer_peekNextToken(&parser->lexer);
         Parser_eat(parser, token, ';');
     } else if (token->type == '{') {
         Lexer_resetPeek(&parser->lexer);
         node = Parser_block(parser);
     } else {
-        // we aren't using the node we allocated up there, but since our arena doesn't support freeing memory at the moment, we won't free it here
         Lexer_resetPeek(&parser->lexer);
         node = Parser_expr(parser);
         token = Lexer_peekNextToken(&parser->lexer);
@@ -1137,31 +788,20 @@ Node *Parser_statement(Parser *parser) {
     return node;
 }
 
-Node *Parser_topLevel(Parser *parser) {
+NodeIndex Parser_topLevel(Parser *parser) {
     Declaration *decl = Parser_declaration(parser, true);
-    Node *tmp = Arena_alloc(parser->arena, sizeof(Node));
-    tmp->token = Arena_alloc(parser->lexer.token_arena, sizeof(Token));
-    tmp->token->type = TOKEN_DECLARATION;
-    tmp->token->name = decl->name;
-    tmp->left = NULL;
-    tmp->right = NULL;
-    tmp->scope = NULL;
-    return tmp;
+    return Node_new((Token){.type = TOKEN_DECLARATION, .name = decl->name}, 0, 0);
 }
 
-Node *Parser_parse(Parser *parser) {
-    Node *node = Parser_topLevel(parser);
+NodeIndex Parser_parse(Parser *parser) {
+    Type_initInterner(parser->type_arena);
+    NodeIndex node = Parser_topLevel(parser);
     Token *token = Lexer_peekNextToken(&parser->lexer);
     
     while (token->type != TOKEN_ERROR) {
         parser->lexer.peek = parser->lexer.pos;
-        Node *tmp = Arena_alloc(parser->arena, sizeof(Node));
-        tmp->left = node;
-        tmp->token = Arena_alloc(parser->lexer.token_arena, sizeof(Token));
-        tmp->token->type = TOKEN_NEXT;
-        tmp->right = Parser_topLevel(parser);
-        tmp->scope = NULL;
-        node = tmp;
+        NodeIndex declaration = Parser_topLevel(parser);
+        node = Node_new((Token){.type = TOKEN_NEXT}, node, declaration);
         token = Lexer_peekNextToken(&parser->lexer);
     }
     
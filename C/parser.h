@@ -21,7 +21,6 @@
 //#define Arena_alloc(x, y) malloc((y))
 
 STRUCT_HEADER(Parser, {
-    Arena *arena;
     Arena *type_arena;
     SymbolTable *symbol_table;
     Lexer lexer;
@@ -35,14 +34,15 @@ typedef enum {
     PRECEDENCE_LOG_OR = 4,
     PRECEDENCE_LOG_AND = 5,
     PRECEDENCE_BIT_OR = 6,
-    PRECEDENCE_BIT_AND = 7,
-    PRECEDENCE_REL_EQ = 8,
-    PRECEDENCE_REL_OP = 9,
-    PRECEDENCE_BITSHIFT = 10,
-    PRECEDENCE_ADD = 11,
-    PRECEDENCE_MUL = 12,
-    PRECEDENCE_HIGH = 13, // NOTE(mdizdar): bad names
-    PRECEDENCE_HIGHEST = 14
+    PRECEDENCE_BIT_XOR = 7,
+    PRECEDENCE_BIT_AND = 8,
+    PRECEDENCE_REL_EQ = 9,
+    PRECEDENCE_REL_OP = 10,
+    PRECEDENCE_BITSHIFT = 11,
+    PRECEDENCE_ADD = 12,
+    PRECEDENCE_MUL = 13,
+    PRECEDENCE_HIGH = 14, // NOTE(mdizdar): bad names
+    PRECEDENCE_HIGHEST = 15
 } Precedence;
 
 _Noreturn void Parser_error(Parser *parser, Token *token, TokenType expected_type);
@@ -50,35 +50,22 @@ _Noreturn void Parser_duplicateError(Parser *parser, SymbolTableEntry *previous)
 _Noreturn void Parser_conflictingTypesError(Parser *parser, TokenType current, TokenType conflicting);
 _Noreturn void Parser_notATypeError(Parser *parser, u64 longs, u64 shorts, TokenType type);
 // TODO(mdizdar): compound literals
-// TODO(mdizdar): the bodies of these precedence based functions are very similar, generalize maybe
 
 void Parser_eat(Parser *parser, Token *token, TokenType token_type);
-Node *Parser_operand(Parser *parser);
-Node *Parser_postfix(Parser *parser);
-Node *Parser_prefix(Parser *parser);
-Node *Parser_muls(Parser *parser);
-Node *Parser_sums(Parser *parser);
-Node *Parser_bitshift(Parser *parser);
-Node *Parser_rel_op(Parser *parser);
-Node *Parser_rel_eq(Parser *parser);
-Node *Parser_bit_and(Parser *parser);
-Node *Parser_bit_xor(Parser *parser);
-Node *Parser_bit_or(Parser *parser);
-Node *Parser_log_and(Parser *parser);
-Node *Parser_log_or(Parser *parser);
-Node *Parser_ternary(Parser *parser);
-Node *Parser_assignment(Parser *parser);
-Node *Parser_comma(Parser *parser);
-Node *Parser_expr(Parser *parser);
-Node *Parser_functionBlock(Parser *parser);
-Node *Parser_block(Parser *parser);
+NodeIndex Parser_operand(Parser *parser);
+NodeIndex Parser_postfix(Parser *parser);
+NodeIndex Parser_prefix(Parser *parser);
+NodeIndex Parser_binary(Parser *parser, Precedence min_precedence);
+NodeIndex Parser_expr(Parser *parser);
+NodeIndex Parser_functionBlock(Parser *parser);
+NodeIndex Parser_block(Parser *parser);
 Declaration *Parser_struct(Parser *parser, Type **type);
 Declaration *Parser_union(Parser *parser, Type **type);
 Type *Parser_function(Parser *parser, Type *type);
 Type *Parser_cvp(Parser *parser, Type *type);
 Declaration *Parser_declaration(Parser *parser, bool can_be_static);
-Node *Parser_statement(Parser *parser);
-Node *Parser_topLevel(Parser *parser);
-Node *Parser_parse(Parser *parser);
+NodeIndex Parser_statement(Parser *parser);
+NodeIndex Parser_topLevel(Parser *parser);
+NodeIndex Parser_parse(Parser *parser);
 
 #endif // PARSER_H
@@ -1,4 +1,5 @@
 #include "reserved.h"
+#include "token.h"
 
 const char * const KEYWORDS[] = {
     "if", "while", "do", "for", "switch", "case",
@@ -32,3 +33,85 @@ const u64 TYPES_count = sizeof(TYPES) / sizeof(char *);
 const u64 MODIFIERS_count = sizeof(MODIFIERS) / sizeof(char *);
 const u64 MULTI_OPS_count = sizeof(MULTI_OPS) / sizeof(char *);
 
+// NOTE(mdizdar): every word in KEYWORDS, TYPES and MODIFIERS sits in its own slot under Reserved_hash,
+// so the lexer needs exactly one comparison to tell a reserved word from an identifier.
+// If you add a reserved word, pick new multipliers so there are no collisions and regenerate this table,
+// Reserved_check says so if it doesn't line up with the word lists and the token numbers anymore.
+const ReservedWord RESERVED_WORDS[RESERVED_WORDS_SIZE] = {
+    [  1] = {"_Decimal128",    11, TOKEN_DECIMAL128},
+    [  6] = {"_Alignas",        8, TOKEN_ALIGNAS},
+    [  7] = {"switch",          6, TOKEN_SWITCH},
+    [  8] = {"default",         7, TOKEN_DEFAULT},
+    [  9] = {"float",           5, TOKEN_FLOAT},
+    [ 11] = {"void",            4, TOKEN_VOID},
+    [ 13] = {"_Bool",           5, TOKEN_BOOL},
+    [ 16] = {"volatile",        8, TOKEN_VOLATILE},
+    [ 19] = {"short",           5, TOKEN_SHORT},
+    [ 21] = {"signed",          6, TOKEN_SIGNED},
+    [ 22] = {"_Imaginary",     10, TOKEN_IMAGINARY},
+    [ 23] = {"sizeof",          6, TOKEN_SIZEOF},
+    [ 28] = {"while",           5, TOKEN_WHILE},
+    [ 29] = {"enum",            4, TOKEN_ENUM},
+    [ 30] = {"continue",        8, TOKEN_CONTINUE},
+    [ 34] = {"double",          6, TOKEN_DOUBLE},
+    [ 36] = {"if",              2, TOKEN_IF},
+    [ 40] = {"do",              2, TOKEN_DO},
+    [ 42] = {"const",           5, TOKEN_CONST},
+    [ 44] = {"case",            4, TOKEN_CASE},
+    [ 45] = {"_Complex",        8, TOKEN_COMPLEX},
+    [ 46] = {"typedef",         7, TOKEN_TYPEDEF},
+    [ 47] = {"inline",          6, TOKEN_INLINE},
+    [ 48] = {"char",            4, TOKEN_CHAR},
+    [ 56] = {"for",             3, TOKEN_FOR},
+    [ 59] = {"int",             3, TOKEN_INT},
+    [ 60] = {"goto",            4, TOKEN_GOTO},
+    [ 63] = {"_Static_assert", 14, TOKEN_STATIC_ASSERT},
+    [ 71] = {"_Thread_local",  13, TOKEN_THREAD_LOCAL},
+    [ 74] = {"extern",          6, TOKEN_EXTERN},
+    [ 78] = {"break",           5, TOKEN_BREAK},
+    [ 79] = {"static",          6, TOKEN_STATIC},
+    [ 82] = {"long",            4, TOKEN_LONG},
+    [ 85] = {"return",          6, TOKEN_RETURN},
+    [ 91] = {"register",        8, TOKEN_REGISTER},
+    [ 92] = {"_Generic",        8, TOKEN_GENERIC},
+    [ 93] = {"restrict",        8, TOKEN_RESTRICT},
+    [ 95] = {"_Noreturn",       9, TOKEN_NORETURN},
+    [ 96] = {"struct",          6, TOKEN_STRUCT},
+    [115] = {"else",            4, TOKEN_ELSE},
+    [117] = {"_Atomic",         7, TOKEN_ATOMIC},
+    [120] = {"unsigned",        8, TOKEN_UNSIGNED},
+    [121] = {"_Alignof",        8, TOKEN_ALIGNOF},
+    [122] = {"_Decimal32",     10, TOKEN_DECIMAL32},
+    [124] = {"_Decimal64",     10, TOKEN_DECOMAL64},
+    [126] = {"auto",            4, TOKEN_AUTO},
+    [127] = {"union",           5, TOKEN_UNION},
+};
+
+u64 Reserved_hash(const char *name, u64 count) {
+    // NOTE(mdizdar): only valid for RESERVED_MIN_LENGTH <= count <= RESERVED_MAX_LENGTH
+    return ((u8)name[0]*6 + (u8)name[1]*17 + (u8)name[count-1] + count) & (RESERVED_WORDS_SIZE-1);
+}
+
+// NOTE(mdizdar): every reserved word has to land in a slot of its own that gives back its own token, which is
+// TOKEN_KEYWORD, TOKEN_TYPE or TOKEN_MODIFIER plus where it is in its list
+void Reserved_check(void) {
+    const char * const *lists[] = { KEYWORDS, TYPES, MODIFIERS };
+    const u64 counts[] = { KEYWORDS_count, TYPES_count, MODIFIERS_count };
+    const u16 first[] = { TOKEN_KEYWORD, TOKEN_TYPE, TOKEN_MODIFIER };
+    u64 used = 0;
+    for (u64 l = 0; l < 3; ++l) {
+        for (u64 i = 0; i < counts[l]; ++i) {
+            const char *name = lists[l][i];
+            const u64 count = strlen(name);
+            assert(count >= RESERVED_MIN_LENGTH && count <= RESERVED_MAX_LENGTH);
+            const ReservedWord *word = &RESERVED_WORDS[Reserved_hash(name, count)];
+            assert(word->count == count && !strcmp(word->name, name));
+            assert(word->token_type == first[l] + i + 1);
+            ++used;
+        }
+    }
+    for (u64 h = 0; h < RESERVED_WORDS_SIZE; ++h) {
+        if (RESERVED_WORDS[h].token_type) --used;
+    }
+    assert(used == 0);
+}
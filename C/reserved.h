@@ -15,4 +15,19 @@ extern const u64 TYPES_count;
 extern const u64 MODIFIERS_count;
 extern const u64 MULTI_OPS_count;
 
+#define RESERVED_WORDS_SIZE 128
+#define RESERVED_MIN_LENGTH 2
+#define RESERVED_MAX_LENGTH 14
+
+typedef struct ReservedWord {
+    const char *name;
+    u64 count;
+    u16 token_type; // 0 for empty slots
+} ReservedWord;
+
+extern const ReservedWord RESERVED_WORDS[RESERVED_WORDS_SIZE];
+
+u64 Reserved_hash(const char *name, u64 count);
+void Reserved_check(void);
+
 #endif //RESERVED_H
@@ -1,16 +1,20 @@
 #include "scope.h"
 
-_generate_hash_map_source(String, SymbolTableEntry);
-
 STRUCT_SOURCE(Scope);
 
 void Scope_init(Scope *scope) {
     scope->previous = NULL;
-    StringSymbolTableEntryHashMap_construct(&scope->hash_table);
+    SymbolTableEntryPtrArray_construct(&scope->entries);
 }
 
+// NOTE(mdizdar): scopes rarely hold more than a handful of names and this is only used after parsing, so no table
 SymbolTableEntry *Scope_shallow_find(const Scope *scope, const String *name) {
-    return StringSymbolTableEntryHashMap_get(&scope->hash_table, name);
+    for (ARRAY_EACH(SymbolTableEntryPtr, entry, &scope->entries)) {
+        if (String_eq(&(*entry)->name, name)) {
+            return *entry;
+        }
+    }
+    return NULL;
 }
 
 SymbolTableEntry *Scope_find(const Scope *scope, const String *name) {
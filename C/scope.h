@@ -4,12 +4,13 @@
 #include "../utils/common.h"
 #include "symbol_table_entry.h"
 
-_generate_hash_map_header(String, SymbolTableEntry);
-
+// NOTE(mdizdar): while parsing, names are looked up through SymbolTable, which only keeps the innermost
+// visible entry for each name. A scope just remembers what was declared directly in it, so that the
+// SymbolTable can undo it on pop, and so the AST can still resolve names in it after parsing is done
 STRUCT_HEADER(Scope, {
     struct Scope *previous;
     
-    StringSymbolTableEntryHashMap hash_table;
+    SymbolTableEntryPtrArray entries;
 });
 
 void Scope_init(Scope *scope);
@@ -2,6 +2,12 @@
 
 STRUCT_SOURCE(SymbolTable);
 
+void SymbolTableEntryPtr_copy(SymbolTableEntryPtr *dest, const SymbolTableEntryPtr *src) {
+    *dest = *src;
+}
+
+_generate_hash_map_source(String, SymbolTableEntryPtr);
+
 void SymbolTable_pushScope(SymbolTable *st) {
     Scope *new_scope = Arena_alloc(st->scopes_arena, sizeof(Scope));
     Scope_init(new_scope);
@@ -11,6 +17,9 @@ void SymbolTable_pushScope(SymbolTable *st) {
 
 void SymbolTable_popScope(SymbolTable *st) {
     // NOTE(mdizdar): we don't want to delete the reference to the scope because the data is used in other parts, such as the Declaration struct
+    for (ARRAY_EACH(SymbolTableEntryPtr, it, &st->scope->entries)) {
+        *StringSymbolTableEntryPtrHashMap_get(&st->visible, &(*it)->name) = (*it)->shadowed;
+    }
     st->scope = st->scope->previous;
 }
 
@@ -18,25 +27,50 @@ void SymbolTable_init(SymbolTable *st) {
     st->scopes_arena = Arena_init(4096);
     st->scope = Arena_alloc(st->scopes_arena, sizeof(Scope));
     Scope_init(st->scope);
+    StringSymbolTableEntryPtrHashMap_construct(&st->visible);
 }
 
 void SymbolTable_add(SymbolTable *st, const String *name, Type *type, u64 definition_line, u64 definition_column) {
-    SymbolTableEntry ste = {
+    SymbolTableEntryPtr *visible = StringSymbolTableEntryPtrHashMap_get(&st->visible, name);
+    SymbolTableEntry *shadowed = visible ? *visible : NULL;
+    if (shadowed != NULL && shadowed->scope == st->scope) {
+        // NOTE(mdizdar): already declared in this scope, the parser reports that before it gets here
+        return;
+    }
+    
+    SymbolTableEntry *entry = Arena_alloc(st->scopes_arena, sizeof(SymbolTableEntry));
+    *entry = (SymbolTableEntry){
         .type = type,
         .definition_line = definition_line,
-        .definition_column = definition_column
+        .definition_column = definition_column,
+        .scope = st->scope,
+        .shadowed = shadowed
     };
-    String_construct(&ste.name);
-    String_copy(&ste.name, name);
-    StringSymbolTableEntryHashMap_add(&st->scope->hash_table, name, &ste);
+    String_copy(&entry->name, name);
+    SymbolTableEntryPtrArray_push_back(&st->scope->entries, entry);
+    
+    if (visible != NULL) {
+        *visible = entry;
+    } else {
+        StringSymbolTableEntryPtrHashMap_add(&st->visible, name, &entry);
+    }
+}
+
+static bool SymbolTable_declared_after(const SymbolTableEntry *entry, u64 line, u64 col) {
+    return entry->definition_line > line || (entry->definition_line == line && entry->definition_column > col);
 }
 
 SymbolTableEntry *SymbolTable_find(const SymbolTable *st, const String *name) {
-    return Scope_find(st->scope, name);
+    SymbolTableEntryPtr *visible = StringSymbolTableEntryPtrHashMap_get(&st->visible, name);
+    return visible ? *visible : NULL;
 }
 
 SymbolTableEntry *SymbolTable_shallow_find(const SymbolTable *st, const String *name) {
-    return Scope_shallow_find(st->scope, name);
+    SymbolTableEntry *entry = SymbolTable_find(st, name);
+    if (entry == NULL || entry->scope != st->scope) {
+        return NULL;
+    }
+    return entry;
 }
 
 SymbolTableEntry *SymbolTable_find_cstr(SymbolTable *st, char *name) {
@@ -50,11 +84,20 @@ SymbolTableEntry *SymbolTable_shallow_find_cstr(const SymbolTable *st, char *nam
 }
 
 SymbolTableEntry *SymbolTable_shallow_find_before(const SymbolTable *st, const String *name, u64 line, u64 col) {
-    return Scope_shallow_find_before(st->scope, name, line, col);
+    SymbolTableEntry *entry = SymbolTable_shallow_find(st, name);
+    if (entry == NULL || SymbolTable_declared_after(entry, line, col)) {
+        return NULL;
+    }
+    return entry;
 }
 
 SymbolTableEntry *SymbolTable_find_before(const SymbolTable *st, const String *name, u64 line, u64 col) {
-    return Scope_find_before(st->scope, name, line, col);
+    SymbolTableEntry *entry = SymbolTable_find(st, name);
+    // NOTE(mdizdar): only the current scope is checked against the position, same as Scope_find_before
+    if (entry != NULL && entry->scope == st->scope && SymbolTable_declared_after(entry, line, col)) {
+        return entry->shadowed;
+    }
+    return entry;
 }
 
 SymbolTableEntry *SymbolTable_shallow_find_before_cstr(const SymbolTable *st, char *name, u64 line, u64 col) {
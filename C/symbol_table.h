@@ -10,9 +10,14 @@
 #include "arena.h"
 #include "scope.h"
 
+_generate_hash_map_header(String, SymbolTableEntryPtr);
+
 STRUCT_HEADER(SymbolTable, {
-    Arena *scopes_arena;
+    Arena *scopes_arena; // NOTE(mdizdar): the entries live here too, everything else holds pointers to them
     Scope *scope;
+    
+    // the innermost visible entry for every name, the ones it hides are reachable through ->shadowed
+    StringSymbolTableEntryPtrHashMap visible;
 });
 
 void SymbolTable_pushScope(SymbolTable *st);
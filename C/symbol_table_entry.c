@@ -4,8 +4,8 @@ STRUCT_SOURCE(SymbolTableEntry);
 
 char *SymbolTableEntry_toStr(char *s, const SymbolTableEntry *entry) {
     char ts[256];
-    sprintf(s, "name: %s; type: %s; line: %lu; col: %lu; typename?: %u", 
-            entry->name.data, Type_toStr(ts, entry->type, false, 0), entry->definition_line, entry->definition_column, entry->is_typename);
+    sprintf(s, "name: %.*s; type: %s; line: %lu; col: %lu; typename?: %u", 
+            (int)entry->name.count, entry->name.data, Type_toStr(ts, entry->type, false, 0), entry->definition_line, entry->definition_column, entry->is_typename);
     return s;
 }
 
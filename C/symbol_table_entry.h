@@ -7,6 +7,7 @@
 
 struct SymbolTableEntry;
 typedef struct SymbolTableEntry SymbolTableEntry;
+struct Scope;
 
 #include "type.h"
 
@@ -15,11 +16,13 @@ STRUCT_HEADER(SymbolTableEntry, {
     Type *type;
     u64 definition_line;
     u64 definition_column;
-    LineTemporaryIDArray all_temp_ids; // indexed by line number in IR
     TemporaryID temporary_id; // NOTE(mdizdar): this is used in IR generation to keep track
     Address location_in_memory;
 
     bool is_typename;
+    
+    const struct Scope *scope; // the one it was declared in
+    SymbolTableEntry *shadowed; // same name, declared in an enclosing scope, NULL if there isn't one
 });
 
 char *SymbolTableEntry_toStr(char *s, const SymbolTableEntry *entry);
@@ -44,7 +44,7 @@ char *Token_toStr_long(char *s, Token t) {
                 break;
             }
             case TOKEN_IDENT: {
-                sprintf(s, "Token: { type: identifier (%d); name: \"%s\" }", t.type, t.name.data);
+                sprintf(s, "Token: { type: identifier (%d); name: \"%.*s\" }", t.type, (int)t.name.count, t.name.data);
                 break;
             }
             case TOKEN_FUNCTION_CALL: {
@@ -109,7 +109,7 @@ char *Token_toStr(char *s, Token t) {
                 break;
             }
             case TOKEN_IDENT: {
-                sprintf(s, "ident %s (%d)", t.entry->name.data, t.type);
+                sprintf(s, "ident %.*s (%d)", (int)t.entry->name.count, t.entry->name.data, t.type);
                 break;
             }
             case TOKEN_FUNCTION_CALL: {
@@ -155,7 +155,7 @@ char *Token_toStr(char *s, Token t) {
             case TOKEN_DECLARATION: {
                 SymbolTableEntry *entry = t.entry;
                 assert(entry);
-                sprintf(s, "decl %s (%d)", entry->name.data, t.type);
+                sprintf(s, "decl %.*s (%d)", (int)entry->name.count, entry->name.data, t.type);
                 break;
             }
             case TOKEN_ERROR: {
@@ -122,7 +122,6 @@ STRUCT_HEADER(Token, {
         String string_value;
     };
     
-    u64 lookahead;
     u64 line;
     u64 col;
     
@@ -5,7 +5,7 @@ STRUCT_SOURCE(Type);
 #define internal_error internal_error(__FILE__, __LINE__)
 
 // NOTE(mdizdar): in a real compiler this should depend on the target machine, but since we're targetting exactly one machine... 
-u64 Type_sizeof(Type *type) {
+static u64 Type_computeSizeof(Type *type) {
     if (type->pointer_count) {
         return 2;
     } else if (type->is_struct) {
@@ -19,7 +19,7 @@ u64 Type_sizeof(Type *type) {
     } else if (type->is_union) {
         u64 size = 0;
         for (u64 i = 0; i < type->struct_type->members.count; ++i) {
-            max(size, Type_sizeof(((Declaration *)type->struct_type->members.data)[i].type));
+            size = max(size, Type_sizeof(((Declaration *)type->struct_type->members.data)[i].type));
         }
         return size;
     } else if (type->is_typedef) {
@@ -49,6 +49,41 @@ u64 Type_sizeof(Type *type) {
     }
 }
 
+// NOTE(mdizdar): the AVR doesn't care about alignment at all, this is just what the struct layout above pretends
+static u64 Type_computeAlignof(Type *type) {
+    if (type->pointer_count) {
+        return 2;
+    } else if (type->is_struct || type->is_union) {
+        u64 align = 1;
+        for (u64 i = 0; i < type->struct_type->members.count; ++i) {
+            align = max(align, Type_alignof(((Declaration *)type->struct_type->members.data)[i].type));
+        }
+        return align;
+    } else if (type->is_typedef) {
+        return Type_alignof(type->typedef_type);
+    } else if (type->is_array) {
+        return Type_alignof(type->array_type->element);
+    } else if (type->is_function) {
+        // should never happen
+        internal_error;
+    }
+    return min(Type_sizeof(type), 8);
+}
+
+u64 Type_sizeof(Type *type) {
+    if (type->size_of) return type->size_of;
+    u64 size = Type_computeSizeof(type);
+    if (type->is_interned) type->size_of = (u32)size;
+    return size;
+}
+
+u64 Type_alignof(Type *type) {
+    if (type->align_of) return type->align_of;
+    u64 align = Type_computeAlignof(type);
+    if (type->is_interned) type->align_of = (u32)align;
+    return align;
+}
+
 char *Type_toStr(char *s, const Type *type, bool in_line, u64 indent) {
     (void)in_line;
     (void)indent;
@@ -83,9 +118,9 @@ char *Type_toStr(char *s, const Type *type, bool in_line, u64 indent) {
 void Type_print(Type *type, u64 indent) {
     for (u64 i = 0; i < indent; ++i) putchar(' ');
     if (type->is_static) printf("static ");
-    if (Bitset_isSet(type->is_const, 0)) printf("const ");
-    if (Bitset_isSet(type->is_volatile, 0)) printf("volatile ");
-    if (Bitset_isSet(type->is_restrict, 0)) printf("restrict ");
+    if (type->is_const & TYPE_QUALIFIER(0)) printf("const ");
+    if (type->is_volatile & TYPE_QUALIFIER(0)) printf("volatile ");
+    if (type->is_restrict & TYPE_QUALIFIER(0)) printf("restrict ");
     if (type->is_struct) {
         printf("struct { [%lu] \n", type->struct_type->members.count);
         for (u64 i = 0; i < type->struct_type->members.count; ++i) {
@@ -128,34 +163,115 @@ void Type_print(Type *type, u64 indent) {
     
     for (u64 i = 1; i <= type->pointer_count; ++i) {
         printf("* ");
-        if (Bitset_isSet(type->is_const, i)) printf("const ");
-        if (Bitset_isSet(type->is_volatile, i)) printf("volatile ");
-        if (Bitset_isSet(type->is_restrict, i)) printf("restrict ");
+        if (type->is_const & TYPE_QUALIFIER(i)) printf("const ");
+        if (type->is_volatile & TYPE_QUALIFIER(i)) printf("volatile ");
+        if (type->is_restrict & TYPE_QUALIFIER(i)) printf("restrict ");
     }
     puts("");
 }
 
-//~ some globals to keep the cost of type-making lower
+//~ the interner
 
-// TODO(mdizdar): these should be set in main (because MSVC doesn't have struct literals, since it's 1993) so these common types can be reused
-// NOTE(mdizdar); if these are ever going to become a thing, they'll need to be declared extern in any file that uses them and they'll need to be consts
-/*
-Type *TYPE_VOID;
-Type *TYPE_CHAR;
+// NOTE(mdizdar): only what makes two types different goes into the hash and the comparison, the cached sizes don't
+static u64 Type_payload(const Type *type) {
+    if (type->is_struct)   return (u64)(uintptr_t)type->struct_type;
+    if (type->is_union)    return (u64)(uintptr_t)type->union_type;
+    if (type->is_typedef)  return (u64)(uintptr_t)type->typedef_type;
+    if (type->is_array)    return (u64)(uintptr_t)type->array_type;
+    if (type->is_function) return (u64)(uintptr_t)type->function_type;
+    return type->basic_type;
+}
 
-Type *TYPE_SCHAR;
-Type *TYPE_SSHORT;
-Type *TYPE_SINT;
-Type *TYPE_SLONG;
-Type *TYPE_SLLONG;
+static u64 Type_flags(const Type *type) {
+    return (u64)!!type->is_static        |
+        (u64)!!type->is_struct   << 1 |
+        (u64)!!type->is_union    << 2 |
+        (u64)!!type->is_typedef  << 3 |
+        (u64)!!type->is_array    << 4 |
+        (u64)!!type->is_function << 5;
+}
 
-Type *TYPE_FLOAT;
-Type *TYPE_DOUBLE;
-Type *TYPE_LDOUBLE;
+u64 Type_hash(const Type *type) {
+    u64 key = Type_payload(type);
+    u64 hash = u64_hash(&key);
+    key = hash ^ (type->pointer_count | Type_flags(type) << 32);
+    hash = u64_hash(&key);
+    key = hash ^ type->is_const ^ (type->is_volatile << 21) ^ (type->is_restrict << 42);
+    return u64_hash(&key);
+}
 
-Type *TYPE_UCHAR;
-Type *TYPE_USHORT;
-Type *TYPE_UINT;
-Type *TYPE_ULONG;
-Type *TYPE_ULLONG;
-*/
+bool Type_eq(const Type *a, const Type *b) {
+    return Type_payload(a) == Type_payload(b) &&
+        Type_flags(a) == Type_flags(b) &&
+        a->pointer_count == b->pointer_count &&
+        a->is_const == b->is_const &&
+        a->is_volatile == b->is_volatile &&
+        a->is_restrict == b->is_restrict;
+}
+
+void Type_copy(Type *dest, const Type *src) {
+    *dest = *src;
+}
+
+void TypePtr_copy(TypePtr *dest, const TypePtr *src) {
+    *dest = *src;
+}
+
+_generate_hash_map(Type, TypePtr);
+
+static Arena *type_arena;
+static TypeTypePtrHashMap interned_types;
+// NOTE(mdizdar): the type checker makes these for every literal and comparison, so they skip the hash map
+static Type *basic_types[BASIC_ULLONG+1];
+
+void Type_initInterner(Arena *arena) {
+    type_arena = arena;
+    TypeTypePtrHashMap_construct(&interned_types);
+    memset(basic_types, 0, sizeof(basic_types));
+}
+
+void Type_freeInterner(void) {
+    TypeTypePtrHashMap_destruct(&interned_types);
+    memset(basic_types, 0, sizeof(basic_types));
+    type_arena = NULL;
+}
+
+Type *Type_intern(const Type *type) {
+    TypePtr *found = TypeTypePtrHashMap_get(&interned_types, type);
+    if (found) return *found;
+    
+    Type *interned = Arena_alloc(type_arena, sizeof(Type));
+    *interned = *type;
+    interned->size_of = 0;
+    interned->align_of = 0;
+    interned->is_interned = true;
+    TypeTypePtrHashMap_add(&interned_types, interned, &interned);
+    return interned;
+}
+
+Type *Type_basic(BasicType basic_type) {
+    if (!basic_types[basic_type]) {
+        basic_types[basic_type] = Type_intern(&(Type){ .basic_type = basic_type });
+    }
+    return basic_types[basic_type];
+}
+
+Type *Type_pointerTo(const Type *type) {
+    Type pointer = *type;
+    if (pointer.pointer_count == TYPE_MAX_POINTERS) {
+        error(0, "Error: more than %d levels of pointers, what are you doing", TYPE_MAX_POINTERS);
+    }
+    ++pointer.pointer_count;
+    return Type_intern(&pointer);
+}
+
+Type *Type_pointee(const Type *type) {
+    assert(type->pointer_count);
+    Type pointee = *type;
+    // NOTE(mdizdar): the qualifiers of the pointer we're stripping off go with it
+    pointee.is_const    &= TYPE_QUALIFIER(pointee.pointer_count) - 1;
+    pointee.is_volatile &= TYPE_QUALIFIER(pointee.pointer_count) - 1;
+    pointee.is_restrict &= TYPE_QUALIFIER(pointee.pointer_count) - 1;
+    --pointee.pointer_count;
+    return Type_intern(&pointee);
+}
@@ -43,22 +43,43 @@ STRUCT_HEADER(Type, {
         BasicType basic_type;
     };
     
-    Bitset is_const;
-    Bitset is_volatile;
-    Bitset is_restrict;
+    // NOTE(mdizdar): bit i is set if pointer level i is qualified, level 0 being the base type itself
+    u64 is_const;
+    u64 is_volatile;
+    u64 is_restrict;
     
     u64 pointer_count;
     
+    // NOTE(mdizdar): these are filled in by Type_sizeof/Type_alignof the first time they're asked,
+    // but only on interned types, everything else can still change under our feet
+    u32 size_of;
+    u32 align_of;
+    
     int is_static:1;
     int is_struct:1;
     int is_union:1;
     int is_typedef:1;
     int is_array:1;
     int is_function:1;
+    int is_interned:1;
 });
 
+#define TYPE_MAX_POINTERS 63
+#define TYPE_QUALIFIER(level) (1ull << (level))
+
 u64 Type_sizeof(Type *type);
+u64 Type_alignof(Type *type);
 char *Type_toStr(char *s, const Type *type, bool in_line, u64 indent);
 void Type_print(Type *type, u64 indent);
 
+// NOTE(mdizdar): every distinct type exists exactly once in the arena given to Type_initInterner, so two interned
+// types are the same iff they're the same pointer. Structs, unions and functions are told apart by their
+// struct_type/union_type/function_type pointer and not by what's in them, same as C does it
+void Type_initInterner(Arena *arena);
+void Type_freeInterner(void);
+Type *Type_intern(const Type *type);
+Type *Type_basic(BasicType basic_type);
+Type *Type_pointerTo(const Type *type);
+Type *Type_pointee(const Type *type);
+
 #endif //TYPE_H
@@ -31,12 +31,10 @@ bool is_void_pointer(Type *type) {
     return type->basic_type == BASIC_VOID && pointer;
 }
 
-void do_deref(Type *type) {
-    if (type->pointer_count) {
-        --type->pointer_count;
-        return;
-    }
-    if (type->is_typedef) do_deref(type->typedef_type);
+Type *deref(Type *type) {
+    if (type->pointer_count) return Type_pointee(type);
+    if (type->is_typedef) return deref(type->typedef_type);
+    return type;
 }
 
 bool is_array(Type *type) {
@@ -70,12 +68,7 @@ bool is_union(Type *type) {
 Type *get_base_type(Type *type) {
     // TODO(mdizdar): uncomment this
     //if (type->pointer_count) warning(0, "not sure if I should be letting it slide that this is a pointer tbh");
-    if (type->pointer_count) {
-	Type *tmp = malloc(sizeof(Type));
-	*tmp = *type;
-	--tmp->pointer_count;
-	return tmp;
-    }
+    if (type->pointer_count) return Type_pointee(type);
     if (type->is_typedef) return get_base_type(type->typedef_type);
     return type;
 }
@@ -96,11 +89,11 @@ bool is_integer(Type *type) {
 }
 
 bool is_lvalue(Node *node) { // NOTE(mdizdar): should be good?
-    if (node->token->type == '[') return true;
-    if (node->token->type == '.') return true;
-    if (node->token->type == TOKEN_DEREF) return true;
-    if (node->token->type == TOKEN_ARROW) return true;
-    if (node->token->type == TOKEN_IDENT) return true;
+    if (node->token.type == '[') return true;
+    if (node->token.type == '.') return true;
+    if (node->token.type == TOKEN_DEREF) return true;
+    if (node->token.type == TOKEN_ARROW) return true;
+    if (node->token.type == TOKEN_IDENT) return true;
     
     Type *type = node->type;
     while (!type->pointer_count && type->is_typedef) {
@@ -178,16 +171,7 @@ Type *coerce(Type *t1, Type *t2) {
     
     if (p1 && p2) {
         if (!types_are_equal_or_coercible(b1, b2)) {
-            Type *ret = malloc(sizeof(Type));
-            ret->is_static   = false;
-            ret->is_struct   = false;
-            ret->is_union    = false;
-            ret->is_typedef  = false;
-            ret->is_array    = false;
-            ret->is_function = false;
-            ret->basic_type  = BASIC_VOID;
-            ++ret->pointer_count;
-            return ret;
+            return Type_pointerTo(Type_basic(BASIC_VOID));
         }
         return t1;
     }
@@ -217,34 +201,21 @@ Type *coerce(Type *t1, Type *t2) {
     u64 s1 = Type_sizeof(b1);
     u64 s2 = Type_sizeof(b2);
     
-#define RETURN_INT \
-Type *ret = malloc(sizeof(Type)); \
-ret->is_static   = false;         \
-ret->is_struct   = false;         \
-ret->is_union    = false;         \
-ret->is_typedef  = false;         \
-ret->is_array    = false;         \
-ret->is_function = false;         \
-ret->pointer_count = 0;           \
-ret->basic_type  = BASIC_SINT;    \
-return ret;
-    
     if (s1 > s2) {
         if (s1 < 2) {
-            RETURN_INT;
+            return Type_basic(BASIC_SINT);
         }
         return t1;
     }
     if (s2 > s1) {
         if (s2 < 2) {
-            RETURN_INT;
+            return Type_basic(BASIC_SINT);
         }
         return t2;
     }
     if (s1 < 2) {
-        RETURN_INT;
+        return Type_basic(BASIC_SINT);
     }
-#undef RETURN_INT
     // they're the same size, so if one is unsigned, I should return that one
     if (b1->basic_type > b2->basic_type) return t1;
     return t2;
@@ -254,24 +225,24 @@ u64 type_check(Node *AST, Type *return_type);
 
 void type_check_params(Node *AST, Declaration *params, u64 param_count) {
     if (param_count == 1) {
-        if (AST->token->type == ',') {
-            error(AST->token->line, "too many arguments in function call");
+        if (AST->token.type == ',') {
+            error(AST->token.line, "too many arguments in function call");
         }
         type_check(AST, NULL);
         if (!types_are_equal_or_coercible(params[0].type, type_of(AST))) {
-            error(AST->token->line, "type of parameter %llu doesn't match expected type", param_count);
+            error(AST->token.line, "type of parameter %llu doesn't match expected type", param_count);
         }
         return;
     }
-    if (AST->token->type != ',') {
-        error(AST->token->line, "too few arguments in function call");
+    if (AST->token.type != ',') {
+        error(AST->token.line, "too few arguments in function call");
     }
     // NOTE(mdizdar): return_type can be NULL because it doesn't matter here
-    type_check(AST->right, NULL);
-    if (!types_are_equal_or_coercible(params[--param_count].type, type_of(AST->right))) {
-        error(AST->right->token->line, "type of parameter %llu doesn't match expected type", param_count);
+    type_check(Node_at(AST->right), NULL);
+    if (!types_are_equal_or_coercible(params[--param_count].type, type_of(Node_at(AST->right)))) {
+        error(Node_at(AST->right)->token.line, "type of parameter %llu doesn't match expected type", param_count);
     }
-    type_check_params(AST->left, params, param_count);
+    type_check_params(Node_at(AST->left), params, param_count);
 }
 
 // NOTE(mdizdar): there are still tokens that I didn't cover because I can't be bothered
@@ -282,123 +253,121 @@ u64 type_check(Node *AST, Type *return_type) {
     }
     u64 size_of = 0;
     AST->type = NULL;
-    switch ((int)AST->token->type) {
+    switch ((int)AST->token.type) {
         case TOKEN_IDENT: {
-            SymbolTableEntry *entry = AST->token->entry;
+            SymbolTableEntry *entry = AST->token.entry;
             assert(entry != NULL);
             AST->type = entry->type;
             break;
         }
-#define MAKE_BASIC(x, y) \
-x = malloc(sizeof(Type));       \
-x->is_static   = false;         \
-x->is_struct   = false;         \
-x->is_union    = false;         \
-x->is_typedef  = false;         \
-x->is_array    = false;         \
-x->is_function = false;         \
-x->pointer_count = 0;           \
-x->basic_type  = y;
         case TOKEN_CHAR_LITERAL: {
-            MAKE_BASIC(AST->type, BASIC_CHAR);
+            AST->type = Type_basic(BASIC_CHAR);
             break;
         }
         case TOKEN_INT_LITERAL: {
-            MAKE_BASIC(AST->type, BASIC_SINT);
+            // NOTE(mdizdar): a constant without a suffix is the first of int, long and long long that it fits in. The
+            // lexer doesn't remember the base, so hex and octal ones don't get the unsigned types C would give them
+            const u64 value = AST->token.integer_value;
+            if (value <= 0x7FFF) {
+                AST->type = Type_basic(BASIC_SINT);
+            } else if (value <= 0x7FFFFFFF) {
+                AST->type = Type_basic(BASIC_SLONG);
+            } else {
+                AST->type = Type_basic(value <= INT64_MAX ? BASIC_SLLONG : BASIC_ULLONG);
+            }
             break;
         }
         case TOKEN_LONG_LITERAL: {
-            MAKE_BASIC(AST->type, BASIC_SLONG);
+            AST->type = Type_basic(BASIC_SLONG);
             break;
         }
         case TOKEN_LLONG_LITERAL: {
-            MAKE_BASIC(AST->type, BASIC_SLLONG);
+            AST->type = Type_basic(BASIC_SLLONG);
             break;
         }
         case TOKEN_FLOAT_LITERAL: {
-            MAKE_BASIC(AST->type, BASIC_FLOAT);
+            AST->type = Type_basic(BASIC_FLOAT);
             break;
         }
         case TOKEN_DOUBLE_LITERAL: {
-            MAKE_BASIC(AST->type, BASIC_DOUBLE);
+            AST->type = Type_basic(BASIC_DOUBLE);
             break;
         }
         case TOKEN_STRING_LITERAL: {
-            MAKE_BASIC(AST->type, BASIC_CHAR);
-            ++AST->type->pointer_count; // I think this is stupid but hmm
+            AST->type = Type_pointerTo(Type_basic(BASIC_CHAR)); // I think this is stupid but hmm
             break;
         }
 #undef MAKE_BASIC
         case TOKEN_DECLARATION: {
-            SymbolTableEntry *entry = AST->token->entry;
+            SymbolTableEntry *entry = AST->token.entry;
             assert(entry != NULL);
             if (entry->type->is_function) {
-                entry->type->function_type->size_of = type_check(entry->type->function_type->block, entry->type->function_type->return_type);
+                entry->type->function_type->size_of = type_check(Node_at(entry->type->function_type->block), entry->type->function_type->return_type);
             } else {
                 size_of = Type_sizeof(entry->type);
             }
             break;
         }
         case TOKEN_IF: {
-            type_check(AST->cond, return_type);
-            if (!is_scalar(type_of(AST->cond))) {
-                error(AST->cond->token->line, "conditions should be of a scalar type");
+            type_check(Node_at(AST->cond), return_type);
+            if (!is_scalar(type_of(Node_at(AST->cond)))) {
+                error(Node_at(AST->cond)->token.line, "conditions should be of a scalar type");
             }
-            size_of += type_check(AST->left, return_type);
-            if (AST->right) {
-                size_of += type_check(AST->right, return_type);
+            size_of += type_check(Node_at(AST->left), return_type);
+            if (Node_at(AST->right)) {
+                size_of += type_check(Node_at(AST->right), return_type);
             }
             break;
         }
         case TOKEN_WHILE: {
-            type_check(AST->cond, return_type);
-            if (!is_scalar(type_of(AST->cond))) {
-                error(AST->cond->token->line, "conditions should be of a scalar type");
+            type_check(Node_at(AST->cond), return_type);
+            if (!is_scalar(type_of(Node_at(AST->cond)))) {
+                error(Node_at(AST->cond)->token.line, "conditions should be of a scalar type");
             }
-            size_of += type_check(AST->left, return_type);
+            size_of += type_check(Node_at(AST->left), return_type);
             break;
         }
         case TOKEN_FOR: {
-            Node *init_cond_iter = AST->cond;
-            size_of += type_check(init_cond_iter->left, return_type);
-            type_check(init_cond_iter->cond, return_type);
-            type_check(init_cond_iter->right, return_type);
-            if (!is_scalar(type_of(init_cond_iter->cond))) {
-                error(AST->cond->token->line, "conditions should be of a scalar type");
+            Node *init_cond_iter = Node_at(AST->cond);
+            size_of += type_check(Node_at(init_cond_iter->left), return_type);
+            type_check(Node_at(init_cond_iter->cond), return_type);
+            type_check(Node_at(init_cond_iter->right), return_type);
+            if (!is_scalar(type_of(Node_at(init_cond_iter->cond)))) {
+                error(Node_at(AST->cond)->token.line, "conditions should be of a scalar type");
             }
-            size_of += type_check(AST->left, return_type);
+            size_of += type_check(Node_at(AST->left), return_type);
             break;
         }
         case TOKEN_RETURN: {
-            if (AST->left == NULL) {
+            if (Node_at(AST->left) == NULL) {
                 if (!is_void(return_type)) {
-                    error(AST->token->line, "a return statement in a function with a return type needs to have an argument");
+                    error(AST->token.line, "a return statement in a function with a return type needs to have an argument");
                 }
             } else {
-                type_check(AST->left, return_type);
-                if (!types_are_equal_or_coercible(return_type, type_of(AST->left))) {
-                    error(AST->token->line, "return type and returned type not equal or coercible");
+                type_check(Node_at(AST->left), return_type);
+                if (!types_are_equal_or_coercible(return_type, type_of(Node_at(AST->left)))) {
+                    error(AST->token.line, "return type and returned type not equal or coercible");
                 }
             }
             break;
         }
         case TOKEN_NEXT: {
-            size_of += type_check(AST->left, return_type);
-            size_of += type_check(AST->right, return_type);
+            size_of += type_check(Node_at(AST->left), return_type);
+            size_of += type_check(Node_at(AST->right), return_type);
             break;
         }
         case TOKEN_FUNCTION_CALL: {
-            type_check(AST->left, return_type);
-            Type *left = type_of(AST->left);
+            type_check(Node_at(AST->left), return_type);
+            Type *left = type_of(Node_at(AST->left));
             if (!is_function(left)) {
-                error(AST->token->line, "can't call non-function objects");
+                error(AST->token.line, "can't call non-function objects");
             }
-            if (AST->right == NULL) {
+            if (Node_at(AST->right) == NULL) {
                 if (left->function_type->parameters.count != 0) {
-                    error(AST->token->line, "too few arguments in function call");
+                    error(AST->token.line, "too few arguments in function call");
                 }
             } else {
-                type_check_params(AST->right, left->function_type->parameters.data, left->function_type->parameters.count);
+                type_check_params(Node_at(AST->right), left->function_type->parameters.data, left->function_type->parameters.count);
             }
             AST->type = left->function_type->return_type;
             break;
@@ -409,153 +378,143 @@ x->basic_type  = y;
             break;
         }
         case '?': {
-            type_check(AST->cond, return_type);
-            if (!is_scalar(type_of(AST->cond))) {
-                error(AST->cond->token->line, "conditions should be of a scalar type");
+            type_check(Node_at(AST->cond), return_type);
+            if (!is_scalar(type_of(Node_at(AST->cond)))) {
+                error(Node_at(AST->cond)->token.line, "conditions should be of a scalar type");
             }
-            type_check(AST->left, return_type);
-            type_check(AST->right, return_type);
-            if (!types_are_equal_or_coercible(type_of(AST->left), type_of(AST->right))) {
-                error(AST->left->token->line, "the types bro, they're not good.");
+            type_check(Node_at(AST->left), return_type);
+            type_check(Node_at(AST->right), return_type);
+            if (!types_are_equal_or_coercible(type_of(Node_at(AST->left)), type_of(Node_at(AST->right)))) {
+                error(Node_at(AST->left)->token.line, "the types bro, they're not good.");
             }
-            AST->type = coerce(type_of(AST->left), type_of(AST->right));
+            AST->type = coerce(type_of(Node_at(AST->left)), type_of(Node_at(AST->right)));
             break;
         }
         case '[': {
-            type_check(AST->left, return_type);
-            type_check(AST->right, return_type);
-            Type *left = type_of(AST->left);
-            Type *right = type_of(AST->right);
+            type_check(Node_at(AST->left), return_type);
+            type_check(Node_at(AST->right), return_type);
+            Type *left = type_of(Node_at(AST->left));
+            Type *right = type_of(Node_at(AST->right));
             
             if (!is_integer(right)) {
-                error(AST->right->token->line, "array index is a non integral type");
+                error(Node_at(AST->right)->token.line, "array index is a non integral type");
             }
             if (is_array(left)) {
                 left = get_base_type(left);
                 AST->type = left->array_type->element;
             } else if (is_pointer(left)) {
-                AST->type = malloc(sizeof(Type));
-                
+                AST->type = deref(left);
             } else {
-                error(AST->left->token->line, "only pointers and arrays are indexable");
+                error(Node_at(AST->left)->token.line, "only pointers and arrays are indexable");
             }
             break;
         }
         case TOKEN_ARROW: {
-            type_check(AST->left, return_type);
-            Type *left = type_of(AST->left);
-            if (AST->right->token->type != TOKEN_IDENT) {
-                error(AST->right->token->line, "right hand side of -> operator must be a member variable of the struct pointed to by the left hand side");
+            type_check(Node_at(AST->left), return_type);
+            Type *left = type_of(Node_at(AST->left));
+            if (Node_at(AST->right)->token.type != TOKEN_IDENT) {
+                error(Node_at(AST->right)->token.line, "right hand side of -> operator must be a member variable of the struct pointed to by the left hand side");
             }
             while (!left->pointer_count && left->is_typedef) {
                 left = left->typedef_type;
             }
             if (left->pointer_count != 1) {
-                error(AST->left->token->line, "left hand side of -> operator must be a pointer to a struct or union type");
+                error(Node_at(AST->left)->token.line, "left hand side of -> operator must be a pointer to a struct or union type");
             }
             // NOTE(mdizdar): we want to get the base type of left here, but doing that is hard when there's a pointer in the way
-            --left->pointer_count;
+            left = Type_pointee(left);
             if (is_struct(left)) {
                 left = get_base_type(left);
                 bool is_member = false;
                 for (u64 i = 0; i < left->struct_type->members.count; ++i) {
-                    if (!strcmp(AST->right->token->name.data, ((Declaration *)left->struct_type->members.data)[i].name.data)) {
+                    if (String_eq(&Node_at(AST->right)->token.name, &((Declaration *)left->struct_type->members.data)[i].name)) {
                         is_member = true;
                         AST->type = ((Declaration *)left->union_type->members.data)[i].type;
                         break;
                     }
                 }
                 if (!is_member) {
-                    error(AST->right->token->line, "right hand side of -> operator must be a member variable of the struct pointed to by the left hand side");
+                    error(Node_at(AST->right)->token.line, "right hand side of -> operator must be a member variable of the struct pointed to by the left hand side");
                 }
             } else if (is_union(left)) {
                 left = get_base_type(left);
                 bool is_member = false;
                 for (u64 i = 0; i < left->union_type->members.count; ++i) {
-                    if (!strcmp(AST->right->token->name.data, ((Declaration *)left->union_type->members.data)[i].name.data)) {
+                    if (String_eq(&Node_at(AST->right)->token.name, &((Declaration *)left->union_type->members.data)[i].name)) {
                         is_member = true;
                         AST->type = ((Declaration *)left->union_type->members.data)[i].type;
                         break;
                     }
                 }
                 if (!is_member) {
-                    error(AST->right->token->line, "right hand side of -> operator must be a member variable of the struct pointed to by the left hand side");
+                    error(Node_at(AST->right)->token.line, "right hand side of -> operator must be a member variable of the struct pointed to by the left hand side");
                 }
             } else {
-                error(AST->left->token->line, "left hand side of -> operator must be a pointer to a struct or union type");
+                error(Node_at(AST->left)->token.line, "left hand side of -> operator must be a pointer to a struct or union type");
             }
-            ++left->pointer_count;
             break;
         }
         case '.': {
-            type_check(AST->left, return_type);
-            Type *left = type_of(AST->left);
-            if (AST->right->token->type != TOKEN_IDENT) {
-                error(AST->right->token->line, "right hand side of . operator must be a member variable of the struct on the left hand side");
+            type_check(Node_at(AST->left), return_type);
+            Type *left = type_of(Node_at(AST->left));
+            if (Node_at(AST->right)->token.type != TOKEN_IDENT) {
+                error(Node_at(AST->right)->token.line, "right hand side of . operator must be a member variable of the struct on the left hand side");
             }
             while (!left->pointer_count && left->is_typedef) {
                 left = left->typedef_type;
             }
             if (left->pointer_count != 0) {
-                error(AST->left->token->line, "left hand side of . operator must be a struct or union type (did you mean to use `->`?)");
+                error(Node_at(AST->left)->token.line, "left hand side of . operator must be a struct or union type (did you mean to use `->`?)");
             }
             if (is_struct(left)) {
                 left = get_base_type(left);
                 bool is_member = false;
                 for (u64 i = 0; i < left->struct_type->members.count; ++i) {
-                    if (!strcmp(AST->right->token->name.data, ((Declaration *)left->struct_type->members.data)[i].name.data)) {
+                    if (String_eq(&Node_at(AST->right)->token.name, &((Declaration *)left->struct_type->members.data)[i].name)) {
                         is_member = true;
                         AST->type = ((Declaration *)left->union_type->members.data)[i].type;
                         break;
                     }
                 }
                 if (!is_member) {
-                    error(AST->right->token->line, "right hand side of . operator must be a member variable of the struct on the left hand side");
+                    error(Node_at(AST->right)->token.line, "right hand side of . operator must be a member variable of the struct on the left hand side");
                 }
             } else if (is_union(left)) {
                 left = get_base_type(left);
                 bool is_member = false;
                 for (u64 i = 0; i < left->union_type->members.count; ++i) {
-                    if (!strcmp(AST->right->token->name.data, ((Declaration *)left->union_type->members.data)[i].name.data)) {
+                    if (String_eq(&Node_at(AST->right)->token.name, &((Declaration *)left->union_type->members.data)[i].name)) {
                         is_member = true;
                         AST->type = ((Declaration *)left->union_type->members.data)[i].type;
                         break;
                     }
                 }
                 if (!is_member) {
-                    error(AST->right->token->line, "right hand side of . operator must be a member variable of the struct on the left hand side");
+                    error(Node_at(AST->right)->token.line, "right hand side of . operator must be a member variable of the struct on the left hand side");
                 }
             } else {
-                error(AST->left->token->line, "left hand side of . operator must be a struct or union type");
+                error(Node_at(AST->left)->token.line, "left hand side of . operator must be a struct or union type");
             }
             break;
         }
         case '!': {
-            type_check(AST->left, return_type);
-            Type *left = type_of(AST->left);
+            type_check(Node_at(AST->left), return_type);
+            Type *left = type_of(Node_at(AST->left));
             
             if (!is_scalar(left)) {
-                error(AST->token->line, "wrong argument to unary operator, should be scalar");
+                error(AST->token.line, "wrong argument to unary operator, should be scalar");
             }
             
             // NOTE(mdizdar): the type is just a bool so we set it to any basic integral type
-            AST->type = malloc(sizeof(Type));
-            AST->type->is_function = false;
-            AST->type->is_static = false;
-            AST->type->is_struct = false;
-            AST->type->is_union = false;
-            AST->type->is_typedef = false;
-            AST->type->is_array = false;
-            AST->type->is_function = false;
-            AST->type->basic_type = BASIC_UINT;
+            AST->type = Type_basic(BASIC_UINT);
             break;
         }
         case '~': {
-            type_check(AST->left, return_type);
-            Type *left = type_of(AST->left);
+            type_check(Node_at(AST->left), return_type);
+            Type *left = type_of(Node_at(AST->left));
             
             if (!is_integer(left)) {
-                error(AST->token->line, "wrong argument to unary operator, should be an integral type");
+                error(AST->token.line, "wrong argument to unary operator, should be an integral type");
             }
             
             AST->type = left;
@@ -563,11 +522,11 @@ x->basic_type  = y;
         }
         case TOKEN_PLUS:
         case TOKEN_MINUS: {
-            type_check(AST->left, return_type);
-            Type *left = type_of(AST->left);
+            type_check(Node_at(AST->left), return_type);
+            Type *left = type_of(Node_at(AST->left));
             
             if (!is_scalar(left) || is_pointer(left)) {
-                error(AST->token->line, "wrong argument to unary operator, should be scalar and not a pointer");
+                error(AST->token.line, "wrong argument to unary operator, should be scalar and not a pointer");
             }
             
             AST->type = left;
@@ -575,93 +534,89 @@ x->basic_type  = y;
         }
         case TOKEN_PREINC:
         case TOKEN_PREDEC: {
-            type_check(AST->left, return_type);
-            Type *left = type_of(AST->left);
+            type_check(Node_at(AST->left), return_type);
+            Type *left = type_of(Node_at(AST->left));
             if (!is_integer(left) && !is_pointer(left)) {
-                error(AST->token->line, "invalid expression: trying to increment a non integer or (non-void) pointer");
+                error(AST->token.line, "invalid expression: trying to increment a non integer or (non-void) pointer");
             }
-            if (!is_lvalue(AST->left)) {
-                error(AST->token->line, "can't increment/decrement a non lvalue");
+            if (!is_lvalue(Node_at(AST->left))) {
+                error(AST->token.line, "can't increment/decrement a non lvalue");
             }
             if (is_void_pointer(left)) {
-                error(AST->left->token->line, "can't do pointer arithmetic on void pointers");
+                error(Node_at(AST->left)->token.line, "can't do pointer arithmetic on void pointers");
             }
             AST->type = left;
             break;
         }
         case TOKEN_POSTINC:
         case TOKEN_POSTDEC: {
-            type_check(AST->left, return_type);
-            Type *left = type_of(AST->left);
+            type_check(Node_at(AST->left), return_type);
+            Type *left = type_of(Node_at(AST->left));
             if (!is_integer(left) && !is_pointer(left)) {
-                error(AST->token->line, "trying to increment a non integer or (non-void) pointer is invalid");
+                error(AST->token.line, "trying to increment a non integer or (non-void) pointer is invalid");
             }
-            if (!is_lvalue(AST->left)) {
-                error(AST->token->line, "can't increment/decrement a non lvalue");
+            if (!is_lvalue(Node_at(AST->left))) {
+                error(AST->token.line, "can't increment/decrement a non lvalue");
             }
             if (is_void_pointer(left)) {
-                error(AST->right->token->line, "can't do pointer arithmetic on void pointers");
+                error(Node_at(AST->right)->token.line, "can't do pointer arithmetic on void pointers");
             }
             AST->type = left;
             break;
         }
         case TOKEN_DEREF: {
-            type_check(AST->left, return_type);
-            Type *left = type_of(AST->left);
+            type_check(Node_at(AST->left), return_type);
+            Type *left = type_of(Node_at(AST->left));
             
             if (!is_pointer(left)) {
-                error(AST->token->line, "cannot dereference a non-pointer");
+                error(AST->token.line, "cannot dereference a non-pointer");
             }
             if (is_void_pointer(left)) {
-                error(AST->token->line, "you do not want to know what happens when you dereference a void pointer so I stopped you");
+                error(AST->token.line, "you do not want to know what happens when you dereference a void pointer so I stopped you");
             }
             
-            AST->type = malloc(sizeof(Type));
-            memcpy(AST->type, left, sizeof(Type));
-            do_deref(AST->type);
+            AST->type = deref(left);
             
             break;
         }
         case TOKEN_ADDRESS: {
-            type_check(AST->left, return_type);
-            Type *left = type_of(AST->left);
+            type_check(Node_at(AST->left), return_type);
+            Type *left = type_of(Node_at(AST->left));
             
-            if (!is_lvalue(AST->left)) {
-                error(AST->token->line, "can't take the address of a non lvalue");
+            if (!is_lvalue(Node_at(AST->left))) {
+                error(AST->token.line, "can't take the address of a non lvalue");
             }
-            AST->type = malloc(sizeof(Type));
-            memcpy(AST->type, left, sizeof(Type));
-            ++AST->type->pointer_count;
+            AST->type = Type_pointerTo(left);
             
             break;
         }
         case '+': { // NOTE(mdizdar): one can be a pointer
-            type_check(AST->left, return_type);
-            type_check(AST->right, return_type);
-            Type *left = type_of(AST->left);
-            Type *right = type_of(AST->right);
+            type_check(Node_at(AST->left), return_type);
+            type_check(Node_at(AST->right), return_type);
+            Type *left = type_of(Node_at(AST->left));
+            Type *right = type_of(Node_at(AST->right));
             
             if (!is_scalar(left)) {
-                error(AST->left->token->line, "can't perform arithmetic on non-scalar types");
+                error(Node_at(AST->left)->token.line, "can't perform arithmetic on non-scalar types");
             }
             if (!is_scalar(right)) {
-                error(AST->right->token->line, "can't perform arithmetic on non-scalar types");
+                error(Node_at(AST->right)->token.line, "can't perform arithmetic on non-scalar types");
             }
             
             if (is_pointer(left)) {
                 if (is_void_pointer(left)) {
-                    error(AST->token->line, "can't perform pointer arithmetic on void pointer");
+                    error(AST->token.line, "can't perform pointer arithmetic on void pointer");
                 }
                 if (!is_pointer(right)) {
                     if (!is_integer(right)) {
-                        error(AST->right->token->line, "can't perform summation on a pointer and a non integral type");
+                        error(Node_at(AST->right)->token.line, "can't perform summation on a pointer and a non integral type");
                     }
                     AST->type = left;
                 } else {
-                    error(AST->token->line, "pointer summation isn't a thing in this language (or any other for that matter)");
+                    error(AST->token.line, "pointer summation isn't a thing in this language (or any other for that matter)");
                 }
             } else if (is_pointer(right)) {
-                error(AST->token->line, "adding a pointer to a scalar doesn't make sense");
+                error(AST->token.line, "adding a pointer to a scalar doesn't make sense");
             } else {
                 AST->type = left;
             }
@@ -669,43 +624,35 @@ x->basic_type  = y;
         }
         case '-': {
             // NOTE(mdizdar): can be pointer - scalar (returns pointer), but not scalar - pointer
-            type_check(AST->left, return_type);
-            type_check(AST->right, return_type);
-            Type *left = type_of(AST->left);
-            Type *right = type_of(AST->right);
+            type_check(Node_at(AST->left), return_type);
+            type_check(Node_at(AST->right), return_type);
+            Type *left = type_of(Node_at(AST->left));
+            Type *right = type_of(Node_at(AST->right));
             
             if (!is_scalar(left)) {
-                error(AST->left->token->line, "can't perform arithmetic on non-scalar types");
+                error(Node_at(AST->left)->token.line, "can't perform arithmetic on non-scalar types");
             }
             if (!is_scalar(right)) {
-                error(AST->right->token->line, "can't perform arithmetic on non-scalar types");
+                error(Node_at(AST->right)->token.line, "can't perform arithmetic on non-scalar types");
             }
             
             if (is_pointer(left)) {
                 if (is_void_pointer(left)) {
-                    error(AST->token->line, "can't perform pointer arithmetic on void pointer");
+                    error(AST->token.line, "can't perform pointer arithmetic on void pointer");
                 }
                 if (!is_pointer(right)) {
                     if (!is_integer(right)) {
-                        error(AST->right->token->line, "can't perform summation on a pointer and a non integral type");
+                        error(Node_at(AST->right)->token.line, "can't perform summation on a pointer and a non integral type");
                     }
                     AST->type = left;
                 } else {
                     if (is_void_pointer(right)) {
-                        error(AST->token->line, "can't perform pointer arithmetic on void pointer");
+                        error(AST->token.line, "can't perform pointer arithmetic on void pointer");
                     }
-                    AST->type = malloc(sizeof(Type));
-                    AST->type->is_function = false;
-                    AST->type->is_static = false;
-                    AST->type->is_struct = false;
-                    AST->type->is_union = false;
-                    AST->type->is_typedef = false;
-                    AST->type->is_array = false;
-                    AST->type->is_function = false;
-                    AST->type->basic_type = BASIC_UINT; // NOTE(mdizdar): any word-sized integer type
+                    AST->type = Type_basic(BASIC_UINT); // NOTE(mdizdar): any word-sized integer type
                 }
             } else if (is_pointer(right)) {
-                error(AST->token->line, "subtracting a pointer from a scalar doesn't make sense");
+                error(AST->token.line, "subtracting a pointer from a scalar doesn't make sense");
             } else {
                 AST->type = left;
             }
@@ -713,27 +660,19 @@ x->basic_type  = y;
         }
         case TOKEN_LOGICAL_OR:
         case TOKEN_LOGICAL_AND: { // NOTE(mdizdar): can be pointers, return type scalar (int)
-            type_check(AST->left, return_type);
-            type_check(AST->right, return_type);
-            Type *left = type_of(AST->left);
-            Type *right = type_of(AST->right);
+            type_check(Node_at(AST->left), return_type);
+            type_check(Node_at(AST->right), return_type);
+            Type *left = type_of(Node_at(AST->left));
+            Type *right = type_of(Node_at(AST->right));
             
             if (!is_scalar(left)) {
-                error(AST->left->token->line, "can't perform arithmetic on non-scalar types");
+                error(Node_at(AST->left)->token.line, "can't perform arithmetic on non-scalar types");
             }
             if (!is_scalar(right)) {
-                error(AST->right->token->line, "can't perform arithmetic on non-scalar types");
+                error(Node_at(AST->right)->token.line, "can't perform arithmetic on non-scalar types");
             }
             
-            AST->type = malloc(sizeof(Type));
-            AST->type->is_function = false;
-            AST->type->is_static = false;
-            AST->type->is_struct = false;
-            AST->type->is_union = false;
-            AST->type->is_typedef = false;
-            AST->type->is_array = false;
-            AST->type->is_function = false;
-            AST->type->basic_type = BASIC_UINT;
+            AST->type = Type_basic(BASIC_UINT);
             break;
         }
         case '*':
@@ -744,21 +683,21 @@ x->basic_type  = y;
         case '^':
         case TOKEN_BITSHIFT_LEFT:
         case TOKEN_BITSHIFT_RIGHT: { // NOTE(mdizdar): can't be pointers, return type scalar
-            type_check(AST->left, return_type);
-            type_check(AST->right, return_type);
-            Type *left = type_of(AST->left);
-            Type *right = type_of(AST->right);
+            type_check(Node_at(AST->left), return_type);
+            type_check(Node_at(AST->right), return_type);
+            Type *left = type_of(Node_at(AST->left));
+            Type *right = type_of(Node_at(AST->right));
             if (is_pointer(left)) {
-                error(AST->left->token->line, "you doing weird shit to pointers");
+                error(Node_at(AST->left)->token.line, "you doing weird shit to pointers");
             }
             if (is_pointer(right)) {
-                error(AST->right->token->line, "you doing weird shit to pointers");
+                error(Node_at(AST->right)->token.line, "you doing weird shit to pointers");
             }
             if (!is_scalar(left)) {
-                error(AST->left->token->line, "can't perform arithmetic on non-scalar types");
+                error(Node_at(AST->left)->token.line, "can't perform arithmetic on non-scalar types");
             }
             if (!is_scalar(right)) {
-                error(AST->right->token->line, "can't perform arithmetic on non-scalar types");
+                error(Node_at(AST->right)->token.line, "can't perform arithmetic on non-scalar types");
             }
             AST->type = coerce(left, right);
             break;
@@ -769,58 +708,50 @@ x->basic_type  = y;
         case '<':
         case TOKEN_LESS_EQ:
         case TOKEN_GREATER_EQ: {
-            type_check(AST->left, return_type);
-            type_check(AST->right, return_type);
-            Type *left = type_of(AST->left);
-            Type *right = type_of(AST->right);
+            type_check(Node_at(AST->left), return_type);
+            type_check(Node_at(AST->right), return_type);
+            Type *left = type_of(Node_at(AST->left));
+            Type *right = type_of(Node_at(AST->right));
             if (!is_scalar(left)) {
-                error(AST->left->token->line, "can't compare non-scalar types");
+                error(Node_at(AST->left)->token.line, "can't compare non-scalar types");
             }
             if (!is_scalar(right)) {
-                error(AST->right->token->line, "can't compare non-scalar types");
+                error(Node_at(AST->right)->token.line, "can't compare non-scalar types");
             }
             if (signedness(left) != signedness(right)) {
-                warning(AST->token->line, "comparison between two values of different signedness");
+                warning(AST->token.line, "comparison between two values of different signedness");
             }
             
-            AST->type = malloc(sizeof(Type));
-            AST->type->is_function = false;
-            AST->type->is_static = false;
-            AST->type->is_struct = false;
-            AST->type->is_union = false;
-            AST->type->is_typedef = false;
-            AST->type->is_array = false;
-            AST->type->is_function = false;
-            AST->type->basic_type = BASIC_UINT;
+            AST->type = Type_basic(BASIC_UINT);
             break;
         }
         case TOKEN_ADD_ASSIGN:
         case TOKEN_SUB_ASSIGN: {
-            type_check(AST->left, return_type);
-            type_check(AST->right, return_type);
-            Type *left = type_of(AST->left);
-            Type *right = type_of(AST->right);
+            type_check(Node_at(AST->left), return_type);
+            type_check(Node_at(AST->right), return_type);
+            Type *left = type_of(Node_at(AST->left));
+            Type *right = type_of(Node_at(AST->right));
             
             if (!is_scalar(left)) {
-                error(AST->left->token->line, "can't perform arithmetic on non-scalar types");
+                error(Node_at(AST->left)->token.line, "can't perform arithmetic on non-scalar types");
             }
             if (!is_scalar(right)) {
-                error(AST->right->token->line, "can't perform arithmetic on non-scalar types");
+                error(Node_at(AST->right)->token.line, "can't perform arithmetic on non-scalar types");
             }
             
             if (is_pointer(left)) {
                 if (is_void_pointer(left)) {
-                    error(AST->token->line, "can't perform pointer arithmetic on void pointer");
+                    error(AST->token.line, "can't perform pointer arithmetic on void pointer");
                 }
                 if (!is_pointer(right)) {
                     if (!is_integer(right)) {
-                        error(AST->right->token->line, "can't perform summation on a pointer and a non integral type");
+                        error(Node_at(AST->right)->token.line, "can't perform summation on a pointer and a non integral type");
                     }
                 } else {
-                    error(AST->token->line, "pointer summation isn't a thing in this language (or any other for that matter)");
+                    error(AST->token.line, "pointer summation isn't a thing in this language (or any other for that matter)");
                 }
             } else if (is_pointer(right)) {
-                error(AST->token->line, "adding a pointer to a scalar doesn't make sense");
+                error(AST->token.line, "adding a pointer to a scalar doesn't make sense");
             }
             AST->type = left;
             break;
@@ -834,43 +765,43 @@ x->basic_type  = y;
         case TOKEN_BITNOT_ASSIGN:
         case TOKEN_BIT_L_ASSIGN:
         case TOKEN_BIT_R_ASSIGN: {
-            type_check(AST->left, return_type);
-            type_check(AST->right, return_type);
-            Type *left = type_of(AST->left);
-            Type *right = type_of(AST->right);
+            type_check(Node_at(AST->left), return_type);
+            type_check(Node_at(AST->right), return_type);
+            Type *left = type_of(Node_at(AST->left));
+            Type *right = type_of(Node_at(AST->right));
             if (is_pointer(left)) {
-                error(AST->left->token->line, "you doing weird shit to pointers");
+                error(Node_at(AST->left)->token.line, "you doing weird shit to pointers");
             }
             if (is_pointer(right)) {
-                error(AST->right->token->line, "you doing weird shit to pointers");
+                error(Node_at(AST->right)->token.line, "you doing weird shit to pointers");
             }
-            if (!is_lvalue(AST->left)) {
-                error(AST->left->token->line, "left hand side of assignment needs to be an lvalue");
+            if (!is_lvalue(Node_at(AST->left))) {
+                error(Node_at(AST->left)->token.line, "left hand side of assignment needs to be an lvalue");
             }
             if (!is_scalar(left)) {
-                error(AST->left->token->line, "can't perform arithmetic on non-scalar types");
+                error(Node_at(AST->left)->token.line, "can't perform arithmetic on non-scalar types");
             }
             if (!is_scalar(right)) {
-                error(AST->right->token->line, "can't perform arithmetic on non-scalar types");
+                error(Node_at(AST->right)->token.line, "can't perform arithmetic on non-scalar types");
             }
             AST->type = left;
             break;
         }
         case '=': {
-            type_check(AST->left, return_type);
-            type_check(AST->right, return_type);
-            if (!is_lvalue(AST->left)) {
-                Type_print(AST->left->type, 0);
-                error(AST->left->token->line, "left hand side of assignment needs to be an lvalue");
+            type_check(Node_at(AST->left), return_type);
+            type_check(Node_at(AST->right), return_type);
+            if (!is_lvalue(Node_at(AST->left))) {
+                Type_print(Node_at(AST->left)->type, 0);
+                error(Node_at(AST->left)->token.line, "left hand side of assignment needs to be an lvalue");
             }
-            if (!types_are_equal_or_coercible(type_of(AST->left), type_of(AST->right))) {
-                error(AST->token->line, "you assigning some weird shit..");
+            if (!types_are_equal_or_coercible(type_of(Node_at(AST->left)), type_of(Node_at(AST->right)))) {
+                error(AST->token.line, "you assigning some weird shit..");
             }
-            AST->type = AST->left->type;
+            AST->type = Node_at(AST->left)->type;
             break;
         }
         default: {
-            //warning(AST->token->line, "idk what %llu is", AST->token->type);
+            //warning(AST->token.line, "idk what %llu is", AST->token.type);
             internal_error;
         }
     }
@@ -2,90 +2,189 @@
 
 u64 basic_block_index = 0;
 
-BasicBlock *makeBasicBlock(IRArray *ir, u64 index, LabelArray *labels) {
-    BasicBlock *bb = malloc(sizeof(BasicBlock));
-    bb->begin = index;
-    bb->jump = NULL;
-    bb->next = NULL;
-    bb->id = basic_block_index++;
-    bb->in_blocks = malloc(sizeof(BasicBlockPtrArray));
-    BasicBlockPtrArray_construct(bb->in_blocks);
-    bb->livenessDone = false;
-    bb->loop = false;
-    
+// NOTE(mdizdar): every pass builds the CFG again, and only the latest one is ever looked at, so each rebuild rewinds
+// this to where it started instead of leaving the old blocks to pile up
+static Arena *cfg_arena = NULL;
+static ArenaMark cfg_start;
+
+_generate_hash_map(String, u64);
+
+// NOTE(mdizdar): where every label is, the numbered ones are dense so they get a plain table
+typedef struct LabelTargets {
+    u64 *by_index;
+    u64 index_count;
+    Stringu64HashMap by_name;
+} LabelTargets;
+
+static LabelTargets findLabelTargets(const LabelArray *labels) {
+    LabelTargets targets = {0};
+    Stringu64HashMap_construct(&targets.by_name);
+    for (ARRAY_EACH(Label, it, labels)) {
+        if (!it->named) targets.index_count = max(targets.index_count, it->label_index + 1);
+    }
+    targets.by_index = malloc(sizeof(u64) * targets.index_count);
+    memset(targets.by_index, 0xFF, sizeof(u64) * targets.index_count);
+    for (ARRAY_EACH(Label, it, labels)) {
+        if (it->named) {
+            // NOTE(mdizdar): the first one wins if a name shows up twice, same as the old linear search
+            if (!Stringu64HashMap_get(&targets.by_name, &it->label_name)) {
+                Stringu64HashMap_add(&targets.by_name, &it->label_name, &it->ir_index);
+            }
+        } else {
+            targets.by_index[it->label_index] = it->ir_index;
+        }
+    }
+    return targets;
+}
+
+static BasicBlock *findTarget(const IR *irs, const LabelTargets *targets, const IRVariable *label) {
+    u64 ir_index = (u64)-1;
+    if (label->named) {
+        u64 *found = Stringu64HashMap_get(&targets->by_name, &label->label_name);
+        if (found) ir_index = *found;
+    } else if (label->label_index < targets->index_count) {
+        ir_index = targets->by_index[label->label_index];
+    }
+    if (ir_index == (u64)-1) {
+        error(0, "nice label bro | %d %d", label->label_index, label->named);
+    }
+    return irs[ir_index].block;
+}
+
+static inline bool endsBlock(Op instruction) {
+    return instruction == OP_JUMP || instruction == OP_IF_JUMP || instruction == OP_IFN_JUMP || instruction == OP_RETURN;
+}
+
+// NOTE(mdizdar): first we mark every instruction that starts a block (labels and whatever comes after a jump or a
+// return), then all the blocks get made in one go, and then they get hooked up to their successors. Nothing
+// recurses and every label is found in O(1), so this is linear in the number of instructions
+void makeBasicBlocks(IRArray *ir, LabelArray *labels) {
     IR *irs = ir->data;
-    irs[index].block = bb;
-    for (u64 i = index; i < ir->count; ++i) {
-        if (irs[i].instruction != OP_LABEL) {
-            irs[i].block = bb;
+    const u64 count = ir->count;
+    if (count == 0) return;
+    if (!cfg_arena) {
+        cfg_arena = Arena_init(4096);
+        cfg_start = Arena_mark(cfg_arena);
+    } else {
+        Arena_rewind(cfg_arena, cfg_start);
+    }
+    Arena *arena = cfg_arena;
+    
+    bool *leader = calloc(count, sizeof(bool));
+    leader[0] = true;
+    u64 block_count = 0;
+    for (u64 i = 0; i < count; ++i) {
+        if (irs[i].instruction == OP_LABEL) leader[i] = true;
+        if (endsBlock(irs[i].instruction) && i+1 < count) leader[i+1] = true;
+        block_count += leader[i];
+    }
+    
+    BasicBlock *blocks = Arena_alloc(arena, sizeof(BasicBlock) * block_count);
+    u64 b = 0;
+    for (u64 i = 0; i < count; ++i) {
+        if (leader[i]) {
+            if (b) blocks[b-1].end = i-1;
+            blocks[b] = (BasicBlock){
+                .id = basic_block_index++,
+                .begin = i,
+            };
+            ++b;
         }
-        if (irs[i].instruction == OP_JUMP) {
-            bb->end = i;
-            bb->jump = findBasicBlock(ir, i+1, labels, &irs[i].operands[0]);
-            BasicBlockPtrArray_push_back(bb->jump->in_blocks, bb);
-            return bb;
-        } else if (irs[i].instruction == OP_IF_JUMP ||
-                   irs[i].instruction == OP_IFN_JUMP) {
-            bb->end = i;
-            bb->next = findBasicBlock(ir, i+1, labels, NULL);
-            bb->jump = findBasicBlock(ir, i+1, labels, &irs[i].operands[1]);
-            if (bb->next->begin == bb->jump->begin) {
-                free(bb->next);
-                bb->next = NULL;
-            } else {
-                BasicBlockPtrArray_push_back(bb->next->in_blocks, bb);
+        irs[i].block = &blocks[b-1];
+    }
+    blocks[b-1].end = count-1;
+    free(leader);
+    
+    LabelTargets targets = findLabelTargets(labels);
+    for (b = 0; b < block_count; ++b) {
+        BasicBlock *bb = &blocks[b];
+        BasicBlock *following = b+1 < block_count ? &blocks[b+1] : NULL;
+        IR *last = &irs[bb->end];
+        switch ((int)last->instruction) {
+            case OP_JUMP: {
+                bb->jump = findTarget(irs, &targets, &last->operands[0]);
+                break;
+            }
+            case OP_IF_JUMP: case OP_IFN_JUMP: {
+                bb->jump = findTarget(irs, &targets, &last->operands[1]);
+                // NOTE(mdizdar): jumping to the very next instruction leaves us with only one successor
+                bb->next = following != bb->jump ? following : NULL;
+                break;
+            }
+            case OP_RETURN: {
+                break;
+            }
+            default: {
+                // falling through into a label
+                bb->next = following;
             }
-            BasicBlockPtrArray_push_back(bb->jump->in_blocks, bb);
-            return bb;
-        } else if (i != index && irs[i].instruction == OP_LABEL) {
-            bb->next = findBasicBlock(ir, i, labels, NULL);
-            BasicBlockPtrArray_push_back(bb->next->in_blocks, bb);
-            bb->end = i-1;
-            return bb;
-        } else if (irs[i].instruction == OP_RETURN) {
-            bb->end = i;
-            return bb;
         }
+        if (bb->next) ++bb->next->in_count;
+        if (bb->jump) ++bb->jump->in_count;
+    }
+    free(targets.by_index);
+    Stringu64HashMap_destruct(&targets.by_name);
+    
+    // NOTE(mdizdar): now that we know how many predecessors everyone has, they can all get exactly that much room
+    for (b = 0; b < block_count; ++b) {
+        blocks[b].in_blocks = Arena_alloc(arena, sizeof(BasicBlock *) * blocks[b].in_count);
+        blocks[b].in_count = 0;
+    }
+    for (b = 0; b < block_count; ++b) {
+        BasicBlock *bb = &blocks[b];
+        if (bb->next) bb->next->in_blocks[bb->next->in_count++] = bb;
+        if (bb->jump) bb->jump->in_blocks[bb->jump->in_count++] = bb;
     }
-    bb->end = ir->count-1;
-    return bb;
 }
 
-void makeBasicBlocks(IRArray *ir, LabelArray *labels) {
-    int i = -1;
-    for (ARRAY_EACH(IR, it, ir)) {
-        ++i;
-        IRVariableArray_construct(&it->liveVars);
-        if (it->block) continue;
-        makeBasicBlock(ir, i, labels);
+void freeBasicBlocks(bool memory_stats) {
+    if (!cfg_arena) return;
+    if (memory_stats) Arena_printStats(cfg_arena, "CFG");
+    Arena_freeall(cfg_arena);
+    cfg_arena = NULL;
+}
+
+// one block's end is right before the next one's beginning
+void collectBlocks(IRArray *ir, BasicBlockPtrArray *blocks) {
+    IR *irs = ir->data;
+    for (u64 i = 0; i < ir->count; i = irs[i].block->end + 1) {
+        irs[i].block->order = blocks->count;
+        BasicBlockPtrArray_push_back(blocks, irs[i].block);
     }
 }
 
-BasicBlock *findBasicBlock(IRArray *ir, u64 index, LabelArray *labels, IRVariable *label) {
-    if (label) {
-        // looking for a label, not an index
-        for (ARRAY_EACH(Label, it, labels)) {
-            if (label->named != it->named) continue;
-            if (it->named) {
-                if (strcmp(label->label_name.data, it->label_name.data)) continue;
-            } else {
-                if (label->label_index != it->label_index) continue;
+void postorder(const BasicBlockPtrArray *blocks, u64 *order, bool *is_root) {
+    const u64 count = blocks->count;
+    BasicBlock **bbs = blocks->data;
+    bool *visited = calloc(count, sizeof(bool));
+    u64 *stack = malloc(sizeof(u64) * count);
+    u8 *next_successor = calloc(count, sizeof(u8));
+    u64 emitted = 0;
+    
+    for (u64 root = 0; root < count; ++root) {
+        if (visited[root]) continue;
+        visited[root] = true;
+        if (is_root) is_root[root] = true;
+        u64 depth = 0;
+        stack[depth++] = root;
+        while (depth) {
+            const u64 top = stack[depth-1];
+            BasicBlock *successor = NULL;
+            while (successor == NULL && next_successor[top] < 2) {
+                successor = next_successor[top]++ == 0 ? bbs[top]->next : bbs[top]->jump;
+                if (successor && visited[successor->order]) successor = NULL;
             }
-            // found it
-            if (IRArray_at(ir, it->ir_index)->block) {
-                return IRArray_at(ir, it->ir_index)->block;
+            if (successor) {
+                visited[successor->order] = true;
+                stack[depth++] = successor->order;
             } else {
-                return makeBasicBlock(ir, it->ir_index, labels);
+                order[emitted++] = top;
+                --depth;
             }
         }
-        // oops, didn't find it
-        error(0, "nice label bro | %d %d | %lu", label->label_index, label->named, labels->count);
-    } else {
-        // looking for an index
-        if (IRArray_at(ir, index)->block) {
-            return IRArray_at(ir, index)->block;
-        } else {
-            return makeBasicBlock(ir, index, labels);
-        }
     }
+    
+    free(visited);
+    free(stack);
+    free(next_successor);
 }
@@ -5,9 +5,18 @@
 #include "IRVariable.h"
 #include "basic_block.h"
 #include "label.h"
+#include "../C/arena.h"
 
-BasicBlock *findBasicBlock(IRArray *ir, u64 index, LabelArray *labels, IRVariable *label);
-BasicBlock *makeBasicBlock(IRArray *ir, u64 index, LabelArray *labels);
+// NOTE(mdizdar): the blocks and their in_blocks all live in cfg_arena, every instruction's block points into it.
+// Building them again throws the old ones away, so nothing can hold on to a block past the next makeBasicBlocks
 void makeBasicBlocks(IRArray *ir, LabelArray *labels);
+// what's left of the last blocks, for when nothing needs them anymore
+void freeBasicBlocks(bool memory_stats);
+// NOTE(mdizdar): the blocks are contiguous runs of instructions, so this finds all of them in program order,
+// unreachable ones included, and sets block->order to the index into blocks
+void collectBlocks(IRArray *ir, BasicBlockPtrArray *blocks);
+// order gets the indices (block->order) of blocks in postorder. The walk starts over from the first block that
+// hasn't been seen yet until there aren't any left, is_root (if it isn't NULL) says which ones it started from
+void postorder(const BasicBlockPtrArray *blocks, u64 *order, bool *is_root);
 
 #endif // CFG_H
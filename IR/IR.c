@@ -1,6 +1,8 @@
 #include "IR.h"
+#include "CFG.h"
 
 TemporaryID temporary_index = 0; // global
+extern LabelID label_index;
                                  //
 STRUCT_SOURCE(IR);
 
@@ -46,7 +48,7 @@ break;                                                         \
             break;
         }
         case OP_GET_ARG: {
-            fprintf(fp, "%s = arg #%s%s", IRVariable_toStr(&ir->result, s), IRVariable_toStr(&ir->operands[0], q), newline);
+            fprintf(fp, "%s = arg +%s (%lu)%s", IRVariable_toStr(&ir->result, s), IRVariable_toStr(&ir->operands[0], q), ir->operands[1].integer_value, newline);
             break;
         }
         case OP_GET_RETURNED: {
@@ -80,9 +82,16 @@ break;                                                         \
             break;
         }
         case OP_PHI: {
-            fprintf(fp, "%s = phi ", IRVariable_toStr(&ir->result, s));
-            fprintf(fp, "%s ", IRVariable_toStr(&ir->operands[0], s));
-            fprintf(fp, "%s%s", IRVariable_toStr(&ir->operands[1], s), newline);
+            fprintf(fp, "%s = phi", IRVariable_toStr(&ir->result, s));
+            for (u64 i = 0; i < ir->phi->count; ++i) {
+                IRVariable *value = &ir->phi->values[i];
+                if (value->type == OT_PHI_VAR) {
+                    fprintf(fp, " %s", IRVariable_toStr(value, s));
+                } else {
+                    fprintf(fp, " [%s from L%lu]", IRVariable_toStr(value, s), value->label_index);
+                }
+            }
+            fprintf(fp, "%s", newline);
             break;
         }
         case OP_STORE: {
@@ -137,83 +146,273 @@ void IR_print(IR * const ir, u64 size) {
     }
 }
 
-IRArray IR_resolve_phi(IRArray *ir, LabelArray *labels) {
-    IRArray new_ir;
-    IRArray_construct(&new_ir);
-    IRArray_copy(&new_ir, ir);
-    for (ARRAY_EACH(IR, it, ir)) {
-        if (it->instruction == OP_PHI) {
-            Line left_index = -1;
-            Line right_index = -1;
-            for (ARRAY_EACH(Label, label, labels)) {
-                if (label->named) continue;
-                if (it->operands[0].label_index == label->label_index) {
-                    left_index = label->ir_index;
-                } else if (it->operands[1].label_index == label->label_index) {
-                    right_index = label->ir_index;
-                }
-                if (left_index != (Line)-1 && right_index != (Line)-1) {
-                    break;
-                }
+#define NO_TEMPORARY ((u64)-1)
+
+// NOTE(mdizdar): every phi operand is a copy on the edge from the block it names to the phi's block. All the copies
+// on one edge happen at once, same as the phis they came from, so they get bucketed by where they go: the end of the
+// predecessor (before its jump), the beginning of the phi's block when that's only reached by falling through, or
+// a block of their own when the edge is critical
+typedef struct PhiCopy {
+    Line at;
+    IRVariable dest;
+    IRVariable src;
+} PhiCopy;
+
+typedef struct PhiScratch {
+    u64 *loc;     // where the value a temporary had on entry to the copies lives right now
+    u64 *copy_of; // which copy still has to write a temporary
+    u64 *ready;   // destinations nobody still needs to read
+    u64 *todo;
+} PhiScratch;
+
+// NOTE(mdizdar): a critical edge goes from a block ending in a conditional jump to a block with more than one
+// predecessor. The copies can't go in either of those without running on some other path too, so the jump gets
+// pointed at a new block at the very end that does the copies and jumps on to where it was going
+typedef struct SplitEdge {
+    BasicBlock *from;
+    LabelID label;
+} SplitEdge;
+
+_generate_dynamic_array(SplitEdge);
+
+static Line phiCopyPosition(IR *irs, u64 count, BasicBlock *from, BasicBlock *to, u64 *split_of, SplitEdgeArray *splits) {
+    IR *last = &irs[from->end];
+    switch ((int)last->instruction) {
+        case OP_JUMP: {
+            return from->end;
+        }
+        case OP_IF_JUMP: case OP_IFN_JUMP: {
+            if (from->next == NULL) {
+                // NOTE(mdizdar): both ways lead to the same place, so it might as well happen before we decide
+                return from->end;
             }
-            // NOTE (mdizdar): we want to be inserting BEFORE the jump at the end of the block
-            if (IRArray_at(&new_ir, left_index-1)->instruction == OP_JUMP) {
-                left_index -= 1;
+            if (from->next == to) {
+                return to->begin;
             }
-            if (IRArray_at(&new_ir, right_index-1)->instruction == OP_JUMP) {
-                right_index -= 1;
+            u64 *split = &split_of[from->id - irs[0].block->id];
+            if (*split == (u64)-1) {
+                *split = splits->count;
+                SplitEdgeArray_push_back(splits, (SplitEdge){ .from = from, .label = label_index++ });
             }
-            IR left_mov = {
-                .instruction = '=',
-                .result = it->result,
-                .operands[0] = {
-                    .type = OT_TEMPORARY,
-                    .entry = it->operands[0].entry,
-                    .temporary_id = it->operands[0].temporary_id,
-                },
+            return count + *split;
+        }
+        case OP_RETURN: {
+            error(0, "a block that returns can't be a phi's predecessor");
+        }
+        default: {
+            return to->begin;
+        }
+    }
+}
+
+static void pushCopy(IRArray *out, IRVariable dest, TemporaryID src, uintptr_t entry) {
+    IR mov = {
+        .instruction = '=',
+        .result = dest,
+        .operands[0] = {
+            .type = OT_TEMPORARY,
+            .entry = entry,
+            .temporary_id = src,
+        },
+    };
+    IRArray_push_ptr(out, &mov);
+}
+
+// NOTE(mdizdar): turns a parallel copy into moves one at a time. Anything nobody reads anymore can be written right
+// away, and whatever is left after that is made of cycles, each of which gets broken by saving one value into a
+// fresh temporary. Every temporary is handled a constant number of times, see Boissinot et al.,
+// "Revisiting Out-of-SSA Translation for Correctness, Code Quality, and Efficiency"
+static void sequentializeCopies(IRArray *out, const PhiCopy *copies, u64 count, PhiScratch *s) {
+    u64 ready_count = 0, todo_count = 0;
+    for (u64 i = 0; i < count; ++i) {
+        if (copies[i].src.type != OT_TEMPORARY) continue;
+        TemporaryID a = copies[i].dest.temporary_id;
+        TemporaryID b = copies[i].src.temporary_id;
+        if (a == b) continue;
+        s->loc[b] = b;
+        s->copy_of[a] = i;
+        s->todo[todo_count++] = a;
+    }
+    // the stack pops from the back, so this way the copies that don't depend on anything keep the order of the phis
+    for (u64 i = todo_count; i-- > 0;) {
+        if (s->loc[s->todo[i]] == NO_TEMPORARY) s->ready[ready_count++] = s->todo[i];
+    }
+    while (todo_count) {
+        while (ready_count) {
+            TemporaryID a = s->ready[--ready_count];
+            const PhiCopy *copy = &copies[s->copy_of[a]];
+            TemporaryID b = copy->src.temporary_id;
+            TemporaryID c = s->loc[b];
+            pushCopy(out, copy->dest, c, copy->src.entry);
+            s->copy_of[a] = NO_TEMPORARY;
+            // NOTE(mdizdar): b only has to move if it's about to be overwritten, otherwise the rest can keep reading it
+            if (s->copy_of[b] != NO_TEMPORARY) {
+                s->loc[b] = a;
+                if (b == c) s->ready[ready_count++] = b;
+            }
+        }
+        TemporaryID b = s->todo[--todo_count];
+        if (s->copy_of[b] != NO_TEMPORARY) {
+            const PhiCopy *copy = &copies[s->copy_of[b]];
+            // b still has to be written but its old value is needed, so it's part of a cycle
+            IRVariable saved = {
+                .type = OT_TEMPORARY,
+                .entry = copy->dest.entry,
+                .temporary_id = temporary_index++,
             };
-            IRArray_insert_ptr(&new_ir, &left_mov, left_index);
-            if (right_index > left_index) ++right_index;
-            IR right_mov = {
-                .instruction = '=',
-                .result = it->result,
-                .operands[0] = {
+            pushCopy(out, saved, b, copy->dest.entry);
+            s->loc[b] = saved.temporary_id;
+            s->ready[ready_count++] = b;
+        }
+    }
+    // NOTE(mdizdar): constants don't read anything, so they can go once everyone's done reading what they overwrite
+    for (u64 i = 0; i < count; ++i) {
+        if (copies[i].src.type == OT_TEMPORARY) continue;
+        IR mov = {
+            .instruction = '=',
+            .result = copies[i].dest,
+            .operands[0] = copies[i].src,
+        };
+        IRArray_push_ptr(out, &mov);
+    }
+    for (u64 i = 0; i < count; ++i) {
+        s->loc[copies[i].dest.temporary_id] = NO_TEMPORARY;
+        if (copies[i].src.type == OT_TEMPORARY) s->loc[copies[i].src.temporary_id] = NO_TEMPORARY;
+        s->copy_of[copies[i].dest.temporary_id] = NO_TEMPORARY;
+    }
+}
+
+IRArray IR_resolve_phi(IRArray *ir, LabelArray *labels) {
+    const u64 count = ir->count;
+    const TemporaryID temporary_count = temporary_index;
+    IR *irs = ir->data;
+    
+    u64 phi_count = 0, copy_count = 0;
+    for (ARRAY_EACH(IR, it, ir)) {
+        if (it->instruction != OP_PHI) continue;
+        ++phi_count;
+        copy_count += it->phi->count;
+    }
+    if (phi_count == 0) return *ir;
+    
+    makeBasicBlocks(ir, labels);
+    const u64 block_count = irs[count-1].block->id - irs[0].block->id + 1;
+    
+    u64 label_count = 0;
+    for (ARRAY_EACH(Label, label, labels)) {
+        if (!label->named) label_count = max(label_count, label->label_index + 1);
+    }
+    u64 *label_lines = malloc(sizeof(u64) * label_count);
+    memset(label_lines, 0xFF, sizeof(u64) * label_count);
+    for (ARRAY_EACH(Label, label, labels)) {
+        if (!label->named) label_lines[label->label_index] = label->ir_index;
+    }
+    
+    // NOTE(mdizdar): the copies get bucketed by where they go with a counting sort, so the ones from the same edge
+    // stay in the order of their phis, and then the new IR is written in one pass. Positions from count onwards are
+    // the split edges, which go at the very end
+    SplitEdgeArray splits;
+    SplitEdgeArray_construct(&splits);
+    u64 *split_of = malloc(sizeof(u64) * block_count);
+    memset(split_of, 0xFF, sizeof(u64) * block_count);
+    PhiCopy *unsorted = malloc(sizeof(PhiCopy) * copy_count);
+    u64 c = 0;
+    for (ARRAY_EACH(IR, it, ir)) {
+        if (it->instruction != OP_PHI) continue;
+        for (u64 k = 0; k < it->phi->count; ++k) {
+            const IRVariable *value = &it->phi->values[k];
+            if (value->label_index >= label_count || label_lines[value->label_index] == (u64)-1) {
+                error(0, "phi from label %lu which doesn't exist", value->label_index);
+            }
+            BasicBlock *from = irs[label_lines[value->label_index]].block;
+            PhiCopy *copy = &unsorted[c++];
+            copy->at = phiCopyPosition(irs, count, from, it->block, split_of, &splits);
+            copy->dest = it->result;
+            if (value->type == OT_PHI_VAR) {
+                copy->src = (IRVariable){
                     .type = OT_TEMPORARY,
-                    .entry = it->operands[1].entry,
-                    .temporary_id = it->operands[1].temporary_id,
-                },
-            };
-            IRArray_insert_ptr(&new_ir, &right_mov, right_index);
-            for (ARRAY_EACH(Label, label, labels)) {
-                if (label->ir_index > left_index) {
-                    ++label->ir_index;
-                }
-                if (label->ir_index > right_index) {
-                    ++label->ir_index;
-                }
+                    .entry = value->entry,
+                    .temporary_id = value->temporary_id,
+                };
+            } else {
+                copy->src = (IRVariable){
+                    .type = value->type,
+                    .integer_value = value->integer_value,
+                };
             }
         }
     }
-    IR *result = IRArray_begin(&new_ir);
-    u64 deleted = 0;
-    for (ARRAY_EACH(IR, it, &new_ir)) {
-        if (it->instruction != OP_PHI) {
-            *result = *it;
-            ++result;
-        } else {
-            ++deleted;
-        }
+    free(label_lines);
+    free(split_of);
+    
+    const u64 positions = count + splits.count;
+    PhiCopy *copies = malloc(sizeof(PhiCopy) * copy_count);
+    u64 *first_copy = calloc(positions + 2, sizeof(u64));
+    for (u64 i = 0; i < copy_count; ++i) {
+        ++first_copy[unsorted[i].at + 2];
     }
-    new_ir.count -= deleted;
-    IRArray_shrink_to_fit(&new_ir);
-
+    for (u64 i = 2; i < positions + 2; ++i) {
+        first_copy[i] += first_copy[i-1];
+    }
+    for (u64 i = 0; i < copy_count; ++i) {
+        copies[first_copy[unsorted[i].at + 1]++] = unsorted[i];
+    }
+    // now the copies that go in front of instruction i are copies[first_copy[i]..first_copy[i+1]]
+    free(unsorted);
+    
+    PhiScratch scratch = {
+        .loc = malloc(sizeof(u64) * temporary_count),
+        .copy_of = malloc(sizeof(u64) * temporary_count),
+        .ready = malloc(sizeof(u64) * copy_count),
+        .todo = malloc(sizeof(u64) * copy_count),
+    };
+    memset(scratch.loc, 0xFF, sizeof(u64) * temporary_count);
+    memset(scratch.copy_of, 0xFF, sizeof(u64) * temporary_count);
+    
+    for (ARRAY_EACH(SplitEdge, split, &splits)) {
+        irs[split->from->end].operands[1].label_index = split->label;
+    }
+    
+    IRArray new_ir;
+    IRArray_construct(&new_ir);
+    IRArray_reserve(&new_ir, count - phi_count + copy_count + splits.count * 2);
+    for (u64 i = 0; i < count; ++i) {
+        sequentializeCopies(&new_ir, copies + first_copy[i], first_copy[i+1] - first_copy[i], &scratch);
+        if (irs[i].instruction == OP_PHI) continue;
+        IRArray_push_ptr(&new_ir, &irs[i]);
+    }
+    for (u64 s = 0; s < splits.count; ++s) {
+        const SplitEdge *split = SplitEdgeArray_at(&splits, s);
+        IRArray_push_back(&new_ir, (IR){
+            .instruction = OP_LABEL,
+            .operands[0] = {
+                .type = OT_LABEL,
+                .named = false,
+                .label_index = split->label,
+            },
+        });
+        sequentializeCopies(&new_ir, copies + first_copy[count + s], first_copy[count + s + 1] - first_copy[count + s], &scratch);
+        IRArray_push_back(&new_ir, (IR){
+            .instruction = OP_JUMP,
+            .operands[0] = irs[split->from->jump->begin].operands[0],
+        });
+    }
+    
+    free(scratch.loc);
+    free(scratch.copy_of);
+    free(scratch.ready);
+    free(scratch.todo);
+    free(copies);
+    free(first_copy);
+    SplitEdgeArray_destruct(&splits);
+    IRArray_destruct(ir);
     LabelArray_destruct(labels);
     *labels = findLabels(&new_ir);
-
-    IRArray_destruct(ir);
     return new_ir;
 }
 
+#undef NO_TEMPORARY
+
 LabelArray findLabels(IRArray *ir) {
     LabelArray labels;
     LabelArray_construct(&labels);
@@ -3,6 +3,7 @@
 
 #include "../utils/common.h"
 #include "../C/symbol_table.h"
+#include "../C/arena.h"
 #include "IRVariable.h"
 #include "label.h"
 #include "basic_block.h"
@@ -42,12 +43,20 @@ typedef enum {
     OP_GET_ARG        = 904,
 } Op;
 
+// NOTE(mdizdar): a phi gets one incoming value per predecessor, every one of them an OT_PHI_VAR (or a literal, once
+// IR_propagateConstants has been through) that carries the label of the block it comes from. They live in an arena,
+// so copying an IR around just shares them
+typedef struct PhiOperands {
+    u64 count;
+    IRVariable values[];
+} PhiOperands;
+
 STRUCT_HEADER(IR, {
     struct BasicBlock *block;
-    IRVariableArray liveVars;
     
     IRVariable result;
     IRVariable operands[2];
+    PhiOperands *phi; // only for OP_PHI
 
     Op instruction;
 });
@@ -56,7 +65,8 @@ STRUCT_HEADER(IR, {
 void IR_saveOne(IR *ir, FILE *fp, char *newline);
 void IR_save(const IRArray *generated_IR, char *outfile);
 void IR_print(IR * const ir, u64 size);
-// Returns new IRArray with no Phi functions, destructs the original IRArray
+// Returns new IRArray with no Phi functions, destructs the original IRArray and rebuilds labels to match.
+// The CFG it needs along the way goes into arena
 IRArray IR_resolve_phi(IRArray *ir, LabelArray *labels);
 LabelArray findLabels(IRArray *ir);
 
@@ -9,6 +9,8 @@ typedef struct IRVariable IRVariable;
 STRUCT_HEADER(IRPointer, {
     IRVariable *reference_var;
     u64 offset;
+    uintptr_t pointee; // the Type of what's behind it, 0 if nobody said. Folding the pointer into a literal loses the
+                       // type the pointer temporary had, this is what's left of it then
 });
 
 #endif //IRPOINTER_H
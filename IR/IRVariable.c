@@ -3,26 +3,39 @@
 
 STRUCT_SOURCE(IRVariable);
 
+s64 IRVariable_literalValue(const IRVariable *var) {
+    u8 bits;
+    switch (var->type) {
+        case OT_INT8:  bits = 8;  break;
+        case OT_INT16: bits = 16; break;
+        case OT_INT32: bits = 32; break;
+        default:       return (s64)var->integer_value;
+    }
+    if (var->integer_value >> bits) return (s64)var->integer_value;
+    if (var->is_unsigned || !(var->integer_value >> (bits - 1))) return (s64)var->integer_value;
+    return (s64)(var->integer_value | ~((1ull << bits) - 1));
+}
+
 const char *IRVariable_toStr(IRVariable * const var, char *s) {
     switch (var->type) {
         case OT_VARIABLE: {
-            sprintf(s, "%s", ((SymbolTableEntry *)var->entry)->name.data);
+            sprintf(s, "%.*s", (int)((SymbolTableEntry *)var->entry)->name.count, ((SymbolTableEntry *)var->entry)->name.data);
             break;
         }
         case OT_INT8: {
-            sprintf(s, "%u", (u8)var->integer_value);
+            sprintf(s, "%u%s", (u8)var->integer_value, var->is_unsigned ? "u" : "");
             break;
         }
         case OT_INT16: {
-            sprintf(s, "%u", (u16)var->integer_value);
+            sprintf(s, "%u%s", (u16)var->integer_value, var->is_unsigned ? "u" : "");
             break;
         }
         case OT_INT32: {
-            sprintf(s, "%u", (u32)var->integer_value);
+            sprintf(s, "%u%s", (u32)var->integer_value, var->is_unsigned ? "u" : "");
             break;
         }
         case OT_INT64: {
-            sprintf(s, "%lu", var->integer_value);
+            sprintf(s, "%lu%s", var->integer_value, var->is_unsigned ? "u" : "");
             break;
         }
         case OT_DOUBLE: {
@@ -35,7 +48,7 @@ const char *IRVariable_toStr(IRVariable * const var, char *s) {
         }
         case OT_TEMPORARY: {
             if (var->entry != 0) {
-                sprintf(s, "%s_%lu", ((SymbolTableEntry *)var->entry)->name.data, var->temporary_id);
+                sprintf(s, "%.*s_%lu", (int)((SymbolTableEntry *)var->entry)->name.count, ((SymbolTableEntry *)var->entry)->name.data, var->temporary_id);
             } else {
                 sprintf(s, "t%lu", var->temporary_id);
             }
@@ -50,7 +63,7 @@ const char *IRVariable_toStr(IRVariable * const var, char *s) {
         }
         case OT_LABEL: {
             if (var->named) {
-                s = var->label_name.data;
+                sprintf(s, "%.*s", (int)var->label_name.count, var->label_name.data);
             } else {
                 sprintf(s, "L%lu", var->label_index);
             }
@@ -62,9 +75,9 @@ const char *IRVariable_toStr(IRVariable * const var, char *s) {
         }
         case OT_PHI_VAR: {
             if (var->entry != 0) {
-                sprintf(s, "[%s_%lu from before L%lu]", ((SymbolTableEntry *)var->entry)->name.data, var->temporary_id, var->label_index);
+                sprintf(s, "[%.*s_%lu from L%lu]", (int)((SymbolTableEntry *)var->entry)->name.count, ((SymbolTableEntry *)var->entry)->name.data, var->temporary_id, var->label_index);
             } else {
-                sprintf(s, "[t%lu from before L%lu]", var->temporary_id, var->label_index);
+                sprintf(s, "[t%lu from L%lu]", var->temporary_id, var->label_index);
             }
             break;
         }
@@ -47,10 +47,14 @@ STRUCT_HEADER(IRVariable, {
         };
     };
     IRPointer pointer;
+    bool is_unsigned; // a literal is the unsigned type of the rank its OT_INT* says, instead of the signed one
     uintptr_t entry; // why am I doing this instead of just including SymbolTableEntry?
                      // is the idea that STE is C specific and this shouldn't be?
 });
 
 const char *IRVariable_toStr(IRVariable * const var, char *s);
+// NOTE(mdizdar): what an OT_INT* literal stands for, read the way IR_propagateConstants reads it: sign extended from
+// its rank unless it's unsigned, and taken as the 64 bit value it is if it has more in it than its rank holds
+s64 IRVariable_literalValue(const IRVariable *var);
 
 #endif // IRVARIABLE_H
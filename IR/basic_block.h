@@ -7,16 +7,15 @@
 #include "../utils/common.h"
 
 STRUCT_HEADER(BasicBlock, {
-    bool livenessDone;
-    bool loop;
-    
     u64 id;
+    u64 order; // where livenessAnalysis keeps this block's sets
     u64 begin;
     u64 end;
     struct BasicBlock *jump;
     struct BasicBlock *next;
     
-    struct BasicBlockPtrArray *in_blocks;
+    struct BasicBlock **in_blocks;
+    u64 in_count;
 });
 
 
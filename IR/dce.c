@@ -0,0 +1,272 @@
+#include "dce.h"
+#include "ssa.h"
+#include "CFG.h"
+#include "../C/symbol_table_entry.h"
+#include "../C/type.h"
+
+extern TemporaryID temporary_index;
+extern LabelID label_index;
+
+// the temporary an instruction writes, a deref writes the one its OT_REFERENCE result stands for
+static inline const IRVariable *definedBy(IR *ir) {
+    if (ir->instruction == OP_PHI) return &ir->result;
+    if (ir->instruction == OP_DEREF) return ir->result.type == OT_REFERENCE ? &ir->result : NULL;
+    return writtenBy(ir);
+}
+
+// NOTE(mdizdar): an OT_REFERENCE reads both the deref it's the result of and the pointer that deref went through.
+// A store through one ('=' with an OT_REFERENCE result) only needs the pointer, the deref before it was a load
+static u64 readsOf(const IR *ir, const IRVariable *reads[5]) {
+    switch ((int)ir->instruction) {
+        case OP_LABEL: case OP_JUMP: case OP_CALL: case OP_PRELUDE: case OP_ERROR: case OP_GET_ARG: case OP_GET_RETURNED: {
+            return 0;
+        }
+        default: break;
+    }
+    u64 n = 0;
+    for (u64 k = 0; k < 2; ++k) {
+        const IRVariable *operand = &ir->operands[k];
+        if (k == 0 && ir->instruction == OP_POP) continue;
+        if (operand->type == OT_TEMPORARY) {
+            reads[n++] = operand;
+        } else if (operand->type == OT_REFERENCE) {
+            reads[n++] = operand;
+            if (operand->pointer.reference_var) reads[n++] = operand->pointer.reference_var;
+        }
+    }
+    if (ir->instruction == '=' && ir->result.type == OT_REFERENCE && ir->result.pointer.reference_var) {
+        reads[n++] = ir->result.pointer.reference_var;
+    }
+    return n;
+}
+
+static inline bool isVolatile(uintptr_t entry, u64 level_from_top) {
+    if (!entry) return false;
+    const Type *type = ((SymbolTableEntry *)entry)->type;
+    if (type == NULL || type->pointer_count < level_from_top) return false;
+    return (type->is_volatile & TYPE_QUALIFIER(type->pointer_count - level_from_top)) != 0;
+}
+
+static bool hasSideEffects(IR *ir, const bool *address_taken, const u64 *def_of) {
+    switch ((int)ir->instruction) {
+        case OP_CALL: case OP_STORE: case OP_PUSH: case OP_POP: case OP_PRELUDE: case OP_RETURN:
+        case OP_JUMP: case OP_IF_JUMP: case OP_IFN_JUMP: case OP_LABEL: case OP_ERROR: {
+            return true;
+        }
+        case OP_DEREF: {
+            // NOTE(mdizdar): a load through a pointer to a volatile has to happen, and if the pointer doesn't come
+            // straight from a variable we can't tell what it points to
+            const IRVariable *pointer = &ir->operands[0];
+            return pointer->type != OT_TEMPORARY || !pointer->entry || isVolatile(pointer->entry, 1);
+        }
+        case '=': {
+            if (ir->result.type == OT_REFERENCE) return true;
+            break;
+        }
+        default: break;
+    }
+    const IRVariable *written = writtenBy(ir);
+    if (!written) return false;
+    if (def_of[written->temporary_id] == MANY_INSTRUCTIONS || address_taken[written->temporary_id]) return true;
+    SymbolTableEntry *entry = (SymbolTableEntry *)written->entry;
+    return entry && (entry->location_in_memory.global || isVolatile(written->entry, 0));
+}
+
+static inline u64 markWriter(u64 d, bool *live, u64 *worklist, u64 pending) {
+    if (d >= MANY_INSTRUCTIONS || live[d]) return pending;
+    live[d] = true;
+    worklist[pending++] = d;
+    return pending;
+}
+
+static inline bool sameLabel(const IRVariable *a, const IRVariable *b) {
+    if (a->named != b->named) return false;
+    return a->named ? String_eq(&a->label_name, &b->label_name) : a->label_index == b->label_index;
+}
+
+static inline bool refersToBlock(const IR *ir, const IRVariable **label) {
+    switch ((int)ir->instruction) {
+        case OP_JUMP:                     *label = &ir->operands[0]; return true;
+        case OP_IF_JUMP: case OP_IFN_JUMP: *label = &ir->operands[1]; return true;
+        default:                          return false;
+    }
+}
+
+void IR_eliminateDeadCode(IRArray *ir, LabelArray *labels) {
+    const u64 count = ir->count;
+    if (count == 0) return;
+    IR *irs = ir->data;
+    const TemporaryID temporary_count = temporary_index;
+
+    makeBasicBlocks(ir, labels);
+    BasicBlockPtrArray blocks;
+    BasicBlockPtrArray_construct(&blocks);
+    collectBlocks(ir, &blocks);
+    BasicBlock **bbs = blocks.data;
+    const u64 block_count = blocks.count;
+
+    // 1. what can be reached from the top or from the beginning of a function
+    bool *reachable = calloc(block_count, sizeof(bool));
+    u64 *stack = malloc(sizeof(u64) * block_count);
+    u64 depth = 0;
+    for (u64 b = 0; b < block_count; ++b) {
+        const IR *first = &irs[bbs[b]->begin];
+        if (b != 0 && !(first->instruction == OP_LABEL && first->operands[0].named)) continue;
+        reachable[b] = true;
+        stack[depth++] = b;
+    }
+    while (depth) {
+        const BasicBlock *block = bbs[stack[--depth]];
+        BasicBlock *successors[2] = { block->next, block->jump };
+        for (u64 s = 0; s < 2; ++s) {
+            if (!successors[s] || reachable[successors[s]->order]) continue;
+            reachable[successors[s]->order] = true;
+            stack[depth++] = successors[s]->order;
+        }
+    }
+    free(stack);
+
+    // a phi's operand comes from the block its label starts
+    u64 *label_block = malloc(sizeof(u64) * (label_index + 1));
+    memset(label_block, 0xFF, sizeof(u64) * (label_index + 1));
+    for (ARRAY_EACH(Label, label, labels)) {
+        if (!label->named) label_block[label->label_index] = irs[label->ir_index].block->order;
+    }
+
+    // 2. who writes what. Everything that isn't a global or behind a pointer has exactly one writer in SSA
+    u64 *def_of = malloc(sizeof(u64) * temporary_count);
+    memset(def_of, 0xFF, sizeof(u64) * temporary_count);
+    bool *address_taken = calloc(temporary_count, sizeof(bool));
+    for (u64 i = 0; i < count; ++i) {
+        if (irs[i].instruction == OP_ADDRESS && irs[i].operands[0].type == OT_TEMPORARY) {
+            address_taken[irs[i].operands[0].temporary_id] = true;
+        }
+        const IRVariable *defined = definedBy(&irs[i]);
+        if (!defined) continue;
+        u64 *def = &def_of[defined->temporary_id];
+        *def = *def == NO_INSTRUCTION ? i : MANY_INSTRUCTIONS;
+    }
+
+    // 3. mark
+    bool *live = calloc(count, sizeof(bool));
+    u64 *worklist = malloc(sizeof(u64) * count);
+    u64 pending = 0;
+    for (u64 b = 0; b < block_count; ++b) {
+        if (!reachable[b]) continue;
+        for (u64 i = bbs[b]->begin; i <= bbs[b]->end; ++i) {
+            if (!hasSideEffects(&irs[i], address_taken, def_of)) continue;
+            live[i] = true;
+            worklist[pending++] = i;
+        }
+    }
+    free(address_taken);
+    while (pending) {
+        IR *it = &irs[worklist[--pending]];
+        if (it->instruction == OP_PHI) {
+            for (u64 k = 0; k < it->phi->count; ++k) {
+                const IRVariable *value = &it->phi->values[k];
+                if (value->type != OT_PHI_VAR || !reachable[label_block[value->label_index]]) continue;
+                pending = markWriter(def_of[value->temporary_id], live, worklist, pending);
+            }
+            continue;
+        }
+        const IRVariable *reads[5];
+        const u64 read_count = readsOf(it, reads);
+        for (u64 r = 0; r < read_count; ++r) {
+            if (reads[r]->type != OT_TEMPORARY && reads[r]->type != OT_REFERENCE) continue;
+            pending = markWriter(def_of[reads[r]->temporary_id], live, worklist, pending);
+        }
+    }
+    free(worklist);
+    free(def_of);
+
+    // 4. sweep, a phi that's left with one operand is just an assignment, and those wait until the block's phis are done
+    IRArray new_ir;
+    IRArray_construct(&new_ir);
+    IRArray_reserve(&new_ir, count);
+    IRArray settled;
+    IRArray_construct(&settled);
+    for (u64 b = 0; b < block_count; ++b) {
+        if (!reachable[b]) continue;
+        for (u64 i = bbs[b]->begin; i <= bbs[b]->end; ++i) {
+            if (!live[i]) continue;
+            IR it = irs[i];
+            if (it.instruction == OP_PHI) {
+                u64 kept = 0;
+                for (u64 k = 0; k < it.phi->count; ++k) {
+                    if (!reachable[label_block[it.phi->values[k].label_index]]) continue;
+                    it.phi->values[kept++] = it.phi->values[k];
+                }
+                it.phi->count = kept;
+                if (kept != 1) {
+                    IRArray_push_ptr(&new_ir, &it);
+                    continue;
+                }
+                IRVariable source = it.phi->values[0];
+                if (source.type == OT_PHI_VAR) {
+                    source = (IRVariable){ .type = OT_TEMPORARY, .entry = source.entry, .temporary_id = source.temporary_id };
+                } else {
+                    source = (IRVariable){ .type = source.type, .integer_value = source.integer_value };
+                }
+                IRArray_push_back(&settled, (IR){ .instruction = '=', .result = it.result, .operands[0] = source });
+                continue;
+            }
+            if (it.instruction != OP_LABEL && settled.count) {
+                for (ARRAY_EACH(IR, assignment, &settled)) {
+                    IRArray_push_ptr(&new_ir, assignment);
+                }
+                IRArray_clear(&settled);
+            }
+            IRArray_push_ptr(&new_ir, &it);
+        }
+        for (ARRAY_EACH(IR, assignment, &settled)) {
+            IRArray_push_ptr(&new_ir, assignment);
+        }
+        IRArray_clear(&settled);
+    }
+    IRArray_destruct(&settled);
+    free(live);
+    free(reachable);
+    free(label_block);
+    BasicBlockPtrArray_destruct(&blocks);
+    IRArray_destruct(ir);
+
+    // 5. a jump to the label right after it does nothing, and a numbered label nobody jumps to or takes a phi operand
+    // from only splits a block in two
+    IR *nirs = new_ir.data;
+    bool *dropped = calloc(new_ir.count, sizeof(bool));
+    u64 *references = calloc(label_index + 1, sizeof(u64));
+    for (u64 i = 0; i < new_ir.count; ++i) {
+        const IRVariable *target;
+        if (nirs[i].instruction == OP_PHI) {
+            for (u64 k = 0; k < nirs[i].phi->count; ++k) {
+                ++references[nirs[i].phi->values[k].label_index];
+            }
+            continue;
+        }
+        if (!refersToBlock(&nirs[i], &target)) continue;
+        if (nirs[i].instruction == OP_JUMP) {
+            // NOTE(mdizdar): skipping over other labels makes the last of them the one coming in, so that's only
+            // fine if there aren't any phis there that care
+            for (u64 j = i+1; j < new_ir.count && nirs[j].instruction == OP_LABEL; ++j) {
+                if (!sameLabel(target, &nirs[j].operands[0])) continue;
+                dropped[i] = j == i+1 || j+1 == new_ir.count || nirs[j+1].instruction != OP_PHI;
+            }
+        }
+        if (!dropped[i] && !target->named) ++references[target->label_index];
+    }
+    u64 kept = 0;
+    for (u64 i = 0; i < new_ir.count; ++i) {
+        if (dropped[i]) continue;
+        if (nirs[i].instruction == OP_LABEL && !nirs[i].operands[0].named && !references[nirs[i].operands[0].label_index]) continue;
+        nirs[kept] = nirs[i];
+        nirs[kept++].block = NULL;
+    }
+    new_ir.count = kept;
+    free(dropped);
+    free(references);
+
+    *ir = new_ir;
+    LabelArray_destruct(labels);
+    *labels = findLabels(ir);
+}
@@ -0,0 +1,15 @@
+#ifndef DCE_H
+#define DCE_H
+
+#include "IR.h"
+#include "label.h"
+
+// NOTE(mdizdar): mark and sweep over the SSA IR. Whatever has an effect besides writing its temporary (calls, stores,
+// pushes and pops, control flow, writes to globals, to things that have their address taken or to volatiles) is
+// live, and so is whatever writes something a live instruction reads, everything else goes. The blocks nobody can
+// get to from a function's entry go too, along with the phi operands coming from them, the jumps that only skip
+// to the next instruction and the labels nothing refers to anymore. The labels get rebuilt to match. It looks at
+// the types to find the volatiles, so it has to run before those get freed
+void IR_eliminateDeadCode(IRArray *ir, LabelArray *labels);
+
+#endif // DCE_H
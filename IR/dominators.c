@@ -0,0 +1,128 @@
+#include "dominators.h"
+#include "CFG.h"
+
+// NOTE(mdizdar): Cooper, Harvey and Kennedy, "A Simple, Fast Dominance Algorithm". Blocks get numbered in reverse
+// postorder, so a block's dominators always have smaller numbers and two of them meet by walking up from whichever
+// one is further down. Number 0 is a made up root above all of the real ones, which is what turns the forest into a
+// tree, so the real blocks are off by one in here
+
+static inline u64 intersect(const u64 *doms, u64 a, u64 b) {
+    while (a != b) {
+        while (a > b) a = doms[a];
+        while (b > a) b = doms[b];
+    }
+    return a;
+}
+
+Dominators dominatorAnalysis(IRArray *ir) {
+    Dominators dominators;
+    BasicBlockPtrArray program_order;
+    BasicBlockPtrArray_construct(&program_order);
+    collectBlocks(ir, &program_order);
+    
+    const u64 count = program_order.count;
+    u64 *order = malloc(sizeof(u64) * count);
+    bool *was_root = calloc(count, sizeof(bool));
+    postorder(&program_order, order, was_root);
+    
+    BasicBlockPtrArray_construct(&dominators.blocks);
+    BasicBlockPtrArray_reserve(&dominators.blocks, count);
+    bool *is_root = malloc(sizeof(bool) * count);
+    for (u64 i = 0; i < count; ++i) {
+        const u64 b = order[count-1 - i];
+        is_root[i] = was_root[b];
+        BasicBlockPtrArray_push_back(&dominators.blocks, program_order.data[b]);
+    }
+    BasicBlock **bbs = dominators.blocks.data;
+    for (u64 i = 0; i < count; ++i) {
+        bbs[i]->order = i;
+    }
+    BasicBlockPtrArray_destruct(&program_order);
+    free(order);
+    free(was_root);
+    
+    u64 *doms = malloc(sizeof(u64) * (count + 1));
+    memset(doms, 0xFF, sizeof(u64) * (count + 1));
+    doms[0] = 0;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (u64 i = 0; i < count; ++i) {
+            u64 new_idom = is_root[i] ? 0 : NO_BLOCK;
+            for (u64 j = 0; j < bbs[i]->in_count; ++j) {
+                const u64 p = bbs[i]->in_blocks[j]->order + 1;
+                if (doms[p] == NO_BLOCK) continue;
+                new_idom = new_idom == NO_BLOCK ? p : intersect(doms, p, new_idom);
+            }
+            if (doms[i+1] != new_idom) {
+                doms[i+1] = new_idom;
+                changed = true;
+            }
+        }
+    }
+    free(is_root);
+    
+    dominators.idom = malloc(sizeof(u64) * count);
+    dominators.child_begin = calloc(count + 1, sizeof(u64));
+    for (u64 i = 0; i < count; ++i) {
+        dominators.idom[i] = doms[i+1] ? doms[i+1] - 1 : NO_BLOCK;
+        if (doms[i+1]) ++dominators.child_begin[doms[i+1]];
+    }
+    // NOTE(mdizdar): counted at idom+1 above, so this makes child_begin[b] the start of b's children
+    for (u64 i = 1; i <= count; ++i) {
+        dominators.child_begin[i] += dominators.child_begin[i-1];
+    }
+    dominators.children = malloc(sizeof(u64) * (dominators.child_begin[count] + 1));
+    u64 *filled = malloc(sizeof(u64) * count);
+    memcpy(filled, dominators.child_begin, sizeof(u64) * count);
+    for (u64 i = 0; i < count; ++i) {
+        if (dominators.idom[i] != NO_BLOCK) dominators.children[filled[dominators.idom[i]]++] = i;
+    }
+    
+    // NOTE(mdizdar): a join point is in the frontier of everything from each of its predecessors up to (but not
+    // including) its immediate dominator. The walk is done twice, once to count and once to fill, and last_added
+    // keeps a block from showing up twice in the same frontier
+    u64 *last_added = malloc(sizeof(u64) * (count + 1));
+    dominators.frontier_begin = calloc(count + 1, sizeof(u64));
+    dominators.frontier = NULL;
+    for (u64 pass = 0; pass < 2; ++pass) {
+        memset(last_added, 0xFF, sizeof(u64) * (count + 1));
+        for (u64 i = 0; i < count; ++i) {
+            if (bbs[i]->in_count < 2) continue;
+            for (u64 j = 0; j < bbs[i]->in_count; ++j) {
+                u64 runner = bbs[i]->in_blocks[j]->order + 1;
+                while (runner != doms[i+1] && last_added[runner] != i) {
+                    last_added[runner] = i;
+                    if (pass == 0) {
+                        ++dominators.frontier_begin[runner];
+                    } else {
+                        dominators.frontier[filled[runner-1]++] = i;
+                    }
+                    runner = doms[runner];
+                }
+            }
+        }
+        if (pass == 0) {
+            // same trick as the children, counted at b+1
+            for (u64 i = 1; i <= count; ++i) {
+                dominators.frontier_begin[i] += dominators.frontier_begin[i-1];
+            }
+            dominators.frontier = malloc(sizeof(u64) * (dominators.frontier_begin[count] + 1));
+            memcpy(filled, dominators.frontier_begin, sizeof(u64) * count);
+        }
+    }
+    
+    free(last_added);
+    free(filled);
+    free(doms);
+    return dominators;
+}
+
+void Dominators_destruct(Dominators *dominators) {
+    BasicBlockPtrArray_destruct(&dominators->blocks);
+    free(dominators->idom);
+    free(dominators->children);
+    free(dominators->child_begin);
+    free(dominators->frontier);
+    free(dominators->frontier_begin);
+}
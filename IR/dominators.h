@@ -0,0 +1,24 @@
+#ifndef DOMINATORS_H
+#define DOMINATORS_H
+
+#include "IR.h"
+#include "basic_block.h"
+
+#define NO_BLOCK ((u64)-1)
+
+// NOTE(mdizdar): every function has its own entry, and so does anything unreachable, so this is really a forest.
+// Everything is indexed by block->order, which is where the block is in reverse postorder
+typedef struct Dominators {
+    BasicBlockPtrArray blocks; // reverse postorder
+    u64 *idom;                 // NO_BLOCK for the roots
+    u64 *children;             // the children of b are children[child_begin[b]..child_begin[b+1]]
+    u64 *child_begin;
+    u64 *frontier;             // the dominance frontier of b is frontier[frontier_begin[b]..frontier_begin[b+1]]
+    u64 *frontier_begin;
+} Dominators;
+
+// ir has to have gone through makeBasicBlocks
+Dominators dominatorAnalysis(IRArray *ir);
+void Dominators_destruct(Dominators *dominators);
+
+#endif // DOMINATORS_H
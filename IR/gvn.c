@@ -0,0 +1,269 @@
+#include "gvn.h"
+#include "ssa.h"
+#include "CFG.h"
+#include "dominators.h"
+#include "../C/symbol_table_entry.h"
+
+extern TemporaryID temporary_index;
+
+// NOTE(mdizdar): what an instruction computes, with its temporaries replaced by their value numbers. The type of the
+// result is in there too since the same '+' into a char and into an int don't have to come out the same
+typedef struct Expression {
+    Op instruction;
+    OperandType types[2]; // OT_TEMPORARY for a value number, the literal's type otherwise
+    bool is_unsigned[2];  // the literal's, an int -1 and 65535u have the same bits
+    u64 values[2];
+    const Type *result_type;
+} Expression;
+
+u64 Expression_hash(const Expression *e) {
+    u64 hash = (u64)e->instruction;
+    hash = hash * 31 + e->types[0] * 2 + e->is_unsigned[0];
+    hash = hash * 31 + e->values[0];
+    hash = hash * 31 + e->types[1] * 2 + e->is_unsigned[1];
+    hash = hash * 31 + e->values[1];
+    return hash * 31 + (u64)(uintptr_t)e->result_type;
+}
+
+bool Expression_eq(const Expression *a, const Expression *b) {
+    return a->instruction == b->instruction &&
+        a->types[0] == b->types[0] && a->is_unsigned[0] == b->is_unsigned[0] && a->values[0] == b->values[0] &&
+        a->types[1] == b->types[1] && a->is_unsigned[1] == b->is_unsigned[1] && a->values[1] == b->values[1] &&
+        a->result_type == b->result_type;
+}
+
+void Expression_copy(Expression *dest, const Expression *src) {
+    *dest = *src;
+}
+
+_generate_hash_map(Expression, u64);
+_generate_dynamic_array(Expression);
+
+static inline const Type *typeOf(const IRVariable *var) {
+    return var->entry ? ((SymbolTableEntry *)var->entry)->type : NULL;
+}
+
+static inline bool isCommutative(Op instruction) {
+    switch ((int)instruction) {
+        case '+': case '*': case '&': case '|': case '^':
+        case OP_EQUALS: case OP_NOT_EQ: case OP_LOGICAL_AND: case OP_LOGICAL_OR: return true;
+        default: return false;
+    }
+}
+
+// false if the instruction reads something that can't be numbered
+static bool expressionOf(const IR *ir, const bool *pinned, Expression *e) {
+    *e = (Expression){ .instruction = ir->instruction, .result_type = typeOf(&ir->result) };
+    const u64 operand_count = isUnary(ir->instruction) ? 1 : 2;
+    for (u64 k = 0; k < operand_count; ++k) {
+        const IRVariable *operand = &ir->operands[k];
+        switch (operand->type) {
+            case OT_TEMPORARY: {
+                if (pinned[operand->temporary_id]) return false;
+                e->values[k] = operand->temporary_id;
+                break;
+            }
+            case OT_INT8: case OT_INT16: case OT_INT32: case OT_INT64: {
+                e->values[k] = operand->integer_value;
+                e->is_unsigned[k] = operand->is_unsigned;
+                break;
+            }
+            default: return false;
+        }
+        e->types[k] = operand->type;
+    }
+    if (isCommutative(ir->instruction) &&
+        (e->types[0] > e->types[1] || (e->types[0] == e->types[1] && e->values[0] > e->values[1]))) {
+        const OperandType type = e->types[0];
+        const bool is_unsigned = e->is_unsigned[0];
+        const u64 value = e->values[0];
+        e->types[0] = e->types[1];
+        e->is_unsigned[0] = e->is_unsigned[1];
+        e->values[0] = e->values[1];
+        e->types[1] = type;
+        e->is_unsigned[1] = is_unsigned;
+        e->values[1] = value;
+    }
+    return true;
+}
+
+// NOTE(mdizdar): number[t] is the temporary holding t's value that everyone reads instead, which is t itself until
+// something says otherwise. It's always written somewhere that dominates everything t's writer does, so it can just
+// be swapped in anywhere t is read
+static inline void renumber(IRVariable *var, const u64 *number, const uintptr_t *entry_of) {
+    if (number[var->temporary_id] == var->temporary_id) return;
+    var->entry = entry_of[number[var->temporary_id]];
+    var->temporary_id = number[var->temporary_id];
+}
+
+void IR_numberValues(IRArray *ir, LabelArray *labels) {
+    const u64 count = ir->count;
+    if (count == 0) return;
+    IR *irs = ir->data;
+    const TemporaryID temporary_count = temporary_index;
+
+    makeBasicBlocks(ir, labels);
+    Dominators dominators = dominatorAnalysis(ir);
+    BasicBlock **bbs = dominators.blocks.data;
+    const u64 block_count = dominators.blocks.count;
+
+    // what can't be numbered: globals, volatiles and anything with its address taken can change behind our back,
+    // and whatever has more than one writer isn't in SSA
+    bool *pinned = malloc(sizeof(bool) * temporary_count);
+    u64 *def_of = malloc(sizeof(u64) * temporary_count);
+    findWriters(ir, def_of, pinned);
+    free(def_of);
+    u64 *number = malloc(sizeof(u64) * temporary_count);
+    uintptr_t *entry_of = calloc(temporary_count, sizeof(uintptr_t));
+    for (TemporaryID t = 0; t < temporary_count; ++t) {
+        number[t] = t;
+    }
+    for (u64 i = 0; i < count; ++i) {
+        IRVariable *written = irs[i].instruction == OP_PHI ? &irs[i].result : writtenBy(&irs[i]);
+        if (written) entry_of[written->temporary_id] = written->entry;
+    }
+
+    // NOTE(mdizdar): the table only ever has what's available in the block we're in, i.e. what the blocks dominating
+    // it computed. Everything that goes in goes on the log too, and leaving a block takes it all back out
+    Expressionu64HashMap available;
+    Expressionu64HashMap_construct(&available);
+    ExpressionArray log;
+    ExpressionArray_construct(&log);
+    bool *redundant = calloc(count, sizeof(bool));
+    u64 *stack = malloc(sizeof(u64) * block_count);
+    u64 *next_child = malloc(sizeof(u64) * block_count);
+    u64 *log_mark = malloc(sizeof(u64) * block_count);
+    u64 removed = 0;
+
+    for (u64 root = 0; root < block_count; ++root) {
+        if (dominators.idom[root] != NO_BLOCK) continue;
+        u64 depth = 0;
+        stack[depth++] = root;
+        next_child[root] = dominators.child_begin[root];
+        log_mark[root] = NO_BLOCK;
+        while (depth) {
+            const u64 b = stack[depth-1];
+            if (log_mark[b] == NO_BLOCK) {
+                // coming into b
+                log_mark[b] = log.count;
+                for (u64 i = bbs[b]->begin; i <= bbs[b]->end; ++i) {
+                    IR *it = &irs[i];
+                    if (it->instruction == OP_PHI) {
+                        // NOTE(mdizdar): the operands coming in over back edges haven't been numbered yet, so this
+                        // only catches the ones that are the same on the way in
+                        if (pinned[it->result.temporary_id]) continue;
+                        u64 same = NO_BLOCK;
+                        for (u64 k = 0; k < it->phi->count; ++k) {
+                            const IRVariable *value = &it->phi->values[k];
+                            const u64 n = value->type == OT_PHI_VAR ? number[value->temporary_id] : NO_BLOCK;
+                            if (n == NO_BLOCK || (same != NO_BLOCK && n != same) || pinned[n]) {
+                                same = NO_BLOCK;
+                                break;
+                            }
+                            same = n;
+                        }
+                        if (same == NO_BLOCK) continue;
+                        number[it->result.temporary_id] = same;
+                        redundant[i] = true;
+                        ++removed;
+                        continue;
+                    }
+                    for (u64 k = 0; k < 2; ++k) {
+                        if (readsOperand(it, k)) renumber(&it->operands[k], number, entry_of);
+                    }
+                    if (it->instruction == OP_DEREF && it->result.type == OT_REFERENCE) {
+                        *it->result.pointer.reference_var = it->operands[0];
+                    } else if (it->instruction == OP_RETURN) {
+                        it->result = it->operands[0];
+                    } else if (it->instruction == '=' && it->result.type == OT_REFERENCE &&
+                               it->result.pointer.reference_var->type == OT_TEMPORARY) {
+                        renumber(it->result.pointer.reference_var, number, entry_of);
+                    }
+                    if (!isPure(it->instruction) || it->result.type != OT_TEMPORARY) continue;
+                    const TemporaryID result = it->result.temporary_id;
+                    if (pinned[result]) continue;
+                    // a copy that doesn't convert anything is the same value under another name
+                    if (it->instruction == '=' && it->operands[0].type == OT_TEMPORARY && !pinned[it->operands[0].temporary_id] &&
+                        (!it->result.entry || typeOf(&it->result) == typeOf(&it->operands[0]))) {
+                        number[result] = it->operands[0].temporary_id;
+                        redundant[i] = true;
+                        ++removed;
+                        continue;
+                    }
+                    Expression e;
+                    if (!expressionOf(it, pinned, &e)) continue;
+                    u64 *found = Expressionu64HashMap_get(&available, &e);
+                    if (found) {
+                        number[result] = *found;
+                        redundant[i] = true;
+                        ++removed;
+                    } else {
+                        Expressionu64HashMap_add(&available, &e, &result);
+                        ExpressionArray_push_back(&log, e);
+                    }
+                }
+            }
+            if (next_child[b] < dominators.child_begin[b+1]) {
+                const u64 child = dominators.children[next_child[b]++];
+                next_child[child] = dominators.child_begin[child];
+                log_mark[child] = NO_BLOCK;
+                stack[depth++] = child;
+                continue;
+            }
+            // leaving b
+            while (log.count > log_mark[b]) {
+                Expressionu64HashMap_erase(&available, &log.data[--log.count]);
+            }
+            --depth;
+        }
+    }
+    free(stack);
+    free(next_child);
+    free(log_mark);
+    ExpressionArray_destruct(&log);
+    Expressionu64HashMap_destruct(&available);
+    free(pinned);
+
+    // the phis' operands are the only reads that can come before their writers in the walk, so they're done last.
+    // A number can point at a phi that turned out to be redundant too, so those get followed all the way
+    for (TemporaryID t = 0; t < temporary_count; ++t) {
+        u64 n = number[t];
+        while (number[n] != n) n = number[n];
+        number[t] = n;
+    }
+    for (u64 i = 0; i < count; ++i) {
+        if (irs[i].instruction != OP_PHI || redundant[i]) continue;
+        for (u64 k = 0; k < irs[i].phi->count; ++k) {
+            if (irs[i].phi->values[k].type == OT_PHI_VAR) renumber(&irs[i].phi->values[k], number, entry_of);
+        }
+    }
+    if (removed) {
+        // NOTE(mdizdar): a phi that got numbered can be read by something it dominates that came before it in the walk,
+        // i.e. something reading it in a loop it heads
+        for (u64 i = 0; i < count; ++i) {
+            if (redundant[i] || irs[i].instruction == OP_PHI) continue;
+            for (u64 k = 0; k < 2; ++k) {
+                if (readsOperand(&irs[i], k)) renumber(&irs[i].operands[k], number, entry_of);
+            }
+            if (irs[i].instruction == OP_DEREF && irs[i].result.type == OT_REFERENCE) {
+                *irs[i].result.pointer.reference_var = irs[i].operands[0];
+            } else if (irs[i].instruction == OP_RETURN) {
+                irs[i].result = irs[i].operands[0];
+            }
+        }
+    }
+    free(number);
+    free(entry_of);
+    Dominators_destruct(&dominators);
+
+    u64 kept = 0;
+    for (u64 i = 0; i < count; ++i) {
+        if (redundant[i]) continue;
+        irs[kept] = irs[i];
+        irs[kept++].block = NULL;
+    }
+    ir->count = kept;
+    free(redundant);
+    LabelArray_destruct(labels);
+    *labels = findLabels(ir);
+}
@@ -0,0 +1,15 @@
+#ifndef GVN_H
+#define GVN_H
+
+#include "IR.h"
+#include "label.h"
+
+// NOTE(mdizdar): dominator based value numbering (Briggs, Cooper and Simpson) over the SSA IR. Walking down the
+// dominator tree, every arithmetic instruction gets hashed by what it does and the value numbers of its operands,
+// and if something above it in the tree already computed the same thing the instruction goes and its uses read
+// the older temporary instead. Copies and phis whose operands are all the same value go the same way. Nothing that
+// touches memory gets numbered, and neither does anything that reads or writes a global, a volatile or a variable
+// that has its address taken. The result types are part of the hash, so this has to run before they get freed
+void IR_numberValues(IRArray *ir, LabelArray *labels);
+
+#endif // GVN_H
@@ -0,0 +1,283 @@
+#include "licm.h"
+#include "ssa.h"
+#include "CFG.h"
+#include "dominators.h"
+#include "loops.h"
+
+extern TemporaryID temporary_index;
+extern LabelID label_index;
+
+typedef struct Licm {
+    IR *irs;
+    const Loops *loops;
+    const u64 *def_of;
+    const bool *pinned;
+    u64 *hoisted_to; // the loop whose preheader an instruction goes to, NO_LOOP if it stays where it is
+} Licm;
+
+// the innermost loop an instruction is in, after whatever hoisting it's been through
+static inline u64 loopOf(const Licm *s, u64 i) {
+    const u64 to = s->hoisted_to[i];
+    return to != NO_LOOP ? s->loops->parent[to] : s->loops->innermost[s->irs[i].block->order];
+}
+
+static bool isInvariant(const Licm *s, const IRVariable *operand, u64 l) {
+    switch (operand->type) {
+        case OT_INT8: case OT_INT16: case OT_INT32: case OT_INT64: case OT_FLOAT: case OT_DOUBLE: {
+            return true;
+        }
+        case OT_TEMPORARY: {
+            if (s->pinned[operand->temporary_id]) return false;
+            const u64 d = s->def_of[operand->temporary_id];
+            if (d == NO_INSTRUCTION) return true;
+            return d != MANY_INSTRUCTIONS && !Loops_contains(s->loops, l, loopOf(s, d));
+        }
+        default: return false;
+    }
+}
+
+static bool canHoist(const Licm *s, u64 i, u64 l) {
+    const IR *it = &s->irs[i];
+    // NOTE(mdizdar): the preheader runs even when the loop body doesn't, so nothing that can divide by zero
+    if (!isPure(it->instruction) || it->instruction == '/' || it->instruction == '%') return false;
+    if (it->result.type != OT_TEMPORARY) return false;
+    const TemporaryID result = it->result.temporary_id;
+    if (s->pinned[result] || s->def_of[result] != i) return false;
+    // where a variable lives doesn't change, whatever happens to it
+    if (it->instruction == OP_ADDRESS) return it->operands[0].type == OT_TEMPORARY;
+    if (!isInvariant(s, &it->operands[0], l)) return false;
+    return isUnary(it->instruction) || isInvariant(s, &it->operands[1], l);
+}
+
+static inline void hoist(Licm *s, u64Array *moved, u64 i, u64 l) {
+    s->hoisted_to[i] = l;
+    u64Array_push_back(&moved[l], i);
+}
+
+static inline void emitHoisted(IRArray *new_ir, const IR *irs, const u64Array *moved, const u64 *hoisted_to, u64 l) {
+    for (u64 k = 0; k < moved[l].count; ++k) {
+        const u64 i = moved[l].data[k];
+        if (hoisted_to[i] == l) IRArray_push_ptr(new_ir, &irs[i]);
+    }
+}
+
+void IR_hoistInvariants(IRArray *ir, LabelArray *labels, Arena *arena) {
+    const u64 count = ir->count;
+    if (count == 0) return;
+    IR *irs = ir->data;
+    const TemporaryID temporary_count = temporary_index;
+
+    makeBasicBlocks(ir, labels);
+    Dominators dominators = dominatorAnalysis(ir);
+    Loops loops = loopAnalysis(&dominators);
+    BasicBlock **bbs = dominators.blocks.data;
+    const u64 block_count = dominators.blocks.count;
+    if (loops.count == 0) {
+        Loops_destruct(&loops);
+        Dominators_destruct(&dominators);
+        return;
+    }
+
+    // 1. who writes what, and what can't be moved around
+    u64 *def_of = malloc(sizeof(u64) * temporary_count);
+    bool *pinned = malloc(sizeof(bool) * temporary_count);
+    findWriters(ir, def_of, pinned);
+
+    // 2. a loop without a preheader gets a new label in front of its header, which the header has to start with a
+    // numbered label of its own for, so the jumps into it can be told apart from the ones going around it
+    bool *can_hoist = calloc(loops.count, sizeof(bool));
+    for (u64 l = 0; l < loops.count; ++l) {
+        if (loops.preheader[l] != NO_BLOCK) {
+            can_hoist[l] = true;
+            continue;
+        }
+        const BasicBlock *header = bbs[loops.header[l]];
+        const IR *first = &irs[header->begin];
+        if (first->instruction != OP_LABEL || first->operands[0].named) continue;
+        for (u64 j = 0; j < header->in_count; ++j) {
+            if (!Loops_contains(&loops, l, loops.innermost[header->in_blocks[j]->order])) can_hoist[l] = true;
+        }
+    }
+
+    // 3. innermost loops first. What a loop hoists is in the loop it's nested in now, so it comes up again right
+    // before that loop's header when the one around it gets its turn
+    Licm s = {
+        .irs = irs,
+        .loops = &loops,
+        .def_of = def_of,
+        .pinned = pinned,
+        .hoisted_to = malloc(sizeof(u64) * count),
+    };
+    memset(s.hoisted_to, 0xFF, sizeof(u64) * count);
+    u64Array *moved = malloc(sizeof(u64Array) * loops.count);
+    for (u64 l = 0; l < loops.count; ++l) {
+        u64Array_construct(&moved[l]);
+    }
+    u64 hoisted = 0;
+    for (u64 l = loops.count; l-- > 0;) {
+        if (!can_hoist[l]) continue;
+        for (u64 j = loops.body_begin[l]; j < loops.body_begin[l+1]; ++j) {
+            const u64 b = loops.body[j];
+            const u64 m = loops.header_of[b];
+            if (m != NO_LOOP && m != l && loops.parent[m] == l) {
+                for (u64 k = 0; k < moved[m].count; ++k) {
+                    const u64 i = moved[m].data[k];
+                    if (s.hoisted_to[i] == m && canHoist(&s, i, l)) hoist(&s, moved, i, l);
+                }
+            }
+            if (loops.innermost[b] != l) continue;
+            for (u64 i = bbs[b]->begin; i <= bbs[b]->end; ++i) {
+                if (s.hoisted_to[i] != NO_LOOP || !canHoist(&s, i, l)) continue;
+                hoist(&s, moved, i, l);
+                ++hoisted;
+            }
+        }
+    }
+    free(def_of);
+    free(pinned);
+    free(can_hoist);
+    if (hoisted == 0) {
+        for (u64 l = 0; l < loops.count; ++l) {
+            u64Array_destruct(&moved[l]);
+        }
+        free(moved);
+        free(s.hoisted_to);
+        Loops_destruct(&loops);
+        Dominators_destruct(&dominators);
+        return;
+    }
+
+    // 4. where everything goes. A loop's preheader gets what's left in its list, and the new ones take over the
+    // jumps into the loop from the outside, along with the phi operands that come in that way
+    u64 *hoist_at_end = malloc(sizeof(u64) * block_count);
+    memset(hoist_at_end, 0xFF, sizeof(u64) * block_count);
+    u64 *new_label = malloc(sizeof(u64) * loops.count);
+    memset(new_label, 0xFF, sizeof(u64) * loops.count);
+    for (u64 l = 0; l < loops.count; ++l) {
+        bool has_hoisted = false;
+        for (u64 k = 0; k < moved[l].count && !has_hoisted; ++k) {
+            has_hoisted = s.hoisted_to[moved[l].data[k]] == l;
+        }
+        if (!has_hoisted) continue;
+        if (loops.preheader[l] != NO_BLOCK) {
+            hoist_at_end[loops.preheader[l]] = l;
+        } else {
+            new_label[l] = label_index++;
+        }
+    }
+    // a phi's operand comes from the block its label starts
+    u64 *label_block = malloc(sizeof(u64) * (label_index + 1));
+    memset(label_block, 0xFF, sizeof(u64) * (label_index + 1));
+    for (ARRAY_EACH(Label, label, labels)) {
+        if (!label->named) label_block[label->label_index] = irs[label->ir_index].block->order;
+    }
+
+    IRArray new_ir;
+    IRArray_construct(&new_ir);
+    IRArray_reserve(&new_ir, count + 2*loops.count);
+    for (u64 i = 0; i < count; ++i) {
+        IR *it = &irs[i];
+        const BasicBlock *block = it->block;
+        const u64 b = block->order;
+        const u64 l = loops.header_of[b];
+        if (i == block->begin && l != NO_LOOP && new_label[l] != NO_BLOCK) {
+            // NOTE(mdizdar): the block right before the header goes into the preheader now if it used to fall
+            // through, which is only right if it's coming from outside
+            if (i > 0 && irs[i-1].block->next == block && Loops_contains(&loops, l, loops.innermost[irs[i-1].block->order])) {
+                IRArray_push_back(&new_ir, (IR){ .instruction = OP_JUMP, .operands[0] = it->operands[0] });
+            }
+            IRArray_push_back(&new_ir, (IR){
+                .instruction = OP_LABEL,
+                .operands[0] = {
+                    .type = OT_LABEL,
+                    .named = false,
+                    .label_index = new_label[l],
+                },
+            });
+            for (u64 p = i+1; p <= block->end && irs[p].instruction == OP_PHI; ++p) {
+                PhiOperands *phi = irs[p].phi;
+                u64 outside = 0;
+                for (u64 k = 0; k < phi->count; ++k) {
+                    const u64 from = label_block[phi->values[k].label_index];
+                    if (!Loops_contains(&loops, l, loops.innermost[from])) ++outside;
+                }
+                PhiOperands *merged = outside > 1 ? Arena_alloc(arena, sizeof(PhiOperands) + sizeof(IRVariable) * outside) : NULL;
+                if (merged) merged->count = 0;
+                u64 kept = 0;
+                for (u64 k = 0; k < phi->count; ++k) {
+                    IRVariable value = phi->values[k];
+                    const u64 from = label_block[value.label_index];
+                    if (Loops_contains(&loops, l, loops.innermost[from])) {
+                        phi->values[kept++] = value;
+                    } else if (merged) {
+                        merged->values[merged->count++] = value;
+                    } else {
+                        value.label_index = new_label[l];
+                        phi->values[kept++] = value;
+                    }
+                }
+                if (merged) {
+                    const IRVariable result = {
+                        .type = OT_TEMPORARY,
+                        .entry = irs[p].result.entry,
+                        .temporary_id = temporary_index++,
+                    };
+                    IRArray_push_back(&new_ir, (IR){ .instruction = OP_PHI, .result = result, .phi = merged });
+                    phi->values[kept++] = (IRVariable){
+                        .type = OT_PHI_VAR,
+                        .entry = result.entry,
+                        .temporary_id = result.temporary_id,
+                        .named = false,
+                        .label_index = new_label[l],
+                    };
+                }
+                phi->count = kept;
+            }
+            emitHoisted(&new_ir, irs, moved, s.hoisted_to, l);
+        }
+        if (s.hoisted_to[i] != NO_LOOP) {
+            // NOTE(mdizdar): a preheader's last instruction can go further out itself, what got hoisted into the
+            // preheader still goes where it was
+            if (i == block->end && hoist_at_end[b] != NO_LOOP) emitHoisted(&new_ir, irs, moved, s.hoisted_to, hoist_at_end[b]);
+            continue;
+        }
+        if (block->jump && (it->instruction == OP_JUMP || it->instruction == OP_IF_JUMP || it->instruction == OP_IFN_JUMP)) {
+            const u64 target = loops.header_of[block->jump->order];
+            if (target != NO_LOOP && new_label[target] != NO_BLOCK && !Loops_contains(&loops, target, loops.innermost[b])) {
+                IRVariable *label = &it->operands[it->instruction == OP_JUMP ? 0 : 1];
+                label->named = false;
+                label->label_index = new_label[target];
+            }
+        }
+        const bool terminates = it->instruction == OP_JUMP || it->instruction == OP_IF_JUMP || it->instruction == OP_IFN_JUMP;
+        if (i == block->end && hoist_at_end[b] != NO_LOOP) {
+            if (terminates) {
+                emitHoisted(&new_ir, irs, moved, s.hoisted_to, hoist_at_end[b]);
+                IRArray_push_ptr(&new_ir, it);
+            } else {
+                IRArray_push_ptr(&new_ir, it);
+                emitHoisted(&new_ir, irs, moved, s.hoisted_to, hoist_at_end[b]);
+            }
+            continue;
+        }
+        IRArray_push_ptr(&new_ir, it);
+    }
+    for (ARRAY_EACH(IR, it, &new_ir)) {
+        it->block = NULL;
+    }
+
+    for (u64 l = 0; l < loops.count; ++l) {
+        u64Array_destruct(&moved[l]);
+    }
+    free(moved);
+    free(s.hoisted_to);
+    free(hoist_at_end);
+    free(new_label);
+    free(label_block);
+    Loops_destruct(&loops);
+    Dominators_destruct(&dominators);
+    IRArray_destruct(ir);
+    *ir = new_ir;
+    LabelArray_destruct(labels);
+    *labels = findLabels(ir);
+}
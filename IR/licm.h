@@ -0,0 +1,16 @@
+#ifndef LICM_H
+#define LICM_H
+
+#include "IR.h"
+#include "label.h"
+#include "../C/arena.h"
+
+// NOTE(mdizdar): loop invariant code motion over the SSA IR. Going from the innermost loops out, arithmetic whose
+// operands are all literals or written outside the loop moves into the loop's preheader, and from there it can keep
+// going out of whatever loop that's in. Division and modulo stay where they are since they'd run even when the loop
+// doesn't, and so does anything touching memory, globals, volatiles or variables with their address taken. A loop
+// that doesn't have a block that only goes into it gets one, along with phis for the values coming in from the
+// outside if there's more than one way in. The phis' operands live in arena and the labels get rebuilt to match
+void IR_hoistInvariants(IRArray *ir, LabelArray *labels, Arena *arena);
+
+#endif // LICM_H
@@ -1,133 +1,182 @@
 #include "liveness_analysis.h"
+#include "CFG.h"
 
-// FIXME(mdizdar): half of this file seems to be treating an array as a hash table, make it an actual hash table :)
-void addHelper(IRVariableArray *vars, IRVariable *var, bool *changed) {
-    for (ARRAY_EACH(IRVariable, it, vars)) {
-        if (it->type == var->type && it->temporary_id == var->temporary_id) return;
-    }
-    *changed = true;
-    IRVariableArray_push_ptr(vars, var);
+// NOTE(mdizdar): this is the usual backwards dataflow problem, with every set being a dense bitset over the
+// TemporaryIDs. A block's use set is what it reads before writing, def is what it writes, and
+//     live_in  = use | (live_out & ~def)
+//     live_out = live_in of every successor
+// gets iterated with a worklist until nothing changes. Only live_out survives that, what's live at any single
+// instruction is one backward scan over its block away (Liveness_ofBlock).
+
+static inline bool hasID(const IRVariable *var) {
+    return var->type == OT_TEMPORARY || var->type == OT_REFERENCE;
+}
+
+static inline const IRVariable *asTemporary(const IRVariable *var) {
+    return var->type == OT_TEMPORARY ? var : NULL;
 }
 
-void addVariable(IRVariableArray *vars, IRVariable *var, bool *changed) {
-    if (var->type == OT_TEMPORARY) {
-        addHelper(vars, var, changed);
-    } 
+// NOTE(mdizdar): an instruction that uses its own result (t1 = t1 + 1) doesn't kill it
+static inline bool readsResult(const IR *ir, u64 operand_count) {
+    for (u64 i = 0; i < operand_count; ++i) {
+        if (hasID(&ir->operands[i]) && ir->result.temporary_id == ir->operands[i].temporary_id) return true;
+    }
+    return false;
 }
 
-void removeVariable(IRVariableArray *vars, IRVariable *var, bool *changed) {
-    if (vars->count == 0) return;
-    IRVariable *vs = vars->data;
-    u64 i = 0;
-    bool found = false;
-    for (; i < vars->count; ++i) {
-        if (vs[i].type == var->type && vs[i].temporary_id == var->temporary_id) {
-            found = true;
+LiveEffect liveEffect(const IR *ir) {
+    LiveEffect effect = {0};
+    switch ((int)ir->instruction) {
+        case OP_POP: {
+            effect.def = asTemporary(&ir->operands[0]);
+            break;
+        }
+        case OP_PUSH: case OP_RETURN: case OP_IF_JUMP: case OP_IFN_JUMP: {
+            effect.uses[0] = asTemporary(&ir->operands[0]);
             break;
         }
+        case OP_GET_RETURNED: case OP_GET_ARG: {
+            effect.def = asTemporary(&ir->result);
+            break;
+        }
+        case OP_LABEL: case OP_JUMP: case OP_ERROR: case OP_PRELUDE: case OP_CALL: {
+            // do nothing
+            break;
+        }
+        case OP_DEREF: {
+            // NOTE(mdizdar): a load writes the temporary its OT_REFERENCE result stands for
+            if (!readsResult(ir, 1) && hasID(&ir->result)) effect.def = &ir->result;
+            effect.uses[0] = asTemporary(&ir->operands[0]);
+            break;
+        }
+        case '=': case '~': case '!': case OP_PLUS: case OP_MINUS: case OP_ADDRESS: {
+            if (ir->instruction == '=' && ir->result.type == OT_REFERENCE) {
+                // and a store through one reads the pointer it goes through
+                effect.uses[0] = asTemporary(&ir->operands[0]);
+                if (ir->result.pointer.reference_var) effect.uses[1] = asTemporary(ir->result.pointer.reference_var);
+                break;
+            }
+            if (!readsResult(ir, 1)) effect.def = asTemporary(&ir->result);
+            effect.uses[0] = asTemporary(&ir->operands[0]);
+            break;
+        }
+        default: {
+            if (!readsResult(ir, 2)) effect.def = asTemporary(&ir->result);
+            effect.uses[0] = asTemporary(&ir->operands[0]);
+            effect.uses[1] = asTemporary(&ir->operands[1]);
+        }
     }
-    if (!found) return;
-    *changed = true;
-    IRVariableArray_erase(vars, i);
+    return effect;
 }
 
-static inline bool hasID(const IRVariable *var) {
-    return var->type == OT_TEMPORARY || var->type == OT_REFERENCE;
+void Liveness_stepBack(u64 *live, const IR *ir) {
+    LiveEffect effect = liveEffect(ir);
+    if (effect.def) Bitset_clear(live, effect.def->temporary_id);
+    if (effect.uses[0]) Bitset_set(live, effect.uses[0]->temporary_id);
+    if (effect.uses[1]) Bitset_set(live, effect.uses[1]->temporary_id);
 }
 
-void livenessAnalysisOneBlock(IRArray *ir, BasicBlock *block, IRVariableArray *liveVars) {
-    bool changed = false;
+// returns whether live_in changed
+static inline bool liveTransfer(u64 *live_in, const u64 *use, const u64 *def, const u64 *live_out, u64 words) {
+    u64 changed = 0;
+    for (u64 i = 0; i < words; ++i) {
+        u64 in = use[i] | (live_out[i] & ~def[i]);
+        changed |= in ^ live_in[i];
+        live_in[i] = in;
+    }
+    return changed != 0;
+}
+
+Liveness livenessAnalysis(IRArray *ir, u64 temporary_count) {
     IR *irs = ir->data;
-    for (u64 i = block->end; i >= block->begin && i <= block->end; --i) {
-        IRVariableArray notLive;
-        IRVariableArray_construct(&notLive);
-        for (ARRAY_EACH(IRVariable, it, liveVars)) {
-            addVariable(&irs[i].liveVars, it, &changed);
-        }
-        switch ((int)irs[i].instruction) {
-            case OP_POP: {
-                if (hasID(&irs[i].operands[0])) {
-                    addVariable(&notLive, &irs[i].operands[0], &changed);
-                } else {
-                    addVariable(&irs[i].liveVars, &irs[i].operands[0], &changed);
-                }
-                break;
-            }
-            case OP_PUSH: case OP_RETURN: {
-                addVariable(&irs[i].liveVars, &irs[i].operands[0], &changed);
-                break;
-            }
-            case OP_GET_RETURNED: case OP_GET_ARG: {
-                if (hasID(&irs[i].result)) {
-                    addVariable(&notLive, &irs[i].result, &changed);
-                } else {
-                    addVariable(&irs[i].liveVars, &irs[i].result, &changed);
-                }
-                break;
-            }
-            case OP_LABEL: case OP_JUMP: case OP_ERROR: case OP_PRELUDE: case OP_CALL: {
-                // do nothing
-                break;
-            }
-            case '=': case '~': case '!': case OP_PLUS: case OP_MINUS: case OP_ADDRESS: {
-                if (!(hasID(&irs[i].operands[0]) && irs[i].result.temporary_id == irs[i].operands[0].temporary_id)) {
-                    if (irs[i].result.type == OT_TEMPORARY) {
-                        addVariable(&notLive, &irs[i].result, &changed);
-                    } else {
-                        addVariable(&irs[i].liveVars, &irs[i].result, &changed);
-                    }
-                }
-                addVariable(&irs[i].liveVars, &irs[i].operands[0], &changed);
-                break;
-            }
-            case OP_IF_JUMP: case OP_IFN_JUMP: {
-                addVariable(&irs[i].liveVars, &irs[i].operands[0], &changed);
-                break;
+    Liveness liveness;
+    BasicBlockPtrArray_construct(&liveness.blocks);
+    collectBlocks(ir, &liveness.blocks);
+    
+    const u64 block_count = liveness.blocks.count;
+    const u64 words = BITSET_WORDS(temporary_count);
+    BasicBlock **bbs = liveness.blocks.data;
+    liveness.words = words;
+    liveness.live_out = calloc(block_count * words, sizeof(u64));
+    
+    // NOTE(mdizdar): use, def and live_in for every block, one after the other, these are only needed while solving
+    u64 *sets = calloc(block_count * 3 * words, sizeof(u64));
+#define USE(b)      (sets + ((b)*3 + 0) * words)
+#define DEF(b)      (sets + ((b)*3 + 1) * words)
+#define LIVE_IN(b)  (sets + ((b)*3 + 2) * words)
+#define LIVE_OUT(b) (liveness.live_out + (b) * words)
+    
+    for (u64 b = 0; b < block_count; ++b) {
+        u64 *use = USE(b);
+        u64 *def = DEF(b);
+        for (u64 i = bbs[b]->end + 1; i-- > bbs[b]->begin;) {
+            LiveEffect effect = liveEffect(&irs[i]);
+            if (effect.def) {
+                Bitset_set(def, effect.def->temporary_id);
+                Bitset_clear(use, effect.def->temporary_id);
             }
-            default: {
-                if (!((hasID(&irs[i].operands[0]) && irs[i].result.temporary_id == irs[i].operands[0].temporary_id) || (hasID(&irs[i].operands[1]) && irs[i].result.temporary_id == irs[i].operands[1].temporary_id))) {
-                    if (irs[i].result.type == OT_TEMPORARY) {
-                        addVariable(&notLive, &irs[i].result, &changed);
-                    } else {
-                        addVariable(&irs[i].liveVars, &irs[i].result, &changed);
-                    }
-                }
-                addVariable(&irs[i].liveVars, &irs[i].operands[0], &changed);
-                addVariable(&irs[i].liveVars, &irs[i].operands[1], &changed);
-            }
-        }
-        for (ARRAY_EACH(IRVariable, nl, &notLive)) {
-            removeVariable(&irs[i].liveVars, nl, &changed);
+            if (effect.uses[0]) Bitset_set(use, effect.uses[0]->temporary_id);
+            if (effect.uses[1]) Bitset_set(use, effect.uses[1]->temporary_id);
         }
+    }
+    
+    // NOTE(mdizdar): liveness flows backwards, so a block should be visited after its successors, i.e. in postorder.
+    // That's reverse postorder of the reversed CFG, which is what makes this converge in a couple of passes
+    u64 *order = malloc(sizeof(u64) * block_count);
+    postorder(&liveness.blocks, order, NULL);
+    
+    // NOTE(mdizdar): the worklist is a ring buffer, a block is only ever in it once
+    u64 *worklist = malloc(sizeof(u64) * block_count);
+    bool *queued = malloc(sizeof(bool) * block_count);
+    for (u64 i = 0; i < block_count; ++i) {
+        worklist[i] = order[i];
+        queued[i] = true;
+    }
+    u64 head = 0;
+    u64 pending = block_count;
+    while (pending) {
+        const u64 b = worklist[head];
+        head = (head + 1) % block_count;
+        --pending;
+        queued[b] = false;
+        
+        u64 *live_out = LIVE_OUT(b);
+        if (bbs[b]->next) Bitset_unionWith(live_out, LIVE_IN(bbs[b]->next->order), words);
+        if (bbs[b]->jump) Bitset_unionWith(live_out, LIVE_IN(bbs[b]->jump->order), words);
+        if (!liveTransfer(LIVE_IN(b), USE(b), DEF(b), live_out, words)) continue;
         
-        IRVariableArray_clear(liveVars); // this obviously shouldn't stay
-        for (ARRAY_EACH(IRVariable, l, &irs[i].liveVars)) {
-            IRVariableArray_push_ptr(liveVars, l);
+        for (u64 i = 0; i < bbs[b]->in_count; ++i) {
+            const u64 p = bbs[b]->in_blocks[i]->order;
+            if (queued[p]) continue;
+            queued[p] = true;
+            worklist[(head + pending++) % block_count] = p;
         }
     }
-    if (block->loop) return;
-    if (!changed) return;
-    block->livenessDone = true;
-    block->loop = true;
-    IRVariableArray liveCopy;
-    IRVariableArray_construct(&liveCopy);
-    for (ARRAY_EACH(BasicBlockPtr, in_block, block->in_blocks)) {
-        IRVariableArray_copy(&liveCopy, liveVars);
-        livenessAnalysisOneBlock(ir, *in_block, &liveCopy);
-    }
-    block->loop = false;
-    IRVariableArray_destruct(&liveCopy);
+#undef USE
+#undef DEF
+#undef LIVE_IN
+#undef LIVE_OUT
+    
+    free(sets);
+    free(order);
+    free(worklist);
+    free(queued);
+    return liveness;
 }
 
-void livenessAnalysis(IRArray *ir) {
-    IRVariableArray liveVars;
-    IRVariableArray_construct(&liveVars);
-
-    for (ARRAY_EACH_REV(IR, it, ir)) {
-        if (it->block->livenessDone) continue;
-        IRVariableArray_clear(&liveVars);
-        livenessAnalysisOneBlock(ir, it->block, &liveVars);
+void Liveness_ofBlock(const Liveness *liveness, const IRArray *ir, const BasicBlock *block, u64 *sets) {
+    const IR *irs = ir->data;
+    const u64 words = liveness->words;
+    const u64 *live = liveness->live_out + block->order * words;
+    for (u64 i = block->end + 1; i-- > block->begin;) {
+        u64 *before = sets + (i - block->begin) * words;
+        Bitset_copy(before, live, words);
+        Liveness_stepBack(before, &irs[i]);
+        live = before;
     }
+}
 
-    IRVariableArray_destruct(&liveVars);
+void Liveness_destruct(Liveness *liveness) {
+    free(liveness->live_out);
+    BasicBlockPtrArray_destruct(&liveness->blocks);
 }
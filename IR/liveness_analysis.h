@@ -5,10 +5,28 @@
 #include "IR.h"
 #include "basic_block.h"
 
-void addHelper(IRVariableArray *vars, IRVariable *var, bool *changed);
-void addVariable(IRVariableArray *vars, IRVariable *var, bool *changed);
-void removeVariable(IRVariableArray *vars, IRVariable *var, bool *changed);
-void livenessAnalysisOneBlock(IRArray *ir, BasicBlock *block, IRVariableArray *liveVars);
-void livenessAnalysis(IRArray *ir);
+// NOTE(mdizdar): the temporaries an instruction reads and the one it writes, NULL where there isn't one
+typedef struct LiveEffect {
+    const IRVariable *uses[2];
+    const IRVariable *def;
+} LiveEffect;
+
+LiveEffect liveEffect(const IR *ir);
+
+// NOTE(mdizdar): only what's live coming out of every block is kept around, the rest is cheap to get back with a
+// backward scan over the block, so the instructions don't have to carry their own sets
+typedef struct Liveness {
+    BasicBlockPtrArray blocks; // in program order, block->order is the index into this
+    u64 words;                 // per set
+    u64 *live_out;             // words per block
+} Liveness;
+
+// every TemporaryID in ir has to be smaller than temporary_count
+Liveness livenessAnalysis(IRArray *ir, u64 temporary_count);
+// live goes in as what's live right after ir and comes out as what's live right before it
+void Liveness_stepBack(u64 *live, const IR *ir);
+// sets[i - block->begin] ends up with what's live right before instruction i, it needs room for a set per instruction
+void Liveness_ofBlock(const Liveness *liveness, const IRArray *ir, const BasicBlock *block, u64 *sets);
+void Liveness_destruct(Liveness *liveness);
 
 #endif // LIVENESS_ANALYSIS_H
@@ -0,0 +1,104 @@
+#include "loops.h"
+
+static inline bool dominates(const Dominators *dominators, u64 a, u64 b) {
+    // a block's dominators always come before it in reverse postorder
+    while (b != NO_BLOCK && b > a) b = dominators->idom[b];
+    return b == a;
+}
+
+static int compareBlocks(const void *a, const void *b) {
+    const u64 x = *(const u64 *)a;
+    const u64 y = *(const u64 *)b;
+    return (x > y) - (x < y);
+}
+
+Loops loopAnalysis(const Dominators *dominators) {
+    Loops loops;
+    BasicBlock **bbs = dominators->blocks.data;
+    const u64 block_count = dominators->blocks.count;
+
+    loops.count = 0;
+    loops.innermost = malloc(sizeof(u64) * (block_count + 1));
+    loops.header_of = malloc(sizeof(u64) * (block_count + 1));
+    memset(loops.innermost, 0xFF, sizeof(u64) * (block_count + 1));
+    memset(loops.header_of, 0xFF, sizeof(u64) * (block_count + 1));
+    for (u64 b = 0; b < block_count; ++b) {
+        for (u64 j = 0; j < bbs[b]->in_count; ++j) {
+            if (!dominates(dominators, b, bbs[b]->in_blocks[j]->order)) continue;
+            loops.header_of[b] = loops.count++;
+            break;
+        }
+    }
+    loops.header = malloc(sizeof(u64) * (loops.count + 1));
+    loops.parent = malloc(sizeof(u64) * (loops.count + 1));
+    loops.preheader = malloc(sizeof(u64) * (loops.count + 1));
+    loops.body_begin = malloc(sizeof(u64) * (loops.count + 1));
+
+    // NOTE(mdizdar): the body is whatever can get to one of the back edges without going through the header. The
+    // headers go in reverse postorder, so the loops a header is in have all been done by the time it comes up, and
+    // the last of them to claim it is the innermost one
+    u64Array body;
+    u64Array_construct(&body);
+    u64 *stack = malloc(sizeof(u64) * (block_count + 1));
+    u64 *seen = malloc(sizeof(u64) * (block_count + 1));
+    memset(seen, 0xFF, sizeof(u64) * (block_count + 1));
+    for (u64 h = 0; h < block_count; ++h) {
+        const u64 l = loops.header_of[h];
+        if (l == NO_LOOP) continue;
+        loops.header[l] = h;
+        loops.parent[l] = loops.innermost[h];
+        loops.body_begin[l] = body.count;
+        seen[h] = l;
+        u64Array_push_back(&body, h);
+        u64 depth = 0;
+        for (u64 j = 0; j < bbs[h]->in_count; ++j) {
+            const u64 latch = bbs[h]->in_blocks[j]->order;
+            if (seen[latch] == l || !dominates(dominators, h, latch)) continue;
+            seen[latch] = l;
+            stack[depth++] = latch;
+        }
+        while (depth) {
+            const u64 b = stack[--depth];
+            u64Array_push_back(&body, b);
+            for (u64 j = 0; j < bbs[b]->in_count; ++j) {
+                const u64 p = bbs[b]->in_blocks[j]->order;
+                // a predecessor the header doesn't dominate can only be one nobody gets to
+                if (seen[p] == l || !dominates(dominators, h, p)) continue;
+                seen[p] = l;
+                stack[depth++] = p;
+            }
+        }
+        qsort(body.data + loops.body_begin[l], body.count - loops.body_begin[l], sizeof(u64), compareBlocks);
+        for (u64 i = loops.body_begin[l]; i < body.count; ++i) {
+            loops.innermost[body.data[i]] = l;
+        }
+
+        loops.preheader[l] = NO_BLOCK;
+        for (u64 j = 0; j < bbs[h]->in_count; ++j) {
+            const BasicBlock *p = bbs[h]->in_blocks[j];
+            if (seen[p->order] == l) continue;
+            if (loops.preheader[l] != NO_BLOCK && loops.preheader[l] != p->order) {
+                loops.preheader[l] = NO_BLOCK;
+                break;
+            }
+            const bool only_to_header = (!p->next || p->next == bbs[h]) && (!p->jump || p->jump == bbs[h]);
+            if (!only_to_header) break;
+            loops.preheader[l] = p->order;
+        }
+    }
+    loops.body_begin[loops.count] = body.count;
+    loops.body = body.data;
+    free(stack);
+    free(seen);
+    return loops;
+}
+
+void Loops_destruct(Loops *loops) {
+    free(loops->header);
+    free(loops->parent);
+    free(loops->preheader);
+    free(loops->body);
+    free(loops->body_begin);
+    free(loops->innermost);
+    free(loops->header_of);
+}
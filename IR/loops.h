@@ -0,0 +1,33 @@
+#ifndef LOOPS_H
+#define LOOPS_H
+
+#include "IR.h"
+#include "dominators.h"
+
+#define NO_LOOP ((u64)-1)
+
+// NOTE(mdizdar): the natural loops, one for every block that some edge goes back to from a block it dominates. All
+// of the back edges into the same block make up one loop, so loops are either nested or don't share any blocks and
+// this is a forest. They're numbered in the order their headers come in reverse postorder, so a loop always comes
+// after the ones it's nested in. Blocks are their order from the dominators they were found with
+typedef struct Loops {
+    u64 count;
+    u64 *header;     // the block loop l starts at, the only way in from outside
+    u64 *parent;     // the loop l is nested in, NO_LOOP for the outermost ones
+    u64 *preheader;  // the block outside l that's the only one going into it and goes nowhere else, NO_BLOCK if there isn't one
+    u64 *body;       // the blocks of l are body[body_begin[l]..body_begin[l+1]], in reverse postorder so the header is first
+    u64 *body_begin;
+    u64 *innermost;  // innermost[b] is the innermost loop block b is in, NO_LOOP if it isn't in one
+    u64 *header_of;  // header_of[b] is the loop b is the header of, NO_LOOP if it isn't one
+} Loops;
+
+Loops loopAnalysis(const Dominators *dominators);
+void Loops_destruct(Loops *loops);
+
+// whether inner is outer or nested somewhere inside it
+static inline bool Loops_contains(const Loops *loops, u64 outer, u64 inner) {
+    while (inner != NO_LOOP && inner > outer) inner = loops->parent[inner];
+    return inner == outer;
+}
+
+#endif // LOOPS_H
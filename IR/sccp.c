@@ -0,0 +1,557 @@
+#include "sccp.h"
+#include "ssa.h"
+#include "CFG.h"
+#include "../C/symbol_table_entry.h"
+#include "../C/type.h"
+
+extern TemporaryID temporary_index;
+
+#define NO_BLOCK ((u64)-1)
+
+// NOTE(mdizdar): a temporary starts out at top (nothing that writes it has run yet), goes to a constant the first
+// time something does, and to bottom (could be anything) as soon as it could be two different things. It only
+// ever goes down, which is what makes the whole thing stop
+typedef enum {
+    LATTICE_TOP = 0,
+    LATTICE_CONST,
+    LATTICE_BOTTOM,
+} LatticeState;
+
+// bits is 0 for anything that isn't an integer or a pointer, those never get folded
+typedef struct IntType {
+    u8 bits;
+    bool is_signed;
+} IntType;
+
+typedef struct LatticeValue {
+    LatticeState state;
+    IntType type;
+    u64 value; // only the low type.bits bits, the rest are 0
+} LatticeValue;
+
+static const IntType INT_TYPE = { .bits = 16, .is_signed = true };
+static const LatticeValue BOTTOM = { .state = LATTICE_BOTTOM };
+
+// NOTE(mdizdar): these are the sizes Type_sizeof gives on the AVR, and plain char is signed like it is for avr-gcc
+static IntType intTypeOf(const Type *type) {
+    if (type == NULL) return (IntType){ 0 };
+    if (type->pointer_count) return (IntType){ .bits = 16, .is_signed = false };
+    if (type->is_typedef) return intTypeOf(type->typedef_type);
+    if (type->is_struct || type->is_union || type->is_array || type->is_function) return (IntType){ 0 };
+    switch (type->basic_type) {
+        case BASIC_CHAR: case BASIC_SCHAR: return (IntType){ .bits = 8,  .is_signed = true };
+        case BASIC_SSHORT: case BASIC_SINT: return (IntType){ .bits = 16, .is_signed = true };
+        case BASIC_SLONG:                   return (IntType){ .bits = 32, .is_signed = true };
+        case BASIC_SLLONG:                  return (IntType){ .bits = 64, .is_signed = true };
+        case BASIC_UCHAR:                   return (IntType){ .bits = 8,  .is_signed = false };
+        case BASIC_USHORT: case BASIC_UINT: return (IntType){ .bits = 16, .is_signed = false };
+        case BASIC_ULONG:                   return (IntType){ .bits = 32, .is_signed = false };
+        case BASIC_ULLONG:                  return (IntType){ .bits = 64, .is_signed = false };
+        default:                            return (IntType){ 0 };
+    }
+}
+
+static inline u64 truncateTo(u64 value, IntType type) {
+    return type.bits == 64 ? value : value & ((1ull << type.bits) - 1);
+}
+
+// the value as the 64 bit integer it stands for, sign extended if it's signed
+static inline u64 extend(u64 value, IntType type) {
+    if (!type.is_signed || type.bits == 64 || !(value >> (type.bits - 1))) return value;
+    return value | ~((1ull << type.bits) - 1);
+}
+
+static inline LatticeValue constant(IntType type, u64 value) {
+    return (LatticeValue){ .state = LATTICE_CONST, .type = type, .value = truncateTo(value, type) };
+}
+
+static inline LatticeValue convert(LatticeValue value, IntType to) {
+    if (value.state != LATTICE_CONST) return value;
+    if (to.bits == 0) return BOTTOM;
+    return constant(to, extend(value.value, value.type));
+}
+
+// integer promotion, everything narrower than an int becomes one, which can hold any of their values
+static inline IntType promote(IntType type) {
+    return type.bits < INT_TYPE.bits ? INT_TYPE : type;
+}
+
+// NOTE(mdizdar): the usual arithmetic conversions. When the widths differ the wider one can hold all of the other's
+// values even if it's signed, so it always wins, and when they're the same unsigned wins
+static inline IntType common(IntType a, IntType b) {
+    a = promote(a);
+    b = promote(b);
+    if (a.bits != b.bits) return a.bits > b.bits ? a : b;
+    return (IntType){ .bits = a.bits, .is_signed = a.is_signed && b.is_signed };
+}
+
+// NOTE(mdizdar): a literal is the type IR_generate or literalOf gave it, the rank in its OT_INT* and the signedness in
+// is_unsigned. The ones the other passes make up are signed ints that can go past 16 bits or be negative 64 bit values,
+// those become the first signed type they fit in
+static LatticeValue literal(const IRVariable *var) {
+    u8 bits;
+    switch (var->type) {
+        case OT_INT8:  bits = 8;  break;
+        case OT_INT16: bits = 16; break;
+        case OT_INT32: bits = 32; break;
+        case OT_INT64: bits = 64; break;
+        default:       return BOTTOM;
+    }
+    if (bits < 64 && var->integer_value >> bits) {
+        while (bits < 64 && (s64)var->integer_value >> (bits - 1) != 0 && (s64)var->integer_value >> (bits - 1) != -1) bits *= 2;
+        return constant((IntType){ .bits = bits, .is_signed = true }, var->integer_value);
+    }
+    return constant((IntType){ .bits = bits, .is_signed = !var->is_unsigned }, var->integer_value);
+}
+
+static IRVariable literalOf(LatticeValue value) {
+    OperandType type;
+    switch (value.type.bits) {
+        case 8:  type = OT_INT8;  break;
+        case 16: type = OT_INT16; break;
+        case 32: type = OT_INT32; break;
+        default: type = OT_INT64; break;
+    }
+    return (IRVariable){ .type = type, .integer_value = value.value, .is_unsigned = !value.type.is_signed };
+}
+
+static bool foldUnary(Op op, LatticeValue a, LatticeValue *out) {
+    const IntType type = promote(a.type);
+    const u64 x = extend(a.value, a.type);
+    switch ((int)op) {
+        case OP_PLUS: *out = constant(type, x);        return true;
+        case OP_MINUS: *out = constant(type, -x);      return true;
+        case '~': *out = constant(type, ~x);           return true;
+        case '!': *out = constant(INT_TYPE, x == 0);   return true;
+        default: return false;
+    }
+}
+
+// NOTE(mdizdar): everything gets done on 64 bit unsigned values and cut down to the width of the type at the end, which
+// is the right answer for anything that doesn't overflow a signed type, and for the ones that do C doesn't say.
+// Division by zero and shifting by more than the width is left alone for the program to trip over at runtime
+static bool foldBinary(Op op, LatticeValue a, LatticeValue b, LatticeValue *out) {
+    switch ((int)op) {
+        case OP_LOGICAL_AND: *out = constant(INT_TYPE, a.value != 0 && b.value != 0); return true;
+        case OP_LOGICAL_OR:  *out = constant(INT_TYPE, a.value != 0 || b.value != 0); return true;
+        case OP_BITSHIFT_LEFT: case OP_BITSHIFT_RIGHT: {
+            const IntType type = promote(a.type);
+            const s64 count = (s64)extend(b.value, b.type);
+            if (count < 0 || count >= type.bits) return false;
+            const u64 x = extend(a.value, a.type);
+            if (op == OP_BITSHIFT_LEFT) {
+                *out = constant(type, x << count);
+            } else {
+                // NOTE(mdizdar): shifting a negative value right is implementation defined, avr-gcc shifts the sign in
+                *out = constant(type, type.is_signed ? (u64)((s64)x >> count) : x >> count);
+            }
+            return true;
+        }
+        default: break;
+    }
+    const IntType type = common(a.type, b.type);
+    const u64 x = truncateTo(extend(a.value, a.type), type);
+    const u64 y = truncateTo(extend(b.value, b.type), type);
+    const s64 sx = (s64)extend(x, type);
+    const s64 sy = (s64)extend(y, type);
+    switch ((int)op) {
+        case '+': *out = constant(type, x + y); return true;
+        case '-': *out = constant(type, x - y); return true;
+        case '*': *out = constant(type, x * y); return true;
+        case '&': *out = constant(type, x & y); return true;
+        case '|': *out = constant(type, x | y); return true;
+        case '^': *out = constant(type, x ^ y); return true;
+        case '/': case '%': {
+            if (y == 0) return false;
+            if (type.is_signed) {
+                if (sx == INT64_MIN && sy == -1) return false;
+                *out = constant(type, op == '/' ? (u64)(sx / sy) : (u64)(sx % sy));
+            } else {
+                *out = constant(type, op == '/' ? x / y : x % y);
+            }
+            return true;
+        }
+        case '<':             *out = constant(INT_TYPE, type.is_signed ? sx < sy  : x < y);  return true;
+        case '>':             *out = constant(INT_TYPE, type.is_signed ? sx > sy  : x > y);  return true;
+        case OP_LESS_EQ:      *out = constant(INT_TYPE, type.is_signed ? sx <= sy : x <= y); return true;
+        case OP_GREATER_EQ:   *out = constant(INT_TYPE, type.is_signed ? sx >= sy : x >= y); return true;
+        case OP_EQUALS:       *out = constant(INT_TYPE, x == y); return true;
+        case OP_NOT_EQ:       *out = constant(INT_TYPE, x != y); return true;
+        default: return false;
+    }
+}
+
+typedef struct Sccp {
+    IR *irs;
+    BasicBlock **blocks;
+    LatticeValue *values;    // one per temporary
+    u64 *use_begin;          // the instructions reading temporary t are uses[use_begin[t]..use_begin[t+1]]
+    u64 *uses;
+    u64 *label_block;        // which block an unnamed label starts, for finding where a phi's operand comes from
+    u64 label_count;
+    bool *reached;           // per block
+    bool *next_taken;        // per block, whether falling through/jumping out of it can ever happen
+    bool *jump_taken;
+    u64Array block_worklist; // blocks that just got an edge into them
+    u64Array use_worklist;   // instructions that read something that just changed
+} Sccp;
+
+static inline LatticeValue valueOf(const Sccp *s, const IRVariable *var) {
+    if (var->type == OT_TEMPORARY || var->type == OT_PHI_VAR) return s->values[var->temporary_id];
+    return literal(var);
+}
+
+static inline const BasicBlock *predecessorOf(const Sccp *s, const IRVariable *phi_value) {
+    if (phi_value->label_index >= s->label_count || s->label_block[phi_value->label_index] == NO_BLOCK) {
+        error(0, "phi from label %lu which doesn't exist", phi_value->label_index);
+    }
+    return s->blocks[s->label_block[phi_value->label_index]];
+}
+
+static inline bool edgeTaken(const Sccp *s, const BasicBlock *from, const BasicBlock *to) {
+    return (from->next == to && s->next_taken[from->order]) || (from->jump == to && s->jump_taken[from->order]);
+}
+
+static void takeEdge(Sccp *s, u64 from, bool jump) {
+    bool *taken = jump ? &s->jump_taken[from] : &s->next_taken[from];
+    BasicBlock *to = jump ? s->blocks[from]->jump : s->blocks[from]->next;
+    if (*taken || to == NULL) return;
+    *taken = true;
+    u64Array_push_back(&s->block_worklist, to->order);
+}
+
+static void lower(Sccp *s, const IRVariable *var, LatticeValue value) {
+    if (var->entry) value = convert(value, intTypeOf(((SymbolTableEntry *)var->entry)->type));
+    LatticeValue *current = &s->values[var->temporary_id];
+    if (value.state == LATTICE_TOP || current->state == LATTICE_BOTTOM) return;
+    if (current->state == LATTICE_CONST) {
+        if (value.state == LATTICE_CONST && value.value == current->value) return;
+        value = BOTTOM;
+    }
+    *current = value;
+    for (u64 u = s->use_begin[var->temporary_id]; u < s->use_begin[var->temporary_id + 1]; ++u) {
+        u64Array_push_back(&s->use_worklist, s->uses[u]);
+    }
+}
+
+// NOTE(mdizdar): whatever writes an operand dominates the instruction reading it, so it's always been looked at by the
+// time the reader is. The only way an operand can still be top is if it's read before it's ever written (a variable
+// that's used uninitialized), and that can't be allowed to turn into a constant once the write shows up
+static LatticeValue operandValue(Sccp *s, const IRVariable *var) {
+    if (var->type == OT_TEMPORARY && s->values[var->temporary_id].state == LATTICE_TOP) lower(s, var, BOTTOM);
+    return valueOf(s, var);
+}
+
+static LatticeValue meet(LatticeValue a, LatticeValue b) {
+    if (a.state == LATTICE_TOP || b.state == LATTICE_BOTTOM) return b;
+    if (b.state == LATTICE_TOP || a.state == LATTICE_BOTTOM) return a;
+    const IntType type = a.type.bits == b.type.bits && a.type.is_signed == b.type.is_signed ? a.type : common(a.type, b.type);
+    a = convert(a, type);
+    b = convert(b, type);
+    return a.value == b.value ? a : BOTTOM;
+}
+
+static LatticeValue evaluate(Sccp *s, const IR *it) {
+    if (it->instruction == OP_PHI) {
+        LatticeValue result = { .state = LATTICE_TOP };
+        for (u64 k = 0; k < it->phi->count; ++k) {
+            const IRVariable *value = &it->phi->values[k];
+            if (!edgeTaken(s, predecessorOf(s, value), it->block)) continue;
+            result = meet(result, valueOf(s, value));
+        }
+        return result;
+    }
+    switch ((int)it->instruction) {
+        case '=': {
+            const LatticeValue a = operandValue(s, &it->operands[0]);
+            return a.state == LATTICE_CONST && a.type.bits == 0 ? BOTTOM : a;
+        }
+        case '~': case '!': case OP_PLUS: case OP_MINUS: {
+            const LatticeValue a = operandValue(s, &it->operands[0]);
+            if (a.state != LATTICE_CONST) return a;
+            LatticeValue result;
+            return foldUnary(it->instruction, a, &result) ? result : BOTTOM;
+        }
+        case '+': case '-': case '*': case '/': case '%':
+        case '&': case '|': case '^':
+        case '<': case '>': case OP_LESS_EQ: case OP_GREATER_EQ: case OP_EQUALS: case OP_NOT_EQ:
+        case OP_LOGICAL_AND: case OP_LOGICAL_OR:
+        case OP_BITSHIFT_LEFT: case OP_BITSHIFT_RIGHT: {
+            const LatticeValue a = operandValue(s, &it->operands[0]);
+            const LatticeValue b = operandValue(s, &it->operands[1]);
+            if (a.state == LATTICE_BOTTOM || b.state == LATTICE_BOTTOM) return BOTTOM;
+            if (a.state == LATTICE_TOP || b.state == LATTICE_TOP) return (LatticeValue){ .state = LATTICE_TOP };
+            LatticeValue result;
+            return foldBinary(it->instruction, a, b, &result) ? result : BOTTOM;
+        }
+        default: {
+            return BOTTOM;
+        }
+    }
+}
+
+static void visit(Sccp *s, u64 i) {
+    IR *it = &s->irs[i];
+    const u64 b = it->block->order;
+    if (it->instruction == OP_IF_JUMP || it->instruction == OP_IFN_JUMP) {
+        const LatticeValue condition = operandValue(s, &it->operands[0]);
+        if (condition.state == LATTICE_CONST) {
+            takeEdge(s, b, (condition.value != 0) == (it->instruction == OP_IF_JUMP));
+        } else if (condition.state == LATTICE_BOTTOM) {
+            takeEdge(s, b, false);
+            takeEdge(s, b, true);
+        }
+        return;
+    }
+    if (it->instruction == OP_PHI) {
+        lower(s, &it->result, evaluate(s, it));
+    } else {
+        IRVariable *written = writtenBy(it);
+        if (written) lower(s, written, evaluate(s, it));
+    }
+    if (i == s->blocks[b]->end) {
+        takeEdge(s, b, false);
+        takeEdge(s, b, true);
+    }
+}
+
+// NOTE(mdizdar): IR2AVR can only compare a register to a literal and not the other way around, and a literal doesn't
+// have an address
+static inline bool takesLiteral(const IR *ir, u64 k) {
+    switch ((int)ir->instruction) {
+        case '<': case '>': case OP_EQUALS: return k == 1;
+        case OP_ADDRESS: return false;
+        default: return true;
+    }
+}
+
+// returns false if what's left of the phi is a plain assignment, which it turns it into
+static bool rewritePhi(const Sccp *s, IR *it) {
+    const LatticeValue result = s->values[it->result.temporary_id];
+    if (result.state == LATTICE_CONST) {
+        *it = (IR){ .instruction = '=', .result = it->result, .operands[0] = literalOf(result) };
+        return false;
+    }
+    u64 kept = 0;
+    for (u64 k = 0; k < it->phi->count; ++k) {
+        IRVariable value = it->phi->values[k];
+        if (!edgeTaken(s, predecessorOf(s, &value), it->block)) continue;
+        const LatticeValue known = s->values[value.temporary_id];
+        if (known.state == LATTICE_CONST) {
+            const LabelID label = value.label_index;
+            value = literalOf(known);
+            value.label_index = label;
+        }
+        it->phi->values[kept++] = value;
+    }
+    it->phi->count = kept;
+    if (kept != 1) return true;
+    IRVariable source = it->phi->values[0];
+    if (source.type == OT_PHI_VAR) {
+        source = (IRVariable){ .type = OT_TEMPORARY, .entry = source.entry, .temporary_id = source.temporary_id };
+    } else {
+        source = (IRVariable){ .type = source.type, .integer_value = source.integer_value };
+    }
+    *it = (IR){ .instruction = '=', .result = it->result, .operands[0] = source };
+    return false;
+}
+
+// returns false if the instruction should go, which only happens to branches that are never taken
+static bool rewriteInstruction(const Sccp *s, IR *it) {
+    for (u64 k = 0; k < 2; ++k) {
+        if (!readsOperand(it, k) || !takesLiteral(it, k)) continue;
+        const LatticeValue known = s->values[it->operands[k].temporary_id];
+        if (known.state == LATTICE_CONST) it->operands[k] = literalOf(known);
+    }
+    switch ((int)it->instruction) {
+        case OP_IF_JUMP: case OP_IFN_JUMP: {
+            const LatticeValue condition = valueOf(s, &it->operands[0]);
+            if (condition.state != LATTICE_CONST) return true;
+            if ((condition.value != 0) != (it->instruction == OP_IF_JUMP)) return false;
+            *it = (IR){ .instruction = OP_JUMP, .operands[0] = it->operands[1] };
+            return true;
+        }
+        case OP_RETURN: {
+            it->result = it->operands[0];
+            return true;
+        }
+        case OP_DEREF: {
+            if (it->result.type == OT_REFERENCE) *it->result.pointer.reference_var = it->operands[0];
+            return true;
+        }
+        default: {
+            IRVariable *written = writtenBy(it);
+            if (!written || written != &it->result) return true;
+            const LatticeValue known = s->values[written->temporary_id];
+            if (known.state == LATTICE_CONST) {
+                *it = (IR){ .instruction = '=', .result = *written, .operands[0] = literalOf(known) };
+            }
+            return true;
+        }
+    }
+}
+
+// NOTE(mdizdar): two worklists, one of blocks that just became reachable (or got another way in, in which case only
+// their phis need another look) and one of instructions whose operands just changed. Every edge gets taken and every
+// temporary lowered at most twice, so it's linear in the size of the IR. Anything that isn't in SSA form (globals, things
+// that have their address taken) or gets its value from memory, a call or an argument is just bottom from the start
+void IR_propagateConstants(IRArray *ir, LabelArray *labels) {
+    const u64 count = ir->count;
+    if (count == 0) return;
+    IR *irs = ir->data;
+    const TemporaryID temporary_count = temporary_index;
+
+    makeBasicBlocks(ir, labels);
+    BasicBlockPtrArray blocks;
+    BasicBlockPtrArray_construct(&blocks);
+    collectBlocks(ir, &blocks);
+    const u64 block_count = blocks.count;
+
+    Sccp s = {
+        .irs = irs,
+        .blocks = blocks.data,
+        .values = calloc(temporary_count, sizeof(LatticeValue)),
+        .use_begin = calloc(temporary_count + 2, sizeof(u64)),
+        .reached = calloc(block_count, sizeof(bool)),
+        .next_taken = calloc(block_count, sizeof(bool)),
+        .jump_taken = calloc(block_count, sizeof(bool)),
+    };
+    u64Array_construct(&s.block_worklist);
+    u64Array_construct(&s.use_worklist);
+
+    for (ARRAY_EACH(Label, label, labels)) {
+        if (!label->named) s.label_count = max(s.label_count, label->label_index + 1);
+    }
+    s.label_block = malloc(sizeof(u64) * (s.label_count + 1));
+    memset(s.label_block, 0xFF, sizeof(u64) * (s.label_count + 1));
+    for (ARRAY_EACH(Label, label, labels)) {
+        if (!label->named) s.label_block[label->label_index] = irs[label->ir_index].block->order;
+    }
+
+    // only something written exactly once can be a constant
+    u64 *writes = calloc(temporary_count, sizeof(u64));
+    u64 use_count = 0;
+    for (u64 i = 0; i < count; ++i) {
+        IR *it = &irs[i];
+        IRVariable *written = it->instruction == OP_PHI ? &it->result : writtenBy(it);
+        if (written) {
+            ++writes[written->temporary_id];
+            SymbolTableEntry *entry = (SymbolTableEntry *)written->entry;
+            if (entry && entry->location_in_memory.global) writes[written->temporary_id] = 2;
+        }
+        if (it->instruction == OP_ADDRESS && it->operands[0].type == OT_TEMPORARY) {
+            writes[it->operands[0].temporary_id] = 2;
+        }
+        if (it->instruction == OP_PHI) {
+            for (u64 k = 0; k < it->phi->count; ++k) {
+                if (it->phi->values[k].type != OT_PHI_VAR) continue;
+                ++s.use_begin[it->phi->values[k].temporary_id + 2];
+                ++use_count;
+            }
+        }
+        for (u64 k = 0; k < 2; ++k) {
+            if (!readsOperand(it, k)) continue;
+            ++s.use_begin[it->operands[k].temporary_id + 2];
+            ++use_count;
+        }
+    }
+    for (TemporaryID t = 0; t < temporary_count; ++t) {
+        if (writes[t] != 1) s.values[t] = BOTTOM;
+    }
+    free(writes);
+    for (TemporaryID t = 2; t < temporary_count + 2; ++t) {
+        s.use_begin[t] += s.use_begin[t-1];
+    }
+    s.uses = malloc(sizeof(u64) * (use_count + 1));
+    for (u64 i = 0; i < count; ++i) {
+        const IR *it = &irs[i];
+        if (it->instruction == OP_PHI) {
+            for (u64 k = 0; k < it->phi->count; ++k) {
+                if (it->phi->values[k].type != OT_PHI_VAR) continue;
+                s.uses[s.use_begin[it->phi->values[k].temporary_id + 1]++] = i;
+            }
+        }
+        for (u64 k = 0; k < 2; ++k) {
+            if (!readsOperand(it, k)) continue;
+            s.uses[s.use_begin[it->operands[k].temporary_id + 1]++] = i;
+        }
+    }
+
+    for (u64 b = 0; b < block_count; ++b) {
+        // NOTE(mdizdar): every function starts with its name, and __start jumps back to itself so it has a way in
+        const IR *first = &irs[s.blocks[b]->begin];
+        if (s.blocks[b]->in_count == 0 || (first->instruction == OP_LABEL && first->operands[0].named)) {
+            u64Array_push_back(&s.block_worklist, b);
+        }
+    }
+    while (s.block_worklist.count || s.use_worklist.count) {
+        while (s.block_worklist.count) {
+            const u64 b = s.block_worklist.data[--s.block_worklist.count];
+            const BasicBlock *block = s.blocks[b];
+            if (!s.reached[b]) {
+                s.reached[b] = true;
+                for (u64 i = block->begin; i <= block->end; ++i) {
+                    visit(&s, i);
+                }
+            } else {
+                for (u64 i = block->begin; i <= block->end && (irs[i].instruction == OP_LABEL || irs[i].instruction == OP_PHI); ++i) {
+                    if (irs[i].instruction == OP_PHI) visit(&s, i);
+                }
+            }
+        }
+        while (s.use_worklist.count && !s.block_worklist.count) {
+            const u64 i = s.use_worklist.data[--s.use_worklist.count];
+            if (s.reached[irs[i].block->order]) visit(&s, i);
+        }
+    }
+
+    // NOTE(mdizdar): the phis that turn into assignments wait until the block's phis are done, so the ones that are
+    // left stay together at the top
+    IRArray new_ir;
+    IRArray_construct(&new_ir);
+    IRArray_reserve(&new_ir, count);
+    IRArray settled;
+    IRArray_construct(&settled);
+    for (u64 b = 0; b < block_count; ++b) {
+        if (!s.reached[b]) continue;
+        for (u64 i = s.blocks[b]->begin; i <= s.blocks[b]->end; ++i) {
+            IR it = irs[i];
+            if (it.instruction == OP_PHI) {
+                IRArray_push_ptr(rewritePhi(&s, &it) ? &new_ir : &settled, &it);
+                continue;
+            }
+            if (it.instruction != OP_LABEL && settled.count) {
+                for (ARRAY_EACH(IR, assignment, &settled)) {
+                    IRArray_push_ptr(&new_ir, assignment);
+                }
+                IRArray_clear(&settled);
+            }
+            if (rewriteInstruction(&s, &it)) IRArray_push_ptr(&new_ir, &it);
+        }
+        for (ARRAY_EACH(IR, assignment, &settled)) {
+            IRArray_push_ptr(&new_ir, assignment);
+        }
+        IRArray_clear(&settled);
+    }
+    for (ARRAY_EACH(IR, it, &new_ir)) {
+        it->block = NULL;
+    }
+
+    IRArray_destruct(&settled);
+    u64Array_destruct(&s.block_worklist);
+    u64Array_destruct(&s.use_worklist);
+    free(s.values);
+    free(s.use_begin);
+    free(s.uses);
+    free(s.label_block);
+    free(s.reached);
+    free(s.next_taken);
+    free(s.jump_taken);
+    BasicBlockPtrArray_destruct(&blocks);
+    IRArray_destruct(ir);
+    *ir = new_ir;
+    LabelArray_destruct(labels);
+    *labels = findLabels(ir);
+}
+
+#undef NO_BLOCK
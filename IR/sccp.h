@@ -0,0 +1,14 @@
+#ifndef SCCP_H
+#define SCCP_H
+
+#include "IR.h"
+#include "label.h"
+
+// NOTE(mdizdar): Wegman and Zadeck's sparse conditional constant propagation, it has to run on the IR that
+// IR_constructSSA made, phis and all. Every temporary that's known to hold a constant gets its uses replaced with
+// the literal (wherever IR2AVR can take one), anything computing a constant becomes an assignment of it, branches
+// on constants become jumps or go away, and so do the blocks nobody can reach anymore along with the phi operands
+// coming from them. Folding is done at the widths the types have on the AVR, so the types can't be freed before this
+void IR_propagateConstants(IRArray *ir, LabelArray *labels);
+
+#endif // SCCP_H
@@ -0,0 +1,342 @@
+#include "ssa.h"
+#include "CFG.h"
+#include "dominators.h"
+#include "../C/symbol_table_entry.h"
+#include "../C/type.h"
+
+extern TemporaryID temporary_index;
+extern LabelID label_index;
+
+#define NO_VARIABLE ((u64)-1)
+
+void findWriters(IRArray *ir, u64 *def_of, bool *pinned) {
+    IR *irs = ir->data;
+    memset(def_of, 0xFF, sizeof(u64) * temporary_index);
+    memset(pinned, 0, sizeof(bool) * temporary_index);
+    for (u64 i = 0; i < ir->count; ++i) {
+        IR *it = &irs[i];
+        if (it->instruction == OP_ADDRESS && it->operands[0].type == OT_TEMPORARY) {
+            pinned[it->operands[0].temporary_id] = true;
+        }
+        IRVariable *written;
+        if (it->instruction == OP_PHI) {
+            written = &it->result;
+        } else if (it->instruction == OP_DEREF) {
+            written = it->result.type == OT_REFERENCE ? &it->result : NULL;
+        } else {
+            written = writtenBy(it);
+        }
+        if (!written) continue;
+        u64 *def = &def_of[written->temporary_id];
+        *def = *def == NO_INSTRUCTION ? i : MANY_INSTRUCTIONS;
+        if (*def == MANY_INSTRUCTIONS) pinned[written->temporary_id] = true;
+        SymbolTableEntry *entry = (SymbolTableEntry *)written->entry;
+        if (!entry) continue;
+        if (entry->location_in_memory.global) pinned[written->temporary_id] = true;
+        const Type *type = entry->type;
+        if (type && (type->is_volatile & TYPE_QUALIFIER(type->pointer_count))) pinned[written->temporary_id] = true;
+    }
+}
+
+typedef struct PlacedPhi {
+    u64 block;
+    u64 variable;
+} PlacedPhi;
+
+_generate_dynamic_array(PlacedPhi);
+
+// NOTE(mdizdar): the usual Cytron et al. construction on top of the dominator tree:
+//   1. a variable needs a phi in the iterated dominance frontier of the blocks that write it. Only the ones that are
+//      read in some block before that block writes them are bothered with (Briggs' semi-pruned SSA), the rest can't
+//      be live going into a join anyway
+//   2. walking down the dominator tree, every write gets a new temporary and every read gets whichever one is on top
+//      for its variable, and on the way out of each block its successors' phis get their operand from it
+//   3. the phis and the labels they need go into the IR in one pass
+void IR_constructSSA(IRArray *ir, LabelArray *labels, Arena *arena) {
+    const u64 count = ir->count;
+    if (count == 0) return;
+    IR *irs = ir->data;
+    
+    makeBasicBlocks(ir, labels);
+    Dominators dominators = dominatorAnalysis(ir);
+    BasicBlock **bbs = dominators.blocks.data;
+    const u64 block_count = dominators.blocks.count;
+    const TemporaryID temporary_count = temporary_index;
+    
+    // which temporaries are variables. Anything written only once already is what it would become
+    u64 *variable_of = calloc(temporary_count, sizeof(u64));
+    bool *pinned = calloc(temporary_count, sizeof(bool));
+    for (u64 i = 0; i < count; ++i) {
+        IRVariable *written = writtenBy(&irs[i]);
+        if (written) {
+            ++variable_of[written->temporary_id];
+            SymbolTableEntry *entry = (SymbolTableEntry *)written->entry;
+            if (entry && entry->location_in_memory.global) pinned[written->temporary_id] = true;
+        }
+        if (irs[i].instruction == OP_ADDRESS && irs[i].operands[0].type == OT_TEMPORARY) {
+            pinned[irs[i].operands[0].temporary_id] = true;
+        }
+    }
+    u64 variable_count = 0;
+    for (u64 t = 0; t < temporary_count; ++t) {
+        variable_of[t] = variable_of[t] > 1 && !pinned[t] ? variable_count++ : NO_VARIABLE;
+    }
+    free(pinned);
+    if (variable_count == 0) {
+        free(variable_of);
+        Dominators_destruct(&dominators);
+        return;
+    }
+    
+    u64 *home = malloc(sizeof(u64) * variable_count);
+    uintptr_t *entry_of = calloc(variable_count, sizeof(uintptr_t));
+    bool *crosses_blocks = calloc(variable_count, sizeof(bool));
+    u64 *def_begin = calloc(variable_count + 2, sizeof(u64));
+    u64 *written_in = malloc(sizeof(u64) * variable_count);
+    memset(written_in, 0xFF, sizeof(u64) * variable_count);
+    u64 write_count = 0;
+    for (u64 b = 0; b < block_count; ++b) {
+        for (u64 i = bbs[b]->begin; i <= bbs[b]->end; ++i) {
+            for (u64 k = 0; k < 2; ++k) {
+                if (!readsOperand(&irs[i], k)) continue;
+                const u64 v = variable_of[irs[i].operands[k].temporary_id];
+                if (v != NO_VARIABLE && written_in[v] != b) crosses_blocks[v] = true;
+            }
+            IRVariable *written = writtenBy(&irs[i]);
+            if (!written) continue;
+            const u64 v = variable_of[written->temporary_id];
+            if (v == NO_VARIABLE) continue;
+            home[v] = written->temporary_id;
+            if (written->entry) entry_of[v] = written->entry;
+            written_in[v] = b;
+            ++def_begin[v + 2];
+            ++write_count;
+        }
+    }
+    for (u64 v = 2; v < variable_count + 2; ++v) {
+        def_begin[v] += def_begin[v-1];
+    }
+    u64 *def_blocks = malloc(sizeof(u64) * write_count);
+    for (u64 b = 0; b < block_count; ++b) {
+        for (u64 i = bbs[b]->begin; i <= bbs[b]->end; ++i) {
+            IRVariable *written = writtenBy(&irs[i]);
+            if (!written || variable_of[written->temporary_id] == NO_VARIABLE) continue;
+            def_blocks[def_begin[variable_of[written->temporary_id] + 1]++] = b;
+        }
+    }
+    // now the blocks that write v are def_blocks[def_begin[v]..def_begin[v+1]]
+    free(written_in);
+    
+    // 1. placing the phis
+    PlacedPhiArray placed;
+    PlacedPhiArray_construct(&placed);
+    u64 *has_phi = malloc(sizeof(u64) * block_count);
+    u64 *queued = malloc(sizeof(u64) * block_count);
+    u64 *worklist = malloc(sizeof(u64) * block_count);
+    memset(has_phi, 0xFF, sizeof(u64) * block_count);
+    memset(queued, 0xFF, sizeof(u64) * block_count);
+    for (u64 v = 0; v < variable_count; ++v) {
+        if (!crosses_blocks[v]) continue;
+        u64 pending = 0;
+        for (u64 d = def_begin[v]; d < def_begin[v+1]; ++d) {
+            if (queued[def_blocks[d]] == v) continue;
+            queued[def_blocks[d]] = v;
+            worklist[pending++] = def_blocks[d];
+        }
+        while (pending) {
+            const u64 x = worklist[--pending];
+            for (u64 f = dominators.frontier_begin[x]; f < dominators.frontier_begin[x+1]; ++f) {
+                const u64 y = dominators.frontier[f];
+                if (has_phi[y] == v) continue;
+                has_phi[y] = v;
+                PlacedPhiArray_push_back(&placed, (PlacedPhi){ .block = y, .variable = v });
+                if (queued[y] == v) continue;
+                queued[y] = v;
+                worklist[pending++] = y;
+            }
+        }
+    }
+    free(has_phi);
+    free(queued);
+    free(worklist);
+    free(crosses_blocks);
+    free(def_blocks);
+    free(def_begin);
+    
+    // every block's phis next to each other, the ones for block b are phis[phi_begin[b]..phi_begin[b+1]]
+    const u64 phi_count = placed.count;
+    u64 *phi_begin = calloc(block_count + 2, sizeof(u64));
+    for (ARRAY_EACH(PlacedPhi, it, &placed)) {
+        ++phi_begin[it->block + 2];
+    }
+    for (u64 b = 2; b < block_count + 2; ++b) {
+        phi_begin[b] += phi_begin[b-1];
+    }
+    IR *phis = malloc(sizeof(IR) * (phi_count + 1));
+    u64 *phi_variable = malloc(sizeof(u64) * (phi_count + 1));
+    for (ARRAY_EACH(PlacedPhi, it, &placed)) {
+        const u64 p = phi_begin[it->block + 1]++;
+        const BasicBlock *block = bbs[it->block];
+        PhiOperands *operands = Arena_alloc(arena, sizeof(PhiOperands) + sizeof(IRVariable) * block->in_count);
+        operands->count = block->in_count;
+        for (u64 k = 0; k < block->in_count; ++k) {
+            operands->values[k] = (IRVariable){
+                .type = OT_PHI_VAR,
+                .entry = entry_of[it->variable],
+                .temporary_id = home[it->variable],
+                .named = false,
+            };
+        }
+        phis[p] = (IR){
+            .instruction = OP_PHI,
+            .result = {
+                .type = OT_TEMPORARY,
+                .entry = entry_of[it->variable],
+            },
+            .phi = operands,
+        };
+        phi_variable[p] = it->variable;
+    }
+    PlacedPhiArray_destruct(&placed);
+    
+    // NOTE(mdizdar): the phi operands say where they come from with the label of the block, the ones that don't
+    // start with one get a new label
+    u64 *new_label = malloc(sizeof(u64) * block_count);
+    memset(new_label, 0xFF, sizeof(u64) * block_count);
+    
+    // 2. renaming. current[v] is v's temporary at this point of the walk, and every time it changes the old one goes on
+    // the log, so leaving a block is just undoing the log back to where it was when we came in
+    u64 *current = malloc(sizeof(u64) * variable_count);
+    memcpy(current, home, sizeof(u64) * variable_count);
+    u64 *log_variable = malloc(sizeof(u64) * (write_count + phi_count + 1));
+    u64 *log_temporary = malloc(sizeof(u64) * (write_count + phi_count + 1));
+    u64 log_count = 0;
+    u64 *stack = malloc(sizeof(u64) * block_count);
+    u64 *next_child = malloc(sizeof(u64) * block_count);
+    u64 *log_mark = malloc(sizeof(u64) * block_count);
+    
+    for (u64 root = 0; root < block_count; ++root) {
+        if (dominators.idom[root] != NO_BLOCK) continue;
+        u64 depth = 0;
+        stack[depth++] = root;
+        next_child[root] = dominators.child_begin[root];
+        log_mark[root] = NO_BLOCK;
+        while (depth) {
+            const u64 b = stack[depth-1];
+            if (log_mark[b] == NO_BLOCK) {
+                // coming into b
+                log_mark[b] = log_count;
+                for (u64 p = phi_begin[b]; p < phi_begin[b+1]; ++p) {
+                    const u64 v = phi_variable[p];
+                    log_variable[log_count] = v;
+                    log_temporary[log_count++] = current[v];
+                    current[v] = phis[p].result.temporary_id = temporary_index++;
+                }
+                for (u64 i = bbs[b]->begin; i <= bbs[b]->end; ++i) {
+                    IR *it = &irs[i];
+                    for (u64 k = 0; k < 2; ++k) {
+                        if (!readsOperand(it, k)) continue;
+                        const u64 v = variable_of[it->operands[k].temporary_id];
+                        if (v != NO_VARIABLE) it->operands[k].temporary_id = current[v];
+                    }
+                    if (it->instruction == OP_DEREF && it->result.type == OT_REFERENCE) {
+                        *it->result.pointer.reference_var = it->operands[0];
+                    } else if (it->instruction == OP_RETURN) {
+                        it->result = it->operands[0];
+                    }
+                    IRVariable *written = writtenBy(it);
+                    if (!written || variable_of[written->temporary_id] == NO_VARIABLE) continue;
+                    const u64 v = variable_of[written->temporary_id];
+                    log_variable[log_count] = v;
+                    log_temporary[log_count++] = current[v];
+                    current[v] = written->temporary_id = temporary_index++;
+                }
+                BasicBlock *successors[2] = { bbs[b]->next, bbs[b]->jump };
+                for (u64 s = 0; s < 2; ++s) {
+                    if (!successors[s]) continue;
+                    const u64 to = successors[s]->order;
+                    if (phi_begin[to] == phi_begin[to+1]) continue;
+                    u64 k = 0;
+                    while (successors[s]->in_blocks[k] != bbs[b]) ++k;
+                    if (irs[bbs[b]->begin].instruction == OP_LABEL && !irs[bbs[b]->begin].operands[0].named) {
+                        new_label[b] = irs[bbs[b]->begin].operands[0].label_index;
+                    } else if (new_label[b] == NO_BLOCK) {
+                        new_label[b] = label_index++;
+                    }
+                    for (u64 p = phi_begin[to]; p < phi_begin[to+1]; ++p) {
+                        IRVariable *value = &phis[p].phi->values[k];
+                        value->temporary_id = current[phi_variable[p]];
+                        value->label_index = new_label[b];
+                    }
+                }
+            }
+            if (next_child[b] < dominators.child_begin[b+1]) {
+                const u64 child = dominators.children[next_child[b]++];
+                next_child[child] = dominators.child_begin[child];
+                log_mark[child] = NO_BLOCK;
+                stack[depth++] = child;
+                continue;
+            }
+            // leaving b
+            while (log_count > log_mark[b]) {
+                --log_count;
+                current[log_variable[log_count]] = log_temporary[log_count];
+            }
+            --depth;
+        }
+    }
+    free(stack);
+    free(next_child);
+    free(log_mark);
+    free(log_variable);
+    free(log_temporary);
+    free(current);
+    free(home);
+    free(entry_of);
+    free(variable_of);
+    
+    // 3. putting it all together, the new labels go right after the label a block starts with (if it's a named one)
+    // or at its very beginning, and the phis come after those
+    IRArray new_ir;
+    IRArray_construct(&new_ir);
+    IRArray_reserve(&new_ir, count + phi_count + block_count);
+    for (u64 i = 0; i < count; ++i) {
+        const BasicBlock *block = irs[i].block;
+        if (i == block->begin) {
+            const u64 b = block->order;
+            const bool starts_with_label = irs[i].instruction == OP_LABEL;
+            if (starts_with_label) IRArray_push_ptr(&new_ir, &irs[i]);
+            const bool has_own_label = starts_with_label && !irs[i].operands[0].named;
+            if (new_label[b] != NO_BLOCK && !has_own_label) {
+                IRArray_push_back(&new_ir, (IR){
+                    .instruction = OP_LABEL,
+                    .operands[0] = {
+                        .type = OT_LABEL,
+                        .named = false,
+                        .label_index = new_label[b],
+                    },
+                });
+            }
+            for (u64 p = phi_begin[b]; p < phi_begin[b+1]; ++p) {
+                IRArray_push_ptr(&new_ir, &phis[p]);
+            }
+            if (starts_with_label) continue;
+        }
+        IRArray_push_ptr(&new_ir, &irs[i]);
+    }
+    for (ARRAY_EACH(IR, it, &new_ir)) {
+        it->block = NULL;
+    }
+    
+    free(new_label);
+    free(phis);
+    free(phi_variable);
+    free(phi_begin);
+    Dominators_destruct(&dominators);
+    IRArray_destruct(ir);
+    *ir = new_ir;
+    LabelArray_destruct(labels);
+    *labels = findLabels(ir);
+}
+
+#undef NO_VARIABLE
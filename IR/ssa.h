@@ -0,0 +1,64 @@
+#ifndef SSA_H
+#define SSA_H
+
+#include "IR.h"
+#include "label.h"
+#include "../C/arena.h"
+
+#define NO_INSTRUCTION ((u64)-1)
+#define MANY_INSTRUCTIONS ((u64)-2)
+
+// NOTE(mdizdar): POP is the only thing that writes to an operand, everything else that writes anything writes result
+static inline IRVariable *writtenBy(IR *ir) {
+    switch ((int)ir->instruction) {
+        case OP_POP: {
+            return ir->operands[0].type == OT_TEMPORARY ? &ir->operands[0] : NULL;
+        }
+        case OP_RETURN: case OP_PUSH: case OP_IF_JUMP: case OP_IFN_JUMP:
+        case OP_LABEL: case OP_JUMP: case OP_CALL: case OP_PRELUDE: case OP_ERROR: {
+            return NULL;
+        }
+        default: {
+            return ir->result.type == OT_TEMPORARY ? &ir->result : NULL;
+        }
+    }
+}
+
+static inline bool readsOperand(const IR *ir, u64 k) {
+    return ir->operands[k].type == OT_TEMPORARY && !(k == 0 && ir->instruction == OP_POP);
+}
+
+// whether the instruction computes its result from its operands and nothing else
+static inline bool isPure(Op instruction) {
+    switch ((int)instruction) {
+        case '=': case '~': case '!': case OP_PLUS: case OP_MINUS: case OP_ADDRESS:
+        case '+': case '-': case '*': case '/': case '%': case '&': case '|': case '^':
+        case '<': case '>': case OP_LESS_EQ: case OP_GREATER_EQ: case OP_EQUALS: case OP_NOT_EQ:
+        case OP_LOGICAL_AND: case OP_LOGICAL_OR: case OP_BITSHIFT_LEFT: case OP_BITSHIFT_RIGHT: {
+            return true;
+        }
+        default: return false;
+    }
+}
+
+// the pure instructions that only read operands[0]
+static inline bool isUnary(Op instruction) {
+    switch ((int)instruction) {
+        case '=': case '~': case '!': case OP_PLUS: case OP_MINUS: case OP_ADDRESS: return true;
+        default: return false;
+    }
+}
+
+// NOTE(mdizdar): def_of[t] is the instruction that writes t (a phi, or a deref for the temporary its OT_REFERENCE
+// stands for), NO_INSTRUCTION if nothing does and MANY_INSTRUCTIONS if more than one thing does. pinned[t] is for
+// whatever can change behind an optimization's back or isn't in SSA: globals, volatiles, anything that has its
+// address taken and anything with more than one writer. Both need room for temporary_index temporaries
+void findWriters(IRArray *ir, u64 *def_of, bool *pinned);
+
+// NOTE(mdizdar): IR_generate gives every variable a single temporary that gets written wherever the variable gets
+// assigned to, this gives each of those writes a temporary of its own and puts phis where the paths join.
+// Anything that has its address taken or is a global stays as it is. The phis' operands live in arena, and the
+// labels get rebuilt to match the new IR
+void IR_constructSSA(IRArray *ir, LabelArray *labels, Arena *arena);
+
+#endif // SSA_H
@@ -0,0 +1,542 @@
+#include "strength_reduction.h"
+#include "ssa.h"
+#include "CFG.h"
+#include "dominators.h"
+#include "loops.h"
+
+extern TemporaryID temporary_index;
+extern LabelID label_index;
+
+#define NO_TEMPORARY ((u64)-1)
+#define NO_INDUCTION_VARIABLE ((u64)-1)
+// the biggest literal that's an int however it gets read
+#define LITERAL_MAX 0x7FFF
+// NOTE(mdizdar): IR2AVR compares a register against a byte, so that's all a moved test gets to count up to
+#define COMPARE_MAX 0xFF
+
+typedef struct InductionVariable {
+    u64 loop;
+    u64 phi;         // the instruction
+    u64 increment;   // the one adding step to it
+    u64 outside;     // which of the phi's operands comes in from the preheader
+    IRVariable init; // a literal or a temporary that doesn't change in the loop
+    s64 step;
+    bool is_unsigned; // an unsigned int, as far as its literals say
+} InductionVariable;
+
+// NOTE(mdizdar): scale * (the induction variable) + offset, plus base if there is one
+typedef struct Family {
+    u64 iv;
+    s64 scale;
+    s64 offset;
+    TemporaryID base;
+    uintptr_t base_entry;
+    bool is_unsigned; // an unsigned literal along the way makes the whole thing an unsigned int
+} Family;
+
+// an instruction that goes in right after irs[after], the ones going after the same one go in the order they came
+typedef struct Insertion {
+    u64 after;
+    u64 sequence;
+    IR ir;
+} Insertion;
+
+_generate_dynamic_array(InductionVariable);
+_generate_dynamic_array(Insertion);
+
+typedef struct Reduction {
+    IR *irs;
+    const Loops *loops;
+    const Dominators *dominators;
+    const u64 *def_of;
+    const bool *pinned;
+    const u64 *label_block;
+    Family *family; // .iv is NO_INDUCTION_VARIABLE for whatever isn't in one
+    InductionVariableArray ivs;
+    InsertionArray insertions;
+} Reduction;
+
+static inline bool fits(s64 value) {
+    return value >= -LITERAL_MAX && value <= LITERAL_MAX;
+}
+
+// NOTE(mdizdar): only the ones that are an int or narrower, a long one would make what it's added to a long, and the
+// reduced values are all ints
+static inline bool smallLiteral(const IRVariable *var, s64 *value) {
+    if (var->type != OT_INT8 && var->type != OT_INT16) return false;
+    const s64 k = IRVariable_literalValue(var);
+    if (!fits(k)) return false;
+    *value = k;
+    return true;
+}
+
+// a char one gets promoted to an int like the rest, an unsigned int one doesn't
+static inline bool isUnsignedInt(const IRVariable *var) {
+    return var->type == OT_INT16 && var->is_unsigned;
+}
+
+static inline IRVariable literal(s64 value, bool is_unsigned) {
+    return (IRVariable){ .type = OT_INT16, .integer_value = (u64)value & 0xFFFF, .is_unsigned = is_unsigned };
+}
+
+static inline bool fitsCompare(s64 value) {
+    return value >= 0 && value <= COMPARE_MAX;
+}
+
+static inline u64 blockOf(const Reduction *s, u64 i) {
+    return s->irs[i].block->order;
+}
+
+static inline bool inLoop(const Reduction *s, u64 l, u64 b) {
+    return Loops_contains(s->loops, l, s->loops->innermost[b]);
+}
+
+static bool isInvariant(const Reduction *s, TemporaryID t, u64 l) {
+    if (s->pinned[t]) return false;
+    const u64 d = s->def_of[t];
+    if (d == NO_INSTRUCTION) return true;
+    return d != MANY_INSTRUCTIONS && !inLoop(s, l, blockOf(s, d));
+}
+
+static inline bool dominates(const Reduction *s, u64 a, u64 b) {
+    while (b != NO_BLOCK && b > a) b = s->dominators->idom[b];
+    return b == a;
+}
+
+static inline bool isTemporary(const IRVariable *var, TemporaryID t) {
+    return var->type == OT_TEMPORARY && var->temporary_id == t;
+}
+
+static inline const Family *familyOf(const Reduction *s, const IRVariable *var, u64 l) {
+    if (var->type != OT_TEMPORARY) return NULL;
+    const Family *family = &s->family[var->temporary_id];
+    if (family->iv == NO_INDUCTION_VARIABLE || s->ivs.data[family->iv].loop != l) return NULL;
+    return family;
+}
+
+// whether what it computes is linear in one of l's induction variables, and how
+static bool derive(const Reduction *s, const IR *it, u64 l, Family *out) {
+    const IRVariable *a = &it->operands[0];
+    const IRVariable *b = &it->operands[1];
+    const Family *family = familyOf(s, a, l);
+    const IRVariable *other = b;
+    if (!family && (it->instruction == '+' || it->instruction == '*')) {
+        family = familyOf(s, b, l);
+        other = a;
+    }
+    if (!family) return false;
+    *out = *family;
+    s64 k;
+    switch ((int)it->instruction) {
+        case '+': {
+            if (smallLiteral(other, &k)) {
+                out->offset += k;
+                out->is_unsigned |= isUnsignedInt(other);
+            } else if (other->type == OT_TEMPORARY && out->base == NO_TEMPORARY && isInvariant(s, other->temporary_id, l)) {
+                out->base = other->temporary_id;
+                out->base_entry = other->entry;
+            } else {
+                return false;
+            }
+            break;
+        }
+        case '-': {
+            if (!smallLiteral(other, &k)) return false;
+            out->offset -= k;
+            out->is_unsigned |= isUnsignedInt(other);
+            break;
+        }
+        case '*': {
+            // a negative one would turn the comparisons around
+            if (!smallLiteral(other, &k) || k <= 0 || out->base != NO_TEMPORARY) return false;
+            out->scale *= k;
+            out->is_unsigned |= isUnsignedInt(other);
+            out->offset *= k;
+            break;
+        }
+        case OP_BITSHIFT_LEFT: {
+            if (!smallLiteral(other, &k) || k < 0 || k > 14 || out->base != NO_TEMPORARY) return false;
+            out->scale <<= k;
+            out->offset <<= k;
+            break;
+        }
+        default: return false;
+    }
+    return out->scale <= LITERAL_MAX && out->offset >= -LITERAL_MAX && out->offset <= LITERAL_MAX;
+}
+
+static void findInductionVariables(Reduction *s, u64 l) {
+    const BasicBlock *header = s->dominators->blocks.data[s->loops->header[l]];
+    for (u64 p = header->begin; p <= header->end; ++p) {
+        const IR *it = &s->irs[p];
+        if (it->instruction == OP_LABEL) continue;
+        if (it->instruction != OP_PHI) break;
+        const TemporaryID i = it->result.temporary_id;
+        if (it->phi->count != 2 || s->pinned[i]) continue;
+        const bool first_inside = inLoop(s, l, s->label_block[it->phi->values[0].label_index]);
+        const bool second_inside = inLoop(s, l, s->label_block[it->phi->values[1].label_index]);
+        if (first_inside == second_inside) continue;
+        const u64 outside = first_inside ? 1 : 0;
+        const IRVariable *init = &it->phi->values[outside];
+        const IRVariable *next = &it->phi->values[1 - outside];
+        if (next->type != OT_PHI_VAR) continue;
+        u64 d = s->def_of[next->temporary_id];
+        if (d >= MANY_INSTRUCTIONS || !inLoop(s, l, blockOf(s, d))) continue;
+        // i = i - 2 comes out as a copy of what it subtracts into
+        const IR *copy = &s->irs[d];
+        if (copy->instruction == '=' && copy->operands[0].type == OT_TEMPORARY) {
+            d = s->def_of[copy->operands[0].temporary_id];
+            if (d >= MANY_INSTRUCTIONS || !inLoop(s, l, blockOf(s, d))) continue;
+        }
+
+        const IR *increment = &s->irs[d];
+        s64 step;
+        const IRVariable *by;
+        if (increment->instruction == '+' && isTemporary(&increment->operands[0], i) && smallLiteral(by = &increment->operands[1], &step)) {
+        } else if (increment->instruction == '+' && isTemporary(&increment->operands[1], i) && smallLiteral(by = &increment->operands[0], &step)) {
+        } else if (increment->instruction == '-' && isTemporary(&increment->operands[0], i) && smallLiteral(by = &increment->operands[1], &step)) {
+            step = -step;
+        } else {
+            continue;
+        }
+        if (step == 0) continue;
+
+        s64 k;
+        IRVariable start;
+        bool is_unsigned = isUnsignedInt(by);
+        if (smallLiteral(init, &k)) {
+            is_unsigned |= isUnsignedInt(init);
+            start = literal(k, is_unsigned);
+        } else if (init->type == OT_PHI_VAR && isInvariant(s, init->temporary_id, l)) {
+            start = (IRVariable){ .type = OT_TEMPORARY, .entry = init->entry, .temporary_id = init->temporary_id };
+        } else {
+            continue;
+        }
+        InductionVariableArray_push_back(&s->ivs, (InductionVariable){
+            .loop = l,
+            .phi = p,
+            .increment = d,
+            .outside = outside,
+            .init = start,
+            .step = step,
+            .is_unsigned = is_unsigned,
+        });
+        s->family[i] = (Family){ .iv = s->ivs.count - 1, .scale = 1, .base = NO_TEMPORARY, .is_unsigned = is_unsigned };
+    }
+}
+
+static inline void insert(Reduction *s, u64 after, IR ir) {
+    InsertionArray_push_back(&s->insertions, (Insertion){ .after = after, .sequence = s->insertions.count, .ir = ir });
+}
+
+// result = a op b after irs[after], unless there's nothing to do
+static IRVariable emit(Reduction *s, u64 after, Op op, IRVariable a, IRVariable b) {
+    const IRVariable result = { .type = OT_TEMPORARY, .temporary_id = temporary_index++ };
+    insert(s, after, (IR){ .instruction = op, .result = result, .operands = { a, b } });
+    return result;
+}
+
+static IRVariable addLiteral(Reduction *s, u64 after, IRVariable value, s64 k, bool is_unsigned) {
+    if (k == 0) return value;
+    return k > 0 ? emit(s, after, '+', value, literal(k, is_unsigned)) : emit(s, after, '-', value, literal(-k, is_unsigned));
+}
+
+// NOTE(mdizdar): where the family starts out, computed at the end of the preheader. false if it wouldn't fit in an
+// int anymore
+static bool initialValue(Reduction *s, const Family *family, u64 after, IRVariable *out) {
+    const InductionVariable *iv = &s->ivs.data[family->iv];
+    s64 k;
+    if (smallLiteral(&iv->init, &k)) {
+        const s64 value = family->scale * k + family->offset;
+        if (!fits(value)) return false;
+        if (family->base == NO_TEMPORARY) {
+            *out = literal(value, family->is_unsigned);
+            return true;
+        }
+        const IRVariable base = { .type = OT_TEMPORARY, .entry = family->base_entry, .temporary_id = family->base };
+        *out = addLiteral(s, after, base, value, family->is_unsigned);
+        return true;
+    }
+    IRVariable value = iv->init;
+    if (family->scale != 1) value = emit(s, after, '*', value, literal(family->scale, family->is_unsigned));
+    value = addLiteral(s, after, value, family->offset, family->is_unsigned);
+    if (family->base != NO_TEMPORARY) {
+        const IRVariable base = { .type = OT_TEMPORARY, .entry = family->base_entry, .temporary_id = family->base };
+        value = emit(s, after, '+', base, value);
+    }
+    *out = value;
+    return true;
+}
+
+static inline void forgetReads(const IR *it, u64 *uses) {
+    for (u64 k = 0; k < 2; ++k) {
+        if (it->operands[k].type == OT_TEMPORARY) --uses[it->operands[k].temporary_id];
+    }
+}
+
+static int compareInsertions(const void *a, const void *b) {
+    const Insertion *x = a;
+    const Insertion *y = b;
+    if (x->after != y->after) return (x->after > y->after) - (x->after < y->after);
+    return (x->sequence > y->sequence) - (x->sequence < y->sequence);
+}
+
+static inline void renameReduced(IRVariable *var, const TemporaryID *replaced_by, TemporaryID temporary_count) {
+    if (var->temporary_id < temporary_count && replaced_by[var->temporary_id] != NO_TEMPORARY) {
+        var->temporary_id = replaced_by[var->temporary_id];
+        var->entry = 0;
+    }
+}
+
+void IR_reduceStrength(IRArray *ir, LabelArray *labels, Arena *arena) {
+    const u64 count = ir->count;
+    if (count == 0) return;
+    IR *irs = ir->data;
+    const TemporaryID temporary_count = temporary_index;
+
+    makeBasicBlocks(ir, labels);
+    Dominators dominators = dominatorAnalysis(ir);
+    Loops loops = loopAnalysis(&dominators);
+    BasicBlock **bbs = dominators.blocks.data;
+    if (loops.count == 0) {
+        Loops_destruct(&loops);
+        Dominators_destruct(&dominators);
+        return;
+    }
+
+    u64 *def_of = malloc(sizeof(u64) * temporary_count);
+    bool *pinned = malloc(sizeof(bool) * temporary_count);
+    findWriters(ir, def_of, pinned);
+    // a phi's operand comes from the block its label starts
+    u64 *label_block = malloc(sizeof(u64) * (label_index + 1));
+    memset(label_block, 0xFF, sizeof(u64) * (label_index + 1));
+    for (ARRAY_EACH(Label, label, labels)) {
+        if (!label->named) label_block[label->label_index] = irs[label->ir_index].block->order;
+    }
+    u64 *uses = calloc(temporary_count, sizeof(u64));
+    for (u64 i = 0; i < count; ++i) {
+        const IR *it = &irs[i];
+        if (it->instruction == OP_PHI) {
+            for (u64 k = 0; k < it->phi->count; ++k) {
+                if (it->phi->values[k].type == OT_PHI_VAR) ++uses[it->phi->values[k].temporary_id];
+            }
+            continue;
+        }
+        for (u64 k = 0; k < 2; ++k) {
+            if (readsOperand(it, k)) ++uses[it->operands[k].temporary_id];
+        }
+        if (it->instruction == '=' && it->result.type == OT_REFERENCE && it->result.pointer.reference_var->type == OT_TEMPORARY) {
+            ++uses[it->result.pointer.reference_var->temporary_id];
+        }
+    }
+
+    Reduction s = {
+        .irs = irs,
+        .loops = &loops,
+        .dominators = &dominators,
+        .def_of = def_of,
+        .pinned = pinned,
+        .label_block = label_block,
+        .family = malloc(sizeof(Family) * temporary_count),
+    };
+    for (TemporaryID t = 0; t < temporary_count; ++t) {
+        s.family[t].iv = NO_INDUCTION_VARIABLE;
+    }
+    InductionVariableArray_construct(&s.ivs);
+    InsertionArray_construct(&s.insertions);
+    TemporaryID *replaced_by = malloc(sizeof(TemporaryID) * temporary_count);
+    memset(replaced_by, 0xFF, sizeof(TemporaryID) * temporary_count);
+    bool *deleted = calloc(count, sizeof(bool));
+
+    for (u64 l = 0; l < loops.count; ++l) {
+        if (loops.preheader[l] == NO_BLOCK) continue;
+        const u64 first_iv = s.ivs.count;
+        findInductionVariables(&s, l);
+        if (s.ivs.count == first_iv) continue;
+        const BasicBlock *preheader = bbs[loops.preheader[l]];
+        const Op last = irs[preheader->end].instruction;
+        const u64 at_preheader = last == OP_JUMP || last == OP_IF_JUMP || last == OP_IFN_JUMP ? preheader->end - 1 : preheader->end;
+        const BasicBlock *header = bbs[loops.header[l]];
+        u64 after_phis = header->begin;
+        while (after_phis < header->end && irs[after_phis + 1].instruction == OP_PHI) ++after_phis;
+
+        // NOTE(mdizdar): the blocks go in reverse postorder, so everything an instruction reads from the loop has
+        // had its family figured out by the time it comes up
+        u64Array derived;
+        u64Array_construct(&derived);
+        for (u64 j = loops.body_begin[l]; j < loops.body_begin[l+1]; ++j) {
+            const u64 b = loops.body[j];
+            if (loops.innermost[b] != l) continue;
+            for (u64 i = bbs[b]->begin; i <= bbs[b]->end; ++i) {
+                const IR *it = &irs[i];
+                if (it->instruction == OP_PHI || it->result.type != OT_TEMPORARY || it->result.entry) continue;
+                const TemporaryID result = it->result.temporary_id;
+                if (pinned[result] || def_of[result] != i || !isPure(it->instruction)) continue;
+                Family family;
+                if (!derive(&s, it, l, &family)) continue;
+                s.family[result] = family;
+                u64Array_push_back(&derived, i);
+            }
+        }
+
+        // the reductions, i + k is as cheap as it gets already. Going backwards, whatever's only read by something
+        // that got reduced doesn't need a phi of its own
+        u64 *reduced_to = malloc(sizeof(u64) * (s.ivs.count - first_iv));
+        memset(reduced_to, 0xFF, sizeof(u64) * (s.ivs.count - first_iv));
+        for (u64 d = derived.count; d-- > 0;) {
+            const u64 *i = &derived.data[d];
+            const TemporaryID j = irs[*i].result.temporary_id;
+            const Family *family = &s.family[j];
+            if (uses[j] == 0) {
+                deleted[*i] = true;
+                forgetReads(&irs[*i], uses);
+                continue;
+            }
+            if (family->scale == 1 && family->base == NO_TEMPORARY) continue;
+            const InductionVariable *iv = &s.ivs.data[family->iv];
+            const s64 step = family->scale * iv->step;
+            if (step < -LITERAL_MAX || step > LITERAL_MAX) continue;
+            IRVariable init;
+            if (!initialValue(&s, family, at_preheader, &init)) continue;
+
+            // NOTE(mdizdar): the step goes right after the last load or store through it that happens every time
+            // around, so IR2AVR can turn the two into a post-increment. Otherwise it goes where the induction
+            // variable's does
+            const u64 increment_block = blockOf(&s, iv->increment);
+            u64 step_after = iv->increment;
+            u64 step_block = NO_BLOCK;
+            for (u64 k = loops.body_begin[l]; k < loops.body_begin[l+1]; ++k) {
+                const u64 b = loops.body[k];
+                if (loops.innermost[b] != l || !dominates(&s, b, increment_block)) continue;
+                for (u64 a = bbs[b]->begin; a <= bbs[b]->end; ++a) {
+                    const IR *access = &irs[a];
+                    const bool loads = access->instruction == OP_DEREF && isTemporary(&access->operands[0], j);
+                    const bool stores = access->instruction == '=' && access->result.type == OT_REFERENCE &&
+                        isTemporary(access->result.pointer.reference_var, j);
+                    if (!loads && !stores) continue;
+                    if (b == increment_block && a > iv->increment) continue;
+                    if (step_block == NO_BLOCK || b > step_block || (b == step_block && a > step_after)) {
+                        step_block = b;
+                        step_after = a;
+                    }
+                }
+            }
+
+            const IR *phi = &irs[iv->phi];
+            const TemporaryID r = temporary_index++;
+            const IRVariable current = { .type = OT_TEMPORARY, .temporary_id = r };
+            IRVariable next = addLiteral(&s, step_after, current, step, family->is_unsigned);
+            PhiOperands *operands = Arena_alloc(arena, sizeof(PhiOperands) + sizeof(IRVariable) * 2);
+            operands->count = 2;
+            if (init.type == OT_TEMPORARY) init.type = OT_PHI_VAR;
+            init.label_index = phi->phi->values[iv->outside].label_index;
+            init.named = false;
+            operands->values[iv->outside] = init;
+            next.type = OT_PHI_VAR;
+            next.label_index = phi->phi->values[1 - iv->outside].label_index;
+            next.named = false;
+            operands->values[1 - iv->outside] = next;
+            insert(&s, after_phis, (IR){ .instruction = OP_PHI, .result = current, .phi = operands });
+
+            replaced_by[j] = r;
+            deleted[*i] = true;
+            forgetReads(&irs[*i], uses);
+            if (family->base == NO_TEMPORARY && init.type != OT_PHI_VAR && reduced_to[family->iv - first_iv] == NO_TEMPORARY) {
+                reduced_to[family->iv - first_iv] = j;
+            }
+        }
+
+        // NOTE(mdizdar): linear function test replacement. If all that's left reading the induction variable is its
+        // own increment and a comparison against a literal, the comparison can be done on a reduced one instead, as
+        // long as nothing along the way would overflow an int
+        for (u64 v = first_iv; v < s.ivs.count; ++v) {
+            const InductionVariable *iv = &s.ivs.data[v];
+            const TemporaryID j = reduced_to[v - first_iv];
+            if (j == NO_TEMPORARY) continue;
+            const TemporaryID i_phi = irs[iv->phi].result.temporary_id;
+            const TemporaryID i_next = irs[iv->increment].result.temporary_id;
+            if (uses[i_next] != 1 || uses[i_phi] != 2) continue;
+            s64 init;
+            if (!smallLiteral(&iv->init, &init)) continue;
+            for (u64 k = loops.body_begin[l]; k < loops.body_begin[l+1]; ++k) {
+                const u64 b = loops.body[k];
+                u64 c = bbs[b]->begin;
+                for (; c <= bbs[b]->end; ++c) {
+                    if (!deleted[c] && c != iv->increment && isTemporary(&irs[c].operands[0], i_phi)) break;
+                }
+                if (c > bbs[b]->end) continue;
+                IR *compare = &irs[c];
+                s64 bound;
+                if (!smallLiteral(&compare->operands[1], &bound)) break;
+                const Op op = compare->instruction;
+                const bool upwards = iv->step > 0 && (op == '<' || op == OP_LESS_EQ || op == OP_NOT_EQ);
+                const bool downwards = iv->step < 0 && (op == '>' || op == OP_GREATER_EQ || op == OP_NOT_EQ);
+                if (!upwards && !downwards) break;
+                const Family *family = &s.family[j];
+                const s64 extreme = bound + iv->step;
+                const s64 new_bound = family->scale * bound + family->offset;
+                if (!fitsCompare(extreme) || !fitsCompare(new_bound) || !fitsCompare(family->scale * extreme + family->offset) ||
+                    !fitsCompare(family->scale * init + family->offset)) break;
+                compare->operands[0] = (IRVariable){ .type = OT_TEMPORARY, .temporary_id = j };
+                compare->operands[1] = literal(new_bound, family->is_unsigned);
+                break;
+            }
+        }
+        free(reduced_to);
+        u64Array_destruct(&derived);
+    }
+
+    // putting it together, everything that read a reduced value reads its phi instead
+    if (s.insertions.count) qsort(s.insertions.data, s.insertions.count, sizeof(Insertion), compareInsertions);
+    IRArray new_ir;
+    IRArray_construct(&new_ir);
+    IRArray_reserve(&new_ir, count + s.insertions.count);
+    u64 next_insertion = 0;
+    for (u64 i = 0; i < count; ++i) {
+        if (!deleted[i]) IRArray_push_ptr(&new_ir, &irs[i]);
+        while (next_insertion < s.insertions.count && s.insertions.data[next_insertion].after == i) {
+            IRArray_push_ptr(&new_ir, &s.insertions.data[next_insertion++].ir);
+        }
+    }
+    for (ARRAY_EACH(IR, it, &new_ir)) {
+        it->block = NULL;
+        if (it->instruction == OP_PHI) {
+            for (u64 k = 0; k < it->phi->count; ++k) {
+                if (it->phi->values[k].type == OT_PHI_VAR) renameReduced(&it->phi->values[k], replaced_by, temporary_count);
+            }
+            continue;
+        }
+        for (u64 k = 0; k < 2; ++k) {
+            if (readsOperand(it, k)) renameReduced(&it->operands[k], replaced_by, temporary_count);
+        }
+        if (it->instruction == OP_DEREF && it->result.type == OT_REFERENCE) {
+            *it->result.pointer.reference_var = it->operands[0];
+        } else if (it->instruction == OP_RETURN) {
+            it->result = it->operands[0];
+        } else if (it->instruction == '=' && it->result.type == OT_REFERENCE &&
+                   it->result.pointer.reference_var->type == OT_TEMPORARY) {
+            renameReduced(it->result.pointer.reference_var, replaced_by, temporary_count);
+        }
+    }
+
+    free(def_of);
+    free(pinned);
+    free(label_block);
+    free(uses);
+    free(s.family);
+    free(replaced_by);
+    free(deleted);
+    InductionVariableArray_destruct(&s.ivs);
+    InsertionArray_destruct(&s.insertions);
+    Loops_destruct(&loops);
+    Dominators_destruct(&dominators);
+    IRArray_destruct(ir);
+    *ir = new_ir;
+    LabelArray_destruct(labels);
+    *labels = findLabels(ir);
+}
+
+#undef NO_TEMPORARY
+#undef NO_INDUCTION_VARIABLE
+#undef LITERAL_MAX
+#undef COMPARE_MAX
@@ -0,0 +1,19 @@
+#ifndef STRENGTH_REDUCTION_H
+#define STRENGTH_REDUCTION_H
+
+#include "IR.h"
+#include "label.h"
+#include "../C/arena.h"
+
+// NOTE(mdizdar): induction variables and loop strength reduction over the SSA IR. A basic induction variable is a
+// phi in a loop's header that comes in from the preheader and goes up by the same literal every time around, and
+// anything in the loop that's a literal multiple of one plus something that doesn't change in the loop (i*4,
+// p + i, (i + 1) << 2, ...) gets a phi of its own that starts out where it should in the preheader and goes up by
+// its own step right where the induction variable does, or right after a load or store through it so that can
+// become a post-increment. Whatever read the old value reads the phi instead. If the induction variable is then
+// only left holding up the loop's test against a literal, the test gets moved over to one of the new ones (linear
+// function test replacement) and the old one is left for IR_eliminateDeadCode. Only loops with a preheader are
+// looked at, and only literals that are an int no matter how they get read are trusted
+void IR_reduceStrength(IRArray *ir, LabelArray *labels, Arena *arena);
+
+#endif // STRENGTH_REDUCTION_H
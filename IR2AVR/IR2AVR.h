@@ -7,33 +7,10 @@
 #include "../IR/CFG.h"
 #include "../IR/liveness_analysis.h"
 #include "../AVR/AVR.h"
+#include "register_allocation.h"
+#include "linear_scan.h"
 #include "../C/type.h"
 
-// TODO(mdizdar): regs should probably be a typedef and not a raw u64
-void clashGraph(u64 current_reg, u64Array *regs, u8 *real_reg, u64 reg_number) {
-    u64 *reg = regs[current_reg].data; // this can't be correct lol?
-    bool found;
-    // TODO(mdizdar): this should be all registers, but let's keep it simple for now
-    for (u8 j = 16; j < 24; ++j) {
-        found = false;
-        for (u64 i = 0; i < regs[current_reg].count; ++i) {
-            if (real_reg[reg[i]] == j) {
-                found = true;
-                break;
-            }
-        }
-        if (found) continue;
-        real_reg[current_reg] = j;
-        break;
-    }
-    if (found) {
-        error(0, "too many registers required");
-    }
-    for (u64 i = 0; i < regs[current_reg].count; ++i) {
-        if (real_reg[reg[i]] != 255) continue;
-        clashGraph(reg[i], regs, real_reg, reg_number);
-    }
-}
 #define APPEND_CMD(CMD, ...) AVRArray_push_back(AVR_instructions, CMD(__VA_ARGS__));
 #define APPEND_LONG_CMD(CMD, ...) { \
     u32 c = CMD(__VA_ARGS__); \
@@ -41,327 +18,637 @@ void clashGraph(u64 current_reg, u64Array *regs, u8 *real_reg, u64 reg_number) {
     AVRArray_push_back(AVR_instructions, c & 0xFFF); \
 }
 
-u8 load_to_reg(u8 reg, const IRVariable *var, const u8 *real_reg, AVRArray *AVR_instructions) {
-    // TODO(mdizdar): handle things other than temporaries and literals. I'm not sure if the following
-    // block is useful or not since IIRC the way I implemented derefs is REALLY stupid
-    //           if (irs[i].operands[0].type == OT_DEREF_TEMPORARY) {
-    //               APPEND_CMD(MOV, 30, rd);
-    //               APPEND_CMD(LDI, 31, 0);
-    //               APPEND_CMD(LDDz, 24, 0);
-    if (var->type == OT_TEMPORARY) {
-        APPEND_CMD(MOV, reg, real_reg[var->temporary_id]);
+// CALL pushes a 2 byte return address on anything with up to 128K of flash, and 3 on the ones with more
+#define RETURN_ADDRESS_BYTES 2
+// the most LDD and STD can add to Y or Z
+#define MAX_DISPLACEMENT 63
+
+// NOTE(mdizdar): moves bytes registers from src to dest, a pair at a time where both are even, and from the end that
+// doesn't overwrite anything it still has to read when the two overlap
+static void copyRegisters(u8 dest, u8 src, u8 bytes, AVRArray *AVR_instructions) {
+    if (dest == src) return;
+    if (dest < src) {
+        for (u8 b = 0; b < bytes;) {
+            if (b + 1 < bytes && (dest + b) % 2 == 0 && (src + b) % 2 == 0) {
+                APPEND_CMD(MOVW, dest + b, src + b);
+                b += 2;
+            } else {
+                APPEND_CMD(MOV, dest + b, src + b);
+                b += 1;
+            }
+        }
     } else {
-        APPEND_CMD(LDI, reg, var->integer_value);
+        for (u8 b = bytes; b > 0;) {
+            if (b >= 2 && (dest + b - 2) % 2 == 0 && (src + b - 2) % 2 == 0) {
+                APPEND_CMD(MOVW, dest + b - 2, src + b - 2);
+                b -= 2;
+            } else {
+                APPEND_CMD(MOV, dest + b - 1, src + b - 1);
+                b -= 1;
+            }
+        }
     }
-    return reg;
 }
 
-void IR2AVR(IRArray *ir, AVRArray *AVR_instructions, LabelArray *labels, u64 reg_number) {
-    IR *irs = (IR *)(ir->data);
-    
-    makeBasicBlocks(ir, labels);
+// fills reg+from up to reg+to with copies of the sign of reg+from-1, or with zeroes
+static void extendRegisters(u8 reg, u8 from, u8 to, bool is_signed, AVRArray *AVR_instructions) {
+    if (from >= to) return;
+    APPEND_CMD(CLR, reg + from);
+    if (is_signed && from) {
+        APPEND_CMD(SBRC, reg + from - 1, 7);
+        APPEND_CMD(COM, reg + from);
+    }
+    for (u8 b = from + 1; b < to; ++b) {
+        APPEND_CMD(MOV, reg + b, reg + from);
+    }
+}
 
-    livenessAnalysis(ir);
-    
-    u64Array *regs = malloc(sizeof(u64Array) * reg_number);
-    for (u64 i = 0; i < reg_number; ++i) {
-        u64Array_construct(&regs[i]);
+// NOTE(mdizdar): puts var into reg up to reg+bytes-1, cut down or extended to that many bytes. Literals only need
+// r16 and up to go straight in, everything below that gets them through r31
+static void loadValue(u8 reg, u8 bytes, const IRVariable *var, const Allocation *allocation, AVRArray *AVR_instructions) {
+    if (var->type == OT_TEMPORARY) {
+        const Width width = allocation->widths.data[var->temporary_id];
+        const u8 copied = width.bytes < bytes ? width.bytes : bytes;
+        copyRegisters(reg, allocation->real_reg[var->temporary_id], copied, AVR_instructions);
+        extendRegisters(reg, copied, bytes, width.is_signed, AVR_instructions);
+        return;
     }
-    for (ARRAY_EACH(IR, it, ir)) {
-        IRVariable *live = it->liveVars.data;
-        for (u64 j = 0; j < it->liveVars.count; ++j) {
-            for (u64 k = j+1; k < it->liveVars.count; ++k) {
-                u64Array_push_ptr(&regs[live[j].temporary_id], &live[k].temporary_id);
-                u64Array_push_ptr(&regs[live[k].temporary_id], &live[j].temporary_id);
-            }
+    for (u8 b = 0; b < bytes; ++b) {
+        const u8 k = literalByte(var, b);
+        if (reg + b >= FIRST_IMMEDIATE_REGISTER) {
+            APPEND_CMD(LDI, reg + b, k);
+        } else if (!k) {
+            APPEND_CMD(CLR, reg + b);
+        } else {
+            APPEND_CMD(LDI, 31, k);
+            APPEND_CMD(MOV, reg + b, 31);
         }
     }
-    
-    u8 *real_reg = malloc(sizeof(u8) * reg_number);
-    for (u64 i = 0; i < reg_number; ++i) {
-        real_reg[i] = 255;
+}
+
+// where var is as a bytes wide value, which is where it already is unless it's narrower than that or a literal
+static u8 widened(u8 scratch, u8 bytes, const IRVariable *var, const Allocation *allocation, AVRArray *AVR_instructions) {
+    if (var->type == OT_TEMPORARY && allocation->widths.data[var->temporary_id].bytes >= bytes) {
+        return allocation->real_reg[var->temporary_id];
     }
-    for (u64 i = 0; i < reg_number; ++i) {
-        if (real_reg[i] != 255) continue;
-        clashGraph(i, regs, real_reg, reg_number);
+    loadValue(scratch, bytes, var, allocation, AVR_instructions);
+    return scratch;
+}
+
+// sets Z if var is 0, all of its bytes get ORed together in r24 for that
+static void testValue(const IRVariable *var, const Allocation *allocation, AVRArray *AVR_instructions) {
+    if (var->type != OT_TEMPORARY) {
+        APPEND_CMD(LDI, 24, literalValue(var) != 0);
+        APPEND_CMD(TST, 24);
+        return;
     }
-    
-    /*
-    u64 j = 0;
-    for (ARRAY_EACH(IR, it, ir)) {
-        printf("%lu:\t", j);
-        for (ARRAY_EACH(IRVariable, live, &it->liveVars)) {
-            char s[40];
-            printf("%s, ", IRVariable_toStr(live, s));
+    const u8 reg = allocation->real_reg[var->temporary_id];
+    const u8 bytes = allocation->widths.data[var->temporary_id].bytes;
+    if (bytes == 1) {
+        APPEND_CMD(TST, reg);
+        return;
+    }
+    APPEND_CMD(MOV, 24, reg);
+    for (u8 b = 1; b < bytes; ++b) {
+        APPEND_CMD(OR, 24, reg + b);
+    }
+}
+
+// NOTE(mdizdar): shifts reg up to reg+bytes-1 by one bit, the carry goes from byte to byte
+static void shiftOnce(u8 reg, u8 bytes, bool left, bool arithmetic, AVRArray *AVR_instructions) {
+    if (left) {
+        APPEND_CMD(LSL, reg);
+        for (u8 b = 1; b < bytes; ++b) {
+            APPEND_CMD(ROL, reg + b);
+        }
+        return;
+    }
+    if (arithmetic) {
+        APPEND_CMD(ASR, reg + bytes - 1);
+    } else {
+        APPEND_CMD(LSR, reg + bytes - 1);
+    }
+    for (u8 b = bytes - 1; b > 0; --b) {
+        APPEND_CMD(ROR, reg + b - 1);
+    }
+}
+
+// a shift by a literal moves whole bytes first, and only shifts what's left over a bit at a time
+static void shiftBy(u8 reg, u8 bytes, u64 count, bool left, bool arithmetic, AVRArray *AVR_instructions) {
+    if (count > 8u*bytes) count = 8u*bytes;
+    const u8 whole = count / 8;
+    if (left) {
+        for (u8 b = bytes; whole && b-- > whole;) {
+            APPEND_CMD(MOV, reg + b, reg + b - whole);
+        }
+        for (u8 b = 0; b < whole; ++b) {
+            APPEND_CMD(CLR, reg + b);
+        }
+    } else if (whole) {
+        // the sign has to be put away before the byte it's in gets overwritten
+        if (arithmetic) {
+            APPEND_CMD(CLR, 30);
+            APPEND_CMD(SBRC, reg + bytes - 1, 7);
+            APPEND_CMD(COM, 30);
+        }
+        for (u8 b = 0; b + whole < bytes; ++b) {
+            APPEND_CMD(MOV, reg + b, reg + b + whole);
+        }
+        for (u8 b = bytes - whole; b < bytes; ++b) {
+            if (arithmetic) {
+                APPEND_CMD(MOV, reg + b, 30);
+            } else {
+                APPEND_CMD(CLR, reg + b);
+            }
+        }
+    }
+    if (whole == bytes) return;
+    for (u8 bit = 0; bit < count % 8; ++bit) {
+        // the bytes that are all zeroes or all sign by now stay that way
+        if (left) {
+            shiftOnce(reg + whole, bytes - whole, true, false, AVR_instructions);
+        } else {
+            shiftOnce(reg, bytes - whole, false, arithmetic, AVR_instructions);
+        }
+    }
+}
+
+// the value as the width says it is, for comparing it to the biggest one there is
+static inline s64 inWidth(s64 value, Width width) {
+    const u8 bits = 8*width.bytes;
+    const u64 truncated = (u64)value & ((1ull << bits) - 1);
+    if (width.is_signed && truncated >> (bits - 1)) return (s64)(truncated | ~((1ull << bits) - 1));
+    return (s64)truncated;
+}
+
+// NOTE(mdizdar): a load or store through a pointer that goes up by one right after it (IR_reduceStrength puts the
+// increment there when it can) goes through X instead of Z, and the increment comes with it for free. That's only
+// when it moves a single byte, the increment isn't scaled by how big what it points to is
+static inline bool postIncrements(const IR *irs, u64 count, u64 i, const IRVariable *pointer) {
+    if (i + 1 >= count || pointer->type != OT_TEMPORARY) return false;
+    const IR *next = &irs[i+1];
+    const OperandType step = next->operands[1].type;
+    return next->instruction == '+' && next->result.type == OT_TEMPORARY &&
+           next->operands[0].type == OT_TEMPORARY && next->operands[0].temporary_id == pointer->temporary_id &&
+           step >= OT_INT8 && step <= OT_INT64 && next->operands[1].integer_value == 1;
+}
+
+// what the increment after a post-increment load or store goes into, X has it by now
+static inline void afterPostIncrement(const IR *next, const Allocation *allocation, AVRArray *AVR_instructions) {
+    const u8 bytes = allocation->widths.data[next->result.temporary_id].bytes;
+    const u8 copied = bytes < 2 ? bytes : 2;
+    copyRegisters(allocation->real_reg[next->result.temporary_id], 26, copied, AVR_instructions);
+    extendRegisters(allocation->real_reg[next->result.temporary_id], copied, bytes, false, AVR_instructions);
+}
+
+// NOTE(mdizdar): a deref's OT_REFERENCE result is what keeps the optimizations from moving a load past a store through
+// the same pointer, but by now it's only the temporary the load went into. Everything from here on only knows how to
+// read temporaries and literals, so that's what the reads of one turn into
+static void readReferencesAsTemporaries(IRArray *ir) {
+    IR *irs = (IR *)(ir->data);
+    for (u64 i = 0; i < ir->count; ++i) {
+        for (int k = 0; k < 2; ++k) {
+            if (irs[i].operands[k].type == OT_REFERENCE) irs[i].operands[k].type = OT_TEMPORARY;
         }
-        printf("\n");
-        ++j;
+        IRVariable *pointer = irs[i].result.type == OT_REFERENCE ? irs[i].result.pointer.reference_var : NULL;
+        if (pointer && pointer->type == OT_REFERENCE) pointer->type = OT_TEMPORARY;
     }
-    for (u64 i = 0; i < reg_number; ++i) {
-        printf("t%lu -> r%u\n", i, real_reg[i]);
+}
+
+// NOTE(mdizdar): SP gets written a byte at a time from Y, with interrupts off in between so none of them lands on a
+// stack pointer that's half one and half the other. Writing SREG back only turns them on after the next instruction,
+// so SPL still gets in first
+static void writeStackPointer(AVRArray *AVR_instructions) {
+    APPEND_CMD(IN, 0, 0x3f);
+    APPEND_CMD(CLI);
+    APPEND_CMD(OUT, 29, 0x3e);
+    APPEND_CMD(OUT, 0, 0x3f);
+    APPEND_CMD(OUT, 28, 0x3d);
+}
+
+// Y goes down by the frame in the prelude and back up by it before returning, ADIW and SBIW only take up to 63
+static void moveFramePointer(s32 by, AVRArray *AVR_instructions) {
+    if (by > 0 && by <= MAX_DISPLACEMENT) {
+        APPEND_CMD(ADIW, 28, by);
+    } else if (by < 0 && by >= -MAX_DISPLACEMENT) {
+        APPEND_CMD(SBIW, 28, -by);
+    } else {
+        APPEND_CMD(SUBI, 28, (u8)-by);
+        APPEND_CMD(SBCI, 29, (u8)(-by >> 8));
     }
-    //*/
+    writeStackPointer(AVR_instructions);
+}
+
+// NOTE(mdizdar): LDD and STD only reach 63 bytes past Y, whatever's further up goes through Z pointed right at it.
+// Returns where the bytes start from the pointer they go through, which is Y if is_z comes out false
+static u8 frameDisplacement(u64 offset, u8 bytes, bool *is_z, AVRArray *AVR_instructions) {
+    *is_z = offset + bytes - 1 > MAX_DISPLACEMENT;
+    if (!*is_z) return (u8)offset;
+    APPEND_CMD(MOVW, 30, 28);
+    APPEND_CMD(SUBI, 30, (u8)-offset);
+    APPEND_CMD(SBCI, 31, (u8)(-offset >> 8));
+    return 0;
+}
+
+static inline u8 savedCount(u32 saved) {
+    u8 count = 0;
+    for (u8 r = FIRST_REGISTER; r <= LAST_REGISTER; ++r) {
+        count += (saved >> r) & 1;
+    }
+    return count;
+}
+
+void IR2AVR(IRArray *ir, AVRArray *AVR_instructions, LabelArray *labels, Arena *ir_arena, RegisterAllocator allocator) {
+    readReferencesAsTemporaries(ir);
+    Allocation allocation = allocator == ALLOCATOR_LINEAR_SCAN ? allocateRegistersLinearScan(ir, labels, ir_arena) : allocateRegisters(ir, labels, ir_arena);
+    const u8 *real_reg = allocation.real_reg;
+    const Width *widths = allocation.widths.data;
+    IR *irs = (IR *)(ir->data);
     
     Label *ls = (Label *)labels->data;
-    u64 skip_label_swap = (u64)-1;
+    u64 function = (u64)-1;
+    uintptr_t function_entry = 0; // the function's own, for what it returns
+    uintptr_t called = 0;         // the last function called, for what it returned
     for (u64 i = 0; i < ir->count; ++i) {
         switch ((int)irs[i].instruction) {
-            case OP_LOGICAL_OR: {
-                u8 res = real_reg[irs[i].result.temporary_id];
-                APPEND_CMD(LDI, res, 0);
-                u8 rd = load_to_reg(24, &irs[i].operands[0], real_reg, AVR_instructions);
-                APPEND_CMD(TST, rd);
+            case OP_LOGICAL_OR: case OP_LOGICAL_AND: {
+                // NOTE(mdizdar): both of them are 0 or 1 by the time they meet in r25, and after that it's just an OR
+                // or an AND
+                testValue(&irs[i].operands[0], &allocation, AVR_instructions);
+                APPEND_CMD(LDI, 25, 0);
                 APPEND_CMD(BREQ, 1);
-                APPEND_CMD(LDI, res, 1);
-                u8 rr = load_to_reg(24, &irs[i].operands[1], real_reg, AVR_instructions);
-                APPEND_CMD(TST, rr);
+                APPEND_CMD(LDI, 25, 1);
+                testValue(&irs[i].operands[1], &allocation, AVR_instructions);
+                APPEND_CMD(LDI, 24, 0);
                 APPEND_CMD(BREQ, 1);
-                APPEND_CMD(LDI, res, 1);
-
-                break;
-            }
-            case OP_LOGICAL_AND: {
-                // TODO(mdizdar): it'd probaby be better to just not do a test if one of the operands is 
-                // a literal value, i.e. known at compile time. But we'll optimize later...
-                u8 res = real_reg[irs[i].result.temporary_id];
-                APPEND_CMD(LDI, res, 1);
-                u8 rd = load_to_reg(24, &irs[i].operands[0], real_reg, AVR_instructions);
-                APPEND_CMD(TST, rd);
-                APPEND_CMD(BRNE, 1);
-                APPEND_CMD(LDI, res, 0);
-                u8 rr = load_to_reg(24, &irs[i].operands[1], real_reg, AVR_instructions);
-                APPEND_CMD(TST, rr);
-                APPEND_CMD(BRNE, 1);
-                APPEND_CMD(LDI, res, 0);
-                
-                break;
-            }
-            case '|': {
-                u8 res = load_to_reg(real_reg[irs[i].result.temporary_id], &irs[i].operands[0], real_reg, AVR_instructions);
-                if (irs[i].operands[1].type != OT_TEMPORARY) {
-                    APPEND_CMD(ORI, res, irs[i].operands[1].integer_value);
+                APPEND_CMD(LDI, 24, 1);
+                if (irs[i].instruction == OP_LOGICAL_OR) {
+                    APPEND_CMD(OR, 25, 24);
                 } else {
-                    APPEND_CMD(OR, res, real_reg[irs[i].operands[1].temporary_id]);
+                    APPEND_CMD(AND, 25, 24);
                 }
+                APPEND_CMD(MOV, real_reg[irs[i].result.temporary_id], 25);
                 break;
             }
-            case '&': {
-                u8 res = load_to_reg(real_reg[irs[i].result.temporary_id], &irs[i].operands[0], real_reg, AVR_instructions);
-                if (irs[i].operands[1].type != OT_TEMPORARY) {
-                    APPEND_CMD(ANDI, res, irs[i].operands[1].integer_value);
-                } else {
-                    APPEND_CMD(AND, res, real_reg[irs[i].operands[1].temporary_id]);
+            case '|': case '&': case '^': {
+                const u8 res = real_reg[irs[i].result.temporary_id];
+                const u8 bytes = widths[irs[i].result.temporary_id].bytes;
+                const IRVariable *a = &irs[i].operands[0];
+                const IRVariable *b = &irs[i].operands[1];
+                if (a->type != OT_TEMPORARY) {
+                    const IRVariable *swap = a;
+                    a = b;
+                    b = swap;
                 }
-                break;
-            }
-            case '^': {
-                u8 res = load_to_reg(real_reg[irs[i].result.temporary_id], &irs[i].operands[0], real_reg, AVR_instructions);
-                u8 rr = load_to_reg(24, &irs[i].operands[1], real_reg, AVR_instructions);
-                APPEND_CMD(EOR, res, rr);
-
-                break;
-            }
-            case '+': {
-                u8 res = load_to_reg(real_reg[irs[i].result.temporary_id], &irs[i].operands[0], real_reg, AVR_instructions);
-
-                if (irs[i].operands[1].type == OT_TEMPORARY) {
-                    u8 rr = real_reg[irs[i].operands[1].temporary_id];
-                    APPEND_CMD(ADD, res, rr);
-                } else {
-                    u16 k = (u16)irs[i].operands[1].integer_value;
-                    APPEND_CMD(SUBI, res, -(k & 0xEF));
+                loadValue(res, bytes, a, &allocation, AVR_instructions);
+                if (b->type != OT_TEMPORARY) {
+                    // NOTE(mdizdar): a byte the literal leaves alone doesn't need an instruction
+                    for (u8 k = 0; k < bytes; ++k) {
+                        const u8 byte = literalByte(b, k);
+                        if (irs[i].instruction == '|') {
+                            if (byte) APPEND_CMD(ORI, res + k, byte);
+                        } else if (irs[i].instruction == '&') {
+                            if (byte != 0xFF) APPEND_CMD(ANDI, res + k, byte);
+                        } else if (byte == 0xFF) {
+                            APPEND_CMD(COM, res + k);
+                        } else if (byte) {
+                            APPEND_CMD(LDI, 24, byte);
+                            APPEND_CMD(EOR, res + k, 24);
+                        }
+                    }
+                    break;
+                }
+                const u8 rr = widened(24, bytes, b, &allocation, AVR_instructions);
+                for (u8 k = 0; k < bytes; ++k) {
+                    if (irs[i].instruction == '|') {
+                        APPEND_CMD(OR, res + k, rr + k);
+                    } else if (irs[i].instruction == '&') {
+                        APPEND_CMD(AND, res + k, rr + k);
+                    } else {
+                        APPEND_CMD(EOR, res + k, rr + k);
+                    }
                 }
                 break;
             }
-            case '-': {
-                u8 res = load_to_reg(real_reg[irs[i].result.temporary_id], &irs[i].operands[0], real_reg, AVR_instructions);
-                if (irs[i].operands[1].type == OT_TEMPORARY) {
-                    u8 rr = real_reg[irs[i].operands[1].temporary_id];
-                    APPEND_CMD(SBC, res, rr);
-                } else {
-                    u16 k = (u16)irs[i].operands[1].integer_value;
+            case '+': case '-': {
+                const u8 res = real_reg[irs[i].result.temporary_id];
+                const u8 bytes = widths[irs[i].result.temporary_id].bytes;
+                const IRVariable *a = &irs[i].operands[0];
+                const IRVariable *b = &irs[i].operands[1];
+                if (irs[i].instruction == '+' && a->type != OT_TEMPORARY) {
+                    const IRVariable *swap = a;
+                    a = b;
+                    b = swap;
+                }
+                loadValue(res, bytes, a, &allocation, AVR_instructions);
+                if (b->type != OT_TEMPORARY) {
+                    // NOTE(mdizdar): there's no add immediate, but subtracting the negated literal comes out the same.
+                    // ADIW and SBIW would do a pair with a k up to 63 in one word instead of two, but they only work on
+                    // r24 and up, and giving a value X would cost the post-increments and the scratch the multiplies
+                    // and comparisons use. They take the same 2 cycles as SUBI and SBCI, so all it'd save is the word
+                    const u64 k = irs[i].instruction == '+' ? -(u64)literalValue(b) : (u64)literalValue(b);
                     APPEND_CMD(SUBI, res, k & 0xFF);
+                    for (u8 byte = 1; byte < bytes; ++byte) {
+                        APPEND_CMD(SBCI, res + byte, (k >> (8*byte)) & 0xFF);
+                    }
+                    break;
+                }
+                const u8 rr = widened(24, bytes, b, &allocation, AVR_instructions);
+                if (irs[i].instruction == '+') {
+                    APPEND_CMD(ADD, res, rr);
+                    for (u8 byte = 1; byte < bytes; ++byte) {
+                        APPEND_CMD(ADC, res + byte, rr + byte);
+                    }
+                } else {
+                    APPEND_CMD(SUB, res, rr);
+                    for (u8 byte = 1; byte < bytes; ++byte) {
+                        APPEND_CMD(SBC, res + byte, rr + byte);
+                    }
                 }
                 break;
             }
             case OP_PLUS: {
-                u8 res = load_to_reg(real_reg[irs[i].result.temporary_id], &irs[i].operands[0], real_reg, AVR_instructions);
+                loadValue(real_reg[irs[i].result.temporary_id], widths[irs[i].result.temporary_id].bytes, &irs[i].operands[0], &allocation, AVR_instructions);
                 break;
             }
             case OP_MINUS: {
-                u8 res = real_reg[irs[i].result.temporary_id];
-                if (irs[i].operands[0].type == OT_TEMPORARY) {
-                    u8 rd = real_reg[irs[i].operands[0].temporary_id];
-                    if (rd != res) {
-                        APPEND_CMD(MOV, res, rd);
-                    }
+                const u8 res = real_reg[irs[i].result.temporary_id];
+                const u8 bytes = widths[irs[i].result.temporary_id].bytes;
+                loadValue(res, bytes, &irs[i].operands[0], &allocation, AVR_instructions);
+                if (bytes == 1) {
+                    APPEND_CMD(NEG, res);
+                } else if (bytes == 2) {
+                    // NOTE(mdizdar): negating the low byte borrows from the high one unless it was 0
+                    APPEND_CMD(CLR, 25);
+                    APPEND_CMD(NEG, res + 1);
+                    APPEND_CMD(NEG, res);
+                    APPEND_CMD(SBC, res + 1, 25);
                 } else {
-                    APPEND_CMD(LDI, res, (u16)irs[i].operands[0].integer_value);
+                    // ~x + 1, and COM leaves the carry set, which is the + 1
+                    APPEND_CMD(CLR, 25);
+                    for (u8 k = 0; k < bytes; ++k) {
+                        APPEND_CMD(COM, res + k);
+                    }
+                    for (u8 k = 0; k < bytes; ++k) {
+                        APPEND_CMD(ADC, res + k, 25);
+                    }
                 }
-                APPEND_CMD(NEG, res);
-
                 break;
             }
             case '*': {
-                u8 res = real_reg[irs[i].result.temporary_id];
-                if (irs[i].operands[0].type == OT_TEMPORARY) {
-                    u8 rd = real_reg[irs[i].operands[0].temporary_id];
-                    APPEND_CMD(MOV, res, rd);
-                } else {
-                    u16 k = (u16)irs[i].operands[0].integer_value;
-                    APPEND_CMD(LDI, res, k);
+                // NOTE(mdizdar): schoolbook multiplication a byte at a time, adding up the partial products in res.
+                // Only the ones that end up in the low bytes are needed, and a literal's zero bytes are skipped. The
+                // bytes past the end of a narrower operand are the sign in r24 and r25 or they're skipped too, the
+                // literal's bytes go through r30 and r26 is there to add the carries with
+                const u8 res = real_reg[irs[i].result.temporary_id];
+                const u8 bytes = widths[irs[i].result.temporary_id].bytes;
+                const IRVariable *a = &irs[i].operands[0];
+                const IRVariable *b = &irs[i].operands[1];
+                if (a->type != OT_TEMPORARY) {
+                    const IRVariable *swap = a;
+                    a = b;
+                    b = swap;
                 }
-                if (irs[i].operands[1].type == OT_TEMPORARY) {
-                    u8 rr = real_reg[irs[i].operands[1].temporary_id];
-                    APPEND_CMD(MUL, res, rr);
-                } else {
-                    u16 k = (u16)irs[i].operands[1].integer_value;
-                    APPEND_CMD(LDI, 25, k);
-                    APPEND_CMD(MUL, res, 25);
+                if (a->type != OT_TEMPORARY) {
+                    const IRVariable product = { .type = OT_INT64, .integer_value = (u64)literalValue(a) * (u64)literalValue(b) };
+                    loadValue(res, bytes, &product, &allocation, AVR_instructions);
+                    break;
+                }
+                const IRVariable *factors[2] = { a, b };
+                u8 factor_bytes[2];
+                for (u8 f = 0; f < 2; ++f) {
+                    if (factors[f]->type != OT_TEMPORARY) {
+                        factor_bytes[f] = bytes;
+                        continue;
+                    }
+                    const Width width = widths[factors[f]->temporary_id];
+                    factor_bytes[f] = width.bytes;
+                    if (width.bytes < bytes && width.is_signed) {
+                        APPEND_CMD(CLR, 24 + f);
+                        APPEND_CMD(SBRC, real_reg[factors[f]->temporary_id] + width.bytes - 1, 7);
+                        APPEND_CMD(COM, 24 + f);
+                        factor_bytes[f] = bytes;
+                    }
+                }
+                if (bytes == 1) {
+                    const u8 ra = real_reg[a->temporary_id];
+                    u8 rb = 30;
+                    if (b->type == OT_TEMPORARY) {
+                        rb = real_reg[b->temporary_id];
+                    } else {
+                        APPEND_CMD(LDI, 30, literalByte(b, 0));
+                    }
+                    APPEND_CMD(MUL, ra, rb);
+                    APPEND_CMD(MOV, res, 0);
+                    break;
+                }
+                APPEND_CMD(CLR, 26);
+                for (u8 k = 0; k < bytes; ++k) {
+                    APPEND_CMD(CLR, res + k);
+                }
+                for (u8 x = 0; x < bytes && x < factor_bytes[0]; ++x) {
+                    const Width width_a = widths[a->temporary_id];
+                    const u8 ra = x < width_a.bytes ? real_reg[a->temporary_id] + x : 24;
+                    for (u8 y = 0; x + y < bytes && y < factor_bytes[1]; ++y) {
+                        u8 rb;
+                        if (b->type != OT_TEMPORARY) {
+                            const u8 byte = literalByte(b, y);
+                            if (!byte) continue;
+                            APPEND_CMD(LDI, 30, byte);
+                            rb = 30;
+                        } else {
+                            const Width width_b = widths[b->temporary_id];
+                            rb = y < width_b.bytes ? real_reg[b->temporary_id] + y : 25;
+                        }
+                        APPEND_CMD(MUL, ra, rb);
+                        APPEND_CMD(ADD, res + x + y, 0);
+                        if (x + y + 1 < bytes) APPEND_CMD(ADC, res + x + y + 1, 1);
+                        for (u8 k = x + y + 2; k < bytes; ++k) {
+                            APPEND_CMD(ADC, res + k, 26);
+                        }
+                    }
                 }
                 break;
             }
             case '=': {
-                if (irs[i].result.type == OT_REFERENCE) {
-                    u8 res = load_to_reg(24, irs[i].result.pointer.reference_var, real_reg, AVR_instructions);
-                    if (irs[i].operands[0].type == OT_TEMPORARY) {
-                        u8 rd = real_reg[irs[i].operands[0].temporary_id];
-                        APPEND_CMD(MOV, 30, res);
-                        APPEND_CMD(LDI, 31, 0); // TODO(mdizdar): this is incorrect, pointers are always 2 bytes wide, but there are many things wrong with this code
-                        APPEND_CMD(STDz, 0, rd); // TODO(mdizdar): this will only give us the correct behavior when dereferencing on the right side of an assignment
+                if (irs[i].result.type != OT_REFERENCE) {
+                    loadValue(real_reg[irs[i].result.temporary_id], widths[irs[i].result.temporary_id].bytes, &irs[i].operands[0], &allocation, AVR_instructions);
+                    break;
+                }
+                const IRVariable *pointer = irs[i].result.pointer.reference_var;
+                const IRVariable *value = &irs[i].operands[0];
+                const u8 bytes = storedBytes(widths, &irs[i]);
+                if (bytes == 1 && postIncrements(irs, ir->count, i, pointer)) {
+                    loadValue(26, 2, pointer, &allocation, AVR_instructions);
+                    const u8 rd = widened(24, 1, value, &allocation, AVR_instructions);
+                    APPEND_CMD(STxp, rd);
+                    afterPostIncrement(&irs[i+1], &allocation, AVR_instructions);
+                    ++i;
+                    break;
+                }
+                loadValue(30, 2, pointer, &allocation, AVR_instructions);
+                const u8 rd = widened(24, bytes, value, &allocation, AVR_instructions);
+                for (u8 k = 0; k < bytes; ++k) {
+                    APPEND_CMD(STDz, rd + k, k);
+                }
+                break;
+            }
+            case '<': case '>': case OP_LESS_EQ: case OP_GREATER_EQ: case OP_EQUALS: case OP_NOT_EQ: {
+                // NOTE(mdizdar): everything gets turned into a < b, a >= b, a == b or a != b with the literal second,
+                // since those take a single branch after a CP/CPC chain. a > k is a >= k+1 and a <= k is a < k+1,
+                // unless k is as big as it gets, in which case the answer doesn't depend on a
+                const u8 res = real_reg[irs[i].result.temporary_id];
+                const Width width = compareWidth(widths, &irs[i]);
+                const IRVariable *a = &irs[i].operands[0];
+                const IRVariable *b = &irs[i].operands[1];
+                int relation = irs[i].instruction;
+                if (a->type != OT_TEMPORARY) {
+                    const IRVariable *swap = a;
+                    a = b;
+                    b = swap;
+                    switch (relation) {
+                        case '<':           relation = '>';           break;
+                        case '>':           relation = '<';           break;
+                        case OP_LESS_EQ:    relation = OP_GREATER_EQ; break;
+                        case OP_GREATER_EQ: relation = OP_LESS_EQ;    break;
+                        default: break;
+                    }
+                }
+                IRVariable next = { .type = OT_INT64 };
+                if (relation == '>' || relation == OP_LESS_EQ) {
+                    if (b->type != OT_TEMPORARY) {
+                        const s64 k = inWidth(literalValue(b), width);
+                        const s64 max = width.is_signed ? (s64)((1ull << (8*width.bytes - 1)) - 1) : (s64)((1ull << (8*width.bytes)) - 1);
+                        if (k == max) {
+                            APPEND_CMD(LDI, res, relation == OP_LESS_EQ);
+                            break;
+                        }
+                        next.integer_value = (u64)(k + 1);
+                        b = &next;
+                        relation = relation == '>' ? OP_GREATER_EQ : '<';
                     } else {
-                        u16 k = (u16)irs[i].operands[0].integer_value;
-                        APPEND_CMD(LDI, 30, res);
-                        APPEND_CMD(LDI, 31, 0);
-                        APPEND_CMD(STDz, 0, k & 0xFF); // TODO(mdizdar): this will only give us the correct behavior when dereferencing on the right side of an assignment
+                        const IRVariable *swap = a;
+                        a = b;
+                        b = swap;
+                        relation = relation == '>' ? '<' : OP_GREATER_EQ;
                     }
-                } else {
-                    u8 res = real_reg[irs[i].result.temporary_id];
-                    if (irs[i].operands[0].type == OT_TEMPORARY) {
-                        u8 rd = real_reg[irs[i].operands[0].temporary_id];
-                        APPEND_CMD(MOV, res, rd);
+                }
+                // two operands narrower than what they're compared as only ever happens with a byte against a byte
+                const u8 ra = widened(24, width.bytes, a, &allocation, AVR_instructions);
+                if (b->type != OT_TEMPORARY) {
+                    if (ra >= FIRST_IMMEDIATE_REGISTER) {
+                        APPEND_CMD(CPI, ra, literalByte(b, 0));
                     } else {
-                        u16 k = (u16)irs[i].operands[0].integer_value;
-                        APPEND_CMD(LDI, res, k & 0xFF);
+                        APPEND_CMD(LDI, 31, literalByte(b, 0));
+                        APPEND_CMD(CP, ra, 31);
+                    }
+                    for (u8 k = 1; k < width.bytes; ++k) {
+                        APPEND_CMD(LDI, 31, literalByte(b, k));
+                        APPEND_CMD(CPC, ra + k, 31);
+                    }
+                } else {
+                    const u8 rb = widened(ra == 24 ? 26 : 24, width.bytes, b, &allocation, AVR_instructions);
+                    APPEND_CMD(CP, ra, rb);
+                    for (u8 k = 1; k < width.bytes; ++k) {
+                        APPEND_CMD(CPC, ra + k, rb + k);
                     }
                 }
-                break;
-            }
-            case '<': {
-                u8 rd = real_reg[irs[i].operands[0].temporary_id];
-                u8 res = real_reg[irs[i].result.temporary_id];
+                u16 (*branch)(u8);
+                switch (relation) {
+                    case '<':       branch = width.is_signed ? BRLT : BRLO; break;
+                    case OP_EQUALS: branch = BREQ;                          break;
+                    case OP_NOT_EQ: branch = BRNE;                          break;
+                    default:        branch = width.is_signed ? BRGE : BRSH; break;
+                }
                 APPEND_CMD(LDI, res, 1);
-                // TODO(mdizdar): this only works in a very niche case
-                u16 k = (u16)irs[i].operands[1].integer_value;
-                APPEND_CMD(CPI, rd, k & 0xFF);
-                APPEND_CMD(BRLO, 1);
+                APPEND_CMD(branch, 1);
                 APPEND_CMD(LDI, res, 0);
                 break;
             }
-            case '>': {
-                u8 rd = real_reg[irs[i].operands[0].temporary_id];
-                u8 res = real_reg[irs[i].result.temporary_id];
-                APPEND_CMD(LDI, res, 1);
-                // TODO(mdizdar): this only works in a very niche case
-                u16 k = (u16)irs[i].operands[1].integer_value;
-                APPEND_CMD(CPI, rd, k & 0xFF);
-                APPEND_CMD(BRGE, 1);
+            case '!': {
+                const u8 res = real_reg[irs[i].result.temporary_id];
+                testValue(&irs[i].operands[0], &allocation, AVR_instructions);
                 APPEND_CMD(LDI, res, 0);
-                break;
-            }
-            case OP_EQUALS: {
-                u8 rd = real_reg[irs[i].operands[0].temporary_id];
-                u8 res = real_reg[irs[i].result.temporary_id];
+                APPEND_CMD(BRNE, 1);
                 APPEND_CMD(LDI, res, 1);
-                // TODO(mdizdar): this only works in a very niche case
-                u16 k = (u16)irs[i].operands[1].integer_value;
-                APPEND_CMD(CPI, rd, k & 0xFF);
-                APPEND_CMD(BREQ, 1);
-                APPEND_CMD(LDI, res, 0);
-                break;
-            }
-            case '!': {
-                u8 res = real_reg[irs[i].result.temporary_id];
-                if (irs[i].operands[0].type == OT_TEMPORARY) {
-                    u8 rd = real_reg[irs[i].operands[0].temporary_id];
-                    if (rd != res) {
-                        APPEND_CMD(MOV, res, rd);
-                    }
-                } else {
-                    u16 k = (u16)irs[i].operands[0].integer_value;
-                    APPEND_CMD(LDI, res, k & 0xFF);
-                }
-                APPEND_CMD(COM, res);
-                APPEND_CMD(ANDI, res, 1);
                 break;
             }
             case '~': {
-                u8 res = real_reg[irs[i].result.temporary_id];
-                if (irs[i].operands[0].type == OT_TEMPORARY) {
-                    u8 rd = real_reg[irs[i].operands[0].temporary_id];
-                    if (rd != res) {
-                        APPEND_CMD(MOV, res, rd);
-                    }
-                } else {
-                    u16 k = (u16)irs[i].operands[0].integer_value;
-                    APPEND_CMD(LDI, res, k & 0xFF);
+                const u8 res = real_reg[irs[i].result.temporary_id];
+                const u8 bytes = widths[irs[i].result.temporary_id].bytes;
+                loadValue(res, bytes, &irs[i].operands[0], &allocation, AVR_instructions);
+                for (u8 k = 0; k < bytes; ++k) {
+                    APPEND_CMD(COM, res + k);
                 }
-                APPEND_CMD(COM, res);
                 break;
             }
-            case OP_BITSHIFT_LEFT: {
-                // TODO(mdizdar): works only sometimes
-                u8 res = real_reg[irs[i].result.temporary_id];
-                if (irs[i].operands[0].type == OT_TEMPORARY) {
-                    u8 rd = real_reg[irs[i].operands[0].temporary_id];
-                    APPEND_CMD(MOV, 26, rd); // TODO(mdizdar): I don't like that this uses 26 as a temp register
+            case OP_BITSHIFT_LEFT: case OP_BITSHIFT_RIGHT: {
+                // NOTE(mdizdar): the low bytes of a left shift only depend on the low bytes of what gets shifted, but a
+                // right shift needs all of it, so one that's narrower than what it shifts happens in r24 and up first.
+                // The count is only ever a byte, a variable one goes into r31 and counts down in a loop that starts at
+                // its own test:
+                //     rjmp test; loop: <shift once>; test: subi r31, 1; brcc loop
+                const bool left = irs[i].instruction == OP_BITSHIFT_LEFT;
+                const u8 res = real_reg[irs[i].result.temporary_id];
+                const u8 bytes = widths[irs[i].result.temporary_id].bytes;
+                const Width shifted = promoted(operandWidth(widths, &irs[i].operands[0]));
+                const u8 shift_bytes = left || shifted.bytes <= bytes ? bytes : shifted.bytes;
+                const bool arithmetic = !left && shifted.is_signed;
+                const u8 reg = shift_bytes > bytes ? 24 : res;
+                const IRVariable *count = &irs[i].operands[1];
+                if (count->type != OT_TEMPORARY) {
+                    loadValue(reg, shift_bytes, &irs[i].operands[0], &allocation, AVR_instructions);
+                    const s64 k = literalValue(count);
+                    shiftBy(reg, shift_bytes, k < 0 ? 8u*shift_bytes : (u64)k, left, arithmetic, AVR_instructions);
                 } else {
-                    u8 k = (u8)irs[i].operands[0].integer_value;
-                    APPEND_CMD(LDI, 26, k);
+                    loadValue(31, 1, count, &allocation, AVR_instructions);
+                    loadValue(reg, shift_bytes, &irs[i].operands[0], &allocation, AVR_instructions);
+                    APPEND_CMD(RJMP, shift_bytes);
+                    shiftOnce(reg, shift_bytes, left, arithmetic, AVR_instructions);
+                    APPEND_CMD(SUBI, 31, 1);
+                    APPEND_CMD(BRCC, -(shift_bytes + 2) & 0x7F);
                 }
-                if (irs[i].operands[1].type == OT_TEMPORARY) {
-                    u8 rr = real_reg[irs[i].operands[1].temporary_id];
-                    APPEND_CMD(MOV, 24, rr);
-                } else {
-                    u8 k = (u8)irs[i].operands[1].integer_value;
-                    APPEND_CMD(LDI, 24, k);
-                }
-                APPEND_CMD(MOV, 25, 24);
-                APPEND_CMD(AND, 25, 25);
-                APPEND_CMD(BREQ, 7);
-                u32 jump_back = (u32)AVR_instructions->count;
-                APPEND_CMD(LSL, 26);
-                APPEND_CMD(DEC, 24);
-                APPEND_CMD(MOV, 25, 24);
-                APPEND_CMD(AND, 25, 25);
-                APPEND_CMD(BREQ, 2);
-                skip_label_swap = AVR_instructions->count;
-                APPEND_LONG_CMD(JMP, jump_back);
-                APPEND_CMD(MOV, res, 22);
+                copyRegisters(res, reg, bytes, AVR_instructions);
                 break;
             }
             case OP_DEREF: {
-                u8 res = real_reg[irs[i].result.temporary_id];
-                u8 r0 = load_to_reg(24, &irs[i].operands[0], real_reg, AVR_instructions);
-                APPEND_CMD(MOV, 30, 24);
-                APPEND_CMD(LDI, 31, 0); // TODO(mdizdar): this is incorrect, pointers are always 2 bytes wide, but there are many things wrong with this code
-                APPEND_CMD(LDDz, res, 0); // TODO(mdizdar): this will only give us the correct behavior when dereferencing on the right side of an assignment
-                                          // left side requires *storage* not loading; regrettably, such dereferencing appears to be extremely common
-                                          // i.e. array indexing and struct member accessing through a pointer
-                                          // I'll need to figure out a good way of either having the information (on which side of an assignment am I) at all times
-                                          // or making it so it doesn't matter, and the actual loading/storing will happen exclusively with a '=' IR OP
+                // NOTE(mdizdar): reads as many bytes as what the pointer points to and the result both have, and
+                // extends the rest
+                const u8 res = real_reg[irs[i].result.temporary_id];
+                const Width width = widths[irs[i].result.temporary_id];
+                const IRVariable *pointer = &irs[i].operands[0];
+                Type *pointee_type = irs[i].result.type == OT_REFERENCE ? pointeeOf(widths, &irs[i].result) : NULL;
+                if (!pointee_type && pointer->type == OT_TEMPORARY) pointee_type = widths[pointer->temporary_id].pointee;
+                const Width pointee = pointee_type ? widthOfType(pointee_type) : width;
+                const u8 read = pointee.bytes < width.bytes ? pointee.bytes : width.bytes;
+                if (width.bytes == 1 && pointee.bytes == 1 && postIncrements(irs, ir->count, i, pointer)) {
+                    loadValue(26, 2, pointer, &allocation, AVR_instructions);
+                    APPEND_CMD(LDxp, res);
+                    afterPostIncrement(&irs[i+1], &allocation, AVR_instructions);
+                    ++i;
+                    break;
+                }
+                loadValue(30, 2, pointer, &allocation, AVR_instructions);
+                for (u8 k = 0; k < read; ++k) {
+                    APPEND_CMD(LDDz, res + k, k);
+                }
+                extendRegisters(res, read, width.bytes, pointee.is_signed, AVR_instructions);
                 break;
             }
             case OP_LABEL: {
+                if (irs[i].operands[0].named) {
+                    ++function;
+                    function_entry = irs[i].operands[0].entry;
+                }
                 for (u64 j = 0; j < labels->count; ++j) {
                     if (irs[i].operands[0].named != ls[j].named) continue;
                     if (ls[j].named) {
-                        if (strcmp(irs[i].operands[0].label_name.data, ls[j].label_name.data)) continue;
+                        if (!String_eq(&irs[i].operands[0].label_name, &ls[j].label_name)) continue;
                     } else {
                         if (irs[i].operands[0].label_index != ls[j].label_index) continue;
                     }
                     ls[j].correct_address = (u32)(AVR_instructions->count);
-                    if (irs[i].operands[0].named && !strcmp(irs[i].operands[0].label_name.data, "__start")) {
+                    if (irs[i].operands[0].named && irs[i].operands[0].label_name.count == 7 && !memcmp(irs[i].operands[0].label_name.data, "__start", 7)) {
                         APPEND_CMD(LDI, 28, 0x5f);
                         APPEND_CMD(LDI, 29, 0x04);
                         APPEND_CMD(OUT, 29, 0x3e);
@@ -375,7 +662,7 @@ void IR2AVR(IRArray *ir, AVRArray *AVR_instructions, LabelArray *labels, u64 reg
                 for (u64 j = 0; j < labels->count; ++j) {
                     if (irs[i].operands[0].named != ls[j].named) continue;
                     if (ls[j].named) {
-                        if (strcmp(irs[i].operands[0].label_name.data, ls[j].label_name.data)) continue;
+                        if (!String_eq(&irs[i].operands[0].label_name, &ls[j].label_name)) continue;
                     } else {
                         if (irs[i].operands[0].label_index != ls[j].label_index) continue;
                     }
@@ -385,20 +672,13 @@ void IR2AVR(IRArray *ir, AVRArray *AVR_instructions, LabelArray *labels, u64 reg
                 break;
             }
             case OP_IF_JUMP: {
-                if (irs[i].operands[0].type == OT_TEMPORARY) {
-                    u8 rd = real_reg[irs[i].operands[0].temporary_id];
-                    APPEND_CMD(MOV, 24, rd);
-                } else {
-                    u8 k = (u8)irs[i].operands[0].integer_value;
-                    APPEND_CMD(LDI, 24, k);
-                }
-                APPEND_CMD(AND, 24, 24);
+                testValue(&irs[i].operands[0], &allocation, AVR_instructions);
                 APPEND_CMD(BREQ, 2);
                 
                 for (u64 j = 0; j < labels->count; ++j) {
                     if (irs[i].operands[1].named != ls[j].named) continue;
                     if (ls[j].named) {
-                        if (strcmp(irs[i].operands[1].label_name.data, ls[j].label_name.data)) continue;
+                        if (!String_eq(&irs[i].operands[1].label_name, &ls[j].label_name)) continue;
                     } else {
                         if (irs[i].operands[1].label_index != ls[j].label_index) continue;
                     }
@@ -408,20 +688,13 @@ void IR2AVR(IRArray *ir, AVRArray *AVR_instructions, LabelArray *labels, u64 reg
                 break;
             }
             case OP_IFN_JUMP: {
-                if (irs[i].operands[0].type == OT_TEMPORARY) {
-                    u8 rd = real_reg[irs[i].operands[0].temporary_id];
-                    APPEND_CMD(MOV, 24, rd);
-                } else {
-                    u8 k = (u8)irs[i].operands[0].integer_value;
-                    APPEND_CMD(LDI, 24, k);
-                }
-                APPEND_CMD(AND, 24, 24);
+                testValue(&irs[i].operands[0], &allocation, AVR_instructions);
                 APPEND_CMD(BRNE, 2);
                 
                 for (u64 j = 0; j < labels->count; ++j) {
                     if (irs[i].operands[1].named != ls[j].named) continue;
                     if (ls[j].named) {
-                        if (strcmp(irs[i].operands[1].label_name.data, ls[j].label_name.data)) continue;
+                        if (!String_eq(&irs[i].operands[1].label_name, &ls[j].label_name)) continue;
                     } else {
                         if (irs[i].operands[1].label_index != ls[j].label_index) continue;
                     }
@@ -431,10 +704,11 @@ void IR2AVR(IRArray *ir, AVRArray *AVR_instructions, LabelArray *labels, u64 reg
                 break;
             }
             case OP_CALL: {
+                called = irs[i].operands[0].entry;
                 for (u64 j = 0; j < labels->count; ++j) {
                     if (irs[i].operands[0].named != ls[j].named) continue;
                     if (ls[j].named) {
-                        if (strcmp(irs[i].operands[0].label_name.data, ls[j].label_name.data)) continue;
+                        if (!String_eq(&irs[i].operands[0].label_name, &ls[j].label_name)) continue;
                     } else {
                         if (irs[i].operands[0].label_index != ls[j].label_index) continue;
                     }
@@ -444,17 +718,17 @@ void IR2AVR(IRArray *ir, AVRArray *AVR_instructions, LabelArray *labels, u64 reg
                 break;
             }
             case OP_RETURN: {
-                if (irs[i].operands[0].type == OT_TEMPORARY) {
-                    u8 rd = real_reg[irs[i].operands[0].temporary_id];
-                    APPEND_CMD(MOV, 24, rd);
-                } else if (irs[i].operands[0].type != OT_NONE) {
-                    u16 k = (u16)irs[i].operands[0].integer_value;
-                    APPEND_CMD(LDI, 24, k & 0xFF);
-                }
-                APPEND_CMD(POP, 19);
-                APPEND_CMD(POP, 18);
-                APPEND_CMD(POP, 17);
-                APPEND_CMD(POP, 16);
+                const u8 returned = returnBytes(function_entry);
+                if (irs[i].operands[0].type != OT_NONE && returned) {
+                    loadValue(24, returned, &irs[i].operands[0], &allocation, AVR_instructions);
+                }
+                const u16 frame_size = allocation.frame_size[function];
+                if (frame_size) moveFramePointer(frame_size, AVR_instructions);
+                for (u8 r = LAST_REGISTER + 1; r-- > FIRST_REGISTER;) {
+                    if (allocation.saved[function] & (1u << r)) {
+                        APPEND_CMD(POP, r);
+                    }
+                }
                 
                 APPEND_CMD(POP, 29);
                 APPEND_CMD(POP, 28);
@@ -462,42 +736,89 @@ void IR2AVR(IRArray *ir, AVRArray *AVR_instructions, LabelArray *labels, u64 reg
                 break;
             }
             case OP_GET_RETURNED: {
-                u8 res = real_reg[irs[i].result.temporary_id];
-                APPEND_CMD(MOV, res, 24);
+                // NOTE(mdizdar): whatever got returned is in r24 and up, as wide as the function says it is
+                const u8 res = real_reg[irs[i].result.temporary_id];
+                const u8 bytes = widths[irs[i].result.temporary_id].bytes;
+                const u8 returned = returnBytes(called);
+                const u8 copied = returned < bytes ? returned : bytes;
+                copyRegisters(res, 24, copied, AVR_instructions);
+                extendRegisters(res, copied, bytes, returned && widthOfType(((SymbolTableEntry *)called)->type->function_type->return_type).is_signed, AVR_instructions);
                 break;
             }
             case OP_PRELUDE: {
-                // this isn't done, but it depends on the function
+                // NOTE(mdizdar): the callee saves whatever it writes, and the spilled values go between that and Y
                 APPEND_CMD(PUSH, 28);
                 APPEND_CMD(PUSH, 29);
+                for (u8 r = FIRST_REGISTER; r <= LAST_REGISTER; ++r) {
+                    if (allocation.saved[function] & (1u << r)) {
+                        APPEND_CMD(PUSH, r);
+                    }
+                }
                 APPEND_CMD(IN, 28, 0x3D);
                 APPEND_CMD(IN, 29, 0x3E);
+                const u16 frame_size = allocation.frame_size[function];
+                if (frame_size) moveFramePointer(-(s32)frame_size, AVR_instructions);
                 
-                APPEND_CMD(PUSH, 16);
-                APPEND_CMD(PUSH, 17);
-                APPEND_CMD(PUSH, 18);
-                APPEND_CMD(PUSH, 19);
-                
+                break;
+            }
+            case OP_LOAD: {
+                const u8 res = real_reg[irs[i].result.temporary_id];
+                const u8 bytes = widths[irs[i].result.temporary_id].bytes;
+                bool is_z;
+                const u8 slot = frameDisplacement(1 + irs[i].operands[0].integer_value, bytes, &is_z, AVR_instructions);
+                for (u8 k = 0; k < bytes; ++k) {
+                    APPEND_CMD((is_z ? LDDz : LDDy), res + k, slot + k);
+                }
+                break;
+            }
+            case OP_STORE: {
+                const u8 rd = real_reg[irs[i].operands[0].temporary_id];
+                const u8 bytes = widths[irs[i].operands[0].temporary_id].bytes;
+                bool is_z;
+                const u8 slot = frameDisplacement(1 + irs[i].operands[1].integer_value, bytes, &is_z, AVR_instructions);
+                for (u8 k = 0; k < bytes; ++k) {
+                    APPEND_CMD((is_z ? STDz : STDy), rd + k, slot + k);
+                }
                 break;
             }
             case OP_GET_ARG: {
-                u8 res = real_reg[irs[i].result.temporary_id];
-                u8 k = (u8)irs[i].operands[0].integer_value;;
-                APPEND_CMD(LDDy, res, k+4);
+                // NOTE(mdizdar): going up from Y there's the frame, the registers the prelude saved, Y itself, and the
+                // return address, and the arguments start right after that
+                const u8 res = real_reg[irs[i].result.temporary_id];
+                const Width width = widths[irs[i].result.temporary_id];
+                const u8 size = (u8)irs[i].operands[1].integer_value;
+                const u8 read = size < width.bytes ? size : width.bytes;
+                const u64 offset = allocation.frame_size[function] + savedCount(allocation.saved[function]) + 2 + RETURN_ADDRESS_BYTES + 1 + irs[i].operands[0].integer_value;
+                bool is_z;
+                const u8 displacement = frameDisplacement(offset, read, &is_z, AVR_instructions);
+                for (u8 k = 0; k < read; ++k) {
+                    APPEND_CMD((is_z ? LDDz : LDDy), res + k, displacement + k);
+                }
+                extendRegisters(res, read, width.bytes, width.is_signed, AVR_instructions);
                 break;
             }
             case OP_PUSH: {
-                if (irs[i].operands[0].type == OT_NONE) {
-                    for (u64 j = 0; j < irs[i].operands[1].integer_value; ++j) {
+                // NOTE(mdizdar): an argument takes up as many bytes as its parameter, pushed high byte first so it ends
+                // up little endian, and whatever's past the end of the value is its sign or zeroes
+                const IRVariable *value = &irs[i].operands[0];
+                const u8 size = (u8)irs[i].operands[1].integer_value;
+                for (u8 b = size; b-- > 0;) {
+                    if (value->type == OT_NONE) {
                         APPEND_CMD(PUSH, 0);
+                    } else if (value->type != OT_TEMPORARY) {
+                        APPEND_CMD(LDI, 24, literalByte(value, b));
+                        APPEND_CMD(PUSH, 24);
+                    } else if (b < widths[value->temporary_id].bytes) {
+                        APPEND_CMD(PUSH, real_reg[value->temporary_id] + b);
+                    } else {
+                        const Width width = widths[value->temporary_id];
+                        APPEND_CMD(CLR, 24);
+                        if (width.is_signed) {
+                            APPEND_CMD(SBRC, real_reg[value->temporary_id] + width.bytes - 1, 7);
+                            APPEND_CMD(COM, 24);
+                        }
+                        APPEND_CMD(PUSH, 24);
                     }
-                } else if (irs[i].operands[0].type == OT_TEMPORARY) {
-                    u8 rd = real_reg[irs[i].operands[0].temporary_id];
-                    APPEND_CMD(PUSH, rd);
-                } else {
-                    u8 k = (u8)irs[i].operands[0].integer_value;
-                    APPEND_CMD(LDI, 24, k & 0xFF);
-                    APPEND_CMD(PUSH, 24);
                 }
                 break;
             }
@@ -508,7 +829,9 @@ void IR2AVR(IRArray *ir, AVRArray *AVR_instructions, LabelArray *labels, u64 reg
                     }
                 } else if (irs[i].operands[0].type == OT_TEMPORARY) {
                     u8 rd = real_reg[irs[i].operands[0].temporary_id];
+                    const Width width = widths[irs[i].operands[0].temporary_id];
                     APPEND_CMD(POP, rd);
+                    extendRegisters(rd, 1, width.bytes, width.is_signed, AVR_instructions);
                 }
                 break;
             }
@@ -523,10 +846,6 @@ void IR2AVR(IRArray *ir, AVRArray *AVR_instructions, LabelArray *labels, u64 reg
     }
     AVR *ins = AVR_instructions->data;
     for (u64 i = 0; i < AVR_instructions->count; ++i) {
-        if (i == skip_label_swap) {
-            ++i;
-            continue;
-        }
         if ((ins[i] & 0xFE0E) == 0x940E) {
             u32 address = ((u32)(ins[i] & 0x01F1) << 16) | ins[i+1];
             u32 c = CALL(ls[address].correct_address);
@@ -541,6 +860,7 @@ void IR2AVR(IRArray *ir, AVRArray *AVR_instructions, LabelArray *labels, u64 reg
             ++i;
         }
     }
+    Allocation_destruct(&allocation);
 #undef APPEND_CMD
 #undef APPEND_LONG_CMD
 }
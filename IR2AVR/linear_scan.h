@@ -0,0 +1,302 @@
+#ifndef LINEAR_SCAN_H
+#define LINEAR_SCAN_H
+
+#include "register_allocation.h"
+
+// NOTE(mdizdar): the quick alternative to allocateRegisters, for when getting the program compiled matters more than
+// how fast it runs (-O1). Every instruction i gets two positions, 2i where it reads its operands and 2i+1 where it
+// writes its result, and a temporary's live interval is a list of [from, to) ranges over those, with holes wherever
+// it isn't live. Then it's second-chance binpacking: the intervals go into registers in the order they start, and an
+// interval fits into a register if it only overlaps the holes of whatever's already there. When nothing fits, either
+// it or whatever's in its way in the cheapest register gets spilled, and spilled values get their second chance
+// through the spill code, which reloads them into short intervals of their own right where they're used. No graph,
+// no coalescing, a copy just tries to go where its source was first. Every register is a bin, and a value wider than a
+// byte has to fit into as many of them in a row, starting at an even one
+//
+// bench/cycles.sh runs the code both allocators generate through bench/avr_sim.c and compares the cycle counts
+
+typedef struct LiveRange {
+    u64 from;
+    u64 to;
+} LiveRange;
+
+_generate_dynamic_array(LiveRange);
+
+typedef struct IntervalStart {
+    u64 from;
+    TemporaryID temporary;
+} IntervalStart;
+
+// NOTE(mdizdar): the intervals get built back to front, so the ranges come in going down, and every new one is
+// either before all the others or overlaps the first of them
+static inline void addRange(LiveRangeArray *ranges, u64 from, u64 to) {
+    if (ranges->count) {
+        LiveRange *first = &ranges->data[ranges->count-1];
+        if (to >= first->from) {
+            if (from < first->from) first->from = from;
+            if (to > first->to) first->to = to;
+            return;
+        }
+    }
+    LiveRangeArray_push_back(ranges, (LiveRange){ .from = from, .to = to });
+}
+
+// a write starts the interval where it happens, it was live from the start of the block until now
+static inline void startRange(LiveRangeArray *ranges, u64 from) {
+    ranges->data[ranges->count-1].from = from;
+}
+
+static LiveRangeArray *buildIntervals(IRArray *ir, TemporaryID temporary_count) {
+    IR *irs = ir->data;
+    Liveness liveness = livenessAnalysis(ir, temporary_count);
+    BasicBlock **bbs = liveness.blocks.data;
+    const u64 words = liveness.words;
+    LiveRangeArray *ranges = malloc(sizeof(LiveRangeArray) * temporary_count);
+    for (TemporaryID t = 0; t < temporary_count; ++t) {
+        LiveRangeArray_construct(&ranges[t]);
+    }
+    u64 *live = malloc(sizeof(u64) * (words + 1));
+    for (u64 b = liveness.blocks.count; b-- > 0;) {
+        const u64 begin = 2*bbs[b]->begin;
+        Bitset_copy(live, liveness.live_out + b * words, words);
+        u64 t;
+        BITSET_EACH(t, live, words) {
+            addRange(&ranges[t], begin, 2*bbs[b]->end + 2);
+        }
+        for (u64 i = bbs[b]->end + 1; i-- > bbs[b]->begin;) {
+            const LiveEffect effect = liveEffect(&irs[i]);
+            const IRVariable *def = definedTemporary(&irs[i]);
+            if (def) {
+                // nobody reads it, but it still needs a register to be written into
+                if (!Bitset_isSet(live, def->temporary_id)) addRange(&ranges[def->temporary_id], 2*i + 1, 2*i + 2);
+                if (effect.def) startRange(&ranges[def->temporary_id], 2*i + 1);
+            }
+            if (effect.def) Bitset_clear(live, effect.def->temporary_id);
+            // NOTE(mdizdar): an operand the lowering reads after it's written the result has to make it past the write
+            const u8 clobbered = def ? clobberedOperands(irs[i].instruction) : 0;
+            for (u64 k = 0; k < 2; ++k) {
+                if (!effect.uses[k]) continue;
+                addRange(&ranges[effect.uses[k]->temporary_id], begin, (clobbered & (1 << k)) ? 2*i + 2 : 2*i + 1);
+                Bitset_set(live, effect.uses[k]->temporary_id);
+            }
+        }
+    }
+    free(live);
+    Liveness_destruct(&liveness);
+
+    for (TemporaryID t = 0; t < temporary_count; ++t) {
+        LiveRange *data = ranges[t].data;
+        for (u64 i = 0, j = ranges[t].count; i + 1 < j; ++i, --j) {
+            const LiveRange swap = data[i];
+            data[i] = data[j-1];
+            data[j-1] = swap;
+        }
+    }
+    return ranges;
+}
+
+static bool overlaps(const LiveRangeArray *a, const LiveRangeArray *b) {
+    u64 i = 0, j = 0;
+    while (i < a->count && j < b->count) {
+        if (a->data[i].to <= b->data[j].from) {
+            ++i;
+        } else if (b->data[j].to <= a->data[i].from) {
+            ++j;
+        } else {
+            return true;
+        }
+    }
+    return false;
+}
+
+static int compareIntervalStarts(const void *a, const void *b) {
+    const IntervalStart *x = a;
+    const IntervalStart *y = b;
+    if (x->from != y->from) return (x->from > y->from) - (x->from < y->from);
+    return (x->temporary > y->temporary) - (x->temporary < y->temporary);
+}
+
+static inline bool fits(const u64Array *bin, const LiveRangeArray *ranges, TemporaryID t) {
+    for (ARRAY_EACH(u64, other, bin)) {
+        if (overlaps(&ranges[*other], &ranges[t])) return false;
+    }
+    return true;
+}
+
+static inline bool fitsAt(const u64Array *bins, const LiveRangeArray *ranges, u8 base, u8 bytes, TemporaryID t) {
+    for (u8 r = base; r < base + bytes; ++r) {
+        if (!fits(&bins[r], ranges, t)) return false;
+    }
+    return true;
+}
+
+// NOTE(mdizdar): what it'd cost to empty out everything in bins[base..base+bytes) that's in t's way, (u64)-1 if
+// something there can't be spilled. Something wider than a byte is in more than one of them, it only gets counted in
+// the first one they share
+static inline u64 evictionCost(const u64Array *bins, const LiveRangeArray *ranges, const u64 *cost, const u8 *real_reg, u8 base, u8 bytes, TemporaryID t) {
+    u64 total = 0;
+    for (u8 r = base; r < base + bytes; ++r) {
+        for (ARRAY_EACH(u64, other, &bins[r])) {
+            if (r != (real_reg[*other] > base ? real_reg[*other] : base)) continue;
+            if (!overlaps(&ranges[*other], &ranges[t])) continue;
+            if (cost[*other] == (u64)-1 || total + cost[*other] < total) return (u64)-1;
+            total += cost[*other];
+        }
+    }
+    return total;
+}
+
+// a copy goes where its source was if it can, IR2AVR doesn't bother with a MOV then
+static inline u8 copyHint(const IR *irs, const u8 *real_reg, const Width *widths, u64 from) {
+    if (from % 2 == 0) return NO_REGISTER;
+    const IR *it = &irs[from / 2];
+    if (it->instruction != '=' || it->result.type != OT_TEMPORARY || it->operands[0].type != OT_TEMPORARY) return NO_REGISTER;
+    const u8 hint = real_reg[it->operands[0].temporary_id];
+    return hint != NO_REGISTER && hint % alignmentOf(widths[it->result.temporary_id].bytes) == 0 ? hint : NO_REGISTER;
+}
+
+static inline void removeFromBin(u64Array *bin, TemporaryID t) {
+    u64 kept = 0;
+    for (u64 j = 0; j < bin->count; ++j) {
+        if (bin->data[j] != t) bin->data[kept++] = bin->data[j];
+    }
+    bin->count = kept;
+}
+
+// returns whether anything got spilled
+static bool binpack(IRArray *ir, const LiveRangeArray *ranges, const bool *needs_immediate, const bool *prefers_immediate, const Width *widths, const u64 *cost, TemporaryID temporary_count, u8 *real_reg, bool *spilled) {
+    const IR *irs = ir->data;
+    IntervalStart *order = malloc(sizeof(IntervalStart) * (temporary_count + 1));
+    u64 interval_count = 0;
+    for (TemporaryID t = 0; t < temporary_count; ++t) {
+        real_reg[t] = NO_REGISTER;
+        spilled[t] = false;
+        if (ranges[t].count) order[interval_count++] = (IntervalStart){ .from = ranges[t].data[0].from, .temporary = t };
+    }
+    if (interval_count) qsort(order, interval_count, sizeof(IntervalStart), compareIntervalStarts);
+
+    u64Array bins[LAST_REGISTER + 1];
+    for (u8 r = 0; r <= LAST_REGISTER; ++r) {
+        u64Array_construct(&bins[r]);
+    }
+    bool any_spilled = false;
+    for (u64 k = 0; k < interval_count; ++k) {
+        const TemporaryID t = order[k].temporary;
+        const u64 from = order[k].from;
+        const u8 bytes = widths[t].bytes;
+        const u8 first = firstRegister(needs_immediate[t]);
+        const u8 last = LAST_REGISTER + 1 - bytes;
+        const u8 step = alignmentOf(bytes);
+        // whatever's over by now can't be in anyone's way anymore
+        for (u8 r = FIRST_REGISTER; r <= LAST_REGISTER; ++r) {
+            u64 kept = 0;
+            for (u64 j = 0; j < bins[r].count; ++j) {
+                const LiveRangeArray *other = &ranges[bins[r].data[j]];
+                if (other->data[other->count-1].to > from) bins[r].data[kept++] = bins[r].data[j];
+            }
+            bins[r].count = kept;
+        }
+
+        u8 chosen = copyHint(irs, real_reg, widths, from);
+        if (chosen < first || chosen > last || !fitsAt(bins, ranges, chosen, bytes, t)) {
+            chosen = NO_REGISTER;
+            for (u8 r = FIRST_IMMEDIATE_REGISTER; prefers_immediate[t] && r <= last && chosen == NO_REGISTER; r += step) {
+                if (fitsAt(bins, ranges, r, bytes, t)) chosen = r;
+            }
+            for (u8 r = first; r <= last && chosen == NO_REGISTER; r += step) {
+                if (fitsAt(bins, ranges, r, bytes, t)) chosen = r;
+            }
+        }
+        if (chosen == NO_REGISTER) {
+            u64 cheapest = (u64)-1;
+            for (u8 r = first; r <= last; r += step) {
+                const u64 c = evictionCost(bins, ranges, cost, real_reg, r, bytes, t);
+                if (c < cheapest) {
+                    cheapest = c;
+                    chosen = r;
+                }
+            }
+            if (chosen == NO_REGISTER || cheapest >= cost[t]) {
+                if (cost[t] == (u64)-1) error(0, "too many registers required");
+                spilled[t] = true;
+                any_spilled = true;
+                continue;
+            }
+            for (u8 r = chosen; r < chosen + bytes; ++r) {
+                for (u64 j = 0; j < bins[r].count;) {
+                    const TemporaryID other = bins[r].data[j];
+                    if (!overlaps(&ranges[other], &ranges[t])) {
+                        ++j;
+                        continue;
+                    }
+                    for (u8 o = real_reg[other]; o < real_reg[other] + widths[other].bytes; ++o) {
+                        removeFromBin(&bins[o], other);
+                    }
+                    real_reg[other] = NO_REGISTER;
+                    spilled[other] = true;
+                    any_spilled = true;
+                }
+            }
+        }
+        real_reg[t] = chosen;
+        for (u8 r = chosen; r < chosen + bytes; ++r) {
+            u64Array_push_back(&bins[r], t);
+        }
+    }
+    for (u8 r = 0; r <= LAST_REGISTER; ++r) {
+        u64Array_destruct(&bins[r]);
+    }
+    free(order);
+    return any_spilled;
+}
+
+// NOTE(mdizdar): build the intervals, pack them, and if something got spilled, put the loads and stores in and go
+// again. The reloads can't be spilled, so this runs out of things to spill the same way allocateRegisters does
+Allocation allocateRegistersLinearScan(IRArray *ir, LabelArray *labels, Arena *arena) {
+    Allocation allocation = Allocation_make(ir);
+    const TemporaryID spill_temporaries = temporary_index;
+
+    for (;;) {
+        makeBasicBlocks(ir, labels);
+        const TemporaryID temporary_count = temporary_index;
+        u64 *weight = instructionWeights(ir);
+        bool *read = calloc(temporary_count, sizeof(bool));
+        bool *needs_immediate = calloc(temporary_count, sizeof(bool));
+        u64 *cost = calloc(temporary_count, sizeof(u64));
+        bool *shared = calloc(temporary_count, sizeof(bool));
+        countMentions(ir, weight, read, needs_immediate, cost, shared);
+        for (TemporaryID t = 0; t < temporary_count; ++t) {
+            if (t >= spill_temporaries || shared[t]) cost[t] = (u64)-1;
+        }
+        free(weight);
+        free(shared);
+        bool *prefers_immediate = preferredImmediates(ir, temporary_count);
+
+        LiveRangeArray *ranges = buildIntervals(ir, temporary_count);
+        allocation.real_reg = realloc(allocation.real_reg, sizeof(u8) * temporary_count);
+        bool *spilled = malloc(sizeof(bool) * temporary_count);
+        const bool any_spilled = binpack(ir, ranges, needs_immediate, prefers_immediate, allocation.widths.data, cost, temporary_count, allocation.real_reg, spilled);
+        for (TemporaryID t = 0; t < temporary_count; ++t) {
+            LiveRangeArray_destruct(&ranges[t]);
+        }
+        free(ranges);
+        free(needs_immediate);
+        free(prefers_immediate);
+        free(cost);
+        if (!any_spilled) {
+            free(read);
+            free(spilled);
+            break;
+        }
+        insertSpillCode(ir, spilled, read, &allocation.widths, arena);
+        free(read);
+        free(spilled);
+        LabelArray_destruct(labels);
+        *labels = findLabels(ir);
+    }
+    assignSlots(ir, &allocation);
+    findSavedRegisters(ir, &allocation);
+    return allocation;
+}
+
+#endif // LINEAR_SCAN_H
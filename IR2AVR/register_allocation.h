@@ -0,0 +1,922 @@
+#ifndef REGISTER_ALLOCATION_H
+#define REGISTER_ALLOCATION_H
+
+#include "../utils/common.h"
+#include "../utils/bitset.h"
+#include "../IR/IR.h"
+#include "../IR/CFG.h"
+#include "../IR/liveness_analysis.h"
+#include "../IR/dominators.h"
+#include "../IR/loops.h"
+#include "widths.h"
+
+extern TemporaryID temporary_index;
+
+#define NO_REGISTER 255
+// NOTE(mdizdar): r0 and r1 are where MUL leaves its result, r24-r27 are scratch for the lowering and where values get
+// returned, and the pointer pairs are spoken for: X does post-increments, Y is the frame pointer and Z is for
+// everything else going through a pointer. That leaves r2-r23, and only r16 and up can take an immediate. A value
+// wider than a byte takes that many registers in a row, starting at an even one so MOVW can move it around. None of
+// the pairs ADIW and SBIW work on are left over, so only Y ever gets those, see IR2AVR's '+'
+#define FIRST_REGISTER 2
+#define FIRST_IMMEDIATE_REGISTER 16
+#define LAST_REGISTER 23
+#define REGISTER_COUNT (LAST_REGISTER - FIRST_REGISTER + 1)
+#define IMMEDIATE_REGISTER_COUNT (LAST_REGISTER - FIRST_IMMEDIATE_REGISTER + 1)
+
+// -O2 colours the interference graph, -O1 does a linear scan, which is quicker to run but not as good at it
+typedef enum RegisterAllocator {
+    ALLOCATOR_GRAPH_COLOURING,
+    ALLOCATOR_LINEAR_SCAN,
+} RegisterAllocator;
+
+typedef struct Allocation {
+    u8 *real_reg;       // per temporary, NO_REGISTER for the ones that don't come up anywhere
+    WidthArray widths;  // per temporary, the value takes real_reg up to real_reg + bytes - 1
+    u64 function_count; // a function starts at every named label, __start included
+    u16 *frame_size;    // per function, how many bytes of spilled values it keeps at Y+1 and up
+    u32 *saved;         // per function, bit r is set if it writes rr, which it then has to save and restore
+} Allocation;
+
+// NOTE(mdizdar): which operands (bit 0 for the first, bit 1 for the second) can't share a register with the result.
+// The two address ones get lowered as res = op0; res op= op1, so only op1 gets overwritten before it's read, and a
+// multiplication adds its partial products up in res, so neither can be there. Everything else reads all of its
+// operands before it writes anything, a shift starts by putting its count away in r31
+static inline u8 clobberedOperands(Op instruction) {
+    switch ((int)instruction) {
+        case '=': case '~': case '!': case OP_PLUS: case OP_MINUS: case OP_ADDRESS: case OP_DEREF: return 0;
+        case '<': case '>': case OP_LESS_EQ: case OP_GREATER_EQ: case OP_EQUALS: case OP_NOT_EQ: return 0;
+        case OP_LOGICAL_OR: case OP_LOGICAL_AND: case OP_BITSHIFT_LEFT: case OP_BITSHIFT_RIGHT: return 0;
+        case '|': case '&': case '^': case '+': case '-': return 2;
+        default: return 3;
+    }
+}
+
+// NOTE(mdizdar): same bits as above, plus bit 2 for the result. These are the ones IR2AVR uses LDI, SUBI, SBCI, ANDI
+// or ORI on, which only work on r16 and up. Anything that isn't a temporary gets loaded with an LDI, and a comparison
+// only uses CPI when it can, so its operands can go anywhere. A literal copied into a temporary can go anywhere too,
+// it's a MOV through r31 below r16, but that's mostly what a phi sets a loop's counter to before the loop, and that
+// shouldn't keep it from sharing a register with what it's set to every time around, see preferredImmediates
+static inline u8 immediateOperands(const IR *ir) {
+    const bool literal0 = ir->operands[0].type != OT_TEMPORARY;
+    const bool literal1 = ir->operands[1].type != OT_TEMPORARY;
+    switch ((int)ir->instruction) {
+        case '!': case '<': case '>': case OP_LESS_EQ: case OP_GREATER_EQ: case OP_EQUALS: case OP_NOT_EQ: return 4;
+        case '|': case '&': case '+': case '-': return literal0 || literal1 ? 4 : 0;
+        case '^': case '~': case OP_PLUS: case OP_MINUS: case OP_BITSHIFT_LEFT: case OP_BITSHIFT_RIGHT: {
+            return literal0 ? 4 : 0;
+        }
+        default: return 0;
+    }
+}
+
+// NOTE(mdizdar): the ones that can go anywhere but would rather be in r16 and up, which colouring gives them if it's
+// free when their turn comes: a literal copied into them doesn't need the MOV through r31 there, and they can be
+// compared to a literal with CPI
+static bool *preferredImmediates(const IRArray *ir, TemporaryID temporary_count) {
+    bool *prefers = calloc(temporary_count, sizeof(bool));
+    for (ARRAY_EACH(IR, it, ir)) {
+        const bool literal0 = it->operands[0].type != OT_TEMPORARY;
+        const bool literal1 = it->operands[1].type != OT_TEMPORARY;
+        switch ((int)it->instruction) {
+            case '=': {
+                if (it->result.type == OT_TEMPORARY && literal0) prefers[it->result.temporary_id] = true;
+                break;
+            }
+            case '<': case '>': case OP_LESS_EQ: case OP_GREATER_EQ: case OP_EQUALS: case OP_NOT_EQ: {
+                if (!literal0 && literal1) prefers[it->operands[0].temporary_id] = true;
+                break;
+            }
+            default: break;
+        }
+    }
+    return prefers;
+}
+
+// the temporary an instruction writes, unlike liveEffect this counts the ones that read it first too
+static inline IRVariable *definedTemporary(IR *ir) {
+    switch ((int)ir->instruction) {
+        case OP_POP: return ir->operands[0].type == OT_TEMPORARY ? &ir->operands[0] : NULL;
+        case OP_PUSH: case OP_RETURN: case OP_IF_JUMP: case OP_IFN_JUMP: case OP_LABEL: case OP_JUMP:
+        case OP_ERROR: case OP_PRELUDE: case OP_CALL: case OP_STORE: {
+            return NULL;
+        }
+        case OP_DEREF: return ir->result.type == OT_TEMPORARY || ir->result.type == OT_REFERENCE ? &ir->result : NULL;
+        default: return ir->result.type == OT_TEMPORARY ? &ir->result : NULL;
+    }
+}
+
+static inline bool startsFunction(const IR *ir) {
+    return ir->instruction == OP_LABEL && ir->operands[0].named;
+}
+
+// a copy that could go away if both sides got the same registers, which needs them to be the same kind of value
+static inline bool isMove(const IR *ir, const Width *widths) {
+    return ir->instruction == '=' && ir->result.type == OT_TEMPORARY && ir->operands[0].type == OT_TEMPORARY &&
+           Width_eq(widths[ir->result.temporary_id], widths[ir->operands[0].temporary_id]);
+}
+
+// NOTE(mdizdar): one function's interference graph. Only the temporaries the function mentions get a node, numbered
+// in the order they come up, so everything in here is as big as the function and not the whole program. Whether two
+// nodes interfere is a bit in a triangular matrix, which is also what keeps the adjacency lists free of duplicates.
+// The moves aren't kept free of them, a temporary that gets copied to the same place twice is just asked about twice
+typedef struct Interference {
+    u64Array temporaries; // node -> temporary
+    u64 *matrix;          // bit b*(b-1)/2 + a says whether a < b interfere
+    u64Array *adjacent;   // node -> nodes
+    u64Array *moves;      // node -> nodes it gets copied to or from
+} Interference;
+
+#define NO_NODE ((u64)-1)
+
+static inline u64 pairBit(u64 a, u64 b) {
+    return a < b ? b*(b-1)/2 + a : a*(a-1)/2 + b;
+}
+
+static inline bool interferes(const Interference *graph, u64 a, u64 b) {
+    return a != b && Bitset_isSet(graph->matrix, pairBit(a, b));
+}
+
+static inline void addInterference(Interference *graph, u64 a, u64 b) {
+    if (a == b) return;
+    const u64 bit = pairBit(a, b);
+    if (Bitset_isSet(graph->matrix, bit)) return;
+    Bitset_set(graph->matrix, bit);
+    u64Array_push_back(&graph->adjacent[a], b);
+    u64Array_push_back(&graph->adjacent[b], a);
+}
+
+static inline void addNode(Interference *graph, u64 *node_of, const IRVariable *var) {
+    if (!var || node_of[var->temporary_id] != NO_NODE) return;
+    node_of[var->temporary_id] = graph->temporaries.count;
+    u64Array_push_back(&graph->temporaries, var->temporary_id);
+}
+
+static inline u8 firstRegister(bool needs_immediate) {
+    return needs_immediate ? FIRST_IMMEDIATE_REGISTER : FIRST_REGISTER;
+}
+
+// the registers a value of this many bytes can start at go up by this much
+static inline u8 alignmentOf(u8 bytes) {
+    return bytes > 1 ? 2 : 1;
+}
+
+// NOTE(mdizdar): how many places there are to put a value, which is what colouring counts instead of registers
+static inline u64 placements(bool needs_immediate, u8 bytes) {
+    return (LAST_REGISTER + 1 - bytes - firstRegister(needs_immediate)) / alignmentOf(bytes) + 1;
+}
+
+static inline u64 colours(const bool *needs_immediate, const Width *widths, TemporaryID t) {
+    return placements(needs_immediate[t], widths[t].bytes);
+}
+
+// NOTE(mdizdar): how many of the places a value of these many bytes could go, one of this many bytes can be in the
+// way of. Pairs only ever start on even registers so they can't straddle two, but quads can overlap by a pair
+static inline u64 blocked(u8 neighbour_bytes, u8 bytes) {
+    switch (bytes) {
+        case 1:  return neighbour_bytes;
+        case 2:  return (neighbour_bytes + 1) / 2;
+        default: return neighbour_bytes > 2 ? 3 : 2;
+    }
+}
+
+// what the neighbours of a node of these many bytes take away from it between them
+static inline u64 pressureOn(const Interference *graph, const Width *widths, u64 n, u8 bytes) {
+    u64 pressure = 0;
+    for (ARRAY_EACH(u64, m, &graph->adjacent[n])) {
+        pressure += blocked(widths[graph->temporaries.data[*m]].bytes, bytes);
+    }
+    return pressure;
+}
+
+// a mask of the registers a value takes
+static inline u32 registersOf(u8 reg, u8 bytes) {
+    return ((1u << bytes) - 1) << reg;
+}
+
+// NOTE(mdizdar): what both allocators want to know about every temporary: whether anything reads it, whether it has
+// to be in r16 and up, and how much it'd cost to keep it in memory. shared can be NULL, otherwise it says whether more
+// than one function mentions the temporary, in which case it has to be in the same place in all of them
+static void countMentions(IRArray *ir, const u64 *weight, bool *read, bool *needs_immediate, u64 *cost, bool *shared) {
+    IR *irs = ir->data;
+    u64 *function_of = NULL;
+    if (shared) {
+        function_of = malloc(sizeof(u64) * temporary_index);
+        memset(function_of, 0xFF, sizeof(u64) * temporary_index);
+    }
+    u64 function = 0;
+    for (u64 i = 0; i < ir->count; ++i) {
+        if (startsFunction(&irs[i])) ++function;
+        const LiveEffect effect = liveEffect(&irs[i]);
+        const IRVariable *def = definedTemporary(&irs[i]);
+        const u8 immediate = immediateOperands(&irs[i]);
+        const IRVariable *mentioned[3] = { effect.uses[0], effect.uses[1], def };
+        for (u64 k = 0; k < 3; ++k) {
+            if (!mentioned[k]) continue;
+            const TemporaryID t = mentioned[k]->temporary_id;
+            cost[t] += weight[i];
+            if (shared) {
+                if (function_of[t] != function && function_of[t] != (u64)-1) shared[t] = true;
+                function_of[t] = function;
+            }
+            if (k == 2) continue;
+            read[t] = true;
+            if ((immediate & (1 << k)) && effect.uses[k] == &irs[i].operands[k]) needs_immediate[t] = true;
+        }
+        if (def && (immediate & 4)) needs_immediate[def->temporary_id] = true;
+    }
+    free(function_of);
+}
+
+// NOTE(mdizdar): what a load or store costs where it happens, ten times as much for every loop it's in. This needs
+// the blocks, and it has to happen before liveness since the two disagree on what block->order means
+static u64 *instructionWeights(IRArray *ir) {
+    IR *irs = ir->data;
+    Dominators dominators = dominatorAnalysis(ir);
+    Loops loops = loopAnalysis(&dominators);
+    u64 *loop_weight = malloc(sizeof(u64) * (loops.count + 1));
+    for (u64 l = 0; l < loops.count; ++l) {
+        const u64 outer = loops.parent[l] == NO_LOOP ? 1 : loop_weight[loops.parent[l]];
+        loop_weight[l] = outer < 100000 ? outer * 10 : outer;
+    }
+    u64 *weight = malloc(sizeof(u64) * ir->count);
+    for (u64 i = 0; i < ir->count; ++i) {
+        const u64 l = loops.innermost[irs[i].block->order];
+        weight[i] = l == NO_LOOP ? 1 : loop_weight[l];
+    }
+    free(loop_weight);
+    Loops_destruct(&loops);
+    Dominators_destruct(&dominators);
+    return weight;
+}
+
+// NOTE(mdizdar): one backward walk over each of the function's blocks (blocks[first..last)), starting from what's live
+// coming out of it. A temporary interferes with whatever's live right after it's written, except for a copy's source,
+// which is what lets the two share a register. That only works when they're the same size and can't be put half on
+// top of each other, a quad copied onto the pair above where it was would overwrite its own top half before it's read.
+// node_of has to be all NO_NODE going in
+static Interference buildInterference(const IRArray *ir, const Liveness *liveness, const Width *widths, u64 first, u64 last, u64 *node_of) {
+    IR *irs = ir->data;
+    BasicBlock **bbs = liveness->blocks.data;
+    Interference graph;
+    u64Array_construct(&graph.temporaries);
+    for (u64 b = first; b < last; ++b) {
+        for (u64 i = bbs[b]->begin; i <= bbs[b]->end; ++i) {
+            const LiveEffect effect = liveEffect(&irs[i]);
+            addNode(&graph, node_of, effect.uses[0]);
+            addNode(&graph, node_of, effect.uses[1]);
+            addNode(&graph, node_of, effect.def);
+            addNode(&graph, node_of, definedTemporary(&irs[i]));
+        }
+    }
+    const u64 count = graph.temporaries.count;
+    graph.matrix = calloc(BITSET_WORDS(count * (count - 1) / 2) + 1, sizeof(u64));
+    graph.adjacent = malloc(sizeof(u64Array) * count);
+    graph.moves = malloc(sizeof(u64Array) * count);
+    for (u64 n = 0; n < count; ++n) {
+        u64Array_construct(&graph.adjacent[n]);
+        u64Array_construct(&graph.moves[n]);
+    }
+
+    const u64 words = BITSET_WORDS(count);
+    u64 *live = malloc(sizeof(u64) * (words + 1));
+    for (u64 b = first; b < last; ++b) {
+        memset(live, 0, sizeof(u64) * words);
+        u64 t;
+        BITSET_EACH(t, liveness->live_out + b * liveness->words, liveness->words) {
+            // NOTE(mdizdar): falling off the end of a function goes into the next one, what's live there isn't ours
+            if (node_of[t] != NO_NODE) Bitset_set(live, node_of[t]);
+        }
+        for (u64 i = bbs[b]->end + 1; i-- > bbs[b]->begin;) {
+            const LiveEffect effect = liveEffect(&irs[i]);
+            const IRVariable *def = definedTemporary(&irs[i]);
+            if (def) {
+                const u64 d = node_of[def->temporary_id];
+                const bool copies = irs[i].instruction == '=' && irs[i].operands[0].type == OT_TEMPORARY &&
+                                    widths[def->temporary_id].bytes == widths[irs[i].operands[0].temporary_id].bytes &&
+                                    widths[def->temporary_id].bytes <= 2;
+                const u64 source = copies ? node_of[irs[i].operands[0].temporary_id] : NO_NODE;
+                if (isMove(&irs[i], widths) && d != node_of[irs[i].operands[0].temporary_id]) {
+                    u64Array_push_back(&graph.moves[d], node_of[irs[i].operands[0].temporary_id]);
+                    u64Array_push_back(&graph.moves[node_of[irs[i].operands[0].temporary_id]], d);
+                }
+                u64 n;
+                BITSET_EACH(n, live, words) {
+                    if (n != source) addInterference(&graph, d, n);
+                }
+                // NOTE(mdizdar): an operand that dies right here still can't share a register with the result if the
+                // lowering overwrites the result before it reads the operand
+                const u8 clobbered = clobberedOperands(irs[i].instruction);
+                for (u64 j = 0; j < 2; ++j) {
+                    if (!(clobbered & (1 << j)) || !effect.uses[j]) continue;
+                    addInterference(&graph, d, node_of[effect.uses[j]->temporary_id]);
+                }
+            }
+            if (effect.def) Bitset_clear(live, node_of[effect.def->temporary_id]);
+            if (effect.uses[0]) Bitset_set(live, node_of[effect.uses[0]->temporary_id]);
+            if (effect.uses[1]) Bitset_set(live, node_of[effect.uses[1]->temporary_id]);
+        }
+    }
+    free(live);
+    return graph;
+}
+
+// also puts node_of back the way buildInterference found it
+static void Interference_destruct(Interference *graph, u64 *node_of) {
+    for (u64 n = 0; n < graph->temporaries.count; ++n) {
+        node_of[graph->temporaries.data[n]] = NO_NODE;
+        u64Array_destruct(&graph->adjacent[n]);
+        u64Array_destruct(&graph->moves[n]);
+    }
+    free(graph->adjacent);
+    free(graph->moves);
+    free(graph->matrix);
+    u64Array_destruct(&graph->temporaries);
+}
+
+static inline bool isSignificant(const Interference *graph, const bool *needs_immediate, const Width *widths, u64 n) {
+    const TemporaryID t = graph->temporaries.data[n];
+    return pressureOn(graph, widths, n, widths[t].bytes) >= colours(needs_immediate, widths, t);
+}
+
+// NOTE(mdizdar): Briggs' conservative test: if the neighbours a and b have between them that can't be simplified away
+// don't take up every place the two could go together, the rest of them get simplified away first and the two still
+// get registers together. a and b have to be the same size for them to be merged in the first place
+static bool briggs(const Interference *graph, const bool *needs_immediate, const Width *widths, u64 a, u64 b) {
+    const TemporaryID *temporary = graph->temporaries.data;
+    const u8 bytes = widths[temporary[a]].bytes;
+    const u64 k = placements(needs_immediate[temporary[a]] || needs_immediate[temporary[b]], bytes);
+    u64 significant = 0;
+    for (ARRAY_EACH(u64, n, &graph->adjacent[a])) {
+        if (!isSignificant(graph, needs_immediate, widths, *n)) continue;
+        significant += blocked(widths[temporary[*n]].bytes, bytes);
+        if (significant >= k) return false;
+    }
+    for (ARRAY_EACH(u64, n, &graph->adjacent[b])) {
+        // the ones they share were counted with a
+        if (interferes(graph, *n, a) || !isSignificant(graph, needs_immediate, widths, *n)) continue;
+        significant += blocked(widths[temporary[*n]].bytes, bytes);
+        if (significant >= k) return false;
+    }
+    return true;
+}
+
+// NOTE(mdizdar): George's test, which is the one that still works when b has a lot of neighbours: a can go wherever b
+// goes if every neighbour of a that can't be simplified away is already in b's way. That only holds if b doesn't lose
+// any places to go by it, so a can't be the one that needs an immediate
+static bool george(const Interference *graph, const bool *needs_immediate, const Width *widths, u64 a, u64 b) {
+    const TemporaryID *temporary = graph->temporaries.data;
+    if (needs_immediate[temporary[a]] && !needs_immediate[temporary[b]]) return false;
+    for (ARRAY_EACH(u64, n, &graph->adjacent[a])) {
+        if (!interferes(graph, *n, b) && isSignificant(graph, needs_immediate, widths, *n)) return false;
+    }
+    return true;
+}
+
+static inline bool canCoalesce(const Interference *graph, const bool *needs_immediate, const Width *widths, u64 a, u64 b) {
+    return briggs(graph, needs_immediate, widths, a, b) || george(graph, needs_immediate, widths, a, b) ||
+           george(graph, needs_immediate, widths, b, a);
+}
+
+typedef struct CopyCandidate {
+    u64 weight;
+    u64 at;
+} CopyCandidate;
+
+// the hottest first, and the ones that come first in the code first out of those
+static int compareCopyCandidates(const void *a, const void *b) {
+    const CopyCandidate *x = a;
+    const CopyCandidate *y = b;
+    if (x->weight != y->weight) return (x->weight < y->weight) - (x->weight > y->weight);
+    return (x->at > y->at) - (x->at < y->at);
+}
+
+// every mention of a temporary that got merged into another one becomes that one
+static inline void renameMerged(IRVariable *var, const Interference *graph, const u64 *node_of, const u64 *merged_into) {
+    if (var->type != OT_TEMPORARY && var->type != OT_REFERENCE) return;
+    const u64 n = node_of[var->temporary_id];
+    if (n != NO_NODE && merged_into[n] != NO_NODE) var->temporary_id = graph->temporaries.data[merged_into[n]];
+}
+
+// NOTE(mdizdar): goes over the function's copies (out of irs[begin..end]) and returns whether anything got merged, in
+// which case the interference has to be built again. Temporaries from more than one function are left alone, the
+// other functions wouldn't know about the merge, and so are copies that widen or narrow what they copy. The copies in
+// the deepest loops get their turn first, a phi's copies on the way into a loop and on the way around it tend to
+// fight over the same temporaries, and whichever one loses is the one that's left as a MOV
+static bool coalesceCopies(IRArray *ir, const Interference *graph, const u64 *node_of, const bool *needs_immediate, const Width *widths, const bool *shared, const u64 *weight, u64 begin, u64 end, TemporaryID spill_temporaries) {
+    IR *irs = ir->data;
+    const u64 count = graph->temporaries.count;
+    u64 *merged_into = malloc(sizeof(u64) * (count + 1));
+    memset(merged_into, 0xFF, sizeof(u64) * count);
+    bool *touched = calloc(count + 1, sizeof(bool));
+    bool merged = false;
+    u64 candidate_count = 0;
+    CopyCandidate *candidates = malloc(sizeof(CopyCandidate) * (end - begin + 1));
+    for (u64 i = begin; i <= end; ++i) {
+        if (!isMove(&irs[i], widths)) continue;
+        candidates[candidate_count++] = (CopyCandidate){ .weight = weight[i], .at = i };
+    }
+    qsort(candidates, candidate_count, sizeof(CopyCandidate), compareCopyCandidates);
+    for (u64 c = 0; c < candidate_count; ++c) {
+        const IR *it = &irs[candidates[c].at];
+        const TemporaryID a = it->result.temporary_id;
+        const TemporaryID b = it->operands[0].temporary_id;
+        // NOTE(mdizdar): reloads are kept short so they can't be spilled, merging one would undo that
+        if (a == b || a >= spill_temporaries || b >= spill_temporaries || shared[a] || shared[b]) continue;
+        const u64 x = node_of[a];
+        const u64 y = node_of[b];
+        if (touched[x] || touched[y] || interferes(graph, x, y) || !canCoalesce(graph, needs_immediate, widths, x, y)) continue;
+        merged_into[y] = x;
+        touched[x] = touched[y] = true;
+        merged = true;
+    }
+    if (merged) {
+        for (u64 i = begin; i <= end; ++i) {
+            IR *it = &irs[i];
+            // NOTE(mdizdar): nothing past a call's label is filled in, whatever's there is left over from before
+            if (it->instruction == OP_CALL) continue;
+            renameMerged(&it->result, graph, node_of, merged_into);
+            renameMerged(&it->operands[0], graph, node_of, merged_into);
+            renameMerged(&it->operands[1], graph, node_of, merged_into);
+            if (it->result.type == OT_REFERENCE && it->result.pointer.reference_var) {
+                renameMerged(it->result.pointer.reference_var, graph, node_of, merged_into);
+            }
+        }
+    }
+    free(candidates);
+    free(merged_into);
+    free(touched);
+    return merged;
+}
+
+// NOTE(mdizdar): simplify and select, with Briggs' optimistic twist: when nothing left is trivially colourable, the
+// cheapest thing to spill per unit of pressure goes on the stack anyway, and only gets spilled if its neighbours really
+// did take every place it could go. Trivially colourable goes by what the neighbours can take away between them and
+// not by how many of them there are, since a quad next to a byte has fewer places to go than a byte next to a quad.
+// Whatever already got a register in a function before this one keeps it. Returns whether anything got spilled
+static bool colourGraph(const Interference *graph, const bool *needs_immediate, const bool *prefers_immediate, const Width *widths, const u64 *cost, u8 *real_reg, bool *spilled) {
+    const u64 count = graph->temporaries.count;
+    const TemporaryID *temporary = graph->temporaries.data;
+    const u64Array *adjacent = graph->adjacent;
+    u64 *pressure = malloc(sizeof(u64) * (count + 1));
+    bool *removed = calloc(count + 1, sizeof(bool));
+    u64Array simplify, stack;
+    u64Array_construct(&simplify);
+    u64Array_construct(&stack);
+    u64 remaining = 0;
+    for (u64 n = 0; n < count; ++n) {
+        pressure[n] = pressureOn(graph, widths, n, widths[temporary[n]].bytes);
+        if (real_reg[temporary[n]] != NO_REGISTER) {
+            removed[n] = true;
+            continue;
+        }
+        ++remaining;
+        if (pressure[n] < colours(needs_immediate, widths, temporary[n])) u64Array_push_back(&simplify, n);
+    }
+    while (remaining) {
+        u64 n;
+        if (simplify.count) {
+            n = simplify.data[--simplify.count];
+            if (removed[n]) continue;
+        } else {
+            // cost / pressure, without dividing
+            n = NO_NODE;
+            for (u64 c = 0; c < count; ++c) {
+                if (removed[c]) continue;
+                if (n == NO_NODE || (unsigned __int128)cost[temporary[c]] * pressure[n] < (unsigned __int128)cost[temporary[n]] * pressure[c]) n = c;
+            }
+        }
+        removed[n] = true;
+        --remaining;
+        u64Array_push_back(&stack, n);
+        for (ARRAY_EACH(u64, m, &adjacent[n])) {
+            if (removed[*m]) continue;
+            const u64 k = colours(needs_immediate, widths, temporary[*m]);
+            const u64 before = pressure[*m];
+            pressure[*m] -= blocked(widths[temporary[n]].bytes, widths[temporary[*m]].bytes);
+            if (before >= k && pressure[*m] < k) u64Array_push_back(&simplify, *m);
+        }
+    }
+
+    bool any_spilled = false;
+    while (stack.count) {
+        const u64 n = stack.data[--stack.count];
+        const u8 bytes = widths[temporary[n]].bytes;
+        u32 taken = 0;
+        for (ARRAY_EACH(u64, m, &adjacent[n])) {
+            const TemporaryID other = temporary[*m];
+            if (real_reg[other] != NO_REGISTER) taken |= registersOf(real_reg[other], widths[other].bytes);
+        }
+        // the ones that don't need an immediate go low first, to leave the others room, unless they'd rather not
+        u8 r = firstRegister(needs_immediate[temporary[n]]);
+        if (prefers_immediate[temporary[n]]) {
+            u8 high = FIRST_IMMEDIATE_REGISTER;
+            while (high + bytes - 1 <= LAST_REGISTER && (taken & registersOf(high, bytes))) high += alignmentOf(bytes);
+            if (high + bytes - 1 <= LAST_REGISTER) r = high;
+        }
+        while (r + bytes - 1 <= LAST_REGISTER && (taken & registersOf(r, bytes))) r += alignmentOf(bytes);
+        // NOTE(mdizdar): a copy that couldn't be merged away still goes away if both sides end up in the same place
+        for (ARRAY_EACH(u64, m, &graph->moves[n])) {
+            const u8 other = real_reg[temporary[*m]];
+            if (other == NO_REGISTER || other < firstRegister(needs_immediate[temporary[n]])) continue;
+            if (!(taken & registersOf(other, bytes))) {
+                r = other;
+                break;
+            }
+        }
+        if (r + bytes - 1 > LAST_REGISTER) {
+            spilled[temporary[n]] = true;
+            any_spilled = true;
+        } else {
+            real_reg[temporary[n]] = r;
+        }
+    }
+    free(pressure);
+    free(removed);
+    u64Array_destruct(&simplify);
+    u64Array_destruct(&stack);
+    return any_spilled;
+}
+
+// NOTE(mdizdar): two fixpoints, one going up to find out how wide everything is, and one going down to find out how
+// much of that is needed. The IR isn't in SSA anymore, so a temporary can get written in more than one place, the
+// declared type wins if it has one and otherwise it's as wide as the widest write
+static WidthArray findWidths(IRArray *ir) {
+    IR *irs = ir->data;
+    const TemporaryID temporary_count = temporary_index;
+    WidthArray widths;
+    WidthArray_construct(&widths);
+    WidthArray_reserve(&widths, temporary_count);
+    widths.count = temporary_count;
+    Width *width = widths.data;
+    memset(width, 0, sizeof(Width) * temporary_count);
+    bool *declared = calloc(temporary_count + 1, sizeof(bool));
+    // a right shift needs every byte of what it shifts to get the low ones right, those stay as they are
+    bool *keep = calloc(temporary_count + 1, sizeof(bool));
+
+    for (u64 i = 0; i < ir->count; ++i) {
+        IRVariable *mentioned[4] = { &irs[i].result, &irs[i].operands[0], &irs[i].operands[1], NULL };
+        if (irs[i].result.type == OT_REFERENCE) mentioned[3] = irs[i].result.pointer.reference_var;
+        if (irs[i].instruction == OP_CALL) continue;
+        for (u64 k = 0; k < 4; ++k) {
+            if (!mentioned[k] || mentioned[k]->type != OT_TEMPORARY || !mentioned[k]->entry) continue;
+            declared[mentioned[k]->temporary_id] = true;
+            width[mentioned[k]->temporary_id] = widthOfType(((SymbolTableEntry *)mentioned[k]->entry)->type);
+        }
+        if (irs[i].instruction == OP_BITSHIFT_RIGHT && irs[i].result.type == OT_TEMPORARY) {
+            keep[irs[i].result.temporary_id] = true;
+        }
+    }
+
+    for (bool changed = true; changed;) {
+        changed = false;
+        uintptr_t called = 0;
+        for (u64 i = 0; i < ir->count; ++i) {
+            if (irs[i].instruction == OP_CALL) called = irs[i].operands[0].entry;
+            const IRVariable *def = definedTemporary(&irs[i]);
+            if (!def || declared[def->temporary_id]) continue;
+            const Width joined = joinWidths(width[def->temporary_id], naturalWidth(width, &irs[i], called));
+            if (Width_eq(joined, width[def->temporary_id])) continue;
+            width[def->temporary_id] = joined;
+            changed = true;
+        }
+    }
+
+    u8 *demand = malloc(sizeof(u8) * (temporary_count + 1));
+    for (bool changed = true; changed;) {
+        changed = false;
+        memset(demand, 0, sizeof(u8) * temporary_count);
+        uintptr_t function = 0;
+        for (u64 i = 0; i < ir->count; ++i) {
+            if (startsFunction(&irs[i])) function = irs[i].operands[0].entry;
+            const LiveEffect effect = liveEffect(&irs[i]);
+            u8 bytes[2];
+            demandedBytes(width, &irs[i], function, bytes);
+            Width_demand(demand, effect.uses[0], bytes[0]);
+            if (effect.uses[1] == &irs[i].operands[1]) {
+                Width_demand(demand, effect.uses[1], bytes[1]);
+            } else {
+                // a store's pointer
+                Width_demand(demand, effect.uses[1], 2);
+            }
+        }
+        for (TemporaryID t = 0; t < temporary_count; ++t) {
+            if (keep[t] || width[t].bytes <= 1 || demand[t] >= width[t].bytes) continue;
+            width[t].bytes = demand[t] > 1 ? (demand[t] > 2 ? 4 : 2) : 1;
+            changed = true;
+        }
+    }
+    for (TemporaryID t = 0; t < temporary_count; ++t) {
+        if (width[t].bytes == 0) width[t] = BOOL_WIDTH;
+    }
+    free(demand);
+    free(declared);
+    free(keep);
+    return widths;
+}
+
+
+static Allocation Allocation_make(IRArray *ir) {
+    Allocation allocation = { .real_reg = NULL, .function_count = 0, .widths = findWidths(ir) };
+    for (ARRAY_EACH(IR, it, ir)) {
+        if (startsFunction(it)) ++allocation.function_count;
+    }
+    allocation.frame_size = calloc(allocation.function_count + 1, sizeof(u16));
+    allocation.saved = calloc(allocation.function_count + 1, sizeof(u32));
+    return allocation;
+}
+
+// a function saves every register it writes
+static void findSavedRegisters(IRArray *ir, Allocation *allocation) {
+    u64 function = (u64)-1;
+    for (ARRAY_EACH(IR, it, ir)) {
+        if (startsFunction(it)) ++function;
+        const IRVariable *def = definedTemporary(it);
+        if (def && allocation->real_reg[def->temporary_id] != NO_REGISTER) {
+            allocation->saved[function] |= registersOf(allocation->real_reg[def->temporary_id], allocation->widths.data[def->temporary_id].bytes);
+        }
+    }
+}
+
+// the new temporary is as wide as the one that got spilled, which is what the load says it loads until assignSlots
+static inline IRVariable reload(IRArray *ir, TemporaryID spilled, WidthArray *widths) {
+    const IRVariable loaded = { .type = OT_TEMPORARY, .temporary_id = temporary_index++ };
+    WidthArray_push_back(widths, widths->data[spilled]);
+    IRArray_push_back(ir, (IR){
+        .instruction = OP_LOAD,
+        .result = loaded,
+        .operands[0] = { .type = OT_INT64, .integer_value = spilled },
+    });
+    return loaded;
+}
+
+// NOTE(mdizdar): every read of a spilled temporary gets a load of its own right before it into a new temporary,
+// and every write goes into a new one that gets stored right after. Arguments get written before the prelude sets up
+// the frame, so their stores wait for it. Where in the frame they go is up to assignSlots
+static void insertSpillCode(IRArray *ir, const bool *spilled, const bool *read, WidthArray *widths, Arena *arena) {
+    IR *irs = ir->data;
+    IRArray new_ir, deferred;
+    IRArray_construct(&new_ir);
+    IRArray_construct(&deferred);
+    IRArray_reserve(&new_ir, ir->count);
+    bool before_prelude = false;
+    for (u64 i = 0; i < ir->count; ++i) {
+        IR it = irs[i];
+        if (startsFunction(&it)) before_prelude = true;
+        if (it.instruction == OP_PRELUDE) {
+            IRArray_push_ptr(&new_ir, &it);
+            for (ARRAY_EACH(IR, store, &deferred)) {
+                IRArray_push_ptr(&new_ir, store);
+            }
+            IRArray_clear(&deferred);
+            before_prelude = false;
+            continue;
+        }
+
+        const LiveEffect effect = liveEffect(&irs[i]);
+        IRVariable *uses[2] = {
+            effect.uses[0] ? &it.operands[0] : NULL,
+            effect.uses[1] == &irs[i].operands[1] ? &it.operands[1] : NULL,
+        };
+        for (u64 k = 0; k < 2; ++k) {
+            if (!uses[k] || !spilled[uses[k]->temporary_id]) continue;
+            const TemporaryID t = uses[k]->temporary_id;
+            const IRVariable loaded = reload(&new_ir, t, widths);
+            uses[k]->temporary_id = loaded.temporary_id;
+            if (k == 0 && uses[1] && uses[1]->temporary_id == t) {
+                uses[1]->temporary_id = loaded.temporary_id;
+                break;
+            }
+        }
+        if (effect.uses[1] && effect.uses[1] != &irs[i].operands[1] && spilled[effect.uses[1]->temporary_id]) {
+            // a store's pointer, which the load before it shares, so this one gets a copy of its own
+            IRVariable *pointer = Arena_alloc(arena, sizeof(IRVariable));
+            *pointer = reload(&new_ir, effect.uses[1]->temporary_id, widths);
+            it.result.pointer.reference_var = pointer;
+        }
+
+        IRVariable *def = definedTemporary(&it);
+        const bool stores = def && spilled[def->temporary_id] && read[def->temporary_id];
+        IR store = { .instruction = OP_STORE };
+        if (def && spilled[def->temporary_id]) {
+            const TemporaryID t = def->temporary_id;
+            def->temporary_id = temporary_index++;
+            WidthArray_push_back(widths, widths->data[t]);
+            store.operands[0] = (IRVariable){ .type = OT_TEMPORARY, .temporary_id = def->temporary_id };
+            store.operands[1] = (IRVariable){ .type = OT_INT64, .integer_value = t };
+        }
+        IRArray_push_ptr(&new_ir, &it);
+        if (stores) IRArray_push_ptr(before_prelude ? &deferred : &new_ir, &store);
+    }
+    for (ARRAY_EACH(IR, store, &deferred)) {
+        IRArray_push_ptr(&new_ir, store);
+    }
+    IRArray_destruct(&deferred);
+    IRArray_destruct(ir);
+    *ir = new_ir;
+}
+
+// the load's or the store's slot, NULL for everything else
+static inline IRVariable *slotOperand(IR *ir) {
+    if (ir->instruction == OP_LOAD) return &ir->operands[0];
+    if (ir->instruction == OP_STORE) return &ir->operands[1];
+    return NULL;
+}
+
+// a store fills its slot and a load reads it, slot being what assignSlots numbered the spilled temporaries as
+static inline void slotStepBack(u64 *live, IR *ir, const u64 *slot) {
+    const IRVariable *var = slotOperand(ir);
+    if (!var) return;
+    if (ir->instruction == OP_STORE) {
+        Bitset_clear(live, slot[var->integer_value]);
+    } else {
+        Bitset_set(live, slot[var->integer_value]);
+    }
+}
+
+// what's live coming out of a block is what's live going into whatever comes after it
+static inline void slotsLiveOut(const BasicBlock *block, const u64 *live_in, u64 *live, u64 words) {
+    memset(live, 0, sizeof(u64) * words);
+    if (block->next) Bitset_unionWith(live, live_in + block->next->order * words, words);
+    if (block->jump) Bitset_unionWith(live, live_in + block->jump->order * words, words);
+}
+
+// NOTE(mdizdar): a slot is live from the store that fills it to the last load out of it, which is the same backwards
+// dataflow livenessAnalysis does only over the slots, and two spilled temporaries whose slots are never live at the
+// same time can share the same bytes of the frame. A store interferes with every slot that's live after it whether
+// anything reads what it stored or not, it still overwrites whatever's there. Then the slots get coloured in the
+// order they first come up, each one going as low in the frame as its neighbours let it, there's always more frame
+// above them. The blocks have to be the ones makeBasicBlocks built for ir as it is
+static void assignSlots(IRArray *ir, Allocation *allocation) {
+    IR *irs = ir->data;
+    u64 *slot = malloc(sizeof(u64) * (temporary_index + 1));
+    memset(slot, 0xFF, sizeof(u64) * temporary_index);
+    u64Array spilled, function_of;
+    u64Array_construct(&spilled);
+    u64Array_construct(&function_of);
+    u64 function = (u64)-1;
+    for (ARRAY_EACH(IR, it, ir)) {
+        if (startsFunction(it)) ++function;
+        const IRVariable *var = slotOperand(it);
+        if (!var || slot[var->integer_value] != NO_NODE) continue;
+        slot[var->integer_value] = spilled.count;
+        u64Array_push_back(&spilled, var->integer_value);
+        u64Array_push_back(&function_of, function);
+    }
+    const u64 count = spilled.count;
+    if (count == 0) {
+        free(slot);
+        u64Array_destruct(&spilled);
+        u64Array_destruct(&function_of);
+        return;
+    }
+
+    BasicBlockPtrArray blocks;
+    BasicBlockPtrArray_construct(&blocks);
+    collectBlocks(ir, &blocks);
+    BasicBlock **bbs = blocks.data;
+    const u64 block_count = blocks.count;
+    const u64 words = BITSET_WORDS(count);
+    u64 *live_in = calloc(block_count * words + 1, sizeof(u64));
+    u64 *live = malloc(sizeof(u64) * (words + 1));
+    // NOTE(mdizdar): going through the blocks back to front gets most of it done in the first pass
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (u64 b = block_count; b-- > 0;) {
+            slotsLiveOut(bbs[b], live_in, live, words);
+            for (u64 i = bbs[b]->end + 1; i-- > bbs[b]->begin;) {
+                slotStepBack(live, &irs[i], slot);
+            }
+            if (Bitset_unionWith(live_in + b * words, live, words)) changed = true;
+        }
+    }
+    u64 *interference = calloc(count * words + 1, sizeof(u64));
+    for (u64 b = 0; b < block_count; ++b) {
+        slotsLiveOut(bbs[b], live_in, live, words);
+        for (u64 i = bbs[b]->end + 1; i-- > bbs[b]->begin;) {
+            if (irs[i].instruction == OP_STORE) {
+                const u64 s = slot[irs[i].operands[1].integer_value];
+                u64 n;
+                BITSET_EACH(n, live, words) {
+                    Bitset_set(interference + s * words, n);
+                    Bitset_set(interference + n * words, s);
+                }
+            }
+            slotStepBack(live, &irs[i], slot);
+        }
+    }
+
+    u16 *offset = malloc(sizeof(u16) * count);
+    for (u64 s = 0; s < count; ++s) {
+        const u8 bytes = allocation->widths.data[spilled.data[s]].bytes;
+        offset[s] = 0;
+        for (u64 n = 0; n < s; ++n) {
+            const u8 other = allocation->widths.data[spilled.data[n]].bytes;
+            if (!Bitset_isSet(interference + s * words, n)) continue;
+            if (offset[s] < offset[n] + other && offset[n] < offset[s] + bytes) {
+                // it has to go past this one, and everything it's been checked against has to be checked again
+                offset[s] = offset[n] + other;
+                n = (u64)-1;
+            }
+        }
+        u16 *frame_size = &allocation->frame_size[function_of.data[s]];
+        if (*frame_size < offset[s] + bytes) *frame_size = offset[s] + bytes;
+    }
+    for (ARRAY_EACH(IR, it, ir)) {
+        IRVariable *var = slotOperand(it);
+        if (var) *var = (IRVariable){ .type = OT_INT16, .integer_value = offset[slot[var->integer_value]] };
+    }
+
+    free(offset);
+    free(interference);
+    free(live);
+    free(live_in);
+    BasicBlockPtrArray_destruct(&blocks);
+    free(slot);
+    u64Array_destruct(&spilled);
+    u64Array_destruct(&function_of);
+}
+
+// NOTE(mdizdar): Chaitin-Briggs, one function at a time. Build the function's interference graph, coalesce copies
+// until nothing else can be, simplify and select, and if something had to be spilled, put the loads and stores in and
+// go again. What the spill code adds can't be spilled itself, so this runs out of things to spill eventually. Spill
+// costs are weighted by loop depth. The IR and the labels get rebuilt if anything gets spilled
+Allocation allocateRegisters(IRArray *ir, LabelArray *labels, Arena *arena) {
+    Allocation allocation = Allocation_make(ir);
+    const TemporaryID spill_temporaries = temporary_index;
+
+    for (;;) {
+        makeBasicBlocks(ir, labels);
+        IR *irs = ir->data;
+        const TemporaryID temporary_count = temporary_index;
+        u64 *weight = instructionWeights(ir);
+        bool *read = calloc(temporary_count, sizeof(bool));
+        bool *needs_immediate = calloc(temporary_count, sizeof(bool));
+        u64 *cost = calloc(temporary_count, sizeof(u64));
+        bool *shared = calloc(temporary_count, sizeof(bool));
+        countMentions(ir, weight, read, needs_immediate, cost, shared);
+        bool *prefers_immediate = preferredImmediates(ir, temporary_count);
+        for (TemporaryID t = 0; t < temporary_count; ++t) {
+            if (t >= spill_temporaries || shared[t]) cost[t] = (u64)-1;
+        }
+
+        Liveness liveness = livenessAnalysis(ir, temporary_count);
+        BasicBlock **bbs = liveness.blocks.data;
+        const u64 block_count = liveness.blocks.count;
+        u64 *node_of = malloc(sizeof(u64) * temporary_count);
+        memset(node_of, 0xFF, sizeof(u64) * temporary_count);
+        allocation.real_reg = realloc(allocation.real_reg, sizeof(u8) * temporary_count);
+        memset(allocation.real_reg, NO_REGISTER, sizeof(u8) * temporary_count);
+        bool *spilled = calloc(temporary_count, sizeof(bool));
+        bool merged = false;
+        bool any_spilled = false;
+        for (u64 first = 0, last; first < block_count; first = last) {
+            last = first + 1;
+            while (last < block_count && !startsFunction(&irs[bbs[last]->begin])) ++last;
+            Interference graph = buildInterference(ir, &liveness, allocation.widths.data, first, last, node_of);
+            // NOTE(mdizdar): once anything got merged this whole pass is going to be done again, so there's no point
+            // in colouring the rest of it
+            if (coalesceCopies(ir, &graph, node_of, needs_immediate, allocation.widths.data, shared, weight, bbs[first]->begin, bbs[last-1]->end, spill_temporaries)) {
+                merged = true;
+            } else if (!merged && colourGraph(&graph, needs_immediate, prefers_immediate, allocation.widths.data, cost, allocation.real_reg, spilled)) {
+                any_spilled = true;
+            }
+            Interference_destruct(&graph, node_of);
+        }
+        Liveness_destruct(&liveness);
+        free(weight);
+        free(prefers_immediate);
+        free(node_of);
+        free(needs_immediate);
+        free(cost);
+        if (merged || !any_spilled) {
+            free(read);
+            free(spilled);
+            free(shared);
+            if (merged) continue;
+            break;
+        }
+        for (TemporaryID t = 0; t < temporary_count; ++t) {
+            if (spilled[t] && (t >= spill_temporaries || shared[t])) error(0, "too many registers required");
+        }
+        free(shared);
+        insertSpillCode(ir, spilled, read, &allocation.widths, arena);
+        free(read);
+        free(spilled);
+        LabelArray_destruct(labels);
+        *labels = findLabels(ir);
+    }
+
+    assignSlots(ir, &allocation);
+    findSavedRegisters(ir, &allocation);
+    return allocation;
+}
+
+void Allocation_destruct(Allocation *allocation) {
+    free(allocation->real_reg);
+    free(allocation->frame_size);
+    free(allocation->saved);
+    WidthArray_destruct(&allocation->widths);
+}
+
+#endif // REGISTER_ALLOCATION_H
@@ -0,0 +1,205 @@
+#ifndef WIDTHS_H
+#define WIDTHS_H
+
+#include "../utils/common.h"
+#include "../utils/dyn_array.h"
+#include "../IR/IR.h"
+#include "../C/type.h"
+#include "../C/symbol_table_entry.h"
+
+// NOTE(mdizdar): how many bytes of a temporary the lowering has to keep around, and how to extend it when something
+// wants more of it. The named ones start out as wide as they were declared, the rest as wide as C says the result of
+// whatever writes them is, and then everything gets cut down to what's actually read: the low bytes of a sum only
+// depend on the low bytes of what's being added, so a char that gets added to an int and stored back into a char never
+// needs its second byte. long long gets the same 4 bytes as long, there aren't enough registers for anything wider
+typedef struct Width {
+    u8 bytes;
+    bool is_signed;
+    Type *pointee; // what it points to, NULL if it isn't a pointer
+} Width;
+
+_generate_dynamic_array(Width);
+
+#define INT_WIDTH ((Width){ .bytes = 2, .is_signed = true })
+// comparisons and the logical operators only ever give 0 or 1
+#define BOOL_WIDTH ((Width){ .bytes = 1, .is_signed = false })
+
+// these are the sizes Type_sizeof gives, plain char is signed like it is for avr-gcc
+static Width widthOfType(Type *type) {
+    if (type == NULL) return INT_WIDTH;
+    if (type->is_typedef) return widthOfType(type->typedef_type);
+    if (type->pointer_count) return (Width){ .bytes = 2, .is_signed = false, .pointee = Type_pointee(type) };
+    if (type->is_array) return (Width){ .bytes = 2, .is_signed = false, .pointee = type->array_type->element };
+    if (type->is_struct || type->is_union || type->is_function) return INT_WIDTH;
+    switch (type->basic_type) {
+        case BASIC_VOID: case BASIC_CHAR: case BASIC_SCHAR: return (Width){ .bytes = 1, .is_signed = true };
+        case BASIC_UCHAR:                                   return (Width){ .bytes = 1, .is_signed = false };
+        case BASIC_SSHORT: case BASIC_SINT:                 return (Width){ .bytes = 2, .is_signed = true };
+        case BASIC_USHORT: case BASIC_UINT:                 return (Width){ .bytes = 2, .is_signed = false };
+        case BASIC_SLONG: case BASIC_SLLONG:                return (Width){ .bytes = 4, .is_signed = true };
+        case BASIC_ULONG: case BASIC_ULLONG:                return (Width){ .bytes = 4, .is_signed = false };
+        default:                                            return (Width){ .bytes = 4, .is_signed = false };
+    }
+}
+
+// NOTE(mdizdar): a literal is as wide as its operand type says and as signed as is_unsigned says, the way
+// IR_generate and IR_propagateConstants type them, so an int -1 is a signed OT_INT16 0xFFFF and 65535 is a long. The
+// ones the other passes make up can have more in them than their operand type says, those get the 4 signed bytes
+static inline Width literalWidth(const IRVariable *var) {
+    const u8 bytes = var->type == OT_INT8 ? 1 : var->type == OT_INT16 ? 2 : 4;
+    if (bytes < 4 && var->integer_value >> (8*bytes)) return (Width){ .bytes = 4, .is_signed = true };
+    return (Width){ .bytes = bytes, .is_signed = !var->is_unsigned };
+}
+
+// the literal as the 64 bit integer it stands for
+static inline s64 literalValue(const IRVariable *var) {
+    const Width width = literalWidth(var);
+    const u8 bits = 8*width.bytes;
+    const u64 value = var->integer_value & ((1ull << bits) - 1);
+    return width.is_signed && value >> (bits - 1) ? (s64)(value | ~((1ull << bits) - 1)) : (s64)value;
+}
+
+// byte b of a literal, sign extended past the end of it
+static inline u8 literalByte(const IRVariable *var, u8 b) {
+    return (u8)((u64)literalValue(var) >> (8*b));
+}
+
+static inline bool isLiteral(const IRVariable *var) {
+    return var->type >= OT_INT8 && var->type <= OT_INT64;
+}
+
+// what a function gives back, entry being what its label or a call to it carries around, 0 for __start
+static inline u8 returnBytes(uintptr_t entry) {
+    if (!entry) return INT_WIDTH.bytes;
+    Type *type = ((SymbolTableEntry *)entry)->type->function_type->return_type;
+    if (!type->pointer_count && !type->is_typedef && type->basic_type == BASIC_VOID) return 0;
+    return widthOfType(type).bytes;
+}
+
+// integer promotion and the usual arithmetic conversions, see IR_propagateConstants
+static inline Width promoted(Width a) {
+    return a.bytes < INT_WIDTH.bytes ? INT_WIDTH : a;
+}
+
+static inline Width commonWidth(Width a, Width b) {
+    a = promoted(a);
+    b = promoted(b);
+    if (a.bytes != b.bytes) return a.bytes > b.bytes ? a : b;
+    return (Width){ .bytes = a.bytes, .is_signed = a.is_signed && b.is_signed };
+}
+
+static inline Width operandWidth(const Width *widths, const IRVariable *var) {
+    if (var->type == OT_TEMPORARY) return widths[var->temporary_id];
+    if (isLiteral(var)) return literalWidth(var);
+    return INT_WIDTH;
+}
+
+static inline bool fitsIn(s64 value, Width width) {
+    if (width.is_signed) return value >= -(1ll << (8*width.bytes - 1)) && value < (1ll << (8*width.bytes - 1));
+    return value >= 0 && value < (1ll << (8*width.bytes));
+}
+
+// NOTE(mdizdar): what a comparison gets done in. C says the usual arithmetic conversions, but two things of the same
+// type, or one thing and a literal that fits in its type, compare the same without being widened first
+static Width compareWidth(const Width *widths, const IR *ir) {
+    const IRVariable *a = &ir->operands[0];
+    const IRVariable *b = &ir->operands[1];
+    const Width x = operandWidth(widths, a);
+    const Width y = operandWidth(widths, b);
+    if (a->type == OT_TEMPORARY && b->type == OT_TEMPORARY) {
+        if (x.bytes == y.bytes && x.is_signed == y.is_signed) return x;
+    } else if (a->type == OT_TEMPORARY && isLiteral(b) && fitsIn(literalValue(b), x)) {
+        return x;
+    } else if (b->type == OT_TEMPORARY && isLiteral(a) && fitsIn(literalValue(a), y)) {
+        return y;
+    }
+    return commonWidth(x, y);
+}
+
+// NOTE(mdizdar): what a load or store through a reference goes to. The deref that made the reference knows, unless
+// some pass made it up, and then the pointer it goes through might. NULL if nobody does
+static inline Type *pointeeOf(const Width *widths, const IRVariable *reference) {
+    if (reference->pointer.pointee) return (Type *)reference->pointer.pointee;
+    const IRVariable *pointer = reference->pointer.reference_var;
+    if (pointer && pointer->type == OT_TEMPORARY) return widths[pointer->temporary_id].pointee;
+    return NULL;
+}
+
+// how many bytes a store through a pointer writes, which is what the pointer points to if anyone knows that
+static inline u8 storedBytes(const Width *widths, const IR *ir) {
+    Type *pointee = pointeeOf(widths, &ir->result);
+    if (pointee) return widthOfType(pointee).bytes;
+    return widths[ir->result.temporary_id].bytes ? widths[ir->result.temporary_id].bytes : 1;
+}
+
+// the bigger of two guesses at a temporary that gets written in more than one place
+static inline Width joinWidths(Width a, Width b) {
+    if (a.bytes == 0) return b;
+    if (b.bytes == 0) return a;
+    Width joined = a.bytes != b.bytes ? (a.bytes > b.bytes ? a : b) : (Width){ .bytes = a.bytes, .is_signed = a.is_signed && b.is_signed };
+    joined.pointee = a.pointee ? a.pointee : b.pointee;
+    return joined;
+}
+
+static inline bool Width_eq(Width a, Width b) {
+    return a.bytes == b.bytes && a.is_signed == b.is_signed && a.pointee == b.pointee;
+}
+
+// what C says the result of ir is, given what its operands are
+static Width naturalWidth(const Width *widths, const IR *ir, uintptr_t called) {
+    const Width a = operandWidth(widths, &ir->operands[0]);
+    const Width b = operandWidth(widths, &ir->operands[1]);
+    switch ((int)ir->instruction) {
+        case '=': return a;
+        case '+': case '-': {
+            if (a.pointee) return a;
+            if (b.pointee && ir->instruction == '+') return b;
+            return commonWidth(a, b);
+        }
+        case '*': case '/': case '%': case '&': case '|': case '^': return commonWidth(a, b);
+        case '~': case OP_PLUS: case OP_MINUS: case OP_BITSHIFT_LEFT: case OP_BITSHIFT_RIGHT: return promoted(a);
+        case '<': case '>': case OP_LESS_EQ: case OP_GREATER_EQ: case OP_EQUALS: case OP_NOT_EQ:
+        case OP_LOGICAL_AND: case OP_LOGICAL_OR: case '!': {
+            return BOOL_WIDTH;
+        }
+        case OP_DEREF: {
+            Type *pointee = ir->result.type == OT_REFERENCE ? pointeeOf(widths, &ir->result) : a.pointee;
+            return pointee ? widthOfType(pointee) : (Width){ .bytes = 1, .is_signed = true };
+        }
+        case OP_GET_RETURNED: {
+            const u8 bytes = returnBytes(called);
+            return bytes ? widthOfType(((SymbolTableEntry *)called)->type->function_type->return_type) : INT_WIDTH;
+        }
+        case OP_ADDRESS: return (Width){ .bytes = 2, .is_signed = false };
+        default: return (Width){ .bytes = 1, .is_signed = true };
+    }
+}
+
+// NOTE(mdizdar): how many bytes of each of its operands ir reads, given how wide its result is. Everything that
+// isn't a low bytes only kind of operation wants the whole thing, which is what the 8 stands for
+static void demandedBytes(const Width *widths, const IR *ir, uintptr_t function, u8 demand[2]) {
+    const u8 result = ir->result.type == OT_TEMPORARY ? widths[ir->result.temporary_id].bytes : 8;
+    demand[0] = demand[1] = 8;
+    switch ((int)ir->instruction) {
+        case '=': {
+            demand[0] = ir->result.type == OT_REFERENCE ? storedBytes(widths, ir) : result;
+            break;
+        }
+        case '+': case '-': case '*': case '&': case '|': case '^': case '~': case OP_PLUS: case OP_MINUS: {
+            demand[0] = demand[1] = result;
+            break;
+        }
+        case OP_BITSHIFT_LEFT: demand[0] = result; demand[1] = 1; break;
+        case OP_BITSHIFT_RIGHT: demand[1] = 1; break;
+        case OP_DEREF: demand[0] = 2; break;
+        case OP_PUSH: demand[0] = (u8)ir->operands[1].integer_value; break;
+        case OP_RETURN: demand[0] = returnBytes(function); break;
+        default: break;
+    }
+}
+
+static inline void Width_demand(u8 *demand, const IRVariable *var, u8 bytes) {
+    if (var && var->type == OT_TEMPORARY && demand[var->temporary_id] < bytes) demand[var->temporary_id] = bytes;
+}
+
+#endif // WIDTHS_H
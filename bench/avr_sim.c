@@ -0,0 +1,329 @@
+// cycle-counting simulator for the subset of AVR that fcc emits
+// gcc -std=c17 -O2 bench/avr_sim.c -o build/avr_sim && build/avr_sim tests/while.hex
+//
+// It loads the Intel hex that `fcc -o name` writes to name.hex, runs it from address 0 until
+// __start's `jmp 0` after main returns, and prints main's return value and the cycle count:
+//     r24=10 r25:r24=10 cycles=188
+// Cycle counts are the ATmega ones from the instruction set manual (LD/ST/LDD/STD 2, PUSH/POP 2,
+// CALL 4, RET 4, ...). Anything outside the subset is reported as an unknown opcode.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../utils/types.h"
+
+#define FLASH_WORDS 0x8000
+#define DATA_SIZE   0x900
+#define MAX_STEPS   50000000ull
+
+enum { FLAG_C, FLAG_Z, FLAG_N, FLAG_V, FLAG_S, FLAG_H, FLAG_T, FLAG_I };
+
+#define SREG 0x5F
+#define SPL  0x5D
+#define SPH  0x5E
+
+static u16 flash[FLASH_WORDS];
+static u8 data[DATA_SIZE];
+static u32 pc;
+static u64 cycles;
+
+static bool flag(int f) { return (data[SREG] >> f) & 1; }
+static void setFlag(int f, bool v) { data[SREG] = (u8)((data[SREG] & ~(1u << f)) | ((v ? 1u : 0u) << f)); }
+
+static u8 *mem(u32 address) {
+    if (address >= DATA_SIZE) {
+        fprintf(stderr, "data access out of range: 0x%04X at pc 0x%04X\n", address, pc);
+        exit(2);
+    }
+    return &data[address];
+}
+
+static u16 sp(void) { return (u16)(data[SPL] | (data[SPH] << 8)); }
+static void setSp(u16 v) { data[SPL] = (u8)v; data[SPH] = (u8)(v >> 8); }
+static void push(u8 v) { *mem(sp()) = v; setSp(sp() - 1); }
+static u8 pop(void) { setSp(sp() + 1); return *mem(sp()); }
+
+static u16 pair(int r) { return (u16)(data[r] | (data[r+1] << 8)); }
+static void setPair(int r, u16 v) { data[r] = (u8)v; data[r+1] = (u8)(v >> 8); }
+
+static void logicFlags(u8 r) {
+    setFlag(FLAG_V, 0);
+    setFlag(FLAG_N, r >> 7);
+    setFlag(FLAG_Z, r == 0);
+    setFlag(FLAG_S, flag(FLAG_N));
+}
+
+static void addFlags(u8 d, u8 s, u8 r) {
+    bool d7 = d >> 7, s7 = s >> 7, r7 = r >> 7;
+    setFlag(FLAG_H, ((d & s) | (s & ~r) | (~r & d)) & 0x08);
+    setFlag(FLAG_C, (d7 && s7) || (s7 && !r7) || (!r7 && d7));
+    setFlag(FLAG_V, (d7 && s7 && !r7) || (!d7 && !s7 && r7));
+    setFlag(FLAG_N, r7);
+    setFlag(FLAG_Z, r == 0);
+    setFlag(FLAG_S, flag(FLAG_N) ^ flag(FLAG_V));
+}
+
+// NOTE(mdizdar): the with-carry forms (CPC, SBC, SBCI) only ever clear Z, so a multi-byte compare is zero only if every byte was
+static void subFlags(u8 d, u8 s, u8 r, bool with_carry) {
+    bool d7 = d >> 7, s7 = s >> 7, r7 = r >> 7;
+    setFlag(FLAG_H, ((~d & s) | (s & r) | (r & ~d)) & 0x08);
+    setFlag(FLAG_C, (!d7 && s7) || (s7 && r7) || (r7 && !d7));
+    setFlag(FLAG_V, (d7 && !s7 && !r7) || (!d7 && s7 && r7));
+    setFlag(FLAG_N, r7);
+    setFlag(FLAG_Z, with_carry ? (r == 0 && flag(FLAG_Z)) : r == 0);
+    setFlag(FLAG_S, flag(FLAG_N) ^ flag(FLAG_V));
+}
+
+static bool isTwoWords(u16 op) {
+    return (op & 0xFE0C) == 0x940C ||  // JMP, CALL
+           (op & 0xFC0F) == 0x9000;    // LDS, STS
+}
+
+static void skipNext(void) {
+    u32 words = isTwoWords(flash[pc]) ? 2 : 1;
+    pc += words;
+    cycles += words;
+}
+
+static u16 loadHex(const char *path) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        perror(path);
+        exit(2);
+    }
+    char line[600];
+    u32 end = 0;
+    while (fgets(line, sizeof line, fp)) {
+        unsigned count, address, type;
+        if (sscanf(line, ":%2x%4x%2x", &count, &address, &type) != 3) continue;
+        if (type == 1) break;
+        if (type != 0) continue;
+        for (unsigned i = 0; i < count; ++i) {
+            unsigned byte;
+            if (sscanf(line + 9 + 2*i, "%2x", &byte) != 1) break;
+            u32 at = address + i;
+            if (at / 2 >= FLASH_WORDS) {
+                fprintf(stderr, "%s doesn't fit in flash\n", path);
+                exit(2);
+            }
+            flash[at/2] |= (u16)(byte << (8 * (at & 1)));
+            if (at/2 + 1 > end) end = at/2 + 1;
+        }
+    }
+    fclose(fp);
+    return (u16)end;
+}
+
+// returns false once the program jumps back to the reset vector
+static bool step(void) {
+    u16 op = flash[pc];
+    u32 at = pc++;
+    u64 cyc = 1;
+    int d = (op >> 4) & 0x1F;
+    int r = (op & 0x0F) | ((op >> 5) & 0x10);
+    int dh = 16 + ((op >> 4) & 0x0F);
+    u8 K = (u8)((op & 0x0F) | ((op >> 4) & 0xF0));
+
+    if (op == 0x0000) {
+        // NOP
+    } else if ((op & 0xFF00) == 0x0100) { // MOVW
+        int rd = ((op >> 4) & 0x0F) * 2, rr = (op & 0x0F) * 2;
+        setPair(rd, pair(rr));
+    } else if ((op & 0xFC00) == 0x0C00 || (op & 0xFC00) == 0x1C00) { // ADD, ADC
+        u8 a = data[d], b = data[r];
+        u8 res = (u8)(a + b + ((op & 0x1000) ? flag(FLAG_C) : 0));
+        addFlags(a, b, res);
+        data[d] = res;
+    } else if ((op & 0xFC00) == 0x1800 || (op & 0xFC00) == 0x0800) { // SUB, SBC
+        bool with_carry = (op & 0xFC00) == 0x0800;
+        u8 a = data[d], b = data[r];
+        u8 res = (u8)(a - b - (with_carry ? flag(FLAG_C) : 0));
+        subFlags(a, b, res, with_carry);
+        data[d] = res;
+    } else if ((op & 0xFC00) == 0x1400 || (op & 0xFC00) == 0x0400) { // CP, CPC
+        bool with_carry = (op & 0xFC00) == 0x0400;
+        u8 a = data[d], b = data[r];
+        subFlags(a, b, (u8)(a - b - (with_carry ? flag(FLAG_C) : 0)), with_carry);
+    } else if ((op & 0xFC00) == 0x1000) { // CPSE
+        if (data[d] == data[r]) skipNext();
+    } else if ((op & 0xFC00) == 0x2000) { // AND
+        data[d] &= data[r];
+        logicFlags(data[d]);
+    } else if ((op & 0xFC00) == 0x2400) { // EOR
+        data[d] ^= data[r];
+        logicFlags(data[d]);
+    } else if ((op & 0xFC00) == 0x2800) { // OR
+        data[d] |= data[r];
+        logicFlags(data[d]);
+    } else if ((op & 0xFC00) == 0x2C00) { // MOV
+        data[d] = data[r];
+    } else if ((op & 0xFC00) == 0x9C00) { // MUL
+        u16 p = (u16)(data[d] * data[r]);
+        setPair(0, p);
+        setFlag(FLAG_C, p >> 15);
+        setFlag(FLAG_Z, p == 0);
+        cyc = 2;
+    } else if ((op & 0xF000) == 0x3000) { // CPI
+        u8 a = data[dh];
+        subFlags(a, K, (u8)(a - K), false);
+    } else if ((op & 0xF000) == 0x4000 || (op & 0xF000) == 0x5000) { // SBCI, SUBI
+        bool with_carry = (op & 0xF000) == 0x4000;
+        u8 a = data[dh];
+        u8 res = (u8)(a - K - (with_carry ? flag(FLAG_C) : 0));
+        subFlags(a, K, res, with_carry);
+        data[dh] = res;
+    } else if ((op & 0xF000) == 0x6000) { // ORI
+        data[dh] |= K;
+        logicFlags(data[dh]);
+    } else if ((op & 0xF000) == 0x7000) { // ANDI
+        data[dh] &= K;
+        logicFlags(data[dh]);
+    } else if ((op & 0xF000) == 0xE000) { // LDI
+        data[dh] = K;
+    } else if ((op & 0xFE0F) == 0x9400) { // COM
+        data[d] = (u8)~data[d];
+        logicFlags(data[d]);
+        setFlag(FLAG_C, 1);
+    } else if ((op & 0xFE0F) == 0x9401) { // NEG
+        u8 a = data[d];
+        data[d] = (u8)-a;
+        subFlags(0, a, data[d], false);
+    } else if ((op & 0xFE0F) == 0x9402) { // SWAP
+        data[d] = (u8)((data[d] << 4) | (data[d] >> 4));
+    } else if ((op & 0xFE0F) == 0x9403 || (op & 0xFE0F) == 0x940A) { // INC, DEC
+        bool inc = (op & 0x0F) == 0x03;
+        data[d] = (u8)(data[d] + (inc ? 1 : -1));
+        setFlag(FLAG_V, data[d] == (inc ? 0x80 : 0x7F));
+        setFlag(FLAG_N, data[d] >> 7);
+        setFlag(FLAG_Z, data[d] == 0);
+        setFlag(FLAG_S, flag(FLAG_N) ^ flag(FLAG_V));
+    } else if ((op & 0xFE0C) == 0x9404 && (op & 0x03) != 0) { // ASR, LSR, ROR
+        u8 a = data[d];
+        u8 top = (op & 0x03) == 1 ? (a & 0x80) : (op & 0x03) == 3 ? (u8)(flag(FLAG_C) << 7) : 0;
+        data[d] = (u8)((a >> 1) | top);
+        setFlag(FLAG_C, a & 1);
+        setFlag(FLAG_N, data[d] >> 7);
+        setFlag(FLAG_Z, data[d] == 0);
+        setFlag(FLAG_V, flag(FLAG_N) ^ flag(FLAG_C));
+        setFlag(FLAG_S, flag(FLAG_N) ^ flag(FLAG_V));
+    } else if ((op & 0xFF8F) == 0x9408) { // BSET: SEC, SEI, ...
+        setFlag((op >> 4) & 7, 1);
+    } else if ((op & 0xFF8F) == 0x9488) { // BCLR: CLC, CLI, ...
+        setFlag((op >> 4) & 7, 0);
+    } else if ((op & 0xFE0F) == 0x920F) { // PUSH
+        push(data[d]);
+        cyc = 2;
+    } else if ((op & 0xFE0F) == 0x900F) { // POP
+        data[d] = pop();
+        cyc = 2;
+    } else if ((op & 0xFC0F) == 0x9000) { // LDS, STS
+        u16 address = flash[pc++];
+        if (op & 0x0200) *mem(address) = data[d];
+        else data[d] = *mem(address);
+        cyc = 2;
+    } else if ((op & 0xFC0C) == 0x900C) { // LD/ST X, X+, -X
+        u16 x = pair(26);
+        if ((op & 0x03) == 2) --x;
+        if (op & 0x0200) *mem(x) = data[d];
+        else data[d] = *mem(x);
+        if ((op & 0x03) == 1) ++x;
+        setPair(26, x);
+        cyc = 2;
+    } else if ((op & 0xFC07) == 0x9001 || (op & 0xFC07) == 0x9002) { // LD/ST Y+, -Y, Z+, -Z
+        int base = (op & 0x08) ? 28 : 30;
+        u16 p = pair(base);
+        if ((op & 0x03) == 2) --p;
+        if (op & 0x0200) *mem(p) = data[d];
+        else data[d] = *mem(p);
+        if ((op & 0x03) == 1) ++p;
+        setPair(base, p);
+        cyc = 2;
+    } else if ((op & 0xD000) == 0x8000) { // LDD/STD Y+q, Z+q
+        int q = (op & 0x07) | ((op >> 7) & 0x18) | ((op >> 8) & 0x20);
+        u16 address = (u16)(pair((op & 0x08) ? 28 : 30) + q);
+        if (op & 0x0200) *mem(address) = data[d];
+        else data[d] = *mem(address);
+        cyc = 2;
+    } else if ((op & 0xF800) == 0xB000) { // IN
+        data[d] = data[0x20 + ((op & 0x0F) | ((op >> 5) & 0x30))];
+    } else if ((op & 0xF800) == 0xB800) { // OUT
+        data[0x20 + ((op & 0x0F) | ((op >> 5) & 0x30))] = data[d];
+    } else if ((op & 0xE000) == 0xC000) { // RJMP, RCALL
+        int k = op & 0x0FFF;
+        if (k & 0x800) k -= 0x1000;
+        if (op & 0x1000) {
+            push((u8)pc);
+            push((u8)(pc >> 8));
+            cyc = 3;
+        } else {
+            cyc = 2;
+        }
+        pc = (u32)((int)pc + k);
+    } else if ((op & 0xFE0E) == 0x940C || (op & 0xFE0E) == 0x940E) { // JMP, CALL
+        u32 k = flash[pc++] | ((u32)(op & 1) << 16) | ((u32)((op >> 4) & 0x1F) << 17);
+        if (op & 0x0002) {
+            push((u8)pc);
+            push((u8)(pc >> 8));
+            cyc = 4;
+        } else {
+            if (k == 0) return false;
+            cyc = 3;
+        }
+        pc = k;
+    } else if (op == 0x9508) { // RET
+        u8 hi = pop(), lo = pop();
+        pc = (u32)(hi << 8 | lo);
+        cyc = 4;
+    } else if ((op & 0xFE00) == 0x9600) { // ADIW, SBIW
+        int rp = 24 + 2 * ((op >> 4) & 3);
+        u16 k6 = (u16)((op & 0x0F) | ((op >> 2) & 0x30));
+        u16 a = pair(rp);
+        u16 res = (op & 0x0100) ? (u16)(a - k6) : (u16)(a + k6);
+        bool a15 = a >> 15, r15 = res >> 15;
+        setFlag(FLAG_C, (op & 0x0100) ? r15 && !a15 : !r15 && a15);
+        setFlag(FLAG_V, (op & 0x0100) ? !r15 && a15 : r15 && !a15);
+        setFlag(FLAG_N, res >> 15);
+        setFlag(FLAG_Z, res == 0);
+        setFlag(FLAG_S, flag(FLAG_N) ^ flag(FLAG_V));
+        setPair(rp, res);
+        cyc = 2;
+    } else if ((op & 0xF800) == 0xF000) { // BRBS, BRBC
+        int k = (op >> 3) & 0x7F;
+        if (k & 0x40) k -= 0x80;
+        bool set = flag(op & 7);
+        if (set == !(op & 0x0400)) {
+            pc = (u32)((int)pc + k);
+            cyc = 2;
+        }
+    } else if ((op & 0xFC08) == 0xFC00) { // SBRC, SBRS
+        bool bit = (data[d] >> (op & 7)) & 1;
+        if (bit == !!(op & 0x0200)) skipNext();
+    } else {
+        fprintf(stderr, "unknown opcode 0x%04X at 0x%04X\n", op, at);
+        exit(2);
+    }
+    cycles += cyc;
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s program.hex\n", argv[0]);
+        return 2;
+    }
+    u16 words = loadHex(argv[1]);
+    u64 steps = 0;
+    while (step()) {
+        if (pc >= words) {
+            fprintf(stderr, "ran off the end of the program at 0x%04X\n", pc);
+            return 2;
+        }
+        if (++steps > MAX_STEPS) {
+            fprintf(stderr, "still running after %llu instructions\n", MAX_STEPS);
+            return 2;
+        }
+    }
+    printf("r24=%u r25:r24=%u cycles=%llu\n", data[24], pair(24), (unsigned long long)cycles);
+    return 0;
+}
@@ -0,0 +1,45 @@
+#!/bin/bash
+# simulated cycles of the code generated by the linear-scan (-O1) and graph-colouring (-O2) allocators
+# ./bench/cycles.sh [program.c ...]    (defaults to bench/programs/*.c and the looping tests)
+
+programs=( "$@" )
+if [ ${#programs[@]} == 0 ]; then
+    programs=( bench/programs/*.c tests/for.c tests/while.c tests/whilewhile.c tests/ifsabound.c )
+fi
+
+./build.sh > /dev/null || exit 1
+if [ ! -f build/avr_sim ] || [ bench/avr_sim.c -nt build/avr_sim ]; then
+    gcc -std=c17 -O2 bench/avr_sim.c -o build/avr_sim || exit 1
+fi
+
+out=$(mktemp -d)
+trap 'rm -rf "$out"' EXIT
+
+# prints "<return value> <cycles>" for one program at one level
+simulate() {
+    build/fcc -s $2 $1 -o $out/prog > /dev/null 2>&1 || return 1
+    build/avr_sim $out/prog.hex | sed 's/.*r25:r24=\([0-9]*\) cycles=\([0-9]*\)/\1 \2/'
+}
+
+printf "%-32s %8s %8s %8s\n" "program" "-O1" "-O2" "-O2/-O1"
+total1=0
+total2=0
+status=0
+for p in ${programs[@]}; do
+    read r1 c1 <<< $(simulate $p -O1)
+    read r2 c2 <<< $(simulate $p -O2)
+    if [ -z "$c1" ] || [ -z "$c2" ]; then
+        echo "$p: failed to compile or simulate"
+        status=1
+        continue
+    fi
+    if [ "$r1" != "$r2" ]; then
+        echo "$p: -O1 returned $r1 but -O2 returned $r2"
+        status=1
+    fi
+    printf "%-32s %8d %8d %8.2f\n" $p $c1 $c2 $(awk "BEGIN { print $c2 / $c1 }")
+    total1=$((total1 + c1))
+    total2=$((total2 + c2))
+done
+printf "%-32s %8d %8d %8.2f\n" "total" $total1 $total2 $(awk "BEGIN { print $total2 / $total1 }")
+exit $status
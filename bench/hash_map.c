@@ -0,0 +1,94 @@
+// microbenchmark for utils/hash_map.h against the map it replaced (bench/old_hash_map.h)
+// gcc -std=c17 -O2 bench/hash_map.c utils/*.c -o build/hash_map_bench && build/hash_map_bench
+
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../utils/common.h"
+#include "old_hash_map.h"
+
+_generate_hash_map(u64, u64);
+_generate_old_hash_map(u64, u64);
+_generate_hash_map(String, u64);
+_generate_old_hash_map(String, u64);
+
+static f64 now(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+// xorshift, so both maps see the same keys
+static u64 rng_state = 88172645463325252ull;
+static u64 rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+// NOTE(mdizdar): the volatile sink keeps the lookups from being optimized out
+static volatile u64 sink;
+
+// insert n keys, look every one of them up, then look up n keys that aren't there, and report ns per operation
+#define BENCH(map_type, key_type, keys, misses, n) do { \
+    map_type map; \
+    map_type##_construct(&map); \
+    f64 start = now(); \
+    for (u64 i = 0; i < (n); ++i) map_type##_add(&map, &(keys)[i], &i); \
+    f64 inserted = now(); \
+    for (u64 i = 0; i < (n); ++i) sink += *map_type##_get(&map, &(keys)[i]); \
+    f64 found = now(); \
+    for (u64 i = 0; i < (n); ++i) sink += map_type##_get(&map, &(misses)[i]) != NULL; \
+    f64 missed = now(); \
+    printf("%-22s %8lu %10.1f %10.1f %10.1f\n", #map_type, (u64)(n), \
+           (inserted - start) / (n), (found - inserted) / (n), (missed - found) / (n)); \
+    map_type##_destruct(&map); \
+} while (0)
+
+// identifier-looking strings, the kind the symbol table gets
+static String random_name(void) {
+    static const char letters[] = "abcdefghijklmnopqrstuvwxyz_0123456789";
+    u64 count = 1 + rng() % 12;
+    char *data = malloc(count + 1);
+    data[0] = letters[rng() % 27];
+    for (u64 i = 1; i < count; ++i) data[i] = letters[rng() % 37];
+    // NOTE(mdizdar): a trailing digit nobody else gets, so hits and misses don't overlap
+    data[count] = '\0';
+    return (String){.data = data, .count = count};
+}
+
+int main(void) {
+    static const u64 sizes[] = {100, 10000, 1000000};
+    printf("%-22s %8s %10s %10s %10s   (ns/op)\n", "map", "n", "insert", "hit", "miss");
+    for (u64 s = 0; s < sizeof(sizes)/sizeof(*sizes); ++s) {
+        const u64 n = sizes[s];
+        u64 *keys = malloc(n * sizeof(u64));
+        u64 *misses = malloc(n * sizeof(u64));
+        for (u64 i = 0; i < n; ++i) {
+            // NOTE(mdizdar): hits are even, misses are odd
+            keys[i] = rng() & ~1ull;
+            misses[i] = rng() | 1;
+        }
+        BENCH(u64u64HashMap, u64, keys, misses, n);
+        BENCH(u64u64OldHashMap, u64, keys, misses, n);
+        
+        String *names = malloc(n * sizeof(String));
+        String *other_names = malloc(n * sizeof(String));
+        for (u64 i = 0; i < n; ++i) {
+            names[i] = random_name();
+            other_names[i] = random_name();
+            // copies, so String_eq can't get away with comparing pointers like it does for interned names
+            other_names[i].data[0] = '$';
+        }
+        BENCH(Stringu64HashMap, String, names, other_names, n);
+        BENCH(Stringu64OldHashMap, String, names, other_names, n);
+        puts("");
+        
+        free(keys);
+        free(misses);
+    }
+    return 0;
+}
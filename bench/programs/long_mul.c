@@ -0,0 +1,12 @@
+int main() {
+    long l;
+    long m;
+    int i;
+    l = 1;
+    m = 0;
+    for (i = 0; i < 20; i = i + 1) {
+        l = l * 3;
+        m = m + l;
+    }
+    return (m >> 16) ^ m;
+}
@@ -0,0 +1,18 @@
+int main() {
+    unsigned int u;
+    int x;
+    int r;
+    char c;
+    u = 0;
+    x = 0;
+    r = 0;
+    c = 0;
+    while (u < 60000) {
+        u = u + 5000;
+        x = x - 5000;
+        c = c + 50;
+        if (x < 0) r = r + 1;
+        if (c < 0) r = r + 100;
+    }
+    return r + (x >> 4) + (u << 1);
+}
@@ -0,0 +1,33 @@
+int main() {
+    int a;
+    int b;
+    int i;
+    int j;
+    int s;
+    int z;
+    a = 3;
+    b = 1;
+    s = 0;
+    if (a > b) {
+        z = 1;
+    } else {
+        z = 2;
+    }
+    i = 0;
+    while (i < 10) {
+        s = s + a * b;
+        j = 0;
+        while (j < 5) {
+            s = s + (a << 2) + i * 3;
+            ++j;
+        }
+        ++i;
+    }
+    while (z < 100) {
+        z = z + a - b;
+    }
+    for (i = 0; i < 3; ++i) {
+        s = s + (b ^ 7);
+    }
+    return s + z;
+}
@@ -0,0 +1,16 @@
+int main() {
+    char a; char b; char c; char d; char e; char f; char g; char h; char i; char j; char k; char l; char m;
+    char n; char o; char p; char q; char r; char s; char t; char u; char v; char w; char x; char y; char z;
+    char r1; char r2;
+    a = 1; b = 2; c = 3; d = 4; e = 5; f = 6; g = 7; h = 8; i = 9; j = 10; k = 11; l = 12; m = 13;
+    n = 14; o = 15; p = 16; q = 17; r = 18; s = 19; t = 20; u = 21; v = 22; w = 23; x = 24; y = 25; z = 26;
+    r1 = 0;
+    while (r1 < 10) {
+        a = a + b; b = b + c; c = c + d; d = d + e; e = e + f; f = f + g; g = g + h; h = h + i; i = i + j;
+        j = j + k; k = k + l; l = l + m; m = m + n; n = n + o; o = o + p; p = p + q; q = q + r; r = r + s;
+        s = s + t; t = t + u; u = u + v; v = v + w; w = w + x; x = x + y; y = y + z; z = z + a;
+        r1 = r1 + 1;
+    }
+    r2 = a + b + c + d + e + f + g + h + i + j + k + l + m + n + o + p + q + r + s + t + u + v + w + x + y + z;
+    return r2;
+}
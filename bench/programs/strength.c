@@ -0,0 +1,9 @@
+int main() {
+    int i;
+    int s;
+    s = 0;
+    for (i = 0; i < 10; ++i) {
+        s += i * 4 + 3;
+    }
+    return s;
+}
@@ -1,4 +1,13 @@
+#ifndef _MSC_VER
+#define _DEFAULT_SOURCE // MAP_ANONYMOUS isn't POSIX
+#endif
 #include <time.h>
+#ifndef _MSC_VER
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 #include "utils/common.h"
 
@@ -8,14 +17,23 @@
 #include "C/ir_gen.h"
 
 #include "IR/IR.h"
+#include "IR/ssa.h"
+#include "IR/sccp.h"
+#include "IR/gvn.h"
+#include "IR/licm.h"
+#include "IR/strength_reduction.h"
+#include "IR/dce.h"
 #include "AVR/AVR.h"
 #include "IR2AVR/IR2AVR.h"
 
 char *codefile = NULL;
 char *outfile = NULL;
 bool silent = false;
+bool memory_stats = false;
+RegisterAllocator register_allocator = ALLOCATOR_GRAPH_COLOURING;
 
-void printAST(Node *root, u64 indent, const Scope *current_scope) {
+void printAST(NodeIndex index, u64 indent, const Scope *current_scope) {
+    Node *root = Node_at(index);
     if (root == NULL) return;
     for (u64 i = 0; i < indent; ++i) {
         if (i % 3 == 0) {
@@ -29,17 +47,17 @@ void printAST(Node *root, u64 indent, const Scope *current_scope) {
     }
     {
         char s[256];
-        printf("%s", Token_toStr(s, *root->token));
-        if (root->token->type == TOKEN_DECLARATION) {
-            printf(" %s", SymbolTableEntry_toStr(s, root->token->entry));
+        printf("%s", Token_toStr(s, root->token));
+        if (root->token.type == TOKEN_DECLARATION) {
+            printf(" %s", SymbolTableEntry_toStr(s, root->token.entry));
         }
         puts("");
     }
-    if (root->token->type == '?' || root->token->type == TOKEN_FOR || root->token->type == TOKEN_FOR_COND || root->token->type == TOKEN_IF || root->token->type == TOKEN_WHILE || root->token->type == TOKEN_DO) {
+    if (root->token.type == '?' || root->token.type == TOKEN_FOR || root->token.type == TOKEN_FOR_COND || root->token.type == TOKEN_IF || root->token.type == TOKEN_WHILE || root->token.type == TOKEN_DO) {
         printAST(root->cond, indent+3, current_scope);
     }
-    if (root->token->type == TOKEN_DECLARATION) {
-        SymbolTableEntry *entry = root->token->entry;
+    if (root->token.type == TOKEN_DECLARATION) {
+        SymbolTableEntry *entry = root->token.entry;
         assert(entry != NULL);
         if (entry->type->is_function) {
             printAST(entry->type->function_type->block, indent+3, current_scope);
@@ -49,26 +67,27 @@ void printAST(Node *root, u64 indent, const Scope *current_scope) {
     printAST(root->right, indent+3, current_scope);
 }
 
-void saveAST_labels(Node *AST, const Scope *current_scope, FILE *fp, u64 id) {
+void saveAST_labels(NodeIndex index, const Scope *current_scope, FILE *fp, u64 id) {
+    Node *AST = Node_at(index);
     if (AST == NULL) return;
     if (AST->scope != NULL) {
         current_scope = AST->scope;
     }
-    if (AST->token->type != TOKEN_NEXT && AST->token->type != TOKEN_DECLARATION) {
+    if (AST->token.type != TOKEN_NEXT && AST->token.type != TOKEN_DECLARATION) {
         // NOTE(mdizdar): this is here so it doesn't generate unnecessary nodes
         char s[100];
-        fprintf(fp, "%lu[label=\"%s\"]\n", id, Token_toStr(s, *AST->token));
+        fprintf(fp, "%lu[label=\"%s\"]\n", id, Token_toStr(s, AST->token));
     }
-    if (AST->token->type == '?' || AST->token->type == TOKEN_FOR || AST->token->type == TOKEN_FOR_COND || AST->token->type == TOKEN_IF || AST->token->type == TOKEN_WHILE || AST->token->type == TOKEN_DO) {
+    if (AST->token.type == '?' || AST->token.type == TOKEN_FOR || AST->token.type == TOKEN_FOR_COND || AST->token.type == TOKEN_IF || AST->token.type == TOKEN_WHILE || AST->token.type == TOKEN_DO) {
         saveAST_labels(AST->cond, current_scope, fp, id+1024);
         saveAST_labels(AST->left, current_scope, fp, 2*id+1);
         saveAST_labels(AST->right, current_scope, fp, 2*id+2);
-    } else if (AST->token->type == TOKEN_DECLARATION) {
-        SymbolTableEntry *entry = AST->token->entry;
+    } else if (AST->token.type == TOKEN_DECLARATION) {
+        SymbolTableEntry *entry = AST->token.entry;
         assert(entry != NULL);
         if (entry->type->is_function) {
             char s[100];
-            fprintf(fp, "%lu[label=\"%s\"]\n", id, Token_toStr(s, *AST->token));
+            fprintf(fp, "%lu[label=\"%s\"]\n", id, Token_toStr(s, AST->token));
             saveAST_labels(entry->type->function_type->block, current_scope, fp, 2*id+1);
         }
     } else {
@@ -77,21 +96,22 @@ void saveAST_labels(Node *AST, const Scope *current_scope, FILE *fp, u64 id) {
     }
 }
 
-void saveAST_edges(Node *AST, const Scope *current_scope, FILE *fp, u64 id, u64 prev) {
+void saveAST_edges(NodeIndex index, const Scope *current_scope, FILE *fp, u64 id, u64 prev) {
+    Node *AST = Node_at(index);
     if (AST == NULL) return;
     if (AST->scope != NULL) {
         current_scope = AST->scope;
     }
-    if (AST->token->type == '?' || AST->token->type == TOKEN_FOR || AST->token->type == TOKEN_FOR_COND || AST->token->type == TOKEN_IF || AST->token->type == TOKEN_WHILE || AST->token->type == TOKEN_DO) {
+    if (AST->token.type == '?' || AST->token.type == TOKEN_FOR || AST->token.type == TOKEN_FOR_COND || AST->token.type == TOKEN_IF || AST->token.type == TOKEN_WHILE || AST->token.type == TOKEN_DO) {
         fprintf(fp, "%lu->%lu\n", prev, id);
         saveAST_edges(AST->left, current_scope, fp, 2*id+1, id);
         saveAST_edges(AST->cond, current_scope, fp, id+1024, id);
         saveAST_edges(AST->right, current_scope, fp, 2*id+2, id);
-    } else if (AST->token->type == TOKEN_NEXT) {
+    } else if (AST->token.type == TOKEN_NEXT) {
         saveAST_edges(AST->left, current_scope, fp, 2*id+1, prev);
         saveAST_edges(AST->right, current_scope, fp, 2*id+2, prev);
-    } else if (AST->token->type == TOKEN_DECLARATION) {
-        SymbolTableEntry *entry = AST->token->entry;
+    } else if (AST->token.type == TOKEN_DECLARATION) {
+        SymbolTableEntry *entry = AST->token.entry;
         assert(entry != NULL);
         if (entry->type->is_function) {
             fprintf(fp, "%lu->%lu\n", prev, id);
@@ -104,7 +124,7 @@ void saveAST_edges(Node *AST, const Scope *current_scope, FILE *fp, u64 id, u64
     }
 }
 
-void saveAST(Node *AST, const Scope *current_scope, char *filename) {
+void saveAST(NodeIndex AST, const Scope *current_scope, char *filename) {
     u64 len = strlen(filename);
     char *of = malloc(sizeof(char) * len+15);
     strcpy(of, filename);
@@ -148,19 +168,46 @@ void saveCFG(IRArray *ir, char *filename) {
     fclose(fp);
 }
 
+// NOTE(mdizdar): the lexer wants LEXER_PADDING zero bytes after the code and writes into it
+// (escape sequences), so the file is mapped privately on top of a slightly bigger anonymous mapping.
+// Identifiers and string literals point straight into this, so it's never unmapped
 String read_file(char *filename) {
-    FILE *fp = fopen(filename, "rb");
     String file_data;
+#ifdef _MSC_VER
+    FILE *fp = fopen(filename, "rb");
+    if (fp == NULL) {
+        error(-1, "Couldn't open %s.", filename);
+    }
     fseek(fp, 0L, SEEK_END);
     file_data.count = ftell(fp);
     rewind(fp);
-    file_data.data = malloc((file_data.count+1) * sizeof(char));
+    file_data.data = calloc(file_data.count + LEXER_PADDING, sizeof(char));
     size_t actually_read = fread(file_data.data, sizeof(char), file_data.count, fp);
     if (actually_read != file_data.count) {
         error(-1, "Error reading file.");
     }
     fclose(fp);
-    file_data.data[file_data.count] = 0;
+#else
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        error(-1, "Couldn't open %s.", filename);
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) < 0) {
+        error(-1, "Error reading file.");
+    }
+    file_data.count = file_stat.st_size;
+    u64 page_size = sysconf(_SC_PAGESIZE);
+    u64 mapped_size = (file_data.count + LEXER_PADDING + page_size - 1) & ~(page_size - 1);
+    file_data.data = mmap(NULL, mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (file_data.data == MAP_FAILED) {
+        error(-1, "Error reading file.");
+    }
+    if (file_data.count > 0 && mmap(file_data.data, file_data.count, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        error(-1, "Error reading file.");
+    }
+    close(fd);
+#endif
     return file_data;
 }
 
@@ -171,6 +218,12 @@ void parse_args(int argc, char **argv) {
             outfile = argv[i];
         } else if (strcmp(argv[i], "-s") == 0) {
             silent = true;
+        } else if (strcmp(argv[i], "-m") == 0) {
+            memory_stats = true;
+        } else if (strcmp(argv[i], "-O1") == 0) {
+            register_allocator = ALLOCATOR_LINEAR_SCAN;
+        } else if (strcmp(argv[i], "-O2") == 0) {
+            register_allocator = ALLOCATOR_GRAPH_COLOURING;
         } else {
             codefile = argv[i];;
         }
@@ -192,46 +245,51 @@ int main(int argc, char **argv) {
     Parser parser = (Parser){
         .lexer = {
             .code = code,
-            .token_at = calloc(code.count+5, sizeof(CachedToken)),
             .token_arena = Arena_init(4096),
+            .idents = InternTable_init(1024),
             .pos = 0,
             .peek = 0,
             .cur_line = 1,
             .cur_col = 0
         },
         .symbol_table = &st,
-        .arena = Arena_init(4096),
         .type_arena = Arena_init(4096)
     };
     
-    Node *AST = Parser_parse(&parser);
+    Lexer_tokenize(&parser.lexer);
+    NodeIndex AST = Parser_parse(&parser);
+    
+    // NOTE(mdizdar): the nodes have their own copies of the tokens, so the lexer is done once we've parsed
+    if (memory_stats) Arena_printStats(parser.lexer.token_arena, "lexer");
+    TokenArray_destruct(&parser.lexer.tokens);
+    Arena_freeall(parser.lexer.token_arena);
     
     IRArray generated_IR;
     IRArray_construct(&generated_IR);
     {
-        IR *label = malloc(sizeof(IR));
+        IR *label = calloc(1, sizeof(IR));
         label->block = NULL;
         label->instruction = OP_LABEL;
         label->operands[0].type = OT_LABEL;
         label->operands[0].named = true;
         label->operands[0].label_name.data = "__start";
-        label->operands[0].label_name.count = 8; 
+        label->operands[0].label_name.count = 7;
         IRArray_push_ptr(&generated_IR, label);
-        IR *main_call = malloc(sizeof(IR));
+        IR *main_call = calloc(1, sizeof(IR));
         main_call->block = NULL;
         main_call->instruction = OP_CALL;
         main_call->operands[0].type = OT_LABEL;
         main_call->operands[0].named = true;
         main_call->operands[0].label_name.data = "main";
-        main_call->operands[0].label_name.count = 5;
+        main_call->operands[0].label_name.count = 4;
         IRArray_push_ptr(&generated_IR, main_call);
-        IR *jump = malloc(sizeof(IR));
+        IR *jump = calloc(1, sizeof(IR));
         jump->block = NULL;
         jump->instruction = OP_JUMP;
         jump->operands[0].type = OT_LABEL;
         jump->operands[0].named = true;
         jump->operands[0].label_name.data = "__start";
-        jump->operands[0].label_name.count = 8; 
+        jump->operands[0].label_name.count = 7;
         IRArray_push_ptr(&generated_IR, jump);
     }
     if (!silent) puts(CYAN "***AST***" RESET);
@@ -239,14 +297,42 @@ int main(int argc, char **argv) {
     if (outfile) saveAST(AST, st.scope, outfile);
     
     if (!silent) puts(CYAN "****IR****" RESET);
-    type_check(AST, NULL);
+    type_check(Node_at(AST), NULL);
     IRContext context = {.global = true};
     context.in_loop = false;
-    IR_generate(AST, &generated_IR, st.scope, &context);
+    IR_generate(Node_at(AST), &generated_IR, st.scope, &context);
+    
     if (!silent) IR_print(generated_IR.data, generated_IR.count);
 
     LabelArray labels = findLabels(&generated_IR);
 
+    // NOTE(mdizdar): the phis' operands live here, the basic blocks get an arena of their own in makeBasicBlocks, and
+    // saveCFG still wants them after IR2AVR is done
+    Arena *ir_arena = Arena_init(4096);
+    IR_constructSSA(&generated_IR, &labels, ir_arena);
+    if (!silent) puts(CYAN "***SSA IR***" RESET);
+    if (!silent) IR_print(generated_IR.data, generated_IR.count);
+
+    IR_propagateConstants(&generated_IR, &labels);
+    if (!silent) puts(CYAN "***SCCP IR***" RESET);
+    if (!silent) IR_print(generated_IR.data, generated_IR.count);
+
+    IR_numberValues(&generated_IR, &labels);
+    if (!silent) puts(CYAN "***GVN IR***" RESET);
+    if (!silent) IR_print(generated_IR.data, generated_IR.count);
+
+    IR_hoistInvariants(&generated_IR, &labels, ir_arena);
+    if (!silent) puts(CYAN "***LICM IR***" RESET);
+    if (!silent) IR_print(generated_IR.data, generated_IR.count);
+
+    IR_reduceStrength(&generated_IR, &labels, ir_arena);
+    if (!silent) puts(CYAN "***SR IR***" RESET);
+    if (!silent) IR_print(generated_IR.data, generated_IR.count);
+
+    IR_eliminateDeadCode(&generated_IR, &labels);
+    if (!silent) puts(CYAN "***DCE IR***" RESET);
+    if (!silent) IR_print(generated_IR.data, generated_IR.count);
+
     generated_IR = IR_resolve_phi(&generated_IR, &labels);
     if (!silent) puts(CYAN "***Phi resolved IR***" RESET);
     if (!silent) IR_print(generated_IR.data, generated_IR.count);
@@ -255,7 +341,11 @@ int main(int argc, char **argv) {
     AVRArray generated_AVR;
     AVRArray_construct(&generated_AVR);
 
-    IR2AVR(&generated_IR, &generated_AVR, &labels, temporary_index);
+    IR2AVR(&generated_IR, &generated_AVR, &labels, ir_arena, register_allocator);
+    // NOTE(mdizdar): IR2AVR was the last thing to look at types, it needs them to know how wide everything is
+    if (memory_stats) Arena_printStats(parser.type_arena, "parser/types");
+    Type_freeInterner();
+    Arena_freeall(parser.type_arena);
     if (!silent) printAVR(&generated_AVR);
     
     if (!silent) puts(CYAN "***HEX***" RESET);
@@ -268,6 +358,12 @@ int main(int argc, char **argv) {
         saveIntelHex(&generated_AVR, outfile);
     }
     
+    if (memory_stats) Arena_printStats(ir_arena, "IR");
+    Arena_freeall(ir_arena);
+    freeBasicBlocks(memory_stats);
+    if (memory_stats) Arena_printStats(st.scopes_arena, "symbol table");
+    Arena_freeall(st.scopes_arena);
+    
     /*
 puts(CYAN "**TOKENS**" RESET);
     Lexer lexer = (Lexer){
@@ -304,13 +400,12 @@ puts(CYAN "**TOKENS**" RESET);
             .cur_line = 1,
         },
         .symbol_table = &st,
-        .arena = Arena_init(4096),
         .type_arena = Arena_init(4096)
 #pragma warning(suppress: 4221) 
     };
     // NOTE(mdizdar): this is just so it doesn't scream about initializing .symbol_table with the address of a variable that's on the stack
     
-    Node *AST = Parser_parse(&parser);
+    NodeIndex AST = Parser_parse(&parser);
     
     clock_t end = clock();
     
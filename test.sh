@@ -1,7 +1,9 @@
 #!/bin/bash
 
-all_tests=( 'main' 'int' 'two_variables' 'int_assign' 'int_assign_exp' 'return_exp' 'return_var' 'scope' 'ternary' 'if' 'ifelse' 'ifelseif' 'ifsabound' 'while' 'for' 'whilewhile' 'pointer' 'undeclared_variable' )
+all_tests=( 'main' 'int' 'two_variables' 'int_assign' 'int_assign_exp' 'return_exp' 'return_var' 'scope' 'ternary' 'if' 'ifelse' 'ifelseif' 'ifsabound' 'while' 'for' 'whilewhile' 'pointer' 'pointer_sum' 'literal_types' 'args' 'big_frame' 'licm_preheader' 'reduced_char' 'const_pointer' 'undeclared_variable' )
 declare -A negative_tests=(['undeclared_variable']=1)
+# what main has to return (r25:r24) when bench/avr_sim runs the test
+declare -A expected=(['pointer_sum']=92 ['literal_types']=33330 ['args']=11009 ['big_frame']=6423 ['licm_preheader']=1125 ['reduced_char']=12021 ['const_pointer']=16000)
 
 usage() {
     echo "Usage: test [ -l | --loud] 
@@ -41,6 +43,9 @@ check() {
     result=$?
     if [ $result != 0 ] && [ -z "${negative_tests[$1]}" ]; then 
         res="\e[31m[  FAILED  ]"
+    elif [ -n "${expected[$1]}" ] && ! build/avr_sim tests/$1.hex | grep -q "r25:r24=${expected[$1]} "; then
+        echo "main should have returned ${expected[$1]}: $(build/avr_sim tests/$1.hex 2>&1)"
+        res="\e[31m[  FAILED  ]"
     else
         passed_tests=$((passed_tests + 1))
     fi
@@ -55,6 +60,10 @@ if [ $? != 0 ]; then
     exit 1
 fi
 
+if [ ! -f build/avr_sim ] || [ bench/avr_sim.c -nt build/avr_sim ]; then
+    gcc -std=c17 -O2 bench/avr_sim.c -o build/avr_sim || exit 1
+fi
+
 echo "==================================="
 echo "               TESTS               "
 echo "==================================="
@@ -0,0 +1,29 @@
+long scale(char a, int b, long c, unsigned char d) {
+    return c * a + b - d;
+}
+
+int sum3(int a, int b, int c) {
+    return a + b + c;
+}
+
+int spread(int x, int y) {
+    int a; int b; int c; int d; int e; int f; int g; int h; int i; int j; int k; int l; int m;
+    int n; int o; int p; int q; int r; int s; int t; int u; int v; int w; int z;
+    a = x; b = y; c = x + 1; d = y + 1; e = x + 2; f = y + 2; g = x + 3; h = y + 3; i = x + 4; j = y + 4;
+    k = x + 5; l = y + 5; m = x + 6; n = y + 6; o = x + 7; p = y + 7; q = x + 8; r = y + 8; s = x + 9;
+    t = y + 9; u = x + 10; v = y + 10; w = x + 11; z = y + 11;
+    return a + b + c + d + e + f + g + h + i + j + k + l + m + n + o + p + q + r + s + t + u + v + w + z - x * y;
+}
+
+int fib(char n) {
+    if (n < 2) return n;
+    return fib(n - 1) + fib(n - 2);
+}
+
+int main() {
+    long r;
+    int s;
+    r = scale(-3, 1000, 70000, 200);
+    s = sum3(1, sum3(2, 3, 4), 5);
+    return (r >> 8) + s + spread(200, 300) + fib(12);
+}
@@ -0,0 +1,86 @@
+long weigh(long x, int k) {
+    return x * k;
+}
+
+long frame(long seed) {
+    long a0; long a1; long a2; long a3; long a4; long a5; long a6; long a7; long a8; long a9; long a10; long a11; long a12; long a13; long a14; long a15; long a16; long a17; long a18; long a19; long a20; long a21; long a22; long a23;
+    long sum;
+    a0 = seed * 1 + 7;
+    a1 = seed * 2 + 1007;
+    a2 = seed * 3 + 2007;
+    a3 = seed * 4 + 3007;
+    a4 = seed * 5 + 4007;
+    a5 = seed * 6 + 5007;
+    a6 = seed * 7 + 6007;
+    a7 = seed * 8 + 7007;
+    a8 = seed * 9 + 8007;
+    a9 = seed * 10 + 9007;
+    a10 = seed * 11 + 10007;
+    a11 = seed * 12 + 11007;
+    a12 = seed * 13 + 12007;
+    a13 = seed * 14 + 13007;
+    a14 = seed * 15 + 14007;
+    a15 = seed * 16 + 15007;
+    a16 = seed * 17 + 16007;
+    a17 = seed * 18 + 17007;
+    a18 = seed * 19 + 18007;
+    a19 = seed * 20 + 19007;
+    a20 = seed * 21 + 20007;
+    a21 = seed * 22 + 21007;
+    a22 = seed * 23 + 22007;
+    a23 = seed * 24 + 23007;
+    a0 = a0 + a1;
+    a1 = a1 + a2;
+    a2 = a2 + a3;
+    a3 = a3 + a4;
+    a4 = a4 + a5;
+    a5 = a5 + a6;
+    a6 = a6 + a7;
+    a7 = a7 + a8;
+    a8 = a8 + a9;
+    a9 = a9 + a10;
+    a10 = a10 + a11;
+    a11 = a11 + a12;
+    a12 = a12 + a13;
+    a13 = a13 + a14;
+    a14 = a14 + a15;
+    a15 = a15 + a16;
+    a16 = a16 + a17;
+    a17 = a17 + a18;
+    a18 = a18 + a19;
+    a19 = a19 + a20;
+    a20 = a20 + a21;
+    a21 = a21 + a22;
+    a22 = a22 + a23;
+    a23 = a23 + a0;
+    sum = 0;
+    sum = sum + weigh(a0, 1);
+    sum = sum + weigh(a1, 2);
+    sum = sum + weigh(a2, 3);
+    sum = sum + weigh(a3, 4);
+    sum = sum + weigh(a4, 5);
+    sum = sum + weigh(a5, 1);
+    sum = sum + weigh(a6, 2);
+    sum = sum + weigh(a7, 3);
+    sum = sum + weigh(a8, 4);
+    sum = sum + weigh(a9, 5);
+    sum = sum + weigh(a10, 1);
+    sum = sum + weigh(a11, 2);
+    sum = sum + weigh(a12, 3);
+    sum = sum + weigh(a13, 4);
+    sum = sum + weigh(a14, 5);
+    sum = sum + weigh(a15, 1);
+    sum = sum + weigh(a16, 2);
+    sum = sum + weigh(a17, 3);
+    sum = sum + weigh(a18, 4);
+    sum = sum + weigh(a19, 5);
+    sum = sum + weigh(a20, 1);
+    sum = sum + weigh(a21, 2);
+    sum = sum + weigh(a22, 3);
+    sum = sum + weigh(a23, 4);
+    return sum;
+}
+
+int main() {
+    return frame(3) >> 8;
+}
@@ -0,0 +1,22 @@
+int walk() {
+    int *p;
+    int s;
+    int i;
+    for (i = 0; i < 5; ++i) {
+        p = 600 + i * 2;
+        *p = i * 1000 + 1000;
+    }
+    s = 0;
+    for (i = 0; i < 5; ++i) {
+        p = 600 + i * 2;
+        s = s + *p;
+    }
+    return s;
+}
+
+int main() {
+    int *p;
+    p = 512;
+    *p = 1000;
+    return *p + walk();
+}
@@ -0,0 +1,18 @@
+int f(int v0, int v6) {
+    int v10; int v11; int i0; int i1;
+    v10 = 0; v11 = 0;
+    for (i1 = 0; i1 < 3; ++i1) {
+        i0 = 0;
+        v11 = v6 * 5;
+        while (i0 < 4) {
+            if (v0 != v11) v11 -= v6;
+            v10 -= (i0 - 100) + i1 * v0;
+            ++i0;
+        }
+    }
+    return v10 + v11;
+}
+
+int main() {
+    return f(5, 3);
+}
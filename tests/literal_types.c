@@ -0,0 +1,23 @@
+int main() {
+    char c;
+    int v;
+    unsigned int u;
+    int i;
+    int r;
+    c = 0;
+    v = 0;
+    u = 0;
+    r = 0;
+    for (i = 0; i < 3; ++i) {
+        c = c + 4;
+        v = v + 4;
+        u = u - 4;
+        if (65535 <= c) r = r + 1;
+        if (65535 <= v) r = r + 2;
+        if (c < 65535) r = r + 10;
+        if (v < 70000) r = r + 100;
+        if (u > 65000) r = r + 1000;
+        if (-1 < v) r = r + 10000;
+    }
+    return r;
+}
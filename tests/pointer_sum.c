@@ -0,0 +1,17 @@
+int main() {
+    char *p;
+    char *q;
+    int s;
+    int i;
+    p = 512;
+    for (i = 0; i < 8; ++i) {
+        *p = i * 3 + 1;
+        ++p;
+    }
+    s = 0;
+    q = p - 8;
+    for (i = 0; i < 8; ++i) {
+        s = s + *(q + i);
+    }
+    return s;
+}
@@ -0,0 +1,19 @@
+long first() {
+    long v0; char v1; int i0;
+    v0 = 472;
+    v1 = -87;
+    for (i0 = 0; i0 < 5; ++i0) v0 += i0 * 8 + v1;
+    return v0;
+}
+
+long second() {
+    long v5; char v0; int i1;
+    v5 = 1000;
+    v0 = -100;
+    for (i1 = 0; i1 < 7; ++i1) v5 += (i1 * 1) + v0;
+    return v5;
+}
+
+int main() {
+    return first() * 100 + second();
+}
@@ -3,21 +3,41 @@
 
 #include "common.h"
 
-// NOTE(mdizdar): who's gonna need more than 8*64 pointers for real tho
-static const u64 BITSET_SIZE = 8LL;
-typedef u64 Bitset[8]; // cl is stupid
+// NOTE(mdizdar): a dense bitset is just an array of words, whoever owns it knows how many there are.
+// Sets that get combined with each other always have the same number of words
+#define BITSET_WORDS(bits) (((bits) + 63) / 64)
 
-// NOTE(mdizdar): for all of these we're hoping the compiler will notice the division and modulo operations can be rewritten as bitshifts
-inline bool Bitset_isSet(Bitset bitset, u64 bit) {
-    return !!(bitset[bit/sizeof(*bitset)] & (1LL << (bit % sizeof(*bitset))));
+static inline bool Bitset_isSet(const u64 *bitset, u64 bit) {
+    return (bitset[bit / 64] >> (bit % 64)) & 1;
 }
 
-inline void Bitset_set(Bitset bitset, u64 bit) {
-    bitset[bit/sizeof(*bitset)] |= (1LL << (bit % sizeof(*bitset)));
+static inline void Bitset_set(u64 *bitset, u64 bit) {
+    bitset[bit / 64] |= 1ull << (bit % 64);
 }
 
-inline void Bitset_clear(Bitset bitset, u64 bit) {
-    bitset[bit/sizeof(*bitset)] &= ~(1LL << (bit % sizeof(*bitset)));
+static inline void Bitset_clear(u64 *bitset, u64 bit) {
+    bitset[bit / 64] &= ~(1ull << (bit % 64));
 }
 
+static inline void Bitset_copy(u64 *dest, const u64 *src, u64 words) {
+    memcpy(dest, src, words * sizeof(u64));
+}
+
+// dest |= src, returns whether dest changed
+static inline bool Bitset_unionWith(u64 *dest, const u64 *src, u64 words) {
+    u64 changed = 0;
+    for (u64 i = 0; i < words; ++i) {
+        u64 merged = dest[i] | src[i];
+        changed |= merged ^ dest[i];
+        dest[i] = merged;
+    }
+    return changed != 0;
+}
+
+// goes through the set bits in increasing order, bit has to be declared beforehand.
+// Unlike ARRAY_EACH this is the whole loop header, so it goes without the for: BITSET_EACH(bit, set, words) { ... }
+#define BITSET_EACH(bit, bitset, words) \
+    for (u64 _word_i = 0, _word = 0; _word_i < (words); ++_word_i) \
+        for (_word = (bitset)[_word_i]; _word && ((bit) = _word_i * 64 + __builtin_ctzll(_word), 1); _word &= _word - 1)
+
 #endif //BITSET_H
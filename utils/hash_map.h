@@ -5,6 +5,70 @@
 #include <assert.h>
 #include "common.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// NOTE(mdizdar): open addressing in the style of abseil's swiss tables. Next to the slots there's one control
+// byte per slot, which is either HASH_MAP_EMPTY, HASH_MAP_DELETED, or the top 7 bits of the slot's hash (so the
+// high bit is only set on the first two). A lookup loads the 16 control bytes starting at its probe position,
+// compares them all against its own 7 bits at once, and only calls _eq on the slots that matched. The first
+// HASH_MAP_GROUP_WIDTH control bytes are mirrored past the end, so a group can start at any slot.
+// The capacity is always a power of two and at most 7/8 of it gets filled, so there's always an empty slot
+#define HASH_MAP_GROUP_WIDTH 16
+#define HASH_MAP_EMPTY       ((u8)0x80)
+#define HASH_MAP_DELETED     ((u8)0xFE)
+#define HASH_MAP_IS_FULL(c)  (!((c) & 0x80))
+
+// bit i is set if group[i] == byte
+static inline u32 HashMap_matchByte(const u8 *group, u8 byte) {
+#if defined(__SSE2__)
+    __m128i g = _mm_loadu_si128((const __m128i *)group);
+    return (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8((char)byte)));
+#else
+    u32 mask = 0;
+    for (u32 i = 0; i < HASH_MAP_GROUP_WIDTH; ++i) {
+        mask |= (u32)(group[i] == byte) << i;
+    }
+    return mask;
+#endif
+}
+
+// bit i is set if group[i] is empty or deleted
+static inline u32 HashMap_matchFree(const u8 *group) {
+#if defined(__SSE2__)
+    return (u32)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)group));
+#else
+    u32 mask = 0;
+    for (u32 i = 0; i < HASH_MAP_GROUP_WIDTH; ++i) {
+        mask |= (u32)(group[i] >> 7) << i;
+    }
+    return mask;
+#endif
+}
+
+// the keys' hash functions don't have to spread their bits, this does it for them
+static inline u64 HashMap_mix(u64 hash) {
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+#define HASH_MAP_FINGERPRINT(hash) ((u8)((hash) >> 57))
+
+// index of the first full slot at or after i, capacity if there isn't one
+static inline u64 HashMap_nextFull(const u8 *control, u64 capacity, u64 i) {
+    for (; i < capacity; i += HASH_MAP_GROUP_WIDTH) {
+        u32 full = ~HashMap_matchFree(control + i) & 0xFFFF;
+        if (full) {
+            u64 index = i + __builtin_ctz(full);
+            return index < capacity ? index : capacity;
+        }
+    }
+    return capacity;
+}
+
 #define _generate_hash_map_header(key_type, value_type) \
     typedef struct key_type##value_type##KVPair { \
         key_type key; \
@@ -13,10 +77,10 @@
     \
     typedef struct key_type##value_type##HashMap { \
         key_type##value_type##KVPair *table; \
-        bool *occupied; \
+        u8 *control; /* capacity + HASH_MAP_GROUP_WIDTH bytes */ \
         u64 size; \
         u64 capacity; \
-        double resize_threshold; \
+        u64 growth_left; /* how many more empty slots can be filled before resizing */ \
     } key_type##value_type##HashMap; \
     \
     void key_type##value_type##HashMap_construct(key_type##value_type##HashMap *map); \
@@ -41,36 +105,73 @@
     void key_type##value_type##HashMap_construct(key_type##value_type##HashMap *map) { \
         map->capacity = 0; \
         map->size = 0; \
+        map->growth_left = 0; \
         map->table = NULL; \
-        map->occupied = NULL; \
-        map->resize_threshold = 0.7; \
+        map->control = NULL; \
     } \
     \
     void key_type##value_type##HashMap_destruct(key_type##value_type##HashMap *map) { \
         if (map->table != NULL) { \
             free(map->table); \
-            free(map->occupied); \
+            free(map->control); \
             map->table = NULL; \
-            map->occupied = NULL; \
+            map->control = NULL; \
+        } \
+    } \
+    \
+    static inline void key_type##value_type##HashMap_set_control(key_type##value_type##HashMap *map, u64 index, u8 control) { \
+        map->control[index] = control; \
+        /* NOTE(mdizdar): for index >= HASH_MAP_GROUP_WIDTH this is the same byte again */ \
+        map->control[((index - HASH_MAP_GROUP_WIDTH) & (map->capacity-1)) + HASH_MAP_GROUP_WIDTH] = control; \
+    } \
+    \
+    static inline key_type##value_type##KVPair *key_type##value_type##HashMap_find(const key_type##value_type##HashMap *map, const key_type *key, u64 hash) { \
+        const u8 fingerprint = HASH_MAP_FINGERPRINT(hash); \
+        const u64 mask = map->capacity-1; \
+        u64 position = hash & mask; \
+        for (u64 step = HASH_MAP_GROUP_WIDTH;; step += HASH_MAP_GROUP_WIDTH) { \
+            const u8 *group = map->control + position; \
+            for (u32 matches = HashMap_matchByte(group, fingerprint); matches; matches &= matches-1) { \
+                u64 index = (position + __builtin_ctz(matches)) & mask; \
+                if (key_type##_eq(&map->table[index].key, key)) { \
+                    return map->table + index; \
+                } \
+            } \
+            if (HashMap_matchByte(group, HASH_MAP_EMPTY)) { \
+                return NULL; \
+            } \
+            position = (position + step) & mask; \
+        } \
+    } \
+    \
+    /* returns the first free slot on the key's probe sequence, the key must not already be in the map */ \
+    static inline u64 key_type##value_type##HashMap_find_free(const key_type##value_type##HashMap *map, u64 hash, u64 *travel) { \
+        const u64 mask = map->capacity-1; \
+        u64 position = hash & mask; \
+        for (u64 step = HASH_MAP_GROUP_WIDTH;; step += HASH_MAP_GROUP_WIDTH) { \
+            u32 free_slots = HashMap_matchFree(map->control + position); \
+            if (free_slots) { \
+                return (position + __builtin_ctz(free_slots)) & mask; \
+            } \
+            position = (position + step) & mask; \
+            ++*travel; \
         } \
     } \
     \
     u64 key_type##value_type##HashMap_add_helper(key_type##value_type##HashMap *map, const key_type *key, const value_type *value) { \
-        u64 hash = key_type##_hash(key) % map->capacity; \
-        \
+        const u64 hash = HashMap_mix(key_type##_hash(key)); \
+        if (map->size != 0 && key_type##value_type##HashMap_find(map, key, hash) != NULL) { \
+            /* it's already in the table */ \
+            return 0; \
+        } \
         u64 travel = 0; \
-        /* NOTE(mdizdar): this is checking whether a hash is in use */ \
-        while (map->occupied[hash] != 0) { \
-            if (key_type##_eq(&map->table[hash].key, key)) { \
-                /* it's already in the table */ \
-                return 0; \
-            } \
-            hash = (hash+1) % map->capacity; \
-            ++travel; \
+        u64 index = key_type##value_type##HashMap_find_free(map, hash, &travel); \
+        if (map->control[index] == HASH_MAP_EMPTY) { \
+            --map->growth_left; \
         } \
-        key_type##_copy(&map->table[hash].key, key); \
-        value_type##_copy(&map->table[hash].value, value); \
-        map->occupied[hash] = 1; \
+        key_type##value_type##HashMap_set_control(map, index, HASH_MAP_FINGERPRINT(hash)); \
+        key_type##_copy(&map->table[index].key, key); \
+        value_type##_copy(&map->table[index].value, value); \
         \
         ++map->size; \
         \
@@ -79,51 +180,45 @@
     \
     void key_type##value_type##HashMap_resize(key_type##value_type##HashMap *map) { \
         key_type##value_type##KVPair *old_table = map->table; \
-        bool *old_occupied = map->occupied; \
+        u8 *old_control = map->control; \
         u64 old_capacity = map->capacity; \
+        u64 old_size = map->size; \
         key_type##value_type##HashMap_construct(map); \
-        map->capacity = old_capacity * 2; \
-        if (old_capacity == 0) { \
-            map->capacity = 10; \
-        } \
+        /* NOTE(mdizdar): if most of what's taking up space is deleted slots, rehashing at the same size is enough */ \
+        map->capacity = old_capacity == 0 ? 16 : old_size*16 <= old_capacity*7 ? old_capacity : old_capacity*2; \
+        map->growth_left = map->capacity / 8 * 7; \
         \
-        map->table = calloc(map->capacity, sizeof(key_type##value_type##KVPair)); \
-        map->occupied = calloc(map->capacity, sizeof(bool)); \
+        map->table = malloc(map->capacity * sizeof(key_type##value_type##KVPair)); \
+        map->control = malloc(map->capacity + HASH_MAP_GROUP_WIDTH); \
+        memset(map->control, HASH_MAP_EMPTY, map->capacity + HASH_MAP_GROUP_WIDTH); \
         for (u64 i = 0; i < old_capacity; ++i) { \
-            if (old_occupied[i] == 0) continue; \
-            key_type##value_type##HashMap_add_helper(map, &old_table[i].key, &old_table[i].value); \
+            if (!HASH_MAP_IS_FULL(old_control[i])) continue; \
+            const u64 hash = HashMap_mix(key_type##_hash(&old_table[i].key)); \
+            u64 travel = 0; \
+            u64 index = key_type##value_type##HashMap_find_free(map, hash, &travel); \
+            key_type##value_type##HashMap_set_control(map, index, HASH_MAP_FINGERPRINT(hash)); \
+            memcpy(map->table + index, old_table + i, sizeof *old_table); \
+            --map->growth_left; \
+            ++map->size; \
         } \
         if (old_table != NULL) { \
             free(old_table); \
-            free(old_occupied); \
+            free(old_control); \
         } \
     } \
     \
     void key_type##value_type##HashMap_add(key_type##value_type##HashMap *map, const key_type *key, const value_type *value) { \
-        if (map->capacity == 0) { \
-            key_type##value_type##HashMap_resize(map); \
-        } \
-        const u64 travel = key_type##value_type##HashMap_add_helper(map, key, value); \
-        \
-        if ((travel > map->capacity/2) || (1.0 * map->size / map->capacity > map->resize_threshold)) { \
+        if (map->growth_left == 0) { \
             key_type##value_type##HashMap_resize(map); \
         } \
+        key_type##value_type##HashMap_add_helper(map, key, value); \
     } \
     \
     key_type##value_type##KVPair *key_type##value_type##HashMap_get_helper(const key_type##value_type##HashMap *map, const key_type *key) { \
         if (map->size == 0) { \
             return NULL; \
         } \
-        u64 hash = key_type##_hash(key) % map->capacity; \
-        u64 travel = 0; \
-        while (map->occupied[hash] != 0) { \
-            if (key_type##_eq(&map->table[hash].key, key)) { \
-                return map->table + hash; \
-            } \
-            hash = (hash+1) % map->capacity; \
-            ++travel; \
-        } \
-        return NULL; \
+        return key_type##value_type##HashMap_find(map, key, HashMap_mix(key_type##_hash(key))); \
     } \
     \
     value_type *key_type##value_type##HashMap_get(const key_type##value_type##HashMap *map, const key_type *key) { \
@@ -145,27 +240,18 @@
     } \
     \
     void key_type##value_type##HashMap_erase(key_type##value_type##HashMap *map, const key_type *key) { \
-        u64 hash = key_type##_hash(key) % map->capacity; \
-        u64 travel = 0; \
-        while (map->occupied[hash] != 0) { \
-            if (key_type##_eq(&map->table[hash].key, key)) { \
-                map->occupied[hash] = 0; \
-                --map->size; \
-                return; \
-            } \
-            hash = (hash+1) % map->capacity; \
-            ++travel; \
+        key_type##value_type##KVPair *entry = key_type##value_type##HashMap_get_helper(map, key); \
+        if (entry == NULL) { \
+            return; \
         } \
+        /* NOTE(mdizdar): the slot can't go back to empty, something after it on a probe sequence might be relying on it being taken */ \
+        key_type##value_type##HashMap_set_control(map, entry - map->table, HASH_MAP_DELETED); \
+        --map->size; \
     } \
     \
     key_type##value_type##KVPair *key_type##value_type##HashMap_begin(const key_type##value_type##HashMap *map) { \
         if (map->size == 0) return NULL; \
-        for (u64 i = 0; i < map->capacity; ++i) { \
-            if (map->occupied[i]) { \
-                return map->table + i; \
-            } \
-        } \
-        assert(false); \
+        return map->table + HashMap_nextFull(map->control, map->capacity, 0); \
     } \
     \
     key_type##value_type##KVPair *key_type##value_type##HashMap_end(const key_type##value_type##HashMap *map) { \
@@ -177,18 +263,13 @@
                                                                      key_type##value_type##KVPair *el) { \
         assert(el >= map->table); \
         assert(el < map->table+map->capacity); \
-        for (u64 i = 1 + (u64)(el - map->table); i < map->capacity; ++i) { \
-            if (map->occupied[i]) { \
-                return map->table + i; \
-            } \
-        } \
-        return key_type##value_type##HashMap_end(map); \
+        return map->table + HashMap_nextFull(map->control, map->capacity, 1 + (u64)(el - map->table)); \
     } \
     \
     key_type##value_type##KVPair *key_type##value_type##HashMap_rbegin(const key_type##value_type##HashMap *map) { \
         if (map->size == 0) return NULL; \
         for (u64 i = map->capacity; i > 0; --i) { \
-            if (map->occupied[i-1]) { \
+            if (HASH_MAP_IS_FULL(map->control[i-1])) { \
                 return map->table + i - 1; \
             } \
         } \
@@ -205,7 +286,7 @@
         assert(el >= map->table); \
         assert(el < map->table+map->capacity); \
         for (u64 i = el - map->table; i > 0; --i) { \
-            if (map->occupied[i-1]) { \
+            if (HASH_MAP_IS_FULL(map->control[i-1])) { \
                 return map->table + i - 1; \
             } \
         } \
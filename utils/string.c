@@ -9,25 +9,36 @@ void String_construct(String *str) {
 }
 
 u64 String_hash(const String *name) {
-    u64 result = 5381;
-    for (u64 i = 0; i < name->count; ++i) {
-        result = ((result << 5) + result) + name->data[i]; /* hash * 33 + c */
+    // NOTE(mdizdar): 8 characters at a time, the hash maps mix the result some more on their end
+    u64 result = 0x9E3779B97F4A7C15ull ^ name->count;
+    u64 i = 0;
+    for (; i + 8 <= name->count; i += 8) {
+        u64 word;
+        memcpy(&word, name->data + i, 8);
+        result = (result ^ word) * 0xFF51AFD7ED558CCDull;
+        result ^= result >> 32;
     }
-    return result;
+    u64 tail = 0;
+    memcpy(&tail, name->data + i, name->count - i);
+    result = (result ^ tail) * 0xFF51AFD7ED558CCDull;
+    return result ^ (result >> 32);
 }
 
 bool String_eq(const String *a, const String *b) {
-    return !strcmp(a->data, b->data);
+    // NOTE(mdizdar): identifiers are interned by the lexer, so this is almost always decided before the memcmp
+    if (a->count != b->count) return false;
+    if (a->data == b->data) return true;
+    return !memcmp(a->data, b->data, a->count);
 }
 
 void String_copy(String *dest, const String *src, ...) {
-    // TODO(mdizdar): not freeing here might cause a memory leak, I'll deal with it later
-    dest->data = malloc(src->count);
+    // NOTE(mdizdar): Strings are immutable and their data outlives everything that refers to it
+    // (identifiers live in the lexer's intern table), so there's no need to actually copy the characters
+    dest->data = src->data;
     dest->count = src->count;
-    memcpy(dest->data, src->data, src->count+1);
 }
 
 void String_print(const String *s) {
-    printf("`%s` (%lu)", s->data, s->count);
+    printf("`%.*s` (%lu)", (int)s->count, s->data, s->count);
 }
 
@@ -11,3 +11,11 @@ u64 u64_hash(const u64 *_key) {
     key = key + (key << 31);
     return key;
 }
+
+bool u64_eq(const u64 *a, const u64 *b) {
+    return *a == *b;
+}
+
+void u64_copy(u64 *dest, const u64 *src) {
+    *dest = *src;
+}
@@ -31,6 +31,8 @@ _Static_assert(sizeof(f32) == 4, "Machines not compliant with IEEE 754/IEC 559 a
 _Static_assert(sizeof(f64) == 8, "Machines not compliant with IEEE 754/IEC 559 are not supported. `double` should be 8 bytes (64 bits) wide.");
 
 u64 u64_hash(const u64 *_key);
+bool u64_eq(const u64 *a, const u64 *b);
+void u64_copy(u64 *dest, const u64 *src);
 
 #define _generate_declarations(type) \
     typedef struct type##Array type##Array, *type##ArrayPtr; \